@@ -19,6 +19,8 @@ CTL_A_DIRECTDEPS =					\
 	LIBC_INTRIN					\
 	LIBC_MEM					\
 	LIBC_STR					\
+	LIBC_THREAD					\
+	THIRD_PARTY_VQSORT				\
 
 CTL_A_DEPS := $(call uniq,$(foreach x,$(CTL_A_DIRECTDEPS),$($(x))))
 
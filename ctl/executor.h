@@ -0,0 +1,232 @@
+// -*-mode:c++;indent-tabs-mode:nil;c-basic-offset:4;tab-width:8;coding:utf-8-*-
+// vi: set et ft=cpp ts=4 sts=4 sw=4 fenc=utf-8 :vi
+#ifndef CTL_EXECUTOR_H_
+#define CTL_EXECUTOR_H_
+#include "libc/thread/executor.h"
+#include "new.h"
+#include "utility.h"
+#include <__type_traits/is_trivially_copyable.h>
+#include <__type_traits/is_void.h>
+
+namespace ctl {
+
+namespace __ {
+
+template<typename R, typename F>
+struct task_box
+{
+    F f;
+    alignas(R) char r[sizeof(R)];
+
+    static void* call(void* p)
+    {
+        task_box* b = (task_box*)p;
+        return new (b->r) R(b->f());
+    }
+
+    static void drop(void* p)
+    {
+        task_box* b = (task_box*)p;
+        ((R*)b->r)->~R();
+        delete b;
+    }
+};
+
+template<typename F>
+struct task_box<void, F>
+{
+    F f;
+
+    static void* call(void* p)
+    {
+        ((task_box*)p)->f();
+        return nullptr;
+    }
+
+    static void drop(void* p)
+    {
+        delete (task_box*)p;
+    }
+};
+
+} // namespace __
+
+// handle to function running on an executor
+//
+// destroying a task that hasn't been waited on blocks until it's done,
+// the same way as the future returned by std::async().
+template<typename R>
+class task
+{
+  public:
+    constexpr task() noexcept = default;
+
+    task(cosmo_task* t, void* box, void (*drop)(void*)) noexcept
+      : t_(t), box_(box), drop_(drop)
+    {
+    }
+
+    task(task&& other) noexcept
+      : t_(other.t_), box_(other.box_), drop_(other.drop_)
+    {
+        other.t_ = nullptr;
+    }
+
+    task(const task&) = delete;
+
+    task& operator=(task&& other) noexcept
+    {
+        if (this != &other) {
+            wait();
+            t_ = other.t_;
+            box_ = other.box_;
+            drop_ = other.drop_;
+            other.t_ = nullptr;
+        }
+        return *this;
+    }
+
+    ~task()
+    {
+        wait();
+    }
+
+    bool valid() const noexcept
+    {
+        return t_;
+    }
+
+    bool done() const noexcept
+    {
+        return !t_ || cosmo_task_done(t_);
+    }
+
+    void wait()
+    {
+        if (t_) {
+            cosmo_task_join(t_);
+            t_ = nullptr;
+            drop_(box_);
+        }
+    }
+
+    R get()
+    {
+        cosmo_task* t = t_;
+        t_ = nullptr;
+        if constexpr (std::is_void_v<R>) {
+            cosmo_task_join(t);
+            drop_(box_);
+        } else {
+            R* p = (R*)cosmo_task_join(t);
+            R res(ctl::move(*p));
+            drop_(box_);
+            return res;
+        }
+    }
+
+  private:
+    cosmo_task* t_ = nullptr;
+    void* box_ = nullptr;
+    void (*drop_)(void*) = nullptr;
+};
+
+// work stealing thread pool
+//
+// see cosmo_executor_create() in libc/thread/executor.c
+class executor
+{
+  public:
+    explicit executor(int threads = 0, int flags = 0)
+      : ex_(cosmo_executor_create(threads, flags))
+    {
+        if (!ex_)
+            __builtin_trap();
+    }
+
+    ~executor()
+    {
+        cosmo_executor_destroy(ex_);
+    }
+
+    executor(const executor&) = delete;
+    executor& operator=(const executor&) = delete;
+
+    int threads() const noexcept
+    {
+        return cosmo_executor_threads(ex_);
+    }
+
+    cosmo_executor* native_handle() noexcept
+    {
+        return ex_;
+    }
+
+    template<typename F>
+    auto submit(F f) -> task<decltype(f())>
+    {
+        using R = decltype(f());
+        using box = __::task_box<R, F>;
+        box* b = new box{ ctl::move(f) };
+        cosmo_task* t = cosmo_executor_submit(ex_, box::call, b);
+        if (!t)
+            __builtin_trap();
+        return task<R>(t, b, box::drop);
+    }
+
+    // calls f(b, e) on subranges of [begin,end) from many threads
+    template<typename F>
+    void parallel_for(long begin, long end, F f, long grain = 1)
+    {
+        cosmo_executor_parallel_for(
+          ex_,
+          begin,
+          end,
+          grain,
+          [](void* f, long b, long e) { (*(F*)f)(b, e); },
+          &f);
+    }
+
+    // returns reduce(...reduce(identity, map(b0, e0))..., map(bN, eN))
+    template<typename T, typename Map, typename Reduce>
+    T parallel_reduce(long begin,
+                      long end,
+                      T identity,
+                      Map map,
+                      Reduce reduce,
+                      long grain = 1)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        struct fns
+        {
+            Map& map;
+            Reduce& reduce;
+        } c{ map, reduce };
+        if (cosmo_executor_parallel_reduce(
+              ex_,
+              begin,
+              end,
+              grain,
+              &identity,
+              sizeof(T),
+              [](void* a, long b, long e, void* acc) {
+                  fns* c = (fns*)a;
+                  *(T*)acc = c->reduce(*(T*)acc, c->map(b, e));
+              },
+              [](void* a, void* acc, const void* x) {
+                  fns* c = (fns*)a;
+                  *(T*)acc = c->reduce(*(T*)acc, *(const T*)x);
+              },
+              &c))
+            if (begin < end)
+                identity = reduce(identity, map(begin, end));
+        return identity;
+    }
+
+  private:
+    cosmo_executor* ex_;
+};
+
+} // namespace ctl
+
+#endif // CTL_EXECUTOR_H_
@@ -0,0 +1,133 @@
+// -*- mode:c++; indent-tabs-mode:nil; c-basic-offset:4; coding:utf-8 -*-
+// vi: set et ft=cpp ts=4 sts=4 sw=4 fenc=utf-8 :vi
+//
+// Copyright 2024 Justine Alexandra Roberts Tunney
+//
+// Permission to use, copy, modify, and/or distribute this software for
+// any purpose with or without fee is hereby granted, provided that the
+// above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+// WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE
+// AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+// DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR
+// PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+// TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+
+#include "hash.h"
+#include "hashtable.h"
+
+#include <string.h>
+
+// This is wyhash final version 4 by Wang Yi, which is public domain.
+// https://github.com/wangyi-fudan/wyhash
+
+namespace ctl {
+
+namespace {
+
+constexpr uint64_t kSecret0 = 0x2d358dccaa6c78a5ull;
+constexpr uint64_t kSecret1 = 0x8bb84b93962eacc9ull;
+constexpr uint64_t kSecret2 = 0x4b33a62ed433d4a3ull;
+constexpr uint64_t kSecret3 = 0x4d5a2da51de1aa47ull;
+
+inline void
+mum128(uint64_t* a, uint64_t* b)
+{
+    __uint128_t r = *a;
+    r *= *b;
+    *a = static_cast<uint64_t>(r);
+    *b = static_cast<uint64_t>(r >> 64);
+}
+
+inline uint64_t
+mix(uint64_t a, uint64_t b)
+{
+    mum128(&a, &b);
+    return a ^ b;
+}
+
+inline uint64_t
+read8(const unsigned char* p)
+{
+    uint64_t v;
+    memcpy(&v, p, 8);
+    return v;
+}
+
+inline uint64_t
+read4(const unsigned char* p)
+{
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+inline uint64_t
+read3(const unsigned char* p, size_t k)
+{
+    return (static_cast<uint64_t>(p[0]) << 16) |
+           (static_cast<uint64_t>(p[k >> 1]) << 8) | p[k - 1];
+}
+
+} // namespace
+
+size_t
+hash_bytes(const void* data, size_t n, size_t seed) noexcept
+{
+    uint64_t a, b;
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    seed ^= mix(seed ^ kSecret0, kSecret1);
+    if (n <= 16) {
+        if (n >= 4) {
+            a = (read4(p) << 32) | read4(p + ((n >> 3) << 2));
+            b = (read4(p + n - 4) << 32) | read4(p + n - 4 - ((n >> 3) << 2));
+        } else if (n > 0) {
+            a = read3(p, n);
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        size_t i = n;
+        if (i > 48) {
+            uint64_t see1 = seed, see2 = seed;
+            do {
+                seed = mix(read8(p) ^ kSecret1, read8(p + 8) ^ seed);
+                see1 = mix(read8(p + 16) ^ kSecret2, read8(p + 24) ^ see1);
+                see2 = mix(read8(p + 32) ^ kSecret3, read8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            seed ^= see1 ^ see2;
+        }
+        while (i > 16) {
+            seed = mix(read8(p) ^ kSecret1, read8(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+        a = read8(p + i - 16);
+        b = read8(p + i - 8);
+    }
+    a ^= kSecret1;
+    b ^= seed;
+    mum128(&a, &b);
+    return mix(a ^ kSecret0 ^ n, b ^ kSecret1);
+}
+
+namespace __ {
+
+// control bytes of a hash table that has no allocation
+alignas(16) const signed char empty_group[16] = {
+    ctrl_sentinel, ctrl_empty, ctrl_empty, ctrl_empty,
+    ctrl_empty,    ctrl_empty, ctrl_empty, ctrl_empty,
+    ctrl_empty,    ctrl_empty, ctrl_empty, ctrl_empty,
+    ctrl_empty,    ctrl_empty, ctrl_empty, ctrl_empty,
+};
+
+} // namespace __
+
+} // namespace ctl
@@ -0,0 +1,97 @@
+// -*-mode:c++;indent-tabs-mode:nil;c-basic-offset:4;tab-width:8;coding:utf-8-*-
+// vi: set et ft=cpp ts=4 sts=4 sw=4 fenc=utf-8 :vi
+#ifndef CTL_HASH_H_
+#define CTL_HASH_H_
+#include "string.h"
+#include "string_view.h"
+
+namespace ctl {
+
+size_t
+hash_bytes(const void*, size_t, size_t = 0) noexcept;
+
+// Hash function customization point.
+//
+// Specialize this template for your own key types. The hash tables
+// remix whatever value this returns, so it's fine for it to be weak,
+// e.g. the identity function, as long as equal keys hash the same.
+template<typename T>
+struct hash;
+
+#define CTL_HASH_IDENTITY_(T)                                                  \
+    template<>                                                                 \
+    struct hash<T>                                                             \
+    {                                                                          \
+        size_t operator()(T x) const noexcept                                  \
+        {                                                                      \
+            return static_cast<size_t>(x);                                     \
+        }                                                                      \
+    }
+
+CTL_HASH_IDENTITY_(bool);
+CTL_HASH_IDENTITY_(char);
+CTL_HASH_IDENTITY_(signed char);
+CTL_HASH_IDENTITY_(unsigned char);
+CTL_HASH_IDENTITY_(char8_t);
+CTL_HASH_IDENTITY_(char16_t);
+CTL_HASH_IDENTITY_(char32_t);
+CTL_HASH_IDENTITY_(wchar_t);
+CTL_HASH_IDENTITY_(short);
+CTL_HASH_IDENTITY_(unsigned short);
+CTL_HASH_IDENTITY_(int);
+CTL_HASH_IDENTITY_(unsigned int);
+CTL_HASH_IDENTITY_(long);
+CTL_HASH_IDENTITY_(unsigned long);
+CTL_HASH_IDENTITY_(long long);
+CTL_HASH_IDENTITY_(unsigned long long);
+
+#undef CTL_HASH_IDENTITY_
+
+template<typename T>
+struct hash<T*>
+{
+    size_t operator()(T* p) const noexcept
+    {
+        return reinterpret_cast<size_t>(p);
+    }
+};
+
+template<>
+struct hash<float>
+{
+    size_t operator()(float x) const noexcept
+    {
+        return x == 0 ? 0 : hash_bytes(&x, sizeof(x));
+    }
+};
+
+template<>
+struct hash<double>
+{
+    size_t operator()(double x) const noexcept
+    {
+        return x == 0 ? 0 : hash_bytes(&x, sizeof(x));
+    }
+};
+
+template<>
+struct hash<string_view>
+{
+    size_t operator()(string_view s) const noexcept
+    {
+        return hash_bytes(s.p, s.n);
+    }
+};
+
+template<>
+struct hash<string>
+{
+    size_t operator()(const string& s) const noexcept
+    {
+        return hash_bytes(s.data(), s.size());
+    }
+};
+
+} // namespace ctl
+
+#endif // CTL_HASH_H_
@@ -0,0 +1,705 @@
+// -*-mode:c++;indent-tabs-mode:nil;c-basic-offset:4;tab-width:8;coding:utf-8-*-
+// vi: set et ft=cpp ts=4 sts=4 sw=4 fenc=utf-8 :vi
+#ifndef CTL_HASHTABLE_H_
+#define CTL_HASHTABLE_H_
+#include "libc/mem/mem.h"
+#include "new.h"
+#include "pair.h"
+#include "utility.h"
+#include <__type_traits/conditional.h>
+#include <__type_traits/is_trivially_copyable.h>
+#include <__type_traits/is_trivially_destructible.h>
+#include <stdckdint.h>
+#include <string.h>
+
+namespace ctl {
+
+namespace __ {
+
+// Open addressing hash table with SIMD probed control bytes.
+//
+// This is the design of Google's Swiss Table. Each slot has a control
+// byte that's either empty, deleted, or holds the low 7 bits of the
+// hash of the key stored in that slot. Lookups examine a whole group
+// of control bytes at once, using SSE2 on x86-64 and 64-bit SWAR code
+// elsewhere, so a probe usually costs one load, one compare and one
+// key comparison. The control bytes and slots share one allocation.
+//
+// The capacity is always zero or a power of two minus one. The table
+// grows when 7/8 of the slots have been used. The first group width
+// minus one control bytes are cloned after a sentinel byte, so groups
+// may be loaded from any position without wrapping around.
+
+enum : signed char
+{
+    ctrl_empty = -128, // 0b10000000
+    ctrl_deleted = -2, // 0b11111110
+    ctrl_sentinel = -1, // 0b11111111
+};
+
+extern const signed char empty_group[16];
+
+template<typename T, int Shift>
+class bitmask
+{
+  public:
+    explicit bitmask(T mask) : mask_(mask)
+    {
+    }
+
+    explicit operator bool() const
+    {
+        return mask_ != 0;
+    }
+
+    int lowest() const
+    {
+        return __builtin_ctzll(mask_) >> Shift;
+    }
+
+    int trailing_zeros() const
+    {
+        return __builtin_ctzll(mask_) >> Shift;
+    }
+
+    int leading_zeros() const
+    {
+        constexpr int extra = sizeof(long long) * 8 - sizeof(T) * 8;
+        return (__builtin_clzll(mask_) - extra) >> Shift;
+    }
+
+    void clear_lowest()
+    {
+        mask_ &= mask_ - 1;
+    }
+
+  private:
+    T mask_;
+};
+
+#ifdef __x86_64__
+
+struct group
+{
+    static constexpr size_t width = 16;
+    typedef char v16 __attribute__((__vector_size__(16)));
+    typedef bitmask<unsigned short, 0> mask;
+
+    v16 ctrl;
+
+    explicit group(const signed char* p)
+    {
+        memcpy(&ctrl, p, sizeof(ctrl));
+    }
+
+    static unsigned short movemask(v16 v)
+    {
+        return __builtin_ia32_pmovmskb128(v);
+    }
+
+    mask match(signed char h) const
+    {
+        return mask(movemask((v16)(ctrl == (char)h)));
+    }
+
+    mask match_empty() const
+    {
+        return mask(movemask((v16)(ctrl == (char)ctrl_empty)));
+    }
+
+    mask match_empty_or_deleted() const
+    {
+        typedef signed char s16 __attribute__((__vector_size__(16)));
+        return mask(movemask((v16)((s16)ctrl < (signed char)ctrl_sentinel)));
+    }
+};
+
+#else
+
+struct group
+{
+    static constexpr size_t width = 8;
+    static constexpr uint64_t lsbs = 0x0101010101010101;
+    static constexpr uint64_t msbs = 0x8080808080808080;
+    typedef bitmask<uint64_t, 3> mask;
+
+    uint64_t ctrl;
+
+    explicit group(const signed char* p)
+    {
+        memcpy(&ctrl, p, sizeof(ctrl));
+    }
+
+    // may report false positives, which get weeded out by key compare
+    mask match(signed char h) const
+    {
+        uint64_t x = ctrl ^ (lsbs * (unsigned char)h);
+        return mask((x - lsbs) & ~x & msbs);
+    }
+
+    mask match_empty() const
+    {
+        return mask((ctrl & ~(ctrl << 6)) & msbs);
+    }
+
+    mask match_empty_or_deleted() const
+    {
+        return mask((ctrl & ~(ctrl << 7)) & msbs);
+    }
+};
+
+#endif
+
+inline size_t
+mix_hash(size_t h)
+{
+    __uint128_t m = h;
+    m *= 0x9e3779b97f4a7c15ull;
+    return static_cast<size_t>(m) ^ static_cast<size_t>(m >> 64);
+}
+
+inline size_t
+capacity_to_growth(size_t capacity)
+{
+    if (group::width == 8 && capacity == 7)
+        return 6;
+    return capacity - capacity / 8;
+}
+
+inline size_t
+normalize_capacity(size_t n)
+{
+    return n ? ~size_t{} >> __builtin_clzll(n) : 1;
+}
+
+// KeyOf extracts the key from a stored value.
+template<typename Value, typename Key, typename KeyOf, typename Hash,
+         typename KeyEqual>
+class hashtable
+{
+  public:
+    using key_type = Key;
+    using value_type = Value;
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+    using hasher = Hash;
+    using key_equal = KeyEqual;
+
+    template<bool Const>
+    class basic_iterator
+    {
+      public:
+        using value_type = Value;
+        using difference_type = ptrdiff_t;
+        using pointer = std::conditional_t<Const, const Value*, Value*>;
+        using reference = std::conditional_t<Const, const Value&, Value&>;
+
+        basic_iterator() : ctrl_(nullptr), slot_(nullptr)
+        {
+        }
+
+        basic_iterator(const basic_iterator<false>& other)
+          : ctrl_(other.ctrl_), slot_(other.slot_)
+        {
+        }
+
+        reference operator*() const
+        {
+            return *slot_;
+        }
+
+        pointer operator->() const
+        {
+            return slot_;
+        }
+
+        basic_iterator& operator++()
+        {
+            ++ctrl_;
+            ++slot_;
+            skip_empty_or_deleted();
+            return *this;
+        }
+
+        basic_iterator operator++(int)
+        {
+            basic_iterator tmp = *this;
+            ++(*this);
+            return tmp;
+        }
+
+        template<bool C>
+        bool operator==(const basic_iterator<C>& other) const
+        {
+            return ctrl_ == other.ctrl_;
+        }
+
+        template<bool C>
+        bool operator!=(const basic_iterator<C>& other) const
+        {
+            return ctrl_ != other.ctrl_;
+        }
+
+      private:
+        friend class hashtable;
+        template<bool>
+        friend class basic_iterator;
+
+        basic_iterator(const signed char* ctrl, Value* slot)
+          : ctrl_(ctrl), slot_(slot)
+        {
+            skip_empty_or_deleted();
+        }
+
+        void skip_empty_or_deleted()
+        {
+            while (*ctrl_ < ctrl_sentinel) {
+                ++ctrl_;
+                ++slot_;
+            }
+        }
+
+        const signed char* ctrl_;
+        Value* slot_;
+    };
+
+    using iterator = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+
+    hashtable() noexcept
+      : ctrl_(const_cast<signed char*>(empty_group))
+      , slots_(nullptr)
+      , size_(0)
+      , capacity_(0)
+      , growth_left_(0)
+    {
+    }
+
+    hashtable(const hashtable& other)
+      : hashtable()
+    {
+        hasher_ = other.hasher_;
+        eq_ = other.eq_;
+        reserve(other.size_);
+        for (const Value& v : other)
+            new (&slots_[prepare_insert(hash_of(KeyOf()(v)))]) Value(v);
+    }
+
+    hashtable(hashtable&& other) noexcept
+      : ctrl_(other.ctrl_)
+      , slots_(other.slots_)
+      , size_(other.size_)
+      , capacity_(other.capacity_)
+      , growth_left_(other.growth_left_)
+      , hasher_(other.hasher_)
+      , eq_(other.eq_)
+    {
+        other.ctrl_ = const_cast<signed char*>(empty_group);
+        other.slots_ = nullptr;
+        other.size_ = 0;
+        other.capacity_ = 0;
+        other.growth_left_ = 0;
+    }
+
+    ~hashtable()
+    {
+        destroy_slots();
+        deallocate();
+    }
+
+    hashtable& operator=(const hashtable& other)
+    {
+        if (this != &other) {
+            hashtable tmp(other);
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    hashtable& operator=(hashtable&& other) noexcept
+    {
+        if (this != &other) {
+            hashtable tmp(ctl::move(other));
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    void swap(hashtable& other) noexcept
+    {
+        ctl::swap(ctrl_, other.ctrl_);
+        ctl::swap(slots_, other.slots_);
+        ctl::swap(size_, other.size_);
+        ctl::swap(capacity_, other.capacity_);
+        ctl::swap(growth_left_, other.growth_left_);
+        ctl::swap(hasher_, other.hasher_);
+        ctl::swap(eq_, other.eq_);
+    }
+
+    iterator begin() noexcept
+    {
+        return iterator(ctrl_, slots_);
+    }
+
+    const_iterator begin() const noexcept
+    {
+        return const_iterator(ctrl_, slots_);
+    }
+
+    iterator end() noexcept
+    {
+        return iterator(ctrl_ + capacity_, slots_ + capacity_);
+    }
+
+    const_iterator end() const noexcept
+    {
+        return const_iterator(ctrl_ + capacity_, slots_ + capacity_);
+    }
+
+    bool empty() const noexcept
+    {
+        return !size_;
+    }
+
+    size_t size() const noexcept
+    {
+        return size_;
+    }
+
+    size_t max_size() const noexcept
+    {
+        return (size_t)-1 / sizeof(Value) / 2;
+    }
+
+    size_t bucket_count() const noexcept
+    {
+        return capacity_;
+    }
+
+    float load_factor() const noexcept
+    {
+        return capacity_ ? (float)size_ / capacity_ : 0;
+    }
+
+    hasher hash_function() const
+    {
+        return hasher_;
+    }
+
+    key_equal key_eq() const
+    {
+        return eq_;
+    }
+
+    void clear() noexcept
+    {
+        if (!capacity_)
+            return;
+        destroy_slots();
+        reset_ctrl();
+        size_ = 0;
+    }
+
+    void reserve(size_t n)
+    {
+        if (n > size_ + growth_left_) {
+            size_t want = n + (n - 1) / 7;
+            rehash_to(normalize_capacity(want));
+        }
+    }
+
+    void rehash(size_t n)
+    {
+        if (!n && !capacity_)
+            return;
+        size_t want = size_ + (size_ ? (size_ - 1) / 7 : 0);
+        if (n < want)
+            n = want;
+        if (!n) {
+            destroy_slots();
+            deallocate();
+            ctrl_ = const_cast<signed char*>(empty_group);
+            slots_ = nullptr;
+            capacity_ = 0;
+            growth_left_ = 0;
+            return;
+        }
+        n = normalize_capacity(n);
+        if (n != capacity_)
+            rehash_to(n);
+    }
+
+    template<typename K>
+    iterator find(const K& key)
+    {
+        size_t i = find_index(key, hash_of(key));
+        if (i == (size_t)-1)
+            return end();
+        return iterator(ctrl_ + i, slots_ + i);
+    }
+
+    template<typename K>
+    const_iterator find(const K& key) const
+    {
+        size_t i = find_index(key, hash_of(key));
+        if (i == (size_t)-1)
+            return end();
+        return const_iterator(ctrl_ + i, slots_ + i);
+    }
+
+    template<typename K>
+    bool contains(const K& key) const
+    {
+        return find_index(key, hash_of(key)) != (size_t)-1;
+    }
+
+    // Returns the slot for key, or an uninitialized slot with a control
+    // byte already assigned, in which case the caller must construct a
+    // value with that key using placement new.
+    template<typename K>
+    ctl::pair<size_t, bool> find_or_prepare_insert(const K& key)
+    {
+        size_t h = hash_of(key);
+        size_t i = find_index(key, h);
+        if (i != (size_t)-1)
+            return { i, false };
+        return { prepare_insert(h), true };
+    }
+
+    Value* slot(size_t i) noexcept
+    {
+        return slots_ + i;
+    }
+
+    iterator iterator_at(size_t i) noexcept
+    {
+        return iterator(ctrl_ + i, slots_ + i);
+    }
+
+    template<typename V>
+    ctl::pair<iterator, bool> insert(V&& value)
+    {
+        auto [i, inserted] = find_or_prepare_insert(KeyOf()(value));
+        if (inserted)
+            new (&slots_[i]) Value(ctl::forward<V>(value));
+        return { iterator_at(i), inserted };
+    }
+
+    template<typename... Args>
+    ctl::pair<iterator, bool> emplace(Args&&... args)
+    {
+        Value tmp(ctl::forward<Args>(args)...);
+        return insert(ctl::move(tmp));
+    }
+
+    iterator erase(const_iterator pos)
+    {
+        size_t i = pos.ctrl_ - ctrl_;
+        erase_at(i);
+        return iterator(ctrl_ + i + 1, slots_ + i + 1);
+    }
+
+    iterator erase(const_iterator first, const_iterator last)
+    {
+        while (first != last)
+            first = erase(first);
+        return iterator(last.ctrl_, last.slot_);
+    }
+
+    template<typename K>
+    size_t erase_key(const K& key)
+    {
+        size_t i = find_index(key, hash_of(key));
+        if (i == (size_t)-1)
+            return 0;
+        erase_at(i);
+        return 1;
+    }
+
+  private:
+    static constexpr size_t cloned = group::width - 1;
+
+    template<typename K>
+    size_t hash_of(const K& key) const
+    {
+        return mix_hash(hasher_(key));
+    }
+
+    static size_t h1(size_t hash)
+    {
+        return hash >> 7;
+    }
+
+    static signed char h2(size_t hash)
+    {
+        return hash & 0x7f;
+    }
+
+    static size_t slots_offset(size_t capacity)
+    {
+        size_t a = alignof(Value);
+        return (capacity + group::width + a - 1) & -a;
+    }
+
+    template<typename K>
+    size_t find_index(const K& key, size_t hash) const
+    {
+        size_t mask = capacity_;
+        size_t offset = h1(hash) & mask;
+        for (size_t index = 0;;) {
+            group g(ctrl_ + offset);
+            for (auto m = g.match(h2(hash)); m; m.clear_lowest()) {
+                size_t i = (offset + m.lowest()) & mask;
+                if (eq_(KeyOf()(slots_[i]), key))
+                    return i;
+            }
+            if (g.match_empty())
+                return -1;
+            index += group::width;
+            offset = (offset + index) & mask;
+            if (index > capacity_)
+                return -1;
+        }
+    }
+
+    size_t find_first_non_full(size_t hash) const
+    {
+        size_t mask = capacity_;
+        size_t offset = h1(hash) & mask;
+        for (size_t index = 0;;) {
+            group g(ctrl_ + offset);
+            if (auto m = g.match_empty_or_deleted())
+                return (offset + m.lowest()) & mask;
+            index += group::width;
+            offset = (offset + index) & mask;
+        }
+    }
+
+    void set_ctrl(size_t i, signed char h)
+    {
+        ctrl_[i] = h;
+        ctrl_[((i - cloned) & capacity_) + (cloned & capacity_)] = h;
+    }
+
+    size_t prepare_insert(size_t hash)
+    {
+        size_t i = find_first_non_full(hash);
+        if (!growth_left_ && ctrl_[i] != ctrl_deleted) {
+            grow();
+            i = find_first_non_full(hash);
+        }
+        ++size_;
+        growth_left_ -= ctrl_[i] == ctrl_empty;
+        set_ctrl(i, h2(hash));
+        return i;
+    }
+
+    void erase_at(size_t i)
+    {
+        slots_[i].~Value();
+        --size_;
+        // if no probe sequence could have ever walked past this slot,
+        // since it's in a group that has never been full, then we can
+        // mark it empty rather than leaving a tombstone
+        size_t before = (i - group::width) & capacity_;
+        auto empty_after = group(ctrl_ + i).match_empty();
+        auto empty_before = group(ctrl_ + before).match_empty();
+        bool was_never_full = empty_before && empty_after &&
+                              (size_t)(empty_after.trailing_zeros() +
+                                       empty_before.leading_zeros()) <
+                                group::width;
+        set_ctrl(i, was_never_full ? ctrl_empty : ctrl_deleted);
+        growth_left_ += was_never_full;
+    }
+
+    void grow()
+    {
+        if (capacity_ > group::width && size_ * 32 <= capacity_ * 25) {
+            rehash_to(capacity_); // reclaim tombstones
+        } else {
+            size_t c2;
+            if (ckd_add(&c2, capacity_ * 2, 1))
+                __builtin_trap();
+            rehash_to(c2);
+        }
+    }
+
+    void reset_ctrl()
+    {
+        memset(ctrl_, ctrl_empty, capacity_ + group::width);
+        ctrl_[capacity_] = ctrl_sentinel;
+        growth_left_ = capacity_to_growth(capacity_) - size_;
+    }
+
+    void rehash_to(size_t capacity)
+    {
+        void* mem;
+        size_t bytes;
+        if (ckd_mul(&bytes, capacity, sizeof(Value)) ||
+            ckd_add(&bytes, bytes, slots_offset(capacity)))
+            __builtin_trap();
+        if (alignof(Value) <= alignof(max_align_t))
+            mem = malloc(bytes);
+        else
+            mem = memalign(alignof(Value), bytes);
+        if (!mem)
+            __builtin_trap();
+        signed char* old_ctrl = ctrl_;
+        Value* old_slots = slots_;
+        size_t old_capacity = capacity_;
+        ctrl_ = static_cast<signed char*>(mem);
+        slots_ = reinterpret_cast<Value*>(static_cast<char*>(mem) +
+                                          slots_offset(capacity));
+        capacity_ = capacity;
+        reset_ctrl();
+        for (size_t i = 0; i < old_capacity; ++i) {
+            if (old_ctrl[i] >= 0) {
+                size_t h = hash_of(KeyOf()(old_slots[i]));
+                size_t j = find_first_non_full(h);
+                set_ctrl(j, h2(h));
+                transfer(slots_ + j, old_slots + i);
+            }
+        }
+        if (old_capacity)
+            free(old_ctrl);
+    }
+
+    // relocates a value from a slot that's about to be discarded
+    static void transfer(Value* dst, Value* src)
+    {
+        if constexpr (std::is_trivially_copyable_v<Value>) {
+            memcpy(static_cast<void*>(dst), src, sizeof(Value));
+        } else {
+            KeyOf::relocate(dst, src);
+            src->~Value();
+        }
+    }
+
+    void destroy_slots()
+    {
+        if constexpr (!std::is_trivially_destructible_v<Value>)
+            for (size_t i = 0; i < capacity_; ++i)
+                if (ctrl_[i] >= 0)
+                    slots_[i].~Value();
+    }
+
+    void deallocate()
+    {
+        if (capacity_)
+            free(ctrl_);
+    }
+
+    signed char* ctrl_;
+    Value* slots_;
+    size_t size_;
+    size_t capacity_;
+    size_t growth_left_;
+    [[no_unique_address]] Hash hasher_;
+    [[no_unique_address]] KeyEqual eq_;
+};
+
+} // namespace __
+
+} // namespace ctl
+
+#endif // CTL_HASHTABLE_H_
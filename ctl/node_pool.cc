@@ -0,0 +1,89 @@
+// -*- mode:c++; indent-tabs-mode:nil; c-basic-offset:4; coding:utf-8 -*-
+// vi: set et ft=cpp ts=4 sts=4 sw=4 fenc=utf-8 :vi
+//
+// Copyright 2024 Justine Alexandra Roberts Tunney
+//
+// Permission to use, copy, modify, and/or distribute this software for
+// any purpose with or without fee is hereby granted, provided that the
+// above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+// WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE
+// AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+// DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR
+// PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+// TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include "node_pool.h"
+#include "utility.h"
+
+#include "libc/mem/mem.h"
+#include <stdckdint.h>
+
+namespace ctl {
+
+namespace __ {
+
+// the first slab is small so tiny containers stay tiny
+static constexpr size_t kMinNodes = 8;
+
+// slabs stop growing once they reach this size
+static constexpr size_t kMaxBytes = 256 * 1024;
+
+void
+node_pool::grow()
+{
+    size_t count = count_ ? count_ * 2 : kMinNodes;
+    if (count_ && count * size_ > kMaxBytes)
+        count = count_;
+    size_t header = (sizeof(slab) + align_ - 1) & -align_;
+    size_t bytes;
+    if (ckd_mul(&bytes, count, size_) || ckd_add(&bytes, bytes, header))
+        __builtin_trap();
+    void* mem;
+    if (align_ <= alignof(max_align_t))
+        mem = malloc(bytes);
+    else
+        mem = memalign(align_, bytes);
+    if (!mem)
+        __builtin_trap();
+    slab* s = static_cast<slab*>(mem);
+    s->next = slabs_;
+    slabs_ = s;
+    next_ = static_cast<char*>(mem) + header;
+    end_ = next_ + count * size_;
+    count_ = count;
+}
+
+void
+node_pool::release() noexcept
+{
+    slab* next;
+    for (slab* s = slabs_; s; s = next) {
+        next = s->next;
+        free(s);
+    }
+    free_ = nullptr;
+    next_ = nullptr;
+    end_ = nullptr;
+    slabs_ = nullptr;
+    count_ = 0;
+}
+
+void
+node_pool::swap(node_pool& other) noexcept
+{
+    ctl::swap(size_, other.size_);
+    ctl::swap(align_, other.align_);
+    ctl::swap(free_, other.free_);
+    ctl::swap(next_, other.next_);
+    ctl::swap(end_, other.end_);
+    ctl::swap(slabs_, other.slabs_);
+    ctl::swap(count_, other.count_);
+}
+
+} // namespace __
+
+} // namespace ctl
@@ -0,0 +1,115 @@
+// -*-mode:c++;indent-tabs-mode:nil;c-basic-offset:4;tab-width:8;coding:utf-8-*-
+// vi: set et ft=cpp ts=4 sts=4 sw=4 fenc=utf-8 :vi
+#ifndef CTL_NODE_POOL_H_
+#define CTL_NODE_POOL_H_
+
+namespace ctl {
+
+namespace __ {
+
+// Fixed size allocator for the nodes of a single container.
+//
+// Nodes are carved out of slabs that double in size up to a limit, so
+// neighboring nodes tend to be neighbors in memory. Freed nodes go on
+// a free list and are reused by the next allocation. Memory is only
+// given back to malloc() when release() is called, which frees every
+// slab at once without visiting the individual nodes. The caller is
+// responsible for destroying any objects that live in the nodes.
+class node_pool
+{
+  public:
+    node_pool(size_t size, size_t align) noexcept
+      : size_(size < sizeof(void*) ? sizeof(void*) : size)
+      , align_(align)
+      , free_(nullptr)
+      , next_(nullptr)
+      , end_(nullptr)
+      , slabs_(nullptr)
+      , count_(0)
+    {
+    }
+
+    node_pool(node_pool&& other) noexcept
+      : size_(other.size_)
+      , align_(other.align_)
+      , free_(other.free_)
+      , next_(other.next_)
+      , end_(other.end_)
+      , slabs_(other.slabs_)
+      , count_(other.count_)
+    {
+        other.free_ = nullptr;
+        other.next_ = nullptr;
+        other.end_ = nullptr;
+        other.slabs_ = nullptr;
+        other.count_ = 0;
+    }
+
+    node_pool(const node_pool&) = delete;
+    node_pool& operator=(const node_pool&) = delete;
+
+    node_pool& operator=(node_pool&& other) noexcept
+    {
+        if (this != &other) {
+            release();
+            swap(other);
+        }
+        return *this;
+    }
+
+    ~node_pool()
+    {
+        release();
+    }
+
+    void* allocate()
+    {
+        if (free_) {
+            void* p = free_;
+            free_ = free_->next;
+            return p;
+        }
+        if (next_ == end_)
+            grow();
+        void* p = next_;
+        next_ += size_;
+        return p;
+    }
+
+    void deallocate(void* p) noexcept
+    {
+        free_node* f = static_cast<free_node*>(p);
+        f->next = free_;
+        free_ = f;
+    }
+
+    void swap(node_pool& other) noexcept;
+    void release() noexcept;
+
+  private:
+    struct free_node
+    {
+        free_node* next;
+    };
+
+    struct slab
+    {
+        slab* next;
+    };
+
+    void grow();
+
+    size_t size_;
+    size_t align_;
+    free_node* free_;
+    char* next_;
+    char* end_;
+    slab* slabs_;
+    size_t count_;
+};
+
+} // namespace __
+
+} // namespace ctl
+
+#endif // CTL_NODE_POOL_H_
@@ -4,10 +4,16 @@
 #define CTL_SET_H_
 #include "initializer_list.h"
 #include "less.h"
+#include "new.h"
+#include "node_pool.h"
 #include "pair.h"
+#include <__type_traits/is_trivially_destructible.h>
 
 namespace ctl {
 
+// Nodes are allocated from a slab pool owned by each set, which keeps
+// the tree compact in memory and makes clear() cheap. Destroying a set
+// of trivially destructible keys doesn't need to walk the tree at all.
 template<typename Key, typename Compare = less<Key>>
 class set
 {
@@ -250,7 +256,7 @@ class set
             insert(*first);
     }
 
-    set(const set& other) : root_(nullptr), size_(0)
+    set(const set& other) : root_(nullptr), size_(0), comp_(other.comp_)
     {
         if (other.root_) {
             root_ = copier(other.root_);
@@ -258,7 +264,11 @@ class set
         }
     }
 
-    set(set&& other) noexcept : root_(other.root_), size_(other.size_)
+    set(set&& other) noexcept
+      : root_(other.root_)
+      , size_(other.size_)
+      , comp_(other.comp_)
+      , pool_(ctl::move(other.pool_))
     {
         other.root_ = nullptr;
         other.size_ = 0;
@@ -294,6 +304,7 @@ class set
             clear();
             root_ = other.root_;
             size_ = other.size_;
+            pool_ = ctl::move(other.pool_);
             other.root_ = nullptr;
             other.size_ = 0;
         }
@@ -376,19 +387,23 @@ class set
 
     void clear() noexcept
     {
-        clearer(root_);
+        if constexpr (!std::is_trivially_destructible_v<Key>)
+            clearer(root_);
+        pool_.release();
         root_ = nullptr;
         size_ = 0;
     }
 
     pair<iterator, bool> insert(value_type&& value)
     {
-        return insert_node(new node_type(ctl::move(value)));
+        void* p = pool_.allocate();
+        return insert_node(new (p) node_type(ctl::move(value)));
     }
 
     pair<iterator, bool> insert(const value_type& value)
     {
-        return insert_node(new node_type(value));
+        void* p = pool_.allocate();
+        return insert_node(new (p) node_type(value));
     }
 
     iterator insert(const_iterator hint, const value_type& value)
@@ -449,6 +464,7 @@ class set
     {
         ctl::swap(root_, other.root_);
         ctl::swap(size_, other.size_);
+        pool_.swap(other.pool_);
     }
 
     pair<iterator, iterator> equal_range(const key_type& key)
@@ -534,21 +550,29 @@ class set
         return node;
     }
 
+    // destroys values without freeing nodes, since pool owns memory
     static void clearer(node_type* node) noexcept
     {
         node_type* right;
         for (; node; node = right) {
             right = node->right;
             clearer(node->left);
-            delete node;
+            node->~node_type();
         }
     }
 
-    static node_type* copier(const node_type* node)
+    void destroy_node(node_type* node) noexcept
+    {
+        node->~node_type();
+        pool_.deallocate(node);
+    }
+
+    node_type* copier(const node_type* node)
     {
         if (node == nullptr)
             return nullptr;
-        node_type* new_node = new node_type(node->value);
+        node_type* new_node = new (pool_.allocate()) node_type(node->value);
+        new_node->is_red = node->is_red;
         new_node->left = copier(node->left);
         new_node->right = copier(node->right);
         if (new_node->left)
@@ -630,7 +654,7 @@ class set
             } else if (comp_(current->value, node->value)) {
                 current = current->right;
             } else {
-                delete node; // already exists
+                destroy_node(node); // already exists
                 return { iterator(current), false };
             }
         }
@@ -680,8 +704,9 @@ class set
         }
         if (!y_original_color)
             rebalance_after_erase(x, x_parent);
-        delete node;
-        --size_;
+        destroy_node(node);
+        if (!--size_)
+            pool_.release();
     }
 
     void left_rotate(node_type* x)
@@ -876,6 +901,7 @@ class set
     node_type* root_;
     size_type size_;
     Compare comp_;
+    __::node_pool pool_{ sizeof(node_type), alignof(node_type) };
 };
 
 template<class Key, typename Compare = less<Key>>
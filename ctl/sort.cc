@@ -0,0 +1,86 @@
+// -*- mode:c++; indent-tabs-mode:nil; c-basic-offset:4; coding:utf-8 -*-
+// vi: set et ft=cpp ts=4 sts=4 sw=4 fenc=utf-8 :vi
+//
+// Copyright 2024 Justine Alexandra Roberts Tunney
+//
+// Permission to use, copy, modify, and/or distribute this software for
+// any purpose with or without fee is hereby granted, provided that the
+// above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+// WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE
+// AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+// DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR
+// PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+// TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include "sort.h"
+
+#include "third_party/vqsort/vqsort.h"
+
+namespace ctl {
+
+static_assert(sizeof(int) == 4);
+static_assert(sizeof(long) == 8);
+static_assert(sizeof(long long) == 8);
+static_assert(sizeof(pair<unsigned long, unsigned long>) ==
+              sizeof(struct vqsort_kv64));
+
+void
+sort(int* first, int* last)
+{
+    vqsort_int32((int32_t*)first, last - first);
+}
+
+void
+sort(long* first, long* last)
+{
+    vqsort_int64((int64_t*)first, last - first);
+}
+
+void
+sort(long long* first, long long* last)
+{
+    vqsort_int64((int64_t*)first, last - first);
+}
+
+void
+sort(unsigned* first, unsigned* last)
+{
+    vqsort_uint32((uint32_t*)first, last - first);
+}
+
+void
+sort(unsigned long* first, unsigned long* last)
+{
+    vqsort_uint64((uint64_t*)first, last - first);
+}
+
+void
+sort(unsigned long long* first, unsigned long long* last)
+{
+    vqsort_uint64((uint64_t*)first, last - first);
+}
+
+void
+sort(float* first, float* last)
+{
+    vqsort_float(first, last - first);
+}
+
+void
+sort(double* first, double* last)
+{
+    vqsort_double(first, last - first);
+}
+
+void
+sort(pair<unsigned long, unsigned long>* first,
+     pair<unsigned long, unsigned long>* last)
+{
+    vqsort_kv64((struct vqsort_kv64*)first, last - first);
+}
+
+} // namespace ctl
@@ -0,0 +1,148 @@
+// -*-mode:c++;indent-tabs-mode:nil;c-basic-offset:4;tab-width:8;coding:utf-8-*-
+// vi: set et ft=cpp ts=4 sts=4 sw=4 fenc=utf-8 :vi
+#ifndef CTL_SORT_H_
+#define CTL_SORT_H_
+#include "less.h"
+#include "pair.h"
+#include "utility.h"
+
+namespace ctl {
+
+namespace __ {
+
+template<typename It, typename Compare>
+void
+insertion_sort(It first, It last, Compare& comp)
+{
+    if (first == last)
+        return;
+    for (It i = first + 1; i != last; ++i) {
+        auto t = ctl::move(*i);
+        It j = i;
+        for (; j != first && comp(t, *(j - 1)); --j)
+            *j = ctl::move(*(j - 1));
+        *j = ctl::move(t);
+    }
+}
+
+template<typename It, typename Compare>
+void
+sift_down(It first, ptrdiff_t i, ptrdiff_t n, Compare& comp)
+{
+    for (ptrdiff_t c; (c = 2 * i + 1) < n; i = c) {
+        if (c + 1 < n && comp(first[c], first[c + 1]))
+            ++c;
+        if (!comp(first[i], first[c]))
+            break;
+        ctl::swap(first[i], first[c]);
+    }
+}
+
+template<typename It, typename Compare>
+void
+heap_sort(It first, It last, Compare& comp)
+{
+    ptrdiff_t n = last - first;
+    for (ptrdiff_t i = n / 2; i-- > 0;)
+        sift_down(first, i, n, comp);
+    for (ptrdiff_t i = n; i-- > 1;) {
+        ctl::swap(first[0], first[i]);
+        sift_down(first, 0, i, comp);
+    }
+}
+
+template<typename It, typename Compare>
+void
+intro_sort(It first, It last, Compare& comp, int depth)
+{
+    while (last - first > 16) {
+        if (!depth--)
+            return heap_sort(first, last, comp);
+        // move median of three to front, leaving sentinels at the ends
+        It a = first + 1;
+        It b = first + (last - first) / 2;
+        It c = last - 1;
+        if (comp(*b, *a))
+            ctl::swap(*a, *b);
+        if (comp(*c, *b)) {
+            ctl::swap(*b, *c);
+            if (comp(*b, *a))
+                ctl::swap(*a, *b);
+        }
+        ctl::swap(*first, *b);
+        It i = first;
+        It j = last;
+        for (;;) {
+            do
+                ++i;
+            while (comp(*i, *first));
+            do
+                --j;
+            while (comp(*first, *j));
+            if (!(i < j))
+                break;
+            ctl::swap(*i, *j);
+        }
+        ctl::swap(*first, *j);
+        // recurse into smaller half so stack depth is logarithmic
+        if (j - first < last - j) {
+            intro_sort(first, j, comp, depth);
+            first = j + 1;
+        } else {
+            intro_sort(j + 1, last, comp, depth);
+            last = j;
+        }
+    }
+    insertion_sort(first, last, comp);
+}
+
+} // namespace __
+
+template<typename It, typename Compare>
+void
+sort(It first, It last, Compare comp)
+{
+    ptrdiff_t n = last - first;
+    if (n > 1)
+        __::intro_sort(first, last, comp, 2 * (64 - __builtin_clzll(n)));
+}
+
+template<typename It>
+void
+sort(It first, It last)
+{
+    ctl::sort(first, last, ctl::less<>());
+}
+
+// arrays of numbers and key value pairs are sorted using vqsort
+
+void
+sort(int*, int*);
+
+void
+sort(long*, long*);
+
+void
+sort(long long*, long long*);
+
+void
+sort(unsigned*, unsigned*);
+
+void
+sort(unsigned long*, unsigned long*);
+
+void
+sort(unsigned long long*, unsigned long long*);
+
+void
+sort(float*, float*);
+
+void
+sort(double*, double*);
+
+void
+sort(pair<unsigned long, unsigned long>*, pair<unsigned long, unsigned long>*);
+
+} // namespace ctl
+
+#endif // CTL_SORT_H_
@@ -0,0 +1,321 @@
+// -*-mode:c++;indent-tabs-mode:nil;c-basic-offset:4;tab-width:8;coding:utf-8-*-
+// vi: set et ft=cpp ts=4 sts=4 sw=4 fenc=utf-8 :vi
+#ifndef CTL_UNORDERED_MAP_H_
+#define CTL_UNORDERED_MAP_H_
+#include "equal_to.h"
+#include "hash.h"
+#include "hashtable.h"
+#include "initializer_list.h"
+
+namespace ctl {
+
+template<typename Key,
+         typename Value,
+         typename Hash = ctl::hash<Key>,
+         typename KeyEqual = ctl::equal_to<Key>>
+class unordered_map
+{
+    struct KeyOf
+    {
+        const Key& operator()(const ctl::pair<const Key, Value>& entry) const
+        {
+            return entry.first;
+        }
+
+        // moves the key too, since the source entry is being destroyed
+        static void relocate(ctl::pair<const Key, Value>* dst,
+                             ctl::pair<const Key, Value>* src)
+        {
+            new (dst) ctl::pair<const Key, Value>(
+              ctl::move(const_cast<Key&>(src->first)), ctl::move(src->second));
+        }
+    };
+
+    using table =
+      __::hashtable<ctl::pair<const Key, Value>, Key, KeyOf, Hash, KeyEqual>;
+
+    table data_;
+
+  public:
+    using key_type = Key;
+    using mapped_type = Value;
+    using value_type = ctl::pair<const Key, Value>;
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+    using hasher = Hash;
+    using key_equal = KeyEqual;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+    using iterator = typename table::iterator;
+    using const_iterator = typename table::const_iterator;
+
+    unordered_map() = default;
+    unordered_map(const unordered_map& other) = default;
+    unordered_map(unordered_map&& other) noexcept = default;
+
+    explicit unordered_map(size_t bucket_count)
+    {
+        data_.reserve(bucket_count);
+    }
+
+    unordered_map(std::initializer_list<value_type> init)
+    {
+        insert(init);
+    }
+
+    template<typename InputIt>
+    unordered_map(InputIt first, InputIt last)
+    {
+        insert(first, last);
+    }
+
+    unordered_map& operator=(const unordered_map& other) = default;
+    unordered_map& operator=(unordered_map&& other) noexcept = default;
+
+    unordered_map& operator=(std::initializer_list<value_type> ilist)
+    {
+        clear();
+        insert(ilist);
+        return *this;
+    }
+
+    iterator begin() noexcept
+    {
+        return data_.begin();
+    }
+
+    const_iterator begin() const noexcept
+    {
+        return data_.begin();
+    }
+
+    const_iterator cbegin() const noexcept
+    {
+        return data_.begin();
+    }
+
+    iterator end() noexcept
+    {
+        return data_.end();
+    }
+
+    const_iterator end() const noexcept
+    {
+        return data_.end();
+    }
+
+    const_iterator cend() const noexcept
+    {
+        return data_.end();
+    }
+
+    bool empty() const noexcept
+    {
+        return data_.empty();
+    }
+
+    size_type size() const noexcept
+    {
+        return data_.size();
+    }
+
+    size_type max_size() const noexcept
+    {
+        return data_.max_size();
+    }
+
+    void clear() noexcept
+    {
+        data_.clear();
+    }
+
+    Value& operator[](const Key& key)
+    {
+        return try_emplace(key).first->second;
+    }
+
+    Value& operator[](Key&& key)
+    {
+        return try_emplace(ctl::move(key)).first->second;
+    }
+
+    Value& at(const Key& key)
+    {
+        auto it = find(key);
+        if (it == end())
+            __builtin_trap();
+        return it->second;
+    }
+
+    const Value& at(const Key& key) const
+    {
+        auto it = find(key);
+        if (it == end())
+            __builtin_trap();
+        return it->second;
+    }
+
+    ctl::pair<iterator, bool> insert(const value_type& value)
+    {
+        return data_.insert(value);
+    }
+
+    ctl::pair<iterator, bool> insert(value_type&& value)
+    {
+        return data_.insert(ctl::move(value));
+    }
+
+    template<typename P>
+    ctl::pair<iterator, bool> insert(P&& value)
+    {
+        return data_.insert(value_type(ctl::forward<P>(value)));
+    }
+
+    template<typename InputIt>
+    void insert(InputIt first, InputIt last)
+    {
+        for (; first != last; ++first)
+            data_.insert(*first);
+    }
+
+    void insert(std::initializer_list<value_type> ilist)
+    {
+        data_.reserve(size() + ilist.size());
+        insert(ilist.begin(), ilist.end());
+    }
+
+    template<typename... Args>
+    ctl::pair<iterator, bool> emplace(Args&&... args)
+    {
+        return data_.emplace(ctl::forward<Args>(args)...);
+    }
+
+    template<typename K, typename... Args>
+    ctl::pair<iterator, bool> try_emplace(K&& key, Args&&... args)
+    {
+        auto [i, inserted] = data_.find_or_prepare_insert(key);
+        if (inserted)
+            new (data_.slot(i))
+              value_type(ctl::forward<K>(key),
+                         Value(ctl::forward<Args>(args)...));
+        return { data_.iterator_at(i), inserted };
+    }
+
+    template<typename K, typename V>
+    ctl::pair<iterator, bool> insert_or_assign(K&& key, V&& value)
+    {
+        auto [i, inserted] = data_.find_or_prepare_insert(key);
+        if (inserted)
+            new (data_.slot(i))
+              value_type(ctl::forward<K>(key), ctl::forward<V>(value));
+        else
+            data_.slot(i)->second = ctl::forward<V>(value);
+        return { data_.iterator_at(i), inserted };
+    }
+
+    iterator erase(iterator pos)
+    {
+        return data_.erase(pos);
+    }
+
+    iterator erase(const_iterator pos)
+    {
+        return data_.erase(pos);
+    }
+
+    iterator erase(const_iterator first, const_iterator last)
+    {
+        return data_.erase(first, last);
+    }
+
+    size_type erase(const Key& key)
+    {
+        return data_.erase_key(key);
+    }
+
+    void swap(unordered_map& other) noexcept
+    {
+        data_.swap(other.data_);
+    }
+
+    iterator find(const Key& key)
+    {
+        return data_.find(key);
+    }
+
+    const_iterator find(const Key& key) const
+    {
+        return data_.find(key);
+    }
+
+    size_type count(const Key& key) const
+    {
+        return data_.contains(key);
+    }
+
+    bool contains(const Key& key) const
+    {
+        return data_.contains(key);
+    }
+
+    size_type bucket_count() const noexcept
+    {
+        return data_.bucket_count();
+    }
+
+    float load_factor() const noexcept
+    {
+        return data_.load_factor();
+    }
+
+    float max_load_factor() const noexcept
+    {
+        return 0.875;
+    }
+
+    void rehash(size_type count)
+    {
+        data_.rehash(count);
+    }
+
+    void reserve(size_type count)
+    {
+        data_.reserve(count);
+    }
+
+    hasher hash_function() const
+    {
+        return data_.hash_function();
+    }
+
+    key_equal key_eq() const
+    {
+        return data_.key_eq();
+    }
+
+    friend bool operator==(const unordered_map& lhs, const unordered_map& rhs)
+    {
+        if (lhs.size() != rhs.size())
+            return false;
+        for (const value_type& entry : lhs) {
+            auto it = rhs.find(entry.first);
+            if (it == rhs.end() || !(it->second == entry.second))
+                return false;
+        }
+        return true;
+    }
+
+    friend bool operator!=(const unordered_map& lhs, const unordered_map& rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+    friend void swap(unordered_map& lhs, unordered_map& rhs) noexcept
+    {
+        lhs.swap(rhs);
+    }
+};
+
+} // namespace ctl
+
+#endif // CTL_UNORDERED_MAP_H_
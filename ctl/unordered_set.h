@@ -0,0 +1,238 @@
+// -*-mode:c++;indent-tabs-mode:nil;c-basic-offset:4;tab-width:8;coding:utf-8-*-
+// vi: set et ft=cpp ts=4 sts=4 sw=4 fenc=utf-8 :vi
+#ifndef CTL_UNORDERED_SET_H_
+#define CTL_UNORDERED_SET_H_
+#include "equal_to.h"
+#include "hash.h"
+#include "hashtable.h"
+#include "initializer_list.h"
+
+namespace ctl {
+
+template<typename Key,
+         typename Hash = ctl::hash<Key>,
+         typename KeyEqual = ctl::equal_to<Key>>
+class unordered_set
+{
+    struct KeyOf
+    {
+        const Key& operator()(const Key& key) const
+        {
+            return key;
+        }
+
+        static void relocate(Key* dst, Key* src)
+        {
+            new (dst) Key(ctl::move(*src));
+        }
+    };
+
+    using table = __::hashtable<Key, Key, KeyOf, Hash, KeyEqual>;
+
+    table data_;
+
+  public:
+    using key_type = Key;
+    using value_type = Key;
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+    using hasher = Hash;
+    using key_equal = KeyEqual;
+    using reference = const Key&;
+    using const_reference = const Key&;
+    using iterator = typename table::const_iterator;
+    using const_iterator = typename table::const_iterator;
+
+    unordered_set() = default;
+    unordered_set(const unordered_set& other) = default;
+    unordered_set(unordered_set&& other) noexcept = default;
+
+    explicit unordered_set(size_t bucket_count)
+    {
+        data_.reserve(bucket_count);
+    }
+
+    unordered_set(std::initializer_list<Key> init)
+    {
+        insert(init);
+    }
+
+    template<typename InputIt>
+    unordered_set(InputIt first, InputIt last)
+    {
+        insert(first, last);
+    }
+
+    unordered_set& operator=(const unordered_set& other) = default;
+    unordered_set& operator=(unordered_set&& other) noexcept = default;
+
+    unordered_set& operator=(std::initializer_list<Key> ilist)
+    {
+        clear();
+        insert(ilist);
+        return *this;
+    }
+
+    iterator begin() const noexcept
+    {
+        return data_.begin();
+    }
+
+    const_iterator cbegin() const noexcept
+    {
+        return data_.begin();
+    }
+
+    iterator end() const noexcept
+    {
+        return data_.end();
+    }
+
+    const_iterator cend() const noexcept
+    {
+        return data_.end();
+    }
+
+    bool empty() const noexcept
+    {
+        return data_.empty();
+    }
+
+    size_type size() const noexcept
+    {
+        return data_.size();
+    }
+
+    size_type max_size() const noexcept
+    {
+        return data_.max_size();
+    }
+
+    void clear() noexcept
+    {
+        data_.clear();
+    }
+
+    ctl::pair<iterator, bool> insert(const Key& key)
+    {
+        return data_.insert(key);
+    }
+
+    ctl::pair<iterator, bool> insert(Key&& key)
+    {
+        return data_.insert(ctl::move(key));
+    }
+
+    template<typename InputIt>
+    void insert(InputIt first, InputIt last)
+    {
+        for (; first != last; ++first)
+            data_.insert(*first);
+    }
+
+    void insert(std::initializer_list<Key> ilist)
+    {
+        data_.reserve(size() + ilist.size());
+        insert(ilist.begin(), ilist.end());
+    }
+
+    template<typename... Args>
+    ctl::pair<iterator, bool> emplace(Args&&... args)
+    {
+        return data_.emplace(ctl::forward<Args>(args)...);
+    }
+
+    iterator erase(const_iterator pos)
+    {
+        return data_.erase(pos);
+    }
+
+    iterator erase(const_iterator first, const_iterator last)
+    {
+        return data_.erase(first, last);
+    }
+
+    size_type erase(const Key& key)
+    {
+        return data_.erase_key(key);
+    }
+
+    void swap(unordered_set& other) noexcept
+    {
+        data_.swap(other.data_);
+    }
+
+    const_iterator find(const Key& key) const
+    {
+        return data_.find(key);
+    }
+
+    size_type count(const Key& key) const
+    {
+        return data_.contains(key);
+    }
+
+    bool contains(const Key& key) const
+    {
+        return data_.contains(key);
+    }
+
+    size_type bucket_count() const noexcept
+    {
+        return data_.bucket_count();
+    }
+
+    float load_factor() const noexcept
+    {
+        return data_.load_factor();
+    }
+
+    float max_load_factor() const noexcept
+    {
+        return 0.875;
+    }
+
+    void rehash(size_type count)
+    {
+        data_.rehash(count);
+    }
+
+    void reserve(size_type count)
+    {
+        data_.reserve(count);
+    }
+
+    hasher hash_function() const
+    {
+        return data_.hash_function();
+    }
+
+    key_equal key_eq() const
+    {
+        return data_.key_eq();
+    }
+
+    friend bool operator==(const unordered_set& lhs, const unordered_set& rhs)
+    {
+        if (lhs.size() != rhs.size())
+            return false;
+        for (const Key& key : lhs)
+            if (!rhs.contains(key))
+                return false;
+        return true;
+    }
+
+    friend bool operator!=(const unordered_set& lhs, const unordered_set& rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+    friend void swap(unordered_set& lhs, unordered_set& rhs) noexcept
+    {
+        lhs.swap(rhs);
+    }
+};
+
+} // namespace ctl
+
+#endif // CTL_UNORDERED_SET_H_
@@ -1,12 +1,22 @@
 // -*-mode:c++;indent-tabs-mode:nil;c-basic-offset:4;tab-width:8;coding:utf-8-*-
 // vi: set et ft=cpp ts=4 sts=4 sw=4 fenc=utf-8 :vi
-#ifndef COSMOPOLITAN_CTL_OPTIONAL_H_
-#define COSMOPOLITAN_CTL_OPTIONAL_H_
+#ifndef COSMOPOLITAN_CTL_VECTOR_H_
+#define COSMOPOLITAN_CTL_VECTOR_H_
+#include "libc/mem/mem.h"
 #include "new.h"
 #include "utility.h"
+#include <__type_traits/is_trivially_copyable.h>
+#include <__type_traits/is_trivially_destructible.h>
+#include <stdckdint.h>
+#include <string.h>
 
 namespace ctl {
 
+// Elements live in uninitialized storage obtained from malloc(). Only
+// the first n slots are ever constructed. Types that are trivially
+// copyable get relocated using realloc() and memmove(). Other types
+// first try to grow in place with realloc_in_place() and otherwise
+// are move constructed into a new allocation.
 template<typename T>
 struct vector
 {
@@ -14,6 +24,13 @@ struct vector
     size_t c = 0;
     T* p = nullptr;
 
+    using value_type = T;
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+    using reference = T&;
+    using const_reference = const T&;
+    using pointer = T*;
+    using const_pointer = const T*;
     using iterator = T*;
     using const_iterator = const T*;
 
@@ -21,16 +38,17 @@ struct vector
 
     ~vector()
     {
-        delete[] p;
+        destroy(p, n);
+        deallocate(p);
     }
 
     vector(const vector& other)
     {
-        n = other.n;
-        c = other.c;
-        p = new T[c];
-        for (size_t i = 0; i < n; ++i)
+        p = allocate(other.n);
+        c = other.n;
+        for (size_t i = 0; i < other.n; ++i)
             new (&p[i]) T(other.p[i]);
+        n = other.n;
     }
 
     vector(vector&& other) noexcept
@@ -45,24 +63,29 @@ struct vector
 
     explicit vector(size_t count, const T& value = T())
     {
-        n = count;
+        p = allocate(count);
         c = count;
-        p = new T[c];
-        for (size_t i = 0; i < n; ++i)
+        for (size_t i = 0; i < count; ++i)
             new (&p[i]) T(value);
+        n = count;
     }
 
     vector& operator=(const vector& other)
     {
         if (this != &other) {
-            T* newData = new T[other.c];
-            for (size_t i = 0; i < other.n; ++i) {
-                newData[i] = other.p[i];
+            if (other.n > c) {
+                vector tmp(other);
+                swap(tmp);
+            } else {
+                size_t i = 0;
+                for (; i < n && i < other.n; ++i)
+                    p[i] = other.p[i];
+                for (; i < other.n; ++i)
+                    new (&p[i]) T(other.p[i]);
+                if (n > other.n)
+                    destroy(p + other.n, n - other.n);
+                n = other.n;
             }
-            delete[] p;
-            p = newData;
-            n = other.n;
-            c = other.c;
         }
         return *this;
     }
@@ -70,7 +93,8 @@ struct vector
     vector& operator=(vector&& other) noexcept
     {
         if (this != &other) {
-            delete[] p;
+            destroy(p, n);
+            deallocate(p);
             p = other.p;
             n = other.n;
             c = other.c;
@@ -96,6 +120,16 @@ struct vector
         return c;
     }
 
+    T* data()
+    {
+        return p;
+    }
+
+    const T* data() const
+    {
+        return p;
+    }
+
     T& operator[](size_t i)
     {
         if (i >= n)
@@ -120,6 +154,16 @@ struct vector
         return p + n;
     }
 
+    const_iterator begin() const
+    {
+        return p;
+    }
+
+    const_iterator end() const
+    {
+        return p + n;
+    }
+
     const_iterator cbegin() const
     {
         return p;
@@ -160,42 +204,43 @@ struct vector
 
     void clear()
     {
-        for (size_t i = 0; i < n; ++i)
-            p[i].~T();
+        destroy(p, n);
         n = 0;
     }
 
     void reserve(size_t c2)
     {
-        if (c2 <= c)
-            return;
-        T* newP = new T[c2];
-        for (size_t i = 0; i < n; ++i)
-            newP[i] = ctl::move(p[i]);
-        delete[] p;
-        p = newP;
-        c = c2;
+        if (c2 > c)
+            reallocate(c2);
+    }
+
+    void shrink_to_fit()
+    {
+        if (n < c)
+            reallocate(n);
     }
 
     void push_back(const T& e)
     {
         if (n == c) {
-            size_t c2 = c + 1;
-            c2 += c2 >> 1;
-            reserve(c2);
+            T t(e);
+            grow(n + 1);
+            new (&p[n]) T(ctl::move(t));
+        } else {
+            new (&p[n]) T(e);
         }
-        new (&p[n]) T(e);
         ++n;
     }
 
     void push_back(T&& e)
     {
         if (n == c) {
-            size_t c2 = c + 1;
-            c2 += c2 >> 1;
-            reserve(c2);
+            T t(ctl::move(e));
+            grow(n + 1);
+            new (&p[n]) T(ctl::move(t));
+        } else {
+            new (&p[n]) T(ctl::move(e));
         }
-        new (&p[n]) T(ctl::forward<T>(e));
         ++n;
     }
 
@@ -203,11 +248,12 @@ struct vector
     void emplace_back(Args&&... args)
     {
         if (n == c) {
-            size_t c2 = c + 1;
-            c2 += c2 >> 1;
-            reserve(c2);
+            T t(ctl::forward<Args>(args)...);
+            grow(n + 1);
+            new (&p[n]) T(ctl::move(t));
+        } else {
+            new (&p[n]) T(ctl::forward<Args>(args)...);
         }
-        new (&p[n]) T(ctl::forward<Args>(args)...);
         ++n;
     }
 
@@ -226,20 +272,189 @@ struct vector
             for (size_t i = n; i < n2; ++i)
                 new (&p[i]) T();
         } else if (n2 < n) {
-            for (size_t i = n2; i < n; ++i)
-                p[i].~T();
+            destroy(p + n2, n - n2);
         }
         n = n2;
     }
 
+    void resize(size_t n2, const T& value)
+    {
+        if (n2 > n) {
+            T t(value);
+            reserve(n2);
+            for (size_t i = n; i < n2; ++i)
+                new (&p[i]) T(t);
+        } else if (n2 < n) {
+            destroy(p + n2, n - n2);
+        }
+        n = n2;
+    }
+
+    template<typename... Args>
+    iterator emplace(const_iterator pos, Args&&... args)
+    {
+        size_t i = pos - p;
+        if (i > n)
+            __builtin_trap();
+        if (i == n) {
+            emplace_back(ctl::forward<Args>(args)...);
+        } else {
+            T t(ctl::forward<Args>(args)...);
+            open(i, 1);
+            new (&p[i]) T(ctl::move(t));
+        }
+        return p + i;
+    }
+
+    iterator insert(const_iterator pos, const T& value)
+    {
+        return emplace(pos, value);
+    }
+
+    iterator insert(const_iterator pos, T&& value)
+    {
+        return emplace(pos, ctl::move(value));
+    }
+
+    iterator insert(const_iterator pos, size_t count, const T& value)
+    {
+        size_t i = pos - p;
+        if (i > n)
+            __builtin_trap();
+        if (count) {
+            T t(value);
+            open(i, count);
+            for (size_t j = 0; j < count; ++j)
+                new (&p[i + j]) T(t);
+        }
+        return p + i;
+    }
+
+    iterator erase(const_iterator pos)
+    {
+        return erase(pos, pos + 1);
+    }
+
+    iterator erase(const_iterator first, const_iterator last)
+    {
+        size_t i = first - p;
+        size_t j = last - p;
+        if (i > j || j > n)
+            __builtin_trap();
+        if (i < j) {
+            size_t k = j - i;
+            if constexpr (std::is_trivially_copyable_v<T>) {
+                memmove(p + i, p + j, (n - j) * sizeof(T));
+            } else {
+                for (size_t m = i; m + k < n; ++m)
+                    p[m] = ctl::move(p[m + k]);
+                destroy(p + n - k, k);
+            }
+            n -= k;
+        }
+        return p + i;
+    }
+
     void swap(vector& other) noexcept
     {
         ctl::swap(n, other.n);
         ctl::swap(c, other.c);
         ctl::swap(p, other.p);
     }
+
+  private:
+    static constexpr bool use_realloc =
+      std::is_trivially_copyable_v<T> &&
+      alignof(T) <= alignof(max_align_t);
+
+    static T* allocate(size_t count)
+    {
+        void* q;
+        size_t bytes;
+        if (!count)
+            return nullptr;
+        if (ckd_mul(&bytes, count, sizeof(T)))
+            __builtin_trap();
+        if (alignof(T) <= alignof(max_align_t))
+            q = malloc(bytes);
+        else
+            q = memalign(alignof(T), bytes);
+        if (!q)
+            __builtin_trap();
+        return static_cast<T*>(q);
+    }
+
+    static void deallocate(T* q)
+    {
+        free(q);
+    }
+
+    static void destroy(T* q, size_t count)
+    {
+        if constexpr (!std::is_trivially_destructible_v<T>)
+            for (size_t i = 0; i < count; ++i)
+                q[i].~T();
+    }
+
+    void grow(size_t need)
+    {
+        size_t c2 = c + 1;
+        c2 += c2 >> 1;
+        if (c2 < need)
+            c2 = need;
+        reallocate(c2);
+    }
+
+    // changes capacity to c2, which must be at least n
+    void reallocate(size_t c2)
+    {
+        size_t bytes;
+        if (ckd_mul(&bytes, c2, sizeof(T)))
+            __builtin_trap();
+        if (!c2) {
+            deallocate(p);
+            p = nullptr;
+        } else if (!p) {
+            p = allocate(c2);
+        } else if constexpr (use_realloc) {
+            void* q;
+            if (!(q = realloc(p, bytes)))
+                __builtin_trap();
+            p = static_cast<T*>(q);
+        } else if (alignof(T) > alignof(max_align_t) ||
+                   !realloc_in_place(p, bytes)) {
+            T* q = allocate(c2);
+            for (size_t i = 0; i < n; ++i) {
+                new (&q[i]) T(ctl::move(p[i]));
+                p[i].~T();
+            }
+            deallocate(p);
+            p = q;
+        }
+        c = c2;
+    }
+
+    // shifts elements at index i and beyond to the right by k slots
+    // leaving [i,i+k) as uninitialized storage
+    void open(size_t i, size_t k)
+    {
+        size_t n2;
+        if (ckd_add(&n2, n, k))
+            __builtin_trap();
+        if (n2 > c)
+            grow(n2);
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            memmove(p + i + k, p + i, (n - i) * sizeof(T));
+        } else {
+            for (size_t j = n; j-- > i;) {
+                new (&p[j + k]) T(ctl::move(p[j]));
+                p[j].~T();
+            }
+        }
+        n = n2;
+    }
 };
 
 } // namespace ctl
 
-#endif // COSMOPOLITAN_CTL_OPTIONAL_H_
+#endif // COSMOPOLITAN_CTL_VECTOR_H_
@@ -17,38 +17,170 @@
 │ PERFORMANCE OF THIS SOFTWARE.                                                │
 ╚─────────────────────────────────────────────────────────────────────────────*/
 #include "libc/calls/calls.h"
+#include "libc/calls/internal.h"
+#include "libc/calls/struct/stat.h"
+#include "libc/calls/syscall-sysv.internal.h"
+#include "libc/dce.h"
+#include "libc/errno.h"
+#include "libc/intrin/weaken.h"
 #include "libc/macros.internal.h"
 #include "libc/runtime/runtime.h"
+#include "libc/sock/sock.h"
+#include "libc/sysv/consts/map.h"
+#include "libc/sysv/consts/prot.h"
+#include "libc/sysv/consts/s.h"
+
+#define kChunk  0x7ffff000  // largest transfer every kernel accepts
+#define kBounce 1048576     // largest bounce buffer we'll map
+
+enum CopyMethod {
+  kCopyRw,
+  kCopySendfile,
+  kCopySplice,
+  kCopyFileRange,
+};
+
+static enum CopyMethod GetCopyMethod(int in, int out) {
+  struct stat si, so;
+  if (__isfdkind(in, kFdZip) || __isfdkind(out, kFdZip))
+    return kCopyRw;
+  if (fstat(in, &si) == -1 || fstat(out, &so) == -1)
+    return kCopyRw;
+  if (S_ISREG(si.st_mode) && S_ISREG(so.st_mode))
+    return kCopyFileRange;
+  if (IsLinux() && (S_ISFIFO(si.st_mode) || S_ISFIFO(so.st_mode)))
+    return kCopySplice;
+  if (S_ISREG(si.st_mode) && (IsLinux() || S_ISSOCK(so.st_mode)))
+    return kCopySendfile;
+  return kCopyRw;
+}
+
+// returns true if `err` means `method` can't be used for these fds,
+// in which case the next best method should be tried instead.
+static bool IsCopyMethodUnsupported(int err) {
+  return err == ENOSYS ||      // old kernel or other platform
+         err == EXDEV ||       // different file systems
+         err == EINVAL ||      // file system doesn't support it
+         err == EBADF ||       // O_APPEND, or fd kind we don't know
+         err == ESPIPE ||      // non-seekable input
+         err == ENOTSOCK ||    // bsd sendfile() needs socket
+         err == ENOTSUP ||     // e.g. overlayfs
+         err == EOPNOTSUPP;    // technically the same
+}
+
+static enum CopyMethod DemoteCopyMethod(enum CopyMethod method) {
+  if (method == kCopyFileRange && IsLinux())
+    return kCopySendfile;  // linux sendfile() works across file systems
+  return kCopyRw;
+}
+
+static ssize_t CopyZero(enum CopyMethod method, int in, int out, size_t n) {
+  n = MIN(n, kChunk);
+  switch (method) {
+    case kCopyFileRange:
+      return copy_file_range(in, 0, out, 0, n, 0);
+    case kCopySplice:
+      return splice(in, 0, out, 0, n, 0);
+    case kCopySendfile:
+      if (IsLinux())
+        return sys_sendfile(out, in, 0, n);
+      if (_weaken(sendfile))
+        return _weaken(sendfile)(out, in, 0, n);
+      errno = ENOSYS;
+      return -1;
+    default:
+      __builtin_unreachable();
+  }
+}
+
+static ssize_t CopyRw(int in, int out, size_t n, char *buf, size_t size) {
+  size_t i, j;
+  ssize_t dr, dw;
+  for (i = 0; i < n; i += dr) {
+    dr = read(in, buf, MIN(n - i, size));
+    if (dr == -1)
+      return -1;
+    if (!dr)
+      break;
+    for (j = 0; j < (size_t)dr; j += dw) {
+      dw = write(out, buf + j, dr - j);
+      if (dw == -1)
+        return -1;
+    }
+  }
+  return i;
+}
+
+static ssize_t CopyBounce(int in, int out, size_t n) {
+  char *p;
+  size_t size;
+  ssize_t rc, got;
+  char buf[4096];
+  // use the stack buffer first, so we don't map a big buffer just to
+  // find out that we're already at the end of the file
+  got = CopyRw(in, out, MIN(n, sizeof(buf)), buf, sizeof(buf));
+  if (got == -1 || got < (ssize_t)MIN(n, sizeof(buf)) || got == n)
+    return got;
+  n -= got;
+  size = ROUNDUP(MIN(n, kBounce), sizeof(buf));
+  p = mmap(0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (p == MAP_FAILED) {
+    rc = CopyRw(in, out, n, buf, sizeof(buf));
+  } else {
+    rc = CopyRw(in, out, n, p, size);
+    munmap(p, size);
+  }
+  if (rc == -1)
+    return -1;
+  return got + rc;
+}
 
 /**
- * Copies data between file descriptors the old fashioned way.
+ * Copies data between file descriptors.
+ *
+ * This function uses the fastest method the kernel provides for the
+ * kinds of file descriptors involved, so that data needn't be copied
+ * through userspace. File to file copies use copy_file_range() which
+ * may share extents on file systems like XFS and btrfs. If either fd
+ * is a pipe, then splice() is used. Files are sent to sockets using
+ * sendfile(). If none of these are available, then the data shall go
+ * through a bounce buffer of up to a megabyte.
+ *
+ * Both file positions are advanced by the number of bytes exchanged.
+ * Short writes are retried until all data that was read is written.
  *
  * This function is intended for simple programs without signals. If
  * signals are in play, then `SA_RESTART` needs to be used.
  *
  * @param in is input file descriptor
- * @param out is input file descriptor
+ * @param out is output file descriptor
  * @param n is number of bytes to exchange, or -1 for until eof
  * @return bytes successfully exchanged, or -1 w/ errno
  */
 ssize_t copyfd(int in, int out, size_t n) {
+  int e;
   size_t i;
-  char buf[512];
-  ssize_t dr, dw;
-  for (i = 0; i < n; i += dr) {
-    dr = read(in, buf, MIN(n - i, sizeof(buf)));
-    if (dr == -1)
-      return -1;
-    if (!dr)
+  ssize_t rc;
+  enum CopyMethod method;
+  e = errno;
+  method = GetCopyMethod(in, out);
+  for (i = 0; i < n && method != kCopyRw; i += rc) {
+    if ((rc = CopyZero(method, in, out, n - i)) == -1) {
+      if (!IsCopyMethodUnsupported(errno))
+        return -1;
+      errno = e;
+      method = DemoteCopyMethod(method);
+      rc = 0;
+    } else if (!rc) {
+      // some pseudo-files (e.g. /proc) claim to be empty, so always
+      // confirm end of file using read() before reporting success.
       break;
-    dw = write(out, buf, dr);
-    if (dw == -1)
-      return -1;
-    if (dw != dr) {
-      // POSIX requires atomic IO up to PIPE_BUF
-      // The minimum permissible PIPE_BUF is 512
-      notpossible;
     }
   }
+  if (i < n) {
+    if ((rc = CopyBounce(in, out, n - i)) == -1)
+      return -1;
+    i += rc;
+  }
   return i;
 }
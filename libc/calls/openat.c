@@ -62,6 +62,10 @@
  *     // run `zip program.com hi.txt` beforehand
  *     openat(AT_FDCWD, "/zip/hi.txt", O_RDONLY);
  *
+ * Zip assets that are compressed and too large to be inflated up front
+ * are streamed instead. Opening and reading those calls malloc() and
+ * takes a lock, so it isn't asynchronous signal safe.
+ *
  * Cosmopolitan's general approach on Windows to path translation is to
  *
  *   - replace `/' with `\`
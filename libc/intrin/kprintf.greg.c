@@ -25,7 +25,6 @@
 #include "libc/fmt/magnumstrs.internal.h"
 #include "libc/intrin/asmflag.h"
 #include "libc/intrin/atomic.h"
-#include "libc/intrin/dll.h"
 #include "libc/intrin/getenv.internal.h"
 #include "libc/intrin/kprintf.h"
 #include "libc/intrin/likely.h"
@@ -155,16 +154,10 @@ __funline bool kischarmisaligned(const char *p, signed char t) {
 }
 
 privileged static bool32 kisdangerous_unlocked(const char *addr) {
-  struct Dll *e, *e2;
-  for (e = dll_first(__maps.used); e; e = e2) {
-    e2 = dll_next(__maps.used, e);
-    struct Map *map = MAP_CONTAINER(e);
-    if (map->addr <= addr && addr < map->addr + map->size) {
-      dll_remove(&__maps.used, e);
-      dll_make_first(&__maps.used, e);
+  struct Map *map;
+  if ((map = __maps_floor(addr)))
+    if (addr < map->addr + map->size)
       return !(map->prot & PROT_READ);
-    }
-  }
   return true;
 }
 
@@ -18,6 +18,7 @@
 ╚─────────────────────────────────────────────────────────────────────────────*/
 #include "libc/intrin/maps.h"
 #include "ape/sections.internal.h"
+#include "libc/calls/calls.h"
 #include "libc/dce.h"
 #include "libc/intrin/dll.h"
 #include "libc/intrin/kprintf.h"
@@ -33,8 +34,22 @@
 __static_yoink("_init_maps");
 #endif
 
+// how many times to poll the lock before going to sleep on it
+#define SPINS 100
+
+#define FUTEX_WAIT_PRIVATE_linux 128
+#define FUTEX_WAKE_PRIVATE_linux 129
+
+int _futex(atomic_int *, int, int, const void *);
+
 struct Maps __maps;
 
+int __maps_compare(const struct Tree *ra, const struct Tree *rb) {
+  const struct Map *a = (const struct Map *)MAP_TREE_CONTAINER(ra);
+  const struct Map *b = (const struct Map *)MAP_TREE_CONTAINER(rb);
+  return (a->addr > b->addr) - (a->addr < b->addr);
+}
+
 void __maps_init(void) {
 
   // record _start() stack mapping
@@ -66,7 +81,38 @@ void __maps_init(void) {
   __maps_insert(&text);
 }
 
+privileged static void __maps_pause(void) {
+#if defined(__GNUC__) && defined(__aarch64__)
+  __asm__ volatile("yield");
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  __asm__ volatile("pause");
+#endif
+}
+
+// the lock word is 0 if unlocked, 1 if locked, and 2 if there may be
+// threads sleeping on it. linux lets us sleep on a futex; elsewhere we
+// give the cpu back to the scheduler, which still beats pure spinning
+privileged static void __maps_lock_contended(void) {
+  int i, word = 1;
+  for (i = 0; i < SPINS && word == 1; ++i) {
+    __maps_pause();
+    word = atomic_load_explicit(&__maps.lock, memory_order_relaxed);
+    if (!word && atomic_compare_exchange_weak_explicit(
+                     &__maps.lock, &word, 1, memory_order_acquire,
+                     memory_order_relaxed))
+      return;
+  }
+  while (atomic_exchange_explicit(&__maps.lock, 2, memory_order_acquire)) {
+    if (IsLinux()) {
+      _futex(&__maps.lock, FUTEX_WAIT_PRIVATE_linux, 2, 0);
+    } else {
+      sched_yield();
+    }
+  }
+}
+
 privileged void __maps_lock(void) {
+  int word;
   struct CosmoTib *tib;
   if (!__threaded)
     return;
@@ -75,19 +121,19 @@ privileged void __maps_lock(void) {
   tib = __get_tls_privileged();
   if (tib->tib_flags & TIB_FLAG_MAPLOCK)
     return;
-  while (atomic_exchange_explicit(&__maps.lock, 1, memory_order_acquire)) {
-#if defined(__GNUC__) && defined(__aarch64__)
-    __asm__ volatile("yield");
-#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
-    __asm__ volatile("pause");
-#endif
-  }
+  word = 0;
+  if (!atomic_compare_exchange_strong_explicit(&__maps.lock, &word, 1,
+                                               memory_order_acquire,
+                                               memory_order_relaxed))
+    __maps_lock_contended();
   tib->tib_flags |= TIB_FLAG_MAPLOCK;
 }
 
 privileged void __maps_unlock(void) {
   struct CosmoTib *tib;
-  atomic_store_explicit(&__maps.lock, 0, memory_order_release);
+  if (atomic_exchange_explicit(&__maps.lock, 0, memory_order_release) == 2 &&
+      IsLinux())
+    _futex(&__maps.lock, FUTEX_WAKE_PRIVATE_linux, 1, 0);
   if (__tls_enabled) {
     tib = __get_tls_privileged();
     tib->tib_flags &= ~TIB_FLAG_MAPLOCK;
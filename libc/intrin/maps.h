@@ -2,30 +2,31 @@
 #define COSMOPOLITAN_LIBC_RUNTIME_MAPS_H_
 #include "libc/intrin/atomic.h"
 #include "libc/intrin/dll.h"
+#include "libc/intrin/tree.h"
 #include "libc/thread/tls2.internal.h"
 COSMOPOLITAN_C_START_
 
-#define MAP_CONTAINER(e) DLL_CONTAINER(struct Map, elem, e)
+#define MAP_CONTAINER(e)      DLL_CONTAINER(struct Map, elem, e)
+#define MAP_TREE_CONTAINER(e) TREE_CONTAINER(struct Map, tree, e)
 
 struct Map {
-  _Atomic(struct Map *) next; /* for __maps.maps */
-  char *addr;                 /* granule aligned */
-  size_t size;                /* must be nonzero */
-  struct Dll elem;            /* for __maps.free */
-  int64_t off;                /* -1 if anonymous */
-  int prot;                   /* memory protects */
-  int flags;                  /* memory map flag */
-  bool iscow;                 /* windows nt only */
-  bool readonlyfile;          /* windows nt only */
-  intptr_t h;                 /* windows nt only */
+  char *addr;        /* granule aligned */
+  size_t size;       /* must be nonzero */
+  struct Tree tree;  /* for __maps.maps */
+  struct Dll elem;   /* for __maps.free */
+  int64_t off;       /* -1 if anonymous */
+  int prot;          /* memory protects */
+  int flags;         /* memory map flag */
+  bool iscow;        /* windows nt only */
+  bool readonlyfile; /* windows nt only */
+  intptr_t h;        /* windows nt only */
 };
 
 struct Maps {
   atomic_int lock;
-  _Atomic(struct Map *) maps;
+  struct Tree *maps; /* ordered by address */
   struct Dll *free;
   struct Map stack;
-  struct Dll *used;
   size_t count;
   size_t pages;
 };
@@ -38,6 +39,7 @@ struct AddrSize {
 extern struct Maps __maps;
 
 void __maps_init(void);
+int __maps_compare(const struct Tree *, const struct Tree *);
 void __maps_lock(void);
 void __maps_check(void);
 void __maps_unlock(void);
@@ -47,5 +49,48 @@ void __maps_insert(struct Map *);
 void *__mmap(char *, size_t, int, int, int, int64_t);
 struct AddrSize __get_main_stack(void);
 
+forceinline struct Map *__maps_first(void) {
+  struct Tree *node;
+  if ((node = tree_first(__maps.maps)))
+    return MAP_TREE_CONTAINER(node);
+  return 0;
+}
+
+forceinline struct Map *__maps_next(struct Map *map) {
+  struct Tree *node;
+  if ((node = tree_next(&map->tree)))
+    return MAP_TREE_CONTAINER(node);
+  return 0;
+}
+
+forceinline struct Map *__maps_prev(struct Map *map) {
+  struct Tree *node;
+  if ((node = tree_prev(&map->tree)))
+    return MAP_TREE_CONTAINER(node);
+  return 0;
+}
+
+// returns mapping with the highest address that's <= addr
+forceinline struct Map *__maps_floor(const char *addr) {
+  struct Tree *node, *res = 0;
+  for (node = __maps.maps; node;) {
+    if (addr < MAP_TREE_CONTAINER(node)->addr) {
+      node = node->left;
+    } else {
+      res = node;
+      node = node->right;
+    }
+  }
+  return res ? MAP_TREE_CONTAINER(res) : 0;
+}
+
+// returns first mapping that might overlap addr, in address order
+forceinline struct Map *__maps_search(const char *addr) {
+  struct Map *map;
+  if (!(map = __maps_floor(addr)))
+    map = __maps_first();
+  return map;
+}
+
 COSMOPOLITAN_C_END_
 #endif /* COSMOPOLITAN_LIBC_RUNTIME_MAPS_H_ */
@@ -32,6 +32,7 @@
 #include "libc/intrin/kprintf.h"
 #include "libc/intrin/maps.h"
 #include "libc/intrin/strace.internal.h"
+#include "libc/intrin/tree.h"
 #include "libc/intrin/weaken.h"
 #include "libc/nt/memory.h"
 #include "libc/nt/runtime.h"
@@ -73,70 +74,74 @@
 static atomic_ulong rollo;
 
 static bool overlaps_existing_map(const char *addr, size_t size) {
+  bool res = false;
   int granularity = __granularity();
-  for (struct Map *map = __maps.maps; map; map = map->next)
+  __maps_lock();
+  for (struct Map *map = __maps_search(addr);
+       map && map->addr < addr + PGUP(size); map = __maps_next(map)) {
     if (MAX(addr, map->addr) <
-        MIN(addr + PGUP(size), map->addr + PGUP(map->size)))
-      return true;
-  return false;
+        MIN(addr + PGUP(size), map->addr + PGUP(map->size))) {
+      res = true;
+      break;
+    }
+  }
+  __maps_unlock();
+  return res;
 }
 
 void __maps_check(void) {
 #if MMDEBUG
   size_t maps = 0;
   size_t pages = 0;
+  struct Map *last = 0;
   int granularity = getauxval(AT_PAGESZ);
-  for (struct Map *map = __maps.maps; map; map = map->next) {
+  for (struct Map *map = __maps_first(); map; map = __maps_next(map)) {
     ASSERT(map->addr != MAP_FAILED);
     ASSERT(map->size);
+    if (last)
+      ASSERT(last->addr + PGUP(last->size) <= map->addr);
     pages += PGUP(map->size) / granularity;
     maps += 1;
+    last = map;
   }
-  ASSERT(maps = __maps.count);
+  ASSERT(maps == __maps.count);
   ASSERT(pages == __maps.pages);
-  for (struct Map *m1 = __maps.maps; m1; m1 = m1->next)
-    for (struct Map *m2 = m1->next; m2; m2 = m2->next)
-      ASSERT(MAX(m1->addr, m2->addr) >=
-             MIN(m1->addr + PGUP(m1->size), m2->addr + PGUP(m2->size)));
 #endif
 }
 
 void __maps_free(struct Map *map) {
-  map->next = 0;
   map->size = 0;
   map->addr = MAP_FAILED;
   ASSERT(dll_is_alone(&map->elem));
   dll_make_last(&__maps.free, &map->elem);
 }
 
+static bool __maps_adjacent(const struct Map *x, const struct Map *y) {
+  return !IsWindows() &&                  //
+         x->addr + x->size == y->addr &&  //
+         (x->flags & MAP_ANONYMOUS) &&    //
+         x->flags == y->flags &&          //
+         x->prot == y->prot;
+}
+
 void __maps_insert(struct Map *map) {
-  struct Map *last = __maps.maps;
+  struct Map *prev, *next;
   int granularity = getauxval(AT_PAGESZ);
   __maps.pages += PGUP(map->size) / granularity;
-  if (last && !IsWindows() &&                  //
-      map->addr == last->addr + last->size &&  //
-      (map->flags & MAP_ANONYMOUS) &&          //
-      map->flags == last->flags &&             //
-      map->prot == last->prot) {
-    last->size += map->size;
-    dll_remove(&__maps.used, &last->elem);
-    dll_make_first(&__maps.used, &last->elem);
-    __maps_free(map);
-  } else if (last && !IsWindows() &&                 //
-             map->addr + map->size == last->addr &&  //
-             (map->flags & MAP_ANONYMOUS) &&         //
-             map->flags == last->flags &&            //
-             map->prot == last->prot) {
-    last->addr -= map->size;
-    last->size += map->size;
-    dll_remove(&__maps.used, &last->elem);
-    dll_make_first(&__maps.used, &last->elem);
+  tree_insert(&__maps.maps, &map->tree, __maps_compare);
+  ++__maps.count;
+  if ((prev = __maps_prev(map)) && __maps_adjacent(prev, map)) {
+    prev->size += map->size;
+    tree_remove(&__maps.maps, &map->tree);
+    --__maps.count;
     __maps_free(map);
-  } else {
-    dll_make_first(&__maps.used, &map->elem);
-    map->next = __maps.maps;
-    __maps.maps = map;
-    ++__maps.count;
+    map = prev;
+  }
+  if ((next = __maps_next(map)) && __maps_adjacent(map, next)) {
+    map->size += next->size;
+    tree_remove(&__maps.maps, &next->tree);
+    --__maps.count;
+    __maps_free(next);
   }
   __maps_check();
 }
@@ -147,7 +152,6 @@ struct Map *__maps_alloc(void) {
   if ((e = dll_first(__maps.free))) {
     dll_remove(&__maps.free, e);
     map = MAP_CONTAINER(e);
-    map->next = 0;
     return map;
   }
   int granularity = __granularity();
@@ -164,7 +168,6 @@ struct Map *__maps_alloc(void) {
     dll_init(&map[i].elem);
     __maps_free(map + i);
   }
-  map->next = 0;
   return map;
 }
 
@@ -185,18 +188,16 @@ static int __munmap(char *addr, size_t size, bool untrack_only) {
   int rc = 0;
   __maps_lock();
 StartOver:;
-  struct Map *map = __maps.maps;
-  _Atomic(struct Map *) *prev = &__maps.maps;
-  while (map) {
+  struct Map *map = __maps_search(addr);
+  while (map && map->addr < addr + PGUP(size)) {
     char *map_addr = map->addr;
     size_t map_size = map->size;
-    struct Map *next = map->next;
+    struct Map *next = __maps_next(map);
     if (MAX(addr, map_addr) <
         MIN(addr + PGUP(size), map_addr + PGUP(map_size))) {
       if (addr <= map_addr && addr + PGUP(size) >= map_addr + PGUP(map_size)) {
         // remove mapping completely
-        dll_remove(&__maps.used, &map->elem);
-        *prev = next;
+        tree_remove(&__maps.maps, &map->tree);
         __maps.pages -= (map_size + pagesz - 1) / pagesz;
         __maps.count -= 1;
         if (untrack_only) {
@@ -271,7 +272,6 @@ StartOver:;
         size_t right = map_size - middle - left;
         struct Map *leftmap;
         if ((leftmap = __maps_alloc())) {
-          leftmap->next = map;
           leftmap->addr = map_addr;
           leftmap->size = left;
           leftmap->off = map->off;
@@ -281,8 +281,7 @@ StartOver:;
           map->size = right;
           if (map->off != -1)
             map->off += left + middle;
-          dll_make_first(&__maps.used, &leftmap->elem);
-          *prev = leftmap;
+          tree_insert(&__maps.maps, &leftmap->tree, __maps_compare);
           __maps.pages -= (middle + pagesz - 1) / pagesz;
           __maps.count += 1;
           __maps_check();
@@ -298,7 +297,6 @@ StartOver:;
         }
       }
     }
-    prev = &map->next;
     map = next;
   }
   __maps_unlock();
@@ -21,10 +21,10 @@
 #include "libc/dce.h"
 #include "libc/intrin/describeflags.internal.h"
 #include "libc/intrin/directmap.internal.h"
-#include "libc/intrin/dll.h"
 #include "libc/intrin/kprintf.h"
 #include "libc/intrin/maps.h"
 #include "libc/intrin/strace.internal.h"
+#include "libc/intrin/tree.h"
 #include "libc/nt/memory.h"
 #include "libc/runtime/internal.h"
 #include "libc/runtime/runtime.h"
@@ -66,12 +66,11 @@ int __mprotect(char *addr, size_t size, int prot) {
   int rc = 0;
   __maps_lock();
   bool found = false;
-  struct Map *map = __maps.maps;
-  _Atomic(struct Map *) *prev = &__maps.maps;
-  while (map) {
+  struct Map *map = __maps_search(addr);
+  while (map && map->addr < addr + PGUP(size)) {
     char *map_addr = map->addr;
     size_t map_size = map->size;
-    struct Map *next = map->next;
+    struct Map *next = __maps_next(map);
     char *beg = MAX(addr, map_addr);
     char *end = MIN(addr + PGUP(size), map_addr + PGUP(map_size));
     if (beg < end) {
@@ -96,7 +95,6 @@ int __mprotect(char *addr, size_t size, int prot) {
         struct Map *leftmap;
         if ((leftmap = __maps_alloc())) {
           if (!__mprotect_chunk(map_addr, left, prot, false)) {
-            leftmap->next = map;
             leftmap->addr = map_addr;
             leftmap->size = left;
             leftmap->prot = prot;
@@ -106,8 +104,7 @@ int __mprotect(char *addr, size_t size, int prot) {
             map->size = right;
             if (map->off != -1)
               map->off += left;
-            dll_make_first(&__maps.used, &leftmap->elem);
-            *prev = leftmap;
+            tree_insert(&__maps.maps, &leftmap->tree, __maps_compare);
             __maps.count += 1;
             __maps_check();
           } else {
@@ -124,7 +121,6 @@ int __mprotect(char *addr, size_t size, int prot) {
         struct Map *leftmap;
         if ((leftmap = __maps_alloc())) {
           if (!__mprotect_chunk(map_addr + left, right, prot, false)) {
-            leftmap->next = map;
             leftmap->addr = map_addr;
             leftmap->size = left;
             leftmap->off = map->off;
@@ -135,8 +131,7 @@ int __mprotect(char *addr, size_t size, int prot) {
             map->prot = prot;
             if (map->off != -1)
               map->off += left;
-            dll_make_first(&__maps.used, &leftmap->elem);
-            *prev = leftmap;
+            tree_insert(&__maps.maps, &leftmap->tree, __maps_compare);
             __maps.count += 1;
             __maps_check();
           } else {
@@ -156,13 +151,11 @@ int __mprotect(char *addr, size_t size, int prot) {
           struct Map *midlmap;
           if ((midlmap = __maps_alloc())) {
             if (!__mprotect_chunk(map_addr + left, middle, prot, false)) {
-              leftmap->next = midlmap;
               leftmap->addr = map_addr;
               leftmap->size = left;
               leftmap->off = map->off;
               leftmap->prot = map->prot;
               leftmap->flags = map->flags;
-              midlmap->next = map;
               midlmap->addr = map_addr + left;
               midlmap->size = middle;
               midlmap->off = map->off == -1 ? -1 : map->off + left;
@@ -172,9 +165,8 @@ int __mprotect(char *addr, size_t size, int prot) {
               map->size = right;
               if (map->off != -1)
                 map->off += left + middle;
-              dll_make_first(&__maps.used, &leftmap->elem);
-              dll_make_first(&__maps.used, &midlmap->elem);
-              *prev = leftmap;
+              tree_insert(&__maps.maps, &leftmap->tree, __maps_compare);
+              tree_insert(&__maps.maps, &midlmap->tree, __maps_compare);
               __maps.count += 2;
               __maps_check();
             } else {
@@ -191,7 +183,6 @@ int __mprotect(char *addr, size_t size, int prot) {
         }
       }
     }
-    prev = &map->next;
     map = next;
   }
 
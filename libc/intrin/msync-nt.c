@@ -35,7 +35,8 @@ textwindows int sys_msync_nt(char *addr, size_t size, int flags) {
 
   int rc = 0;
   __maps_lock();
-  for (struct Map *map = __maps.maps; map; map = map->next) {
+  for (struct Map *map = __maps_search(addr); map && map->addr < addr + size;
+       map = __maps_next(map)) {
     char *beg = MAX(addr, map->addr);
     char *end = MIN(addr + size, map->addr + map->size);
     if (beg < end)
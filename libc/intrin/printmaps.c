@@ -34,10 +34,7 @@ void __print_maps(void) {
   long maptally = 0;
   char mappingbuf[8], sb[16];
   __maps_lock();
-  struct Dll *e, *e2;
-  for (e = dll_first(__maps.used); e; e = e2) {
-    e2 = dll_next(__maps.used, e);
-    struct Map *map = MAP_CONTAINER(e);
+  for (struct Map *map = __maps_first(); map; map = __maps_next(map)) {
     maptally += map->size;
     kprintf("%012lx-%012lx %!s", map->addr, map->addr + map->size,
             (DescribeMapping)(mappingbuf, map->prot, map->flags));
@@ -16,6 +16,7 @@
 │ TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR             │
 │ PERFORMANCE OF THIS SOFTWARE.                                                │
 ╚─────────────────────────────────────────────────────────────────────────────*/
+#include "libc/calls/blockcancel.internal.h"
 #include "libc/calls/calls.h"
 #include "libc/calls/state.internal.h"
 #include "libc/errno.h"
@@ -25,8 +26,52 @@
 #include "libc/runtime/internal.h"
 #include "libc/thread/thread.h"
 #include "libc/thread/tls.h"
+#include "third_party/nsync/futex.internal.h"
 #include "third_party/nsync/mu.h"
 
+// how many times to poll a held lock before going to sleep on it
+#define SPINS 100
+
+// acquires futex word, where 0 means unlocked, 1 means locked, and 2
+// means locked with waiters that pthread_mutex_unlock() needs to wake
+static void pthread_mutex_lock_futex(pthread_mutex_t *mutex) {
+  int i, word;
+
+  // fast path
+  word = 0;
+  if (atomic_compare_exchange_strong_explicit(&mutex->_lock, &word, 1,
+                                              memory_order_acquire,
+                                              memory_order_relaxed)) {
+    return;
+  }
+
+  // the owner usually lets go quickly, so spin a little, but stop as
+  // soon as someone else has gone to sleep, since we'd only be adding
+  // to the contention that's making them wait
+  for (i = 0; i < SPINS && word == 1; ++i) {
+    pthread_pause_np();
+    word = atomic_load_explicit(&mutex->_lock, memory_order_relaxed);
+    if (!word && atomic_compare_exchange_weak_explicit(
+                     &mutex->_lock, &word, 1, memory_order_acquire,
+                     memory_order_relaxed)) {
+      return;
+    }
+  }
+
+  // sleep until we're woken by an unlock. we always leave the word in
+  // the contended state afterwards, since we can't know if we were the
+  // last waiter. waiting on a mutex mustn't be a cancelation point
+  BLOCK_CANCELATION;
+  while (atomic_exchange_explicit(&mutex->_lock, 2, memory_order_acquire)) {
+    if (_weaken(nsync_futex_wait_)) {
+      _weaken(nsync_futex_wait_)(&mutex->_lock, 2, mutex->_pshared, 0);
+    } else {
+      sched_yield();
+    }
+  }
+  ALLOW_CANCELATION;
+}
+
 /**
  * Locks mutex.
  *
@@ -81,9 +126,7 @@ errno_t pthread_mutex_lock(pthread_mutex_t *mutex) {
   }
 
   if (mutex->_type == PTHREAD_MUTEX_NORMAL) {
-    while (atomic_exchange_explicit(&mutex->_lock, 1, memory_order_acquire)) {
-      pthread_pause_np();
-    }
+    pthread_mutex_lock_futex(mutex);
     return 0;
   }
 
@@ -101,9 +144,7 @@ errno_t pthread_mutex_lock(pthread_mutex_t *mutex) {
     }
   }
 
-  while (atomic_exchange_explicit(&mutex->_lock, 1, memory_order_acquire)) {
-    pthread_pause_np();
-  }
+  pthread_mutex_lock_futex(mutex);
 
   mutex->_depth = 0;
   mutex->_owner = t;
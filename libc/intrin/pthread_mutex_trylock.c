@@ -38,7 +38,7 @@
  *     current thread already holds this mutex
  */
 errno_t pthread_mutex_trylock(pthread_mutex_t *mutex) {
-  int t;
+  int t, word;
 
   // delegate to *NSYNC if possible
   if (mutex->_type == PTHREAD_MUTEX_NORMAL &&
@@ -53,7 +53,10 @@ errno_t pthread_mutex_trylock(pthread_mutex_t *mutex) {
 
   // handle normal mutexes
   if (mutex->_type == PTHREAD_MUTEX_NORMAL) {
-    if (!atomic_exchange_explicit(&mutex->_lock, 1, memory_order_acquire)) {
+    word = 0;
+    if (atomic_compare_exchange_strong_explicit(&mutex->_lock, &word, 1,
+                                                memory_order_acquire,
+                                                memory_order_relaxed)) {
       return 0;
     } else {
       return EBUSY;
@@ -75,7 +78,10 @@ errno_t pthread_mutex_trylock(pthread_mutex_t *mutex) {
     }
   }
 
-  if (atomic_exchange_explicit(&mutex->_lock, 1, memory_order_acquire)) {
+  word = 0;
+  if (!atomic_compare_exchange_strong_explicit(&mutex->_lock, &word, 1,
+                                               memory_order_acquire,
+                                               memory_order_relaxed)) {
     return EBUSY;
   }
 
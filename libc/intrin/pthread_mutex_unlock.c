@@ -23,8 +23,16 @@
 #include "libc/intrin/weaken.h"
 #include "libc/runtime/internal.h"
 #include "libc/thread/thread.h"
+#include "third_party/nsync/futex.internal.h"
 #include "third_party/nsync/mu.h"
 
+static void pthread_mutex_unlock_futex(pthread_mutex_t *mutex) {
+  if (atomic_exchange_explicit(&mutex->_lock, 0, memory_order_release) == 2 &&
+      _weaken(nsync_futex_wake_)) {
+    _weaken(nsync_futex_wake_)(&mutex->_lock, 1, mutex->_pshared);
+  }
+}
+
 /**
  * Releases mutex.
  *
@@ -47,7 +55,7 @@ errno_t pthread_mutex_unlock(pthread_mutex_t *mutex) {
   }
 
   if (mutex->_type == PTHREAD_MUTEX_NORMAL) {
-    atomic_store_explicit(&mutex->_lock, 0, memory_order_release);
+    pthread_mutex_unlock_futex(mutex);
     return 0;
   }
 
@@ -66,7 +74,7 @@ errno_t pthread_mutex_unlock(pthread_mutex_t *mutex) {
   }
 
   mutex->_owner = 0;
-  atomic_store_explicit(&mutex->_lock, 0, memory_order_release);
+  pthread_mutex_unlock_futex(mutex);
 
   return 0;
 }
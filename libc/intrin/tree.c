@@ -0,0 +1,235 @@
+/*-*- mode:c;indent-tabs-mode:nil;c-basic-offset:2;tab-width:8;coding:utf-8 -*-│
+│ vi: set et ft=c ts=2 sts=2 sw=2 fenc=utf-8                               :vi │
+╞══════════════════════════════════════════════════════════════════════════════╡
+│ Copyright 2024 Justine Alexandra Roberts Tunney                              │
+│                                                                              │
+│ Permission to use, copy, modify, and/or distribute this software for         │
+│ any purpose with or without fee is hereby granted, provided that the         │
+│ above copyright notice and this permission notice appear in all copies.      │
+│                                                                              │
+│ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL                │
+│ WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED                │
+│ WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE             │
+│ AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL         │
+│ DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR        │
+│ PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER               │
+│ TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR             │
+│ PERFORMANCE OF THIS SOFTWARE.                                                │
+╚─────────────────────────────────────────────────────────────────────────────*/
+#include "libc/intrin/tree.h"
+
+/**
+ * @fileoverview Red-Black Tree Library
+ *
+ * Nodes are intrusive and keep a pointer to their parent, so callers
+ * can walk the tree in order, and remove a node they're holding, with
+ * no allocations and without needing to search for it again.
+ */
+
+privileged static void tree_rotate_left(struct Tree **root, struct Tree *x) {
+  struct Tree *y = x->right;
+  if ((x->right = y->left))
+    y->left->parent = x;
+  if (!(y->parent = x->parent)) {
+    *root = y;
+  } else if (x == x->parent->left) {
+    x->parent->left = y;
+  } else {
+    x->parent->right = y;
+  }
+  y->left = x;
+  x->parent = y;
+}
+
+privileged static void tree_rotate_right(struct Tree **root, struct Tree *x) {
+  struct Tree *y = x->left;
+  if ((x->left = y->right))
+    y->right->parent = x;
+  if (!(y->parent = x->parent)) {
+    *root = y;
+  } else if (x == x->parent->right) {
+    x->parent->right = y;
+  } else {
+    x->parent->left = y;
+  }
+  y->right = x;
+  x->parent = y;
+}
+
+privileged static void tree_rebalance_insert(struct Tree **root,
+                                             struct Tree *node) {
+  struct Tree *uncle;
+  while (node->parent && node->parent->red) {
+    if (node->parent == node->parent->parent->left) {
+      uncle = node->parent->parent->right;
+      if (uncle && uncle->red) {
+        node->parent->red = false;
+        uncle->red = false;
+        node->parent->parent->red = true;
+        node = node->parent->parent;
+      } else {
+        if (node == node->parent->right) {
+          node = node->parent;
+          tree_rotate_left(root, node);
+        }
+        node->parent->red = false;
+        node->parent->parent->red = true;
+        tree_rotate_right(root, node->parent->parent);
+      }
+    } else {
+      uncle = node->parent->parent->left;
+      if (uncle && uncle->red) {
+        node->parent->red = false;
+        uncle->red = false;
+        node->parent->parent->red = true;
+        node = node->parent->parent;
+      } else {
+        if (node == node->parent->left) {
+          node = node->parent;
+          tree_rotate_right(root, node);
+        }
+        node->parent->red = false;
+        node->parent->parent->red = true;
+        tree_rotate_left(root, node->parent->parent);
+      }
+    }
+  }
+  (*root)->red = false;
+}
+
+/**
+ * Inserts `node` into tree.
+ *
+ * Nodes comparing equal to one that's already in the tree are placed
+ * after it, so iteration order is stable.
+ */
+privileged void tree_insert(struct Tree **root, struct Tree *node,
+                            tree_cmp_f *cmp) {
+  struct Tree *parent = 0, **link = root;
+  while (*link) {
+    parent = *link;
+    if (cmp(node, parent) < 0) {
+      link = &parent->left;
+    } else {
+      link = &parent->right;
+    }
+  }
+  node->parent = parent;
+  node->left = 0;
+  node->right = 0;
+  node->red = true;
+  *link = node;
+  tree_rebalance_insert(root, node);
+}
+
+privileged static void tree_transplant(struct Tree **root, struct Tree *u,
+                                       struct Tree *v) {
+  if (!u->parent) {
+    *root = v;
+  } else if (u == u->parent->left) {
+    u->parent->left = v;
+  } else {
+    u->parent->right = v;
+  }
+  if (v)
+    v->parent = u->parent;
+}
+
+privileged static void tree_rebalance_remove(struct Tree **root,
+                                             struct Tree *node,
+                                             struct Tree *parent) {
+  struct Tree *sibling;
+  while (node != *root && (!node || !node->red)) {
+    if (node == parent->left) {
+      sibling = parent->right;
+      if (sibling->red) {
+        sibling->red = false;
+        parent->red = true;
+        tree_rotate_left(root, parent);
+        sibling = parent->right;
+      }
+      if ((!sibling->left || !sibling->left->red) &&
+          (!sibling->right || !sibling->right->red)) {
+        sibling->red = true;
+        node = parent;
+        parent = node->parent;
+      } else {
+        if (!sibling->right || !sibling->right->red) {
+          sibling->left->red = false;
+          sibling->red = true;
+          tree_rotate_right(root, sibling);
+          sibling = parent->right;
+        }
+        sibling->red = parent->red;
+        parent->red = false;
+        sibling->right->red = false;
+        tree_rotate_left(root, parent);
+        node = *root;
+      }
+    } else {
+      sibling = parent->left;
+      if (sibling->red) {
+        sibling->red = false;
+        parent->red = true;
+        tree_rotate_right(root, parent);
+        sibling = parent->left;
+      }
+      if ((!sibling->left || !sibling->left->red) &&
+          (!sibling->right || !sibling->right->red)) {
+        sibling->red = true;
+        node = parent;
+        parent = node->parent;
+      } else {
+        if (!sibling->left || !sibling->left->red) {
+          sibling->right->red = false;
+          sibling->red = true;
+          tree_rotate_left(root, sibling);
+          sibling = parent->left;
+        }
+        sibling->red = parent->red;
+        parent->red = false;
+        sibling->left->red = false;
+        tree_rotate_right(root, parent);
+        node = *root;
+      }
+    }
+  }
+  if (node)
+    node->red = false;
+}
+
+/**
+ * Removes `node` from tree.
+ */
+privileged void tree_remove(struct Tree **root, struct Tree *node) {
+  bool red;
+  struct Tree *child, *parent, *succ;
+  red = node->red;
+  if (!node->left) {
+    child = node->right;
+    parent = node->parent;
+    tree_transplant(root, node, child);
+  } else if (!node->right) {
+    child = node->left;
+    parent = node->parent;
+    tree_transplant(root, node, child);
+  } else {
+    succ = tree_first(node->right);
+    red = succ->red;
+    child = succ->right;
+    if (succ->parent == node) {
+      parent = succ;
+    } else {
+      parent = succ->parent;
+      tree_transplant(root, succ, succ->right);
+      succ->right = node->right;
+      succ->right->parent = succ;
+    }
+    tree_transplant(root, node, succ);
+    succ->left = node->left;
+    succ->left->parent = succ;
+    succ->red = node->red;
+  }
+  if (!red && *root)
+    tree_rebalance_remove(root, child, parent);
+}
@@ -0,0 +1,57 @@
+#ifdef _COSMO_SOURCE
+#ifndef COSMOPOLITAN_LIBC_INTRIN_TREE_H_
+#define COSMOPOLITAN_LIBC_INTRIN_TREE_H_
+#define tree_insert __tree_insert
+#define tree_remove __tree_remove
+COSMOPOLITAN_C_START_
+
+#define TREE_CONTAINER(t, f, p) ((t *)(((char *)(p)) - offsetof(t, f)))
+
+struct Tree {
+  struct Tree *parent;
+  struct Tree *left;
+  struct Tree *right;
+  bool red;
+};
+
+typedef int tree_cmp_f(const struct Tree *, const struct Tree *);
+
+forceinline struct Tree *tree_first(struct Tree *node) {
+  if (node)
+    while (node->left)
+      node = node->left;
+  return node;
+}
+
+forceinline struct Tree *tree_last(struct Tree *node) {
+  if (node)
+    while (node->right)
+      node = node->right;
+  return node;
+}
+
+forceinline struct Tree *tree_next(struct Tree *node) {
+  struct Tree *parent;
+  if (node->right)
+    return tree_first(node->right);
+  while ((parent = node->parent) && node == parent->right)
+    node = parent;
+  return parent;
+}
+
+forceinline struct Tree *tree_prev(struct Tree *node) {
+  struct Tree *parent;
+  if (node->left)
+    return tree_last(node->left);
+  while ((parent = node->parent) && node == parent->left)
+    node = parent;
+  return parent;
+}
+
+void tree_insert(struct Tree **, struct Tree *, tree_cmp_f *) paramsnonnull()
+    libcesque;
+void tree_remove(struct Tree **, struct Tree *) paramsnonnull() libcesque;
+
+COSMOPOLITAN_C_END_
+#endif /* COSMOPOLITAN_LIBC_INTRIN_TREE_H_ */
+#endif /* _COSMO_SOURCE */
@@ -24,6 +24,11 @@ int heapsort_r(void *, size_t, size_t,
 int mergesort(void *, size_t, size_t, int (*)(const void *, const void *));
 int mergesort_r(void *, size_t, size_t,
                 int (*)(const void *, const void *, void *), void *);
+void qsort_r_par(void *, size_t, size_t,
+                 int (*)(const void *, const void *, void *), void *)
+    paramsnonnull((1, 4));
+int mergesort_r_par(void *, size_t, size_t,
+                    int (*)(const void *, const void *, void *), void *);
 
 int radix_sort_int32(int32_t *, size_t) libcesque;
 int radix_sort_int64(int64_t *, size_t) libcesque;
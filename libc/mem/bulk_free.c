@@ -22,11 +22,12 @@
 /**
  * Frees and clears (sets to NULL) each non-null pointer in given array.
  *
- * This is twice as fast as freeing them one-by-one. If footers are
- * used, pointers that have been allocated in different mspaces are
- * not freed or cleared, and the count of all such pointers is returned.
- * For large arrays of pointers with poor locality, it may be worthwhile
- * to sort this array before calling bulk_free.
+ * This is twice as fast as freeing them one-by-one. This function may
+ * reorder the array, sorting it by address so that pointers owned by
+ * the same malloc arena are released under a single lock acquisition
+ * and neighboring chunks are coalesced.
+ *
+ * @return number of pointers that couldn't be freed, which is zero
  */
 size_t bulk_free(void **p, size_t n) {
   return dlbulk_free(p, n);
@@ -77,6 +77,8 @@ void CheckForMemoryLeaks(void) {
   // validate usage of this api
   if (_weaken(_pthread_decimate))
     _weaken(_pthread_decimate)();
+  if (_weaken(_pthread_cache_trim))
+    _weaken(_pthread_cache_trim)();
   if (!pthread_orphan_np())
     kprintf("warning: called CheckForMemoryLeaks() from non-orphaned thread\n");
 
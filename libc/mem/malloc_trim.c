@@ -16,16 +16,24 @@
 │ TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR             │
 │ PERFORMANCE OF THIS SOFTWARE.                                                │
 ╚─────────────────────────────────────────────────────────────────────────────*/
+#include "libc/intrin/weaken.h"
 #include "libc/mem/mem.h"
+#include "libc/thread/posixthread.internal.h"
 #include "third_party/dlmalloc/dlmalloc.h"
 
 /**
  * Releases freed memory back to system.
  *
+ * This also returns the small chunks held in the calling thread's free
+ * list cache back to their arenas before trimming, and releases stacks
+ * that pthread_create() kept around from exited threads.
+ *
  * @param n specifies bytes of memory to leave available
  * @return 1 if it actually released any memory, else 0
  */
 int malloc_trim(size_t n) {
+  if (_weaken(_pthread_cache_trim))
+    _weaken(_pthread_cache_trim)();
   return dlmalloc_trim(n);
 }
 
@@ -38,11 +38,11 @@ wchar_t *wcsdup(const wchar_t *) strlenesque __wur;
 struct mallinfo {
   size_t arena;    /* non-mmapped space allocated from system */
   size_t ordblks;  /* number of free chunks */
-  size_t smblks;   /* always 0 */
+  size_t smblks;   /* chunks in calling thread's cache */
   size_t hblks;    /* always 0 */
   size_t hblkhd;   /* space in mmapped regions */
   size_t usmblks;  /* maximum total allocated space */
-  size_t fsmblks;  /* always 0 */
+  size_t fsmblks;  /* bytes in calling thread's cache */
   size_t uordblks; /* total allocated space */
   size_t fordblks; /* total free space */
   size_t keepcost; /* releasable (via malloc_trim) space */
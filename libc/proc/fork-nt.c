@@ -29,6 +29,7 @@
 #include "libc/intrin/directmap.internal.h"
 #include "libc/intrin/kprintf.h"
 #include "libc/intrin/maps.h"
+#include "libc/intrin/tree.h"
 #include "libc/intrin/strace.internal.h"
 #include "libc/intrin/weaken.h"
 #include "libc/macros.internal.h"
@@ -226,10 +227,12 @@ textwindows void WinMainForked(void) {
   ReadOrDie(reader, jb, sizeof(jb));
 
   // read memory mappings from parent process
-  struct Map *maps = __maps.maps;
+  struct Dll *maps = 0;
   for (;;) {
     map = Malloc(sizeof(*map));
     ReadOrDie(reader, map, sizeof(*map));
+    if (!map->size)
+      break;  // end of list
     if ((map->flags & MAP_TYPE) != MAP_SHARED) {
       // we don't need to close the map handle because sys_mmap_nt
       // doesn't mark it inheritable across fork() for MAP_PRIVATE
@@ -244,11 +247,7 @@ textwindows void WinMainForked(void) {
                 map->off, map->size, map->addr);
     }
     dll_init(&map->elem);
-    bool isdone = !map->next;
-    map->next = maps;
-    maps = map;
-    if (isdone)
-      break;
+    dll_make_last(&maps, &map->elem);
   }
 
   // read the .data and .bss program image sections
@@ -262,16 +261,17 @@ textwindows void WinMainForked(void) {
 
   // fixup memory manager
   __maps.free = 0;
-  __maps.used = 0;
-  __maps.maps = maps;
+  __maps.maps = 0;
   __maps.count = 0;
   __maps.pages = 0;
   dll_init(&__maps.stack.elem);
-  dll_make_first(&__maps.used, &__maps.stack.elem);
-  for (struct Map *map = maps; map; map = map->next) {
+  // the parent sent its stack along with the other maps, so we insert
+  // its copy rather than __maps.stack, which would be a duplicate key
+  for (struct Dll *e = dll_first(maps); e; e = dll_next(maps, e)) {
+    map = MAP_CONTAINER(e);
     __maps.count += 1;
     __maps.pages += (map->size + 4095) / 4096;
-    dll_make_last(&__maps.used, &map->elem);
+    tree_insert(&__maps.maps, &map->tree, __maps_compare);
     if (!VirtualProtect(map->addr, map->size, __prot2nt(map->prot, map->iscow),
                         &oldprot)) {
       AbortFork("VirtualProtect");
@@ -364,7 +364,8 @@ textwindows int sys_fork_nt(uint32_t dwCreationFlags) {
       if (spawnrc != -1) {
         CloseHandle(procinfo.hThread);
         ok = WriteAll(writer, jb, sizeof(jb));
-        for (struct Map *map = __maps.maps; ok && map; map = map->next) {
+        for (struct Map *map = __maps_first(); ok && map;
+             map = __maps_next(map)) {
           if (MAX((char *)__executable_start, map->addr) <
               MIN((char *)_end, map->addr + map->size))
             continue;  // executable image is loaded by windows
@@ -376,6 +377,8 @@ textwindows int sys_fork_nt(uint32_t dwCreationFlags) {
             ok = WriteAll(writer, map->addr, map->size);
           }
         }
+        if (ok)
+          ok = WriteAll(writer, &(struct Map){0}, sizeof(struct Map));
         if (ok)
           ok = WriteAll(writer, __data_start, __data_end - __data_start);
         if (ok)
@@ -42,6 +42,7 @@ int GetDosArgv(const char16_t *, char *, size_t, char **, size_t);
 int GetDosEnviron(const char16_t *, char *, size_t, char **, size_t);
 bool __intercept_flag(int *, char *[], const char *);
 int __inflate(void *, size_t, const void *, size_t);
+int __unzstd(void *, size_t, const void *, size_t);
 void *__mmap_unlocked(void *, size_t, int, int, int, int64_t);
 int __munmap_unlocked(char *, size_t);
 void __on_arithmetic_overflow(void);
@@ -0,0 +1,50 @@
+/*-*- mode:c;indent-tabs-mode:nil;c-basic-offset:2;tab-width:8;coding:utf-8 -*-│
+│ vi: set et ft=c ts=2 sts=2 sw=2 fenc=utf-8                               :vi │
+╞══════════════════════════════════════════════════════════════════════════════╡
+│ Copyright 2024 Justine Alexandra Roberts Tunney                              │
+│                                                                              │
+│ Permission to use, copy, modify, and/or distribute this software for         │
+│ any purpose with or without fee is hereby granted, provided that the         │
+│ above copyright notice and this permission notice appear in all copies.      │
+│                                                                              │
+│ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL                │
+│ WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED                │
+│ WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE             │
+│ AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL         │
+│ DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR        │
+│ PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER               │
+│ TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR             │
+│ PERFORMANCE OF THIS SOFTWARE.                                                │
+╚─────────────────────────────────────────────────────────────────────────────*/
+#include "libc/intrin/strace.internal.h"
+#include "libc/intrin/weaken.h"
+#include "libc/macros.internal.h"
+#include "libc/runtime/internal.h"
+#include "libc/runtime/runtime.h"
+#include "third_party/zstd/zstd.h"
+
+/**
+ * Decompresses zstd frame.
+ *
+ * This is only possible if zstd is linked, e.g. by saying
+ * `__static_yoink("ZSTD_decompress")` in your main module.
+ *
+ * @param outsize needs to be known ahead of time by some other means
+ * @return 0 on success or nonzero on failure
+ */
+int __unzstd(void *out, size_t outsize, const void *in, size_t insize) {
+  int rc;
+  size_t got;
+  if (_weaken(ZSTD_decompress) &&  //
+      _weaken(ZSTD_isError) &&     //
+      __runlevel >= RUNLEVEL_MALLOC) {
+    got = _weaken(ZSTD_decompress)(out, outsize, in, insize);
+    rc = _weaken(ZSTD_isError)(got) || got != outsize;
+  } else {
+    rc = -1;
+  }
+  STRACE("unzstd([%#.*hhs%s], %'zu, %#.*hhs%s, %'zu) → %d",
+         (int)MIN(40, outsize), out, outsize > 40 ? "..." : "", outsize,
+         (int)MIN(40, insize), in, insize > 40 ? "..." : "", insize, rc);
+  return rc;
+}
@@ -22,6 +22,7 @@
 #include "libc/calls/syscall_support-nt.internal.h"
 #include "libc/intrin/dll.h"
 #include "libc/intrin/maps.h"
+#include "libc/intrin/tree.h"
 #include "libc/intrin/nomultics.internal.h"
 #include "libc/intrin/weaken.h"
 #include "libc/limits.h"
@@ -211,11 +212,10 @@ static abi wontreturn void WinInit(const char16_t *cmdline) {
   __maps.stack.addr = stackaddr;
   __maps.stack.size = stacksize;
   __maps.stack.prot = prot;
-  __maps.maps = &__maps.stack;
   __maps.pages = (stacksize + 4095) / 4096;
   __maps.count = 1;
   dll_init(&__maps.stack.elem);
-  dll_make_first(&__maps.used, &__maps.stack.elem);
+  tree_insert(&__maps.maps, &__maps.stack.tree, __maps_compare);
   struct WinArgs *wa =
       (struct WinArgs *)(stackaddr + (stacksize - sizeof(struct WinArgs)));
 
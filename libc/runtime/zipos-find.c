@@ -19,14 +19,38 @@
 #include "libc/intrin/kprintf.h"
 #include "libc/macros.internal.h"
 #include "libc/runtime/zipos.internal.h"
+#include "libc/serialize.h"
 #include "libc/str/str.h"
 #include "libc/sysv/consts/s.h"
 #include "libc/sysv/errfuns.h"
 #include "libc/zip.internal.h"
 
+// returns offset of i'th central directory record in name order
+static inline size_t __zipos_index(struct Zipos *z, size_t i) {
+  return z->cdiroff + READ32LE(z->index + i * 4);
+}
+
+// returns offset of record with exact name, or -1 if not found
+static ssize_t __zipos_lookup(struct Zipos *z, const char *path, int len,
+                              bool dir, uint32_t h) {
+  size_t cf;
+  uint32_t i, x;
+  const char *zname;
+  for (i = h & z->hashmask; (x = READ32LE(z->table + i * 4));
+       i = (i + 1) & z->hashmask) {
+    cf = z->cdiroff + x - 1;
+    zname = ZIP_CFILE_NAME(z->map + cf);
+    if (ZIP_CFILE_NAMESIZE(z->map + cf) == len + dir &&
+        !memcmp(zname, path, len) && (!dir || zname[len] == '/')) {
+      return cf;
+    }
+  }
+  return -1;
+}
+
 static ssize_t __zipos_match(struct Zipos *z, struct ZiposUri *name, int len,
                              int i) {
-  size_t cfile = z->index[i];
+  size_t cfile = __zipos_index(z, i);
   const char *zname = ZIP_CFILE_NAME(z->map + cfile);
   int zsize = ZIP_CFILE_NAMESIZE(z->map + cfile);
   if ((len == zsize || (len + 1 == zsize && zname[len] == '/')) &&
@@ -53,14 +77,23 @@ ssize_t __zipos_scan(struct Zipos *zipos, struct ZiposUri *name) {
     return ZIPOS_SYNTHETIC_DIRECTORY;
   }
 
+  // try hash table, which will find files and explicit directories
+  ssize_t cf;
+  uint32_t h = __zipos_hash(ZIPOS_HASH_INIT, name->path, len);
+  if ((cf = __zipos_lookup(zipos, name->path, len, false, h)) != -1 ||
+      (cf = __zipos_lookup(zipos, name->path, len, true,
+                           __zipos_hash(h, "/", 1))) != -1) {
+    return cf;
+  }
+
   // binary search for leftmost name in central directory
   int l = 0;
   int r = zipos->records;
   while (l < r) {
     int m = (l & r) + ((l ^ r) >> 1);  // floor((a+b)/2)
-    const char *xp = ZIP_CFILE_NAME(zipos->map + zipos->index[m]);
+    const char *xp = ZIP_CFILE_NAME(zipos->map + __zipos_index(zipos, m));
     const char *yp = name->path;
-    int xn = ZIP_CFILE_NAMESIZE(zipos->map + zipos->index[m]);
+    int xn = ZIP_CFILE_NAMESIZE(zipos->map + __zipos_index(zipos, m));
     int yn = len;
     int n = MIN(xn, yn);
     int c;
@@ -80,7 +113,7 @@ ssize_t __zipos_scan(struct Zipos *zipos, struct ZiposUri *name) {
 
   if (l < zipos->records) {
     int dx;
-    size_t cfile = zipos->index[l];
+    size_t cfile = __zipos_index(zipos, l);
     const char *zname = ZIP_CFILE_NAME(zipos->map + cfile);
     int zsize = ZIP_CFILE_NAMESIZE(zipos->map + cfile);
     if (zsize > len && (dx = '/' - (zname[len] & 255))) {
@@ -90,11 +123,10 @@ ssize_t __zipos_scan(struct Zipos *zipos, struct ZiposUri *name) {
       dx = dx > +1 ? +1 : dx;
       dx = dx < -1 ? -1 : dx;
       for (l += dx; 0 <= l && l < zipos->records; l += dx) {
-        ssize_t cf;
         if ((cf = __zipos_match(zipos, name, len, l)) != -1) {
           return cf;
         }
-        cfile = zipos->index[l];
+        cfile = __zipos_index(zipos, l);
         zname = ZIP_CFILE_NAME(zipos->map + cfile);
         zsize = ZIP_CFILE_NAMESIZE(zipos->map + cfile);
         if (zsize < len || (len && zname[len - 1] != name->path[len - 1])) {
@@ -25,10 +25,11 @@
 #include "libc/intrin/cmpxchg.h"
 #include "libc/intrin/promises.internal.h"
 #include "libc/intrin/strace.internal.h"
+#include "libc/limits.h"
 #include "libc/macros.internal.h"
-#include "libc/mem/alg.h"
 #include "libc/runtime/runtime.h"
 #include "libc/runtime/zipos.internal.h"
+#include "libc/serialize.h"
 #include "libc/str/str.h"
 #include "libc/sysv/consts/auxv.h"
 #include "libc/sysv/consts/f.h"
@@ -46,10 +47,10 @@ __static_yoink(APE_COM_NAME);
 static struct Zipos __zipos;
 static atomic_uint __zipos_once;
 
-static void __zipos_dismiss(uint8_t *map, const uint8_t *cdir, long pg) {
-  uint64_t i, n, c, ef, lf, mo, lo, hi;
-
-  // determine the byte range of zip file content (excluding central dir)
+// determines byte range of zip file content (excluding central dir)
+static void __zipos_extent(uint8_t *map, const uint8_t *cdir, uint64_t *out_lo,
+                           uint64_t *out_hi) {
+  uint64_t i, n, c, ef, lf, lo, hi;
   c = GetZipCdirOffset(cdir);
   n = GetZipCdirRecords(cdir);
   for (lo = c, hi = i = 0; i < n; ++i, c += ZIP_CFILE_HDRSIZE(map + c)) {
@@ -60,6 +61,13 @@ static void __zipos_dismiss(uint8_t *map, const uint8_t *cdir, long pg) {
     if (ef > hi)
       hi = ef;
   }
+  *out_lo = lo;
+  *out_hi = hi;
+}
+
+static void __zipos_dismiss(uint8_t *map, uint64_t lo, uint64_t hi, uint64_t c,
+                            long pg) {
+  uint64_t mo;
 
   // unmap the executable portion beneath the local files
   mo = ROUNDDOWN(lo, __granularity());
@@ -74,35 +82,15 @@ static void __zipos_dismiss(uint8_t *map, const uint8_t *cdir, long pg) {
   }
 }
 
-static int __zipos_compare_names(const void *a, const void *b, void *c) {
-  const size_t *x = (const size_t *)a;
-  const size_t *y = (const size_t *)b;
-  struct Zipos *z = (struct Zipos *)c;
-  int xn = ZIP_CFILE_NAMESIZE(z->map + *x);
-  int yn = ZIP_CFILE_NAMESIZE(z->map + *y);
-  int n = MIN(xn, yn);
-  if (n) {
-    int res =
-        memcmp(ZIP_CFILE_NAME(z->map + *x), ZIP_CFILE_NAME(z->map + *y), n);
-    if (res)
-      return res;
-  }
-  return xn - yn;  // xn and yn are 16-bit
-}
-
 // creates binary searchable array of file offsets to cdir records
 static void __zipos_generate_index(struct Zipos *zipos) {
-  size_t c, i;
-  zipos->records = GetZipCdirRecords(zipos->cdir);
-  zipos->index = _mapanon(zipos->records * sizeof(size_t));
-  for (i = 0, c = GetZipCdirOffset(zipos->cdir); i < zipos->records;
-       ++i, c += ZIP_CFILE_HDRSIZE(zipos->map + c)) {
-    zipos->index[i] = c;
-  }
-  // smoothsort() isn't the fastest algorithm, but it guarantees
-  // o(nlogn) won't smash the stack and doesn't depend on malloc
-  smoothsort_r(zipos->index, zipos->records, sizeof(size_t),
-               __zipos_compare_names, zipos);
+  size_t size = __zipos_index_size(zipos->records);
+  uint8_t *idx = _mapanon(size);
+  __zipos_index_build(idx, zipos->map + zipos->cdiroff,
+                      GetZipCdirSize(zipos->cdir), zipos->records, 0, 0);
+  zipos->index = idx + ZIPOS_INDEX_HDRSIZE;
+  zipos->table = zipos->index + zipos->records * 4;
+  zipos->hashmask = READ32LE(idx + 12);
 }
 
 static void __zipos_init(void) {
@@ -131,13 +119,19 @@ static void __zipos_init(void) {
         if (!fstat(fd, &st) && (map = mmap(0, st.st_size, PROT_READ, MAP_SHARED,
                                            fd, 0)) != MAP_FAILED) {
           if ((cdir = GetZipEocd(map, st.st_size, &err))) {
+            uint64_t lo, hi;
             long pagesz = getauxval(AT_PAGESZ);
-            __zipos_dismiss(map, cdir, pagesz);
             __zipos.map = map;
             __zipos.cdir = cdir;
             __zipos.dev = st.st_ino;
             __zipos.pagesz = pagesz;
-            __zipos_generate_index(&__zipos);
+            __zipos.cdiroff = GetZipCdirOffset(cdir);
+            __zipos.records = GetZipCdirRecords(cdir);
+            if (!__zipos_load_index(&__zipos, &lo, &hi)) {
+              __zipos_extent(map, cdir, &lo, &hi);
+              __zipos_generate_index(&__zipos);
+            }
+            __zipos_dismiss(map, lo, hi, __zipos.cdiroff, pagesz);
             msg = kZipOk;
           } else {
             munmap(map, st.st_size);
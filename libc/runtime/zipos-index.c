@@ -0,0 +1,181 @@
+/*-*- mode:c;indent-tabs-mode:nil;c-basic-offset:2;tab-width:8;coding:utf-8 -*-│
+│ vi: set et ft=c ts=2 sts=2 sw=2 fenc=utf-8                               :vi │
+╞══════════════════════════════════════════════════════════════════════════════╡
+│ Copyright 2024 Justine Alexandra Roberts Tunney                              │
+│                                                                              │
+│ Permission to use, copy, modify, and/or distribute this software for         │
+│ any purpose with or without fee is hereby granted, provided that the         │
+│ above copyright notice and this permission notice appear in all copies.      │
+│                                                                              │
+│ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL                │
+│ WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED                │
+│ WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE             │
+│ AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL         │
+│ DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR        │
+│ PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER               │
+│ TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR             │
+│ PERFORMANCE OF THIS SOFTWARE.                                                │
+╚─────────────────────────────────────────────────────────────────────────────*/
+#include "libc/limits.h"
+#include "libc/macros.internal.h"
+#include "libc/mem/alg.h"
+#include "libc/runtime/zipos.internal.h"
+#include "libc/serialize.h"
+#include "libc/str/str.h"
+#include "libc/zip.internal.h"
+
+/**
+ * Returns number of hash table slots in index of `records` entries.
+ */
+size_t __zipos_index_slots(size_t records) {
+  size_t n = 1;
+  while (n < records * 2)
+    n <<= 1;
+  return n;
+}
+
+static int __zipos_index_compare(const void *a, const void *b, void *c) {
+  const uint8_t *x = (const uint8_t *)c + *(const uint32_t *)a;
+  const uint8_t *y = (const uint8_t *)c + *(const uint32_t *)b;
+  int xn = ZIP_CFILE_NAMESIZE(x);
+  int yn = ZIP_CFILE_NAMESIZE(y);
+  int n = MIN(xn, yn);
+  if (n) {
+    int res = memcmp(ZIP_CFILE_NAME(x), ZIP_CFILE_NAME(y), n);
+    if (res)
+      return res;
+  }
+  return xn - yn;  // xn and yn are 16-bit
+}
+
+/**
+ * Returns true if central directory record `cf` is the zipos index.
+ */
+bool __zipos_is_index(const uint8_t *cf) {
+  return ZIP_CFILE_NAMESIZE(cf) == strlen(ZIPOS_INDEX_NAME) &&
+         !memcmp(ZIP_CFILE_NAME(cf), ZIPOS_INDEX_NAME,
+                 strlen(ZIPOS_INDEX_NAME));
+}
+
+/**
+ * Returns number of bytes needed to index zip central directory.
+ */
+size_t __zipos_index_size(size_t records) {
+  return ZIPOS_INDEX_HDRSIZE + records * 4 + __zipos_index_slots(records) * 4;
+}
+
+/**
+ * Creates index of zip central directory.
+ *
+ * @param idx receives __zipos_index_size(records) bytes and must be
+ *     aligned on a four byte boundary
+ * @param cdir is the central directory, which has `records` entries
+ * @param lo is distance from first local file to central directory
+ * @param hi is distance from end of last local file to central dir
+ */
+void __zipos_index_build(uint8_t *idx, const uint8_t *cdir, size_t cdirsize,
+                         size_t records, uint32_t lo, uint32_t hi) {
+  uint32_t h, *sorted, *table;
+  size_t i, j, c, n, slots = __zipos_index_slots(records);
+  sorted = (uint32_t *)(idx + ZIPOS_INDEX_HDRSIZE);
+  table = sorted + records;
+  for (c = i = 0; i < records; ++i, c += ZIP_CFILE_HDRSIZE(cdir + c))
+    sorted[i] = c;
+  // smoothsort() isn't the fastest algorithm, but it guarantees
+  // o(nlogn) won't smash the stack and doesn't depend on malloc
+  smoothsort_r(sorted, records, sizeof(uint32_t), __zipos_index_compare,
+               (void *)cdir);
+  // entries are inserted in sorted order, so if the same name appears
+  // more than once, both lookup methods will find the same one first
+  bzero(table, slots * sizeof(uint32_t));
+  for (i = 0; i < records; ++i) {
+    n = ZIP_CFILE_NAMESIZE(cdir + sorted[i]);
+    h = __zipos_hash(ZIPOS_HASH_INIT, ZIP_CFILE_NAME(cdir + sorted[i]), n);
+    for (j = h & (slots - 1); table[j]; j = (j + 1) & (slots - 1)) {
+    }
+    table[j] = sorted[i] + 1;
+  }
+  WRITE32LE(idx + 0, ZIPOS_INDEX_MAGIC);
+  WRITE32LE(idx + 4, records);
+  WRITE32LE(idx + 8, cdirsize);
+  WRITE32LE(idx + 12, slots - 1);
+  WRITE32LE(idx + 16, lo);
+  WRITE32LE(idx + 20, hi);
+  WRITE32LE(idx + 24, 0);
+  WRITE32LE(idx + 28, 0);
+}
+
+/**
+ * Loads index that zipcopy or apelink put at end of central directory.
+ *
+ * The index is only used if it matches the central directory and it's
+ * impossible for it to send lookups out of bounds or into a loop.
+ *
+ * @param zipos has its `map`, `cdir`, `cdiroff`, and `records` fields
+ *     initialized, and receives the index on success
+ * @param out_lo receives file offset of first local file
+ * @param out_hi receives file offset of end of last local file
+ * @return true if index was loaded, otherwise false w/o changing zipos
+ */
+bool __zipos_load_index(struct Zipos *zipos, uint64_t *out_lo,
+                        uint64_t *out_hi) {
+  uint32_t x;
+  uint64_t lf, ef, lo, hi;
+  size_t i, n, slots, empty, cdirsize;
+  const uint8_t *cf, *idx, *cdir, *table;
+  n = strlen(ZIPOS_INDEX_NAME);
+  cdir = zipos->map + zipos->cdiroff;
+  cdirsize = GetZipCdirSize(zipos->cdir);
+  if (!zipos->records || zipos->records > UINT32_MAX / 8 ||
+      cdirsize < kZipCfileHdrMinSize + n || cdirsize > UINT32_MAX)
+    return false;
+  cf = cdir + cdirsize - (kZipCfileHdrMinSize + n);
+  if (ZIP_CFILE_MAGIC(cf) != kZipCfileHdrMagic ||  //
+      ZIP_CFILE_NAMESIZE(cf) != n ||                //
+      ZIP_CFILE_EXTRASIZE(cf) ||                    //
+      ZIP_CFILE_COMMENTSIZE(cf) ||                  //
+      !__zipos_is_index(cf) ||
+      ZIP_CFILE_COMPRESSIONMETHOD(cf) != kZipCompressionNone ||
+      GetZipCfileCompressedSize(cf) != __zipos_index_size(zipos->records))
+    return false;
+  if ((lf = GetZipCfileOffset(cf)) + kZipLfileHdrMinSize > zipos->cdiroff ||
+      ZIP_LFILE_MAGIC(zipos->map + lf) != kZipLfileHdrMagic ||
+      (ef = lf + ZIP_LFILE_HDRSIZE(zipos->map + lf) +
+            __zipos_index_size(zipos->records)) > zipos->cdiroff)
+    return false;
+  idx = ZIP_LFILE_CONTENT(zipos->map + lf);
+  slots = __zipos_index_slots(zipos->records);
+  if (READ32LE(idx + 0) != ZIPOS_INDEX_MAGIC ||
+      READ32LE(idx + 4) != zipos->records ||  //
+      READ32LE(idx + 8) != cdirsize ||        //
+      READ32LE(idx + 12) != slots - 1 ||      //
+      (lo = READ32LE(idx + 16)) > zipos->cdiroff ||
+      (hi = READ32LE(idx + 20)) > lo)
+    return false;
+  // __zipos_dismiss() unmaps everything beneath lo, so it mustn't claim
+  // the local files begin after either the index or the first record's
+  lo = zipos->cdiroff - lo;
+  hi = zipos->cdiroff - hi;
+  if (lo > lf || lo > GetZipCfileOffset(cdir) || hi < ef)
+    return false;
+  // make sure the index can't send us outside the central directory
+  for (i = 0; i < zipos->records; ++i)
+    if (READ32LE(idx + ZIPOS_INDEX_HDRSIZE + i * 4) >
+        cdirsize - kZipCfileHdrMinSize)
+      return false;
+  // and that every hash probe sequence terminates at an empty slot
+  table = idx + ZIPOS_INDEX_HDRSIZE + zipos->records * 4;
+  for (empty = i = 0; i < slots; ++i) {
+    if ((x = READ32LE(table + i * 4)) > cdirsize - kZipCfileHdrMinSize + 1)
+      return false;
+    empty += !x;
+  }
+  if (!empty)
+    return false;
+  zipos->index = idx + ZIPOS_INDEX_HDRSIZE;
+  zipos->table = table;
+  zipos->hashmask = slots - 1;
+  *out_lo = lo;
+  *out_hi = hi;
+  return true;
+}
@@ -26,6 +26,7 @@
 #include "libc/calls/syscall_support-sysv.internal.h"
 #include "libc/dce.h"
 #include "libc/errno.h"
+#include "libc/fmt/conv.h"
 #include "libc/intrin/atomic.h"
 #include "libc/intrin/cmpxchg.h"
 #include "libc/intrin/directmap.internal.h"
@@ -36,6 +37,7 @@
 #include "libc/limits.h"
 #include "libc/runtime/internal.h"
 #include "libc/runtime/memtrack.internal.h"
+#include "libc/runtime/runtime.h"
 #include "libc/runtime/zipos.internal.h"
 #include "libc/str/str.h"
 #include "libc/sysv/consts/f.h"
@@ -52,12 +54,42 @@
 
 #define MAX_REFS SSIZE_MAX
 
+#define CACHE_BUDGET 16777216
+#define STREAM_MIN   1048576
+
+#define kZiposLoading 0
+#define kZiposReady   1
+#define kZiposFailed  2
+
 static char *__zipos_mapend;
 static size_t __zipos_maptotal;
 static pthread_mutex_t __zipos_lock_obj;
 
+// inflated assets are shared between open() calls, since languages
+// like python will repeatedly open the same modules. the cache holds
+// one reference to each entry. evicting an entry only drops that so
+// file descriptors still using the content are unaffected
+static struct {
+  bool once;
+  size_t used;
+  size_t budget;
+  struct Dll *lru;
+} __zipos_cache;
+
 static void __zipos_wipe(void) {
+  struct Dll *e, *e2;
+  struct ZiposHandle *h;
   pthread_mutex_init(&__zipos_lock_obj, 0);
+  // entries another thread was inflating at fork() time won't finish
+  for (e = dll_first(__zipos_cache.lru); e; e = e2) {
+    e2 = dll_next(__zipos_cache.lru, e);
+    h = ZIPOS_HANDLE_CONTAINER(e);
+    if (atomic_load_explicit(&h->state, memory_order_relaxed) ==
+        kZiposLoading) {
+      dll_remove(&__zipos_cache.lru, e);
+      __zipos_cache.used -= h->size;
+    }
+  }
 }
 
 static void __zipos_lock(void) {
@@ -89,15 +121,23 @@ struct ZiposHandle *__zipos_keep(struct ZiposHandle *h) {
 }
 
 void __zipos_drop(struct ZiposHandle *h) {
+  struct ZiposHandle *base;
   if (atomic_fetch_sub_explicit(&h->refs, 1, memory_order_release)) {
     return;
   }
   atomic_thread_fence(memory_order_acquire);
+  base = h->base;
+  if (h->stream) {
+    __zipos_stream_close(h->stream);
+  }
   __zipos_lock();
   do
     h->next = h->zipos->freelist;
   while (!_cmpxchg(&h->zipos->freelist, h->next, h));
   __zipos_unlock();
+  if (base) {
+    __zipos_drop(base);
+  }
 }
 
 static struct ZiposHandle *__zipos_alloc(struct Zipos *zipos, size_t size) {
@@ -122,6 +162,9 @@ StartOver:
   __zipos_unlock();
   if (h) {
     atomic_store_explicit(&h->refs, 0, memory_order_relaxed);
+    dll_init(&h->elem);
+    h->base = 0;
+    h->stream = 0;
     h->size = size;
     h->zipos = zipos;
     h->mapsize = mapsize;
@@ -129,6 +172,186 @@ StartOver:
   return h;
 }
 
+static size_t __zipos_cache_budget(void) {
+  const char *s;
+  if (!__zipos_cache.once) {
+    // cache size in bytes may be tuned by environment variable
+    if ((s = getenv("COSMOPOLITAN_ZIPOS_CACHE"))) {
+      __zipos_cache.budget = strtoul(s, 0, 0);
+    } else {
+      __zipos_cache.budget = CACHE_BUDGET;
+    }
+    __zipos_cache.once = true;
+  }
+  return __zipos_cache.budget;
+}
+
+// returns referenced cache entry for central directory offset, or null
+// @asyncsignalsafe with __zipos_lock() held
+static struct ZiposHandle *__zipos_cache_find(struct Zipos *zipos,
+                                              size_t cf) {
+  struct Dll *e;
+  struct ZiposHandle *h;
+  for (e = dll_first(__zipos_cache.lru); e;
+       e = dll_next(__zipos_cache.lru, e)) {
+    h = ZIPOS_HANDLE_CONTAINER(e);
+    if (h->cfile == cf && h->zipos == zipos) {
+      dll_remove(&__zipos_cache.lru, e);
+      dll_make_first(&__zipos_cache.lru, e);
+      return __zipos_keep(h);
+    }
+  }
+  return 0;
+}
+
+// adds entry to cache, returning evicted entries to be dropped
+// @asyncsignalsafe with __zipos_lock() held
+static struct Dll *__zipos_cache_insert(struct ZiposHandle *h) {
+  struct Dll *e, *evicted = 0;
+  struct ZiposHandle *old;
+  __zipos_keep(h);
+  dll_make_first(&__zipos_cache.lru, &h->elem);
+  __zipos_cache.used += h->size;
+  while (__zipos_cache.used > __zipos_cache.budget &&
+         (e = dll_last(__zipos_cache.lru)) != &h->elem) {
+    old = ZIPOS_HANDLE_CONTAINER(e);
+    dll_remove(&__zipos_cache.lru, e);
+    dll_make_last(&evicted, e);
+    __zipos_cache.used -= old->size;
+  }
+  return evicted;
+}
+
+static void __zipos_cache_release(struct Dll *evicted) {
+  struct Dll *e;
+  while ((e = dll_first(evicted))) {
+    dll_remove(&evicted, e);
+    __zipos_drop(ZIPOS_HANDLE_CONTAINER(e));
+  }
+}
+
+static void __zipos_uncache(struct ZiposHandle *h) {
+  struct Dll *e;
+  __zipos_lock();
+  for (e = dll_first(__zipos_cache.lru); e;
+       e = dll_next(__zipos_cache.lru, e)) {
+    if (e == &h->elem) {
+      dll_remove(&__zipos_cache.lru, e);
+      __zipos_cache.used -= h->size;
+      break;
+    }
+  }
+  __zipos_unlock();
+  if (e) {
+    __zipos_drop(h);
+  }
+}
+
+// decompresses zip file member content into `out`
+static int __zipos_decompress(struct Zipos *zipos, size_t lf, uint8_t *out,
+                              size_t size) {
+  const uint8_t *in = ZIP_LFILE_CONTENT(zipos->map + lf);
+  size_t insize = GetZipLfileCompressedSize(zipos->map + lf);
+  switch (ZIP_LFILE_COMPRESSIONMETHOD(zipos->map + lf)) {
+    case kZipCompressionDeflate:
+      return __inflate(out, size, in, insize);
+    case kZipCompressionZstd:
+      return __unzstd(out, size, in, insize);
+    default:
+      return -1;
+  }
+}
+
+static struct ZiposHandle *__zipos_inflate_private(struct Zipos *zipos,
+                                                   size_t lf, size_t size) {
+  struct ZiposHandle *h;
+  struct ZiposStream *s;
+  // large files get inflated as they're read, so opening a gigabyte
+  // dataset doesn't need a gigabyte of memory and a long wait
+  if (size >= STREAM_MIN &&
+      ZIP_LFILE_COMPRESSIONMETHOD(zipos->map + lf) ==
+          kZipCompressionDeflate &&
+      (s = __zipos_stream_open(ZIP_LFILE_CONTENT(zipos->map + lf),
+                               GetZipLfileCompressedSize(zipos->map + lf)))) {
+    if (!(h = __zipos_alloc(zipos, 0))) {
+      __zipos_stream_close(s);
+      return 0;
+    }
+    h->stream = s;
+    h->mem = 0;
+    return h;
+  }
+  if (!(h = __zipos_alloc(zipos, size)))
+    return 0;
+  if (__zipos_decompress(zipos, lf, h->data, size)) {
+    __zipos_drop(h);
+    eio();
+    return 0;
+  }
+  h->mem = h->data;
+  return h;
+}
+
+// returns handle to inflated content of zip file member
+//
+// if the asset fits in the cache, then the inflated content is shared
+// with every other open file descriptor for the same member, and when
+// several threads open it at once only the first one does the work.
+static struct ZiposHandle *__zipos_inflate(struct Zipos *zipos, size_t cf,
+                                           size_t lf, size_t size) {
+  int state;
+  bool cacheable;
+  struct Dll *evicted;
+  struct ZiposHandle *h, *base, *found;
+  __zipos_lock();
+  cacheable = size <= __zipos_cache_budget();
+  base = cacheable ? __zipos_cache_find(zipos, cf) : 0;
+  __zipos_unlock();
+  if (!cacheable)
+    return __zipos_inflate_private(zipos, lf, size);
+  if (!base) {
+    if (!(base = __zipos_alloc(zipos, size)))
+      return 0;
+    base->cfile = cf;
+    base->mem = 0;
+    atomic_store_explicit(&base->state, kZiposLoading, memory_order_relaxed);
+    __zipos_lock();
+    if ((found = __zipos_cache_find(zipos, cf))) {
+      evicted = 0;
+    } else {
+      evicted = __zipos_cache_insert(base);
+    }
+    __zipos_unlock();
+    __zipos_cache_release(evicted);
+    if (found) {
+      __zipos_drop(base);
+      base = found;
+    } else if (!__zipos_decompress(zipos, lf, base->data, size)) {
+      base->mem = base->data;
+      atomic_store_explicit(&base->state, kZiposReady, memory_order_release);
+    } else {
+      atomic_store_explicit(&base->state, kZiposFailed, memory_order_release);
+      __zipos_uncache(base);
+    }
+  }
+  while ((state = atomic_load_explicit(&base->state, memory_order_acquire)) ==
+         kZiposLoading) {
+    sched_yield();
+  }
+  if (state == kZiposFailed) {
+    __zipos_drop(base);
+    eio();
+    return 0;
+  }
+  if (!(h = __zipos_alloc(zipos, 0))) {
+    __zipos_drop(base);
+    return 0;
+  }
+  h->base = base;
+  h->mem = base->mem;
+  return h;
+}
+
 static int __zipos_mkfd(int minfd) {
   int fd, e = errno;
   if ((fd = __sys_fcntl(2, F_DUPFD_CLOEXEC, minfd)) != -1) {
@@ -177,15 +400,9 @@ static int __zipos_load(struct Zipos *zipos, size_t cf, int flags,
         h->mem = ZIP_LFILE_CONTENT(zipos->map + lf);
         break;
       case kZipCompressionDeflate:
-        if (!(h = __zipos_alloc(zipos, size)))
+      case kZipCompressionZstd:
+        if (!(h = __zipos_inflate(zipos, cf, lf, size)))
           return -1;
-        if (!__inflate(h->data, size, ZIP_LFILE_CONTENT(zipos->map + lf),
-                       GetZipLfileCompressedSize(zipos->map + lf))) {
-          h->mem = h->data;
-        } else {
-          h->mem = 0;
-          eio();
-        }
         break;
       default:
         return eio();
@@ -195,7 +412,7 @@ static int __zipos_load(struct Zipos *zipos, size_t cf, int flags,
   h->cfile = cf;
   unassert(size < SIZE_MAX);
   h->size = size;
-  if (h->mem) {
+  if (h->mem || h->stream) {
     minfd = 3;
     __fds_lock();
   TryAgain:
@@ -245,7 +462,6 @@ void __zipos_postdup(int oldfd, int newfd) {
  * Loads compressed file from αcτµαlly pδrταblε εxεcµταblε object store.
  *
  * @param uri is obtained via __zipos_parseuri()
- * @asyncsignalsafe
  */
 int __zipos_open(struct ZiposUri *name, int flags) {
 
@@ -32,6 +32,8 @@
 static ssize_t __zipos_read_impl(struct ZiposHandle *h, const struct iovec *iov,
                                  size_t iovlen, ssize_t opt_offset) {
   int i;
+  ssize_t n;
+  bool err = false;
   int64_t b, x, y, start_pos;
   if (h->cfile == ZIPOS_SYNTHETIC_DIRECTORY ||
       S_ISDIR(GetZipCfileMode(h->zipos->map + h->cfile))) {
@@ -53,13 +55,26 @@ static ssize_t __zipos_read_impl(struct ZiposHandle *h, const struct iovec *iov,
   }
   for (i = 0; i < iovlen && y < h->size; ++i, y += b) {
     b = MIN(iov[i].iov_len, h->size - y);
-    if (b)
+    if (!b)
+      continue;
+    if (h->mem) {
       memcpy(iov[i].iov_base, h->mem + y, b);
+    } else if ((n = __zipos_stream_read(h->stream, iov[i].iov_base, b, y)) !=
+               b) {
+      if (n != -1) {
+        y += n;
+      } else {
+        err = true;
+      }
+      break;
+    }
   }
   if (opt_offset == -1) {
     unassert(y != SIZE_MAX);
     atomic_store_explicit(&h->pos, y, memory_order_release);
   }
+  if (err && y == x)
+    return -1;
   return y - x;
 }
 
@@ -68,7 +83,6 @@ static ssize_t __zipos_read_impl(struct ZiposHandle *h, const struct iovec *iov,
  *
  * @return [1..size] bytes on success, 0 on EOF, or -1 w/ errno; with
  *     exception of size==0, in which case return zero means no error
- * @asyncsignalsafe
  */
 ssize_t __zipos_read(struct ZiposHandle *h, const struct iovec *iov,
                      size_t iovlen, ssize_t opt_offset) {
@@ -0,0 +1,216 @@
+/*-*- mode:c;indent-tabs-mode:nil;c-basic-offset:2;tab-width:8;coding:utf-8 -*-│
+│ vi: set et ft=c ts=2 sts=2 sw=2 fenc=utf-8                               :vi │
+╞══════════════════════════════════════════════════════════════════════════════╡
+│ Copyright 2024 Justine Alexandra Roberts Tunney                              │
+│                                                                              │
+│ Permission to use, copy, modify, and/or distribute this software for         │
+│ any purpose with or without fee is hereby granted, provided that the         │
+│ above copyright notice and this permission notice appear in all copies.      │
+│                                                                              │
+│ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL                │
+│ WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED                │
+│ WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE             │
+│ AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL         │
+│ DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR        │
+│ PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER               │
+│ TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR             │
+│ PERFORMANCE OF THIS SOFTWARE.                                                │
+╚─────────────────────────────────────────────────────────────────────────────*/
+#include "libc/intrin/weaken.h"
+#include "libc/macros.internal.h"
+#include "libc/mem/mem.h"
+#include "libc/runtime/internal.h"
+#include "libc/runtime/runtime.h"
+#include "libc/runtime/zipos.internal.h"
+#include "libc/str/str.h"
+#include "libc/sysv/errfuns.h"
+#include "libc/thread/thread.h"
+#include "third_party/zlib/zlib.h"
+
+#define SPAN   1048576  // uncompressed bytes between checkpoints
+#define WINDOW 32768    // deflate history needed to resume inflating
+#define BUFFER 262144   // uncompressed bytes kept around for reads
+
+// deflate block boundary from which inflating can be restarted
+struct ZiposPoint {
+  size_t out;    // offset in uncompressed content
+  size_t in;     // offset of first whole byte in compressed content
+  int bits;      // bits still needed from the byte before `in`
+  unsigned len;  // bytes of history in window
+  uint8_t window[WINDOW];
+};
+
+// state for reading large deflated file without inflating all of it
+struct ZiposStream {
+  pthread_mutex_t lock;
+  z_stream zs;
+  const uint8_t *in;
+  size_t insize;
+  size_t bufoff;  // offset of buf[0] in uncompressed content
+  size_t buflen;  // number of bytes in buf
+  size_t npoints;
+  struct ZiposPoint *points;
+  uint8_t buf[BUFFER];
+};
+
+/**
+ * Prepares to inflate zip file member on demand.
+ *
+ * This requires zlib and malloc() to be linked.
+ *
+ * @param in is the raw deflate compressed content
+ * @return new stream, or null if not possible
+ */
+struct ZiposStream *__zipos_stream_open(const uint8_t *in, size_t insize) {
+  struct ZiposStream *s;
+  if (!_weaken(inflateInit2) ||          //
+      !_weaken(inflateReset2) ||         //
+      !_weaken(inflatePrime) ||          //
+      !_weaken(inflateSetDictionary) ||  //
+      !_weaken(inflateGetDictionary) ||  //
+      !_weaken(inflate) ||               //
+      !_weaken(inflateEnd) ||            //
+      !_weaken(malloc) ||                //
+      !_weaken(realloc) ||               //
+      !_weaken(free) ||                  //
+      __runlevel < RUNLEVEL_MALLOC) {
+    return 0;
+  }
+  if (!(s = _weaken(malloc)(sizeof(*s))))
+    return 0;
+  bzero(&s->zs, sizeof(s->zs));
+  if (_weaken(inflateInit2)(&s->zs, -MAX_WBITS) != Z_OK) {
+    _weaken(free)(s);
+    return 0;
+  }
+  s->zs.next_in = in;
+  s->zs.avail_in = insize;
+  s->in = in;
+  s->insize = insize;
+  s->bufoff = 0;
+  s->buflen = 0;
+  s->npoints = 0;
+  s->points = 0;
+  pthread_mutex_init(&s->lock, 0);
+  return s;
+}
+
+/**
+ * Frees stream created by __zipos_stream_open().
+ */
+void __zipos_stream_close(struct ZiposStream *s) {
+  _weaken(inflateEnd)(&s->zs);
+  _weaken(free)(s->points);
+  _weaken(free)(s);
+}
+
+static void __zipos_stream_checkpoint(struct ZiposStream *s) {
+  struct ZiposPoint *p;
+  if (!(p = _weaken(realloc)(s->points, (s->npoints + 1) * sizeof(*p))))
+    return;  // checkpoints are only an optimization
+  s->points = p;
+  p += s->npoints++;
+  p->out = s->bufoff + s->buflen;
+  p->in = s->zs.next_in - s->in;
+  p->bits = s->zs.data_type & 7;
+  p->len = 0;
+  _weaken(inflateGetDictionary)(&s->zs, p->window, &p->len);
+}
+
+// returns last checkpoint at or before `off`
+static struct ZiposPoint *__zipos_stream_find(struct ZiposStream *s,
+                                              size_t off) {
+  size_t l, r, m;
+  l = 0;
+  r = s->npoints;
+  while (l < r) {
+    m = (l + r) >> 1;
+    if (s->points[m].out <= off) {
+      l = m + 1;
+    } else {
+      r = m;
+    }
+  }
+  return l ? s->points + l - 1 : 0;
+}
+
+// restarts inflating from checkpoint, or beginning if `p` is null
+static void __zipos_stream_rewind(struct ZiposStream *s,
+                                  struct ZiposPoint *p) {
+  _weaken(inflateReset2)(&s->zs, -MAX_WBITS);
+  if (p) {
+    s->zs.next_in = s->in + p->in;
+    s->zs.avail_in = s->insize - p->in;
+    if (p->bits)
+      _weaken(inflatePrime)(&s->zs, p->bits,
+                            s->in[p->in - 1] >> (8 - p->bits));
+    _weaken(inflateSetDictionary)(&s->zs, p->window, p->len);
+    s->bufoff = p->out;
+  } else {
+    s->zs.next_in = s->in;
+    s->zs.avail_in = s->insize;
+    s->bufoff = 0;
+  }
+  s->buflen = 0;
+}
+
+// inflates up to the next deflate block boundary
+static int __zipos_stream_advance(struct ZiposStream *s) {
+  int rc;
+  size_t out;
+  uint8_t *start;
+  if (s->buflen == BUFFER) {
+    s->bufoff += s->buflen;
+    s->buflen = 0;
+  }
+  start = s->buf + s->buflen;
+  s->zs.next_out = start;
+  s->zs.avail_out = BUFFER - s->buflen;
+  rc = _weaken(inflate)(&s->zs, Z_BLOCK);
+  s->buflen = s->zs.next_out - s->buf;
+  if (rc != Z_OK && (rc != Z_STREAM_END || s->zs.next_out == start))
+    return -1;
+  out = s->bufoff + s->buflen;
+  if ((s->zs.data_type & 128) && !(s->zs.data_type & 64) &&
+      out >= (s->npoints ? s->points[s->npoints - 1].out : 0) + SPAN) {
+    __zipos_stream_checkpoint(s);
+  }
+  return 0;
+}
+
+/**
+ * Reads uncompressed content from deflated zip file member.
+ *
+ * The most recently inflated bytes are kept in a buffer, so sequential
+ * reads only need to inflate each byte once. Seeking forwards inflates
+ * and discards the bytes in between. Seeking backwards restarts from a
+ * checkpoint, which is recorded every megabyte of uncompressed output.
+ *
+ * @param off is offset in uncompressed content, where `off + size`
+ *     must not exceed the uncompressed size of the file
+ * @return bytes read, or -1 w/ errno if content is corrupted
+ */
+ssize_t __zipos_stream_read(struct ZiposStream *s, void *data, size_t size,
+                            size_t off) {
+  size_t n, got;
+  struct ZiposPoint *p;
+  pthread_mutex_lock(&s->lock);
+  for (got = 0; got < size;) {
+    if (s->bufoff <= off && off < s->bufoff + s->buflen) {
+      n = MIN(size - got, s->bufoff + s->buflen - off);
+      memcpy((char *)data + got, s->buf + (off - s->bufoff), n);
+      got += n;
+      off += n;
+      continue;
+    }
+    p = __zipos_stream_find(s, off);
+    if (off < s->bufoff || (p && p->out > s->bufoff + s->buflen))
+      __zipos_stream_rewind(s, p);
+    if (__zipos_stream_advance(s) == -1)
+      break;
+  }
+  pthread_mutex_unlock(&s->lock);
+  if (got < size && !got)
+    return eio();
+  return got;
+}
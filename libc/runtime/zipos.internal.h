@@ -1,28 +1,60 @@
 #ifndef COSMOPOLITAN_LIBC_ZIPOS_ZIPOS_H_
 #define COSMOPOLITAN_LIBC_ZIPOS_ZIPOS_H_
+#include "libc/intrin/dll.h"
 COSMOPOLITAN_C_START_
 
 #define ZIPOS_PATH_MAX 1024
 
 #define ZIPOS_SYNTHETIC_DIRECTORY 0
 
+/*
+ * zipcopy and apelink append a `.zipos` file to the zip, whose central
+ * directory record comes last, so programs don't have to sort 100,000+
+ * file names each time they start. its content is the following array
+ * of little endian 32-bit words:
+ *
+ *   - ZIPOS_INDEX_MAGIC
+ *   - number of records in central directory, including this one
+ *   - size of central directory in bytes
+ *   - number of hash table slots minus one
+ *   - distance from first local file to the central directory
+ *   - distance from end of last local file to the central directory
+ *   - two reserved words which must be zero
+ *   - central directory offsets of records sorted by file name
+ *   - hash table of central directory offsets plus one, or zero if empty
+ *
+ * offsets are relative to the start of the central directory, so tools
+ * may move the zip around without changing it.
+ */
+#define ZIPOS_INDEX_NAME    ".zipos"
+#define ZIPOS_INDEX_MAGIC   0x5844495a /* "ZIDX" */
+#define ZIPOS_INDEX_HDRSIZE 32
+#define ZIPOS_HASH_INIT     2166136261u
+
 struct stat;
 struct iovec;
 struct Zipos;
+struct ZiposStream;
 
 struct ZiposUri {
   uint32_t len;
   char path[ZIPOS_PATH_MAX];
 };
 
+#define ZIPOS_HANDLE_CONTAINER(e) DLL_CONTAINER(struct ZiposHandle, elem, e)
+
 struct ZiposHandle {
   struct ZiposHandle *next;
+  struct ZiposHandle *base;   /* shared inflated content, if any */
   struct Zipos *zipos;
   size_t size;
   size_t mapsize;
   size_t cfile;
   _Atomic(size_t) refs;
   _Atomic(size_t) pos;
+  _Atomic(int) state;         /* for inflate cache entries */
+  struct Dll elem;            /* for inflate cache entries */
+  struct ZiposStream *stream; /* for members inflated on demand */
   uint8_t *mem;
   uint8_t data[];
 };
@@ -32,11 +64,30 @@ struct Zipos {
   uint8_t *map;
   uint8_t *cdir;
   uint64_t dev;
-  size_t *index;
+  size_t cdiroff;
   size_t records;
+  uint32_t hashmask;
+  const uint8_t *index; /* sorted cdir offsets */
+  const uint8_t *table; /* hash table of cdir offsets plus one */
   struct ZiposHandle *freelist;
 };
 
+/* fnv-1a hash of file name, for ZIPOS_INDEX_NAME hash table */
+forceinline uint32_t __zipos_hash(uint32_t h, const void *p, size_t n) {
+  size_t i;
+  for (i = 0; i < n; ++i) {
+    h ^= ((const unsigned char *)p)[i];
+    h *= 16777619;
+  }
+  return h;
+}
+
+size_t __zipos_index_size(size_t);
+size_t __zipos_index_slots(size_t);
+bool __zipos_is_index(const uint8_t *);
+bool __zipos_load_index(struct Zipos *, uint64_t *, uint64_t *);
+void __zipos_index_build(uint8_t *, const uint8_t *, size_t, size_t, uint32_t,
+                         uint32_t);
 int __zipos_close(int);
 void __zipos_drop(struct ZiposHandle *);
 struct ZiposHandle *__zipos_keep(struct ZiposHandle *);
@@ -57,6 +108,9 @@ ssize_t __zipos_read(struct ZiposHandle *, const struct iovec *, size_t,
 int64_t __zipos_seek(struct ZiposHandle *, int64_t, unsigned);
 int __zipos_fcntl(int, int, uintptr_t);
 int __zipos_notat(int, const char *);
+struct ZiposStream *__zipos_stream_open(const uint8_t *, size_t);
+ssize_t __zipos_stream_read(struct ZiposStream *, void *, size_t, size_t);
+void __zipos_stream_close(struct ZiposStream *);
 void *__zipos_mmap(void *, uint64_t, int32_t, int32_t, struct ZiposHandle *,
                    int64_t);
 
@@ -42,6 +42,7 @@ LIBC_SOCK_A_DIRECTDEPS =			\
 	LIBC_STR  				\
 	LIBC_SYSV				\
 	LIBC_SYSV_CALLS				\
+	LIBC_THREAD				\
 	THIRD_PARTY_TZ
 
 LIBC_SOCK_A_DEPS :=				\
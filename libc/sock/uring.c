@@ -0,0 +1,377 @@
+/*-*- mode:c;indent-tabs-mode:nil;c-basic-offset:2;tab-width:8;coding:utf-8 -*-│
+│ vi: set et ft=c ts=2 sts=2 sw=2 fenc=utf-8                               :vi │
+╞══════════════════════════════════════════════════════════════════════════════╡
+│ Copyright 2024 Justine Alexandra Roberts Tunney                              │
+│                                                                              │
+│ Permission to use, copy, modify, and/or distribute this software for         │
+│ any purpose with or without fee is hereby granted, provided that the         │
+│ above copyright notice and this permission notice appear in all copies.      │
+│                                                                              │
+│ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL                │
+│ WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED                │
+│ WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE             │
+│ AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL         │
+│ DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR        │
+│ PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER               │
+│ TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR             │
+│ PERFORMANCE OF THIS SOFTWARE.                                                │
+╚─────────────────────────────────────────────────────────────────────────────*/
+#include "libc/calls/calls.h"
+#include "libc/calls/internal.h"
+#include "libc/dce.h"
+#include "libc/errno.h"
+#include "libc/intrin/atomic.h"
+#include "libc/intrin/weaken.h"
+#include "libc/macros.internal.h"
+#include "libc/mem/mem.h"
+#include "libc/runtime/runtime.h"
+#include "libc/runtime/zipos.internal.h"
+#include "libc/sock/uring.internal.h"
+#include "libc/str/str.h"
+#include "libc/sysv/consts/map.h"
+#include "libc/sysv/consts/prot.h"
+#include "libc/sysv/errfuns.h"
+
+/**
+ * @fileoverview batched asynchronous i/o
+ *
+ * On Linux 5.7+ operations are submitted to the kernel using io_uring
+ * so that any number of them cost a single system call. Elsewhere, or
+ * if io_uring is unavailable or disabled, they're run by a thread pool
+ * instead, which has the same semantics but none of the speed.
+ */
+
+static const unsigned char kRingOps[] = {
+    IORING_OP_READV,   IORING_OP_WRITEV,     IORING_OP_FSYNC,
+    IORING_OP_ACCEPT,  IORING_OP_READ_FIXED, IORING_OP_WRITE_FIXED,
+    IORING_OP_CONNECT, IORING_OP_OPENAT,     IORING_OP_CLOSE,
+    IORING_OP_READ,    IORING_OP_WRITE,      IORING_OP_SEND,
+    IORING_OP_RECV,    IORING_OP_SPLICE,
+};
+
+static bool __ring_probe(int fd) {
+  int i;
+  struct io_uring_probe p;
+  bzero(&p, sizeof(p));
+  if (sys_io_uring_register(fd, IORING_REGISTER_PROBE, &p, ARRAYLEN(p.ops)))
+    return false;
+  for (i = 0; i < ARRAYLEN(kRingOps); ++i)
+    if (kRingOps[i] > p.last_op ||
+        !(p.ops[kRingOps[i]].flags & IO_URING_OP_SUPPORTED))
+      return false;
+  return true;
+}
+
+static void __ring_unmap(struct cosmo_ring *r) {
+  if (r->sqes)
+    munmap(r->sqes, r->sqessize);
+  if (r->cqring && r->cqring != r->sqring)
+    munmap(r->cqring, r->cqringsize);
+  if (r->sqring)
+    munmap(r->sqring, r->sqringsize);
+}
+
+static int __ring_setup(struct cosmo_ring *r, unsigned entries) {
+  int fd;
+  unsigned i;
+  char *sq, *cq;
+  struct io_uring_params p;
+  bzero(&p, sizeof(p));
+  if ((fd = sys_io_uring_setup(entries, &p)) == -1)
+    return -1;
+  if (!(p.features & IORING_FEAT_NODROP) || !__ring_probe(fd)) {
+    close(fd);
+    return -1;
+  }
+  r->sqringsize = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+  r->cqringsize = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+  if (p.features & IORING_FEAT_SINGLE_MMAP)
+    r->sqringsize = r->cqringsize = MAX(r->sqringsize, r->cqringsize);
+  r->sqessize = p.sq_entries * sizeof(struct io_uring_sqe);
+  if ((sq = mmap(0, r->sqringsize, PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+                 IORING_OFF_SQ_RING)) == MAP_FAILED)
+    goto Failure;
+  r->sqring = sq;
+  if (p.features & IORING_FEAT_SINGLE_MMAP) {
+    cq = sq;
+  } else if ((cq = mmap(0, r->cqringsize, PROT_READ | PROT_WRITE, MAP_SHARED,
+                        fd, IORING_OFF_CQ_RING)) == MAP_FAILED) {
+    goto Failure;
+  }
+  r->cqring = cq;
+  if ((r->sqes = mmap(0, r->sqessize, PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+                      IORING_OFF_SQES)) == MAP_FAILED) {
+    r->sqes = 0;
+    goto Failure;
+  }
+  r->fd = fd;
+  r->entries = p.sq_entries;
+  r->mask = *(unsigned *)(sq + p.sq_off.ring_mask);
+  r->ksqhead = (_Atomic(unsigned) *)(sq + p.sq_off.head);
+  r->ksqtail = (_Atomic(unsigned) *)(sq + p.sq_off.tail);
+  r->kcqhead = (_Atomic(unsigned) *)(cq + p.cq_off.head);
+  r->kcqtail = (_Atomic(unsigned) *)(cq + p.cq_off.tail);
+  r->kcqmask = *(unsigned *)(cq + p.cq_off.ring_mask);
+  r->kcqes = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+  r->sqtail = r->sqhead = *r->ksqtail;
+  // we always fill the sqe slot with the same index as the ring
+  for (i = 0; i < p.sq_entries; ++i)
+    ((unsigned *)(sq + p.sq_off.array))[i] = i;
+  return 0;
+Failure:
+  __ring_unmap(r);
+  r->sqring = r->cqring = 0;
+  close(fd);
+  return -1;
+}
+
+/**
+ * Creates ring for batched asynchronous i/o.
+ *
+ * @param entries is how many operations may be queued before submitting
+ *     which is rounded up to a two power
+ * @param flags may have `COSMO_RING_EMULATE` to force use of thread pool
+ * @return new ring, or null w/ errno
+ * @raise EINVAL if `entries` is zero or exceeds 4096
+ * @raise ENOMEM if out of memory
+ */
+struct cosmo_ring *cosmo_ring_create(unsigned entries, int flags) {
+  int e;
+  struct cosmo_ring *r;
+  if (!entries || entries > 4096)
+    return (void *)einval();
+  if (!(r = calloc(1, sizeof(*r))))
+    return 0;
+  r->fd = -1;
+  pthread_mutex_init(&r->reglock, 0);
+  e = errno;
+  if (IsLinux() && !(flags & COSMO_RING_EMULATE) &&
+      __ring_setup(r, entries) != -1)
+    return r;
+  errno = e;
+  for (r->entries = 1; r->entries < entries; r->entries <<= 1) {
+  }
+  r->mask = r->entries - 1;
+  if ((r->sqes = calloc(r->entries, sizeof(*r->sqes))) &&
+      __ring_emu_init(r) != -1)
+    return r;
+  free(r->sqes);
+  pthread_mutex_destroy(&r->reglock);
+  free(r);
+  return 0;
+}
+
+/**
+ * Destroys ring.
+ *
+ * Operations that are still in flight get canceled.
+ */
+void cosmo_ring_destroy(struct cosmo_ring *r) {
+  if (!r)
+    return;
+  if (r->fd != -1) {
+    __ring_unmap(r);
+    close(r->fd);
+  } else {
+    __ring_emu_destroy(r);
+    free(r->sqes);
+  }
+  pthread_mutex_destroy(&r->reglock);
+  free(r->local);
+  free(r->files);
+  free(r->bufs);
+  free(r);
+}
+
+/**
+ * Returns true if ring is being emulated with threads.
+ */
+bool32 cosmo_ring_emulated(const struct cosmo_ring *r) {
+  return r->fd == -1;
+}
+
+/**
+ * Registers buffers for cosmo_ring_read_fixed(), etc.
+ *
+ * The kernel pins these pages in memory, which saves it the trouble of
+ * doing that on each operation. This may only be called once per ring.
+ *
+ * @return 0 on success, or -1 w/ errno
+ * @raise EBUSY if buffers were already registered
+ * @raise ENOMEM if `RLIMIT_MEMLOCK` was exceeded
+ */
+int cosmo_ring_register_buffers(struct cosmo_ring *r, const struct iovec *iov,
+                                unsigned n) {
+  int rc;
+  struct iovec *p;
+  if (!n)
+    return einval();
+  if (!(p = malloc(n * sizeof(*iov))))
+    return -1;
+  memcpy(p, iov, n * sizeof(*iov));
+  pthread_mutex_lock(&r->reglock);
+  if (r->bufs) {
+    rc = ebusy();
+  } else if (r->fd != -1 &&
+             sys_io_uring_register(r->fd, IORING_REGISTER_BUFFERS, iov, n)) {
+    rc = -1;
+  } else {
+    r->bufs = p;
+    r->nbufs = n;
+    p = 0;
+    rc = 0;
+  }
+  pthread_mutex_unlock(&r->reglock);
+  free(p);
+  return rc;
+}
+
+/**
+ * Registers file descriptors for use with `COSMO_RING_FIXED_FILE`.
+ *
+ * This saves the kernel from having to look up the file each time. It
+ * may only be called once per ring.
+ *
+ * @return 0 on success, or -1 w/ errno
+ * @raise EBUSY if files were already registered
+ * @raise EBADF if one of `fds` isn't open
+ */
+int cosmo_ring_register_files(struct cosmo_ring *r, const int *fds,
+                              unsigned n) {
+  int rc;
+  int *p;
+  if (!n)
+    return einval();
+  if (!(p = malloc(n * sizeof(*fds))))
+    return -1;
+  memcpy(p, fds, n * sizeof(*fds));
+  pthread_mutex_lock(&r->reglock);
+  if (r->files) {
+    rc = ebusy();
+  } else if (r->fd != -1 &&
+             sys_io_uring_register(r->fd, IORING_REGISTER_FILES, fds, n)) {
+    rc = -1;
+  } else {
+    r->files = p;
+    r->nfiles = n;
+    p = 0;
+    rc = 0;
+  }
+  pthread_mutex_unlock(&r->reglock);
+  free(p);
+  return rc;
+}
+
+static bool __ring_iszip(const struct io_uring_sqe *e) {
+  struct ZiposUri uri;
+  if (e->opcode == IORING_OP_OPENAT)
+    return _weaken(__zipos_parseuri) &&
+           _weaken(__zipos_parseuri)((const char *)e->addr, &uri) != -1;
+  if (e->opcode == IORING_OP_SPLICE && __isfdkind(e->splice_fd_in, kFdZip))
+    return true;
+  return !(e->flags & IOSQE_FIXED_FILE) && __isfdkind(e->fd, kFdZip);
+}
+
+// the kernel doesn't know about files in our zip executable, so we run
+// those operations ourself, and turn the sqe into a nop that's ignored
+static void __ring_zip(struct cosmo_ring *r, struct io_uring_sqe *e) {
+  unsigned cap;
+  struct cosmo_ring_cqe *p;
+  if (!__ring_iszip(e))
+    return;
+  if (r->nlocal == r->caplocal) {
+    cap = MAX(r->caplocal * 2, 8);
+    if (!(p = realloc(r->local, cap * sizeof(*p))))
+      return;  // kernel will say EBADF
+    r->local = p;
+    r->caplocal = cap;
+  }
+  p = r->local + r->nlocal++;
+  p->data = e->user_data;
+  p->res = __ring_execute(r, e);
+  p->flags = 0;
+  e->opcode = IORING_OP_NOP;
+  e->user_data = COSMO_RING_IGNORE;
+}
+
+static int __ring_enter(struct cosmo_ring *r, unsigned wait) {
+  unsigned n;
+  for (; r->sqhead != r->sqtail; ++r->sqhead)
+    __ring_zip(r, r->sqes + (r->sqhead & r->mask));
+  atomic_store_explicit(r->ksqtail, r->sqtail, memory_order_release);
+  n = r->sqtail - atomic_load_explicit(r->ksqhead, memory_order_acquire);
+  if (!n && !wait)
+    return 0;
+  return sys_io_uring_enter(r->fd, n, wait, wait ? IORING_ENTER_GETEVENTS : 0,
+                            0, 0);
+}
+
+static int __ring_reap(struct cosmo_ring *r, struct cosmo_ring_cqe *cqes,
+                       int max) {
+  int n, k;
+  unsigned head, tail;
+  struct io_uring_cqe *c;
+  n = MIN(r->nlocal, max);
+  if (n) {
+    memcpy(cqes, r->local, n * sizeof(*cqes));
+    memmove(r->local, r->local + n, (r->nlocal -= n) * sizeof(*cqes));
+  }
+  head = atomic_load_explicit(r->kcqhead, memory_order_relaxed);
+  tail = atomic_load_explicit(r->kcqtail, memory_order_acquire);
+  for (k = n; k < max && head != tail; ++head) {
+    c = r->kcqes + (head & r->kcqmask);
+    if (c->user_data != COSMO_RING_IGNORE) {
+      cqes[k].data = c->user_data;
+      cqes[k].res = c->res;
+      cqes[k].flags = c->flags;
+      ++k;
+    }
+  }
+  atomic_store_explicit(r->kcqhead, head, memory_order_release);
+  return k;
+}
+
+/**
+ * Submits queued operations.
+ *
+ * @return number of operations submitted, or -1 w/ errno
+ * @raise EBUSY if completion ring is full and must be drained
+ * @raise EINTR if a signal was delivered
+ */
+int cosmo_ring_submit(struct cosmo_ring *r) {
+  if (r->fd == -1)
+    return __ring_emu_submit(r);
+  return __ring_enter(r, 0);
+}
+
+/**
+ * Submits queued operations and waits for completions.
+ *
+ * This should be called from one thread at a time.
+ *
+ * @param cqes receives completions
+ * @param max is the number of elements in `cqes`
+ * @param min is how many completions to wait for, or 0 to poll
+ * @return number of completions in `cqes`, or -1 w/ errno
+ * @raise EINTR if a signal was delivered before anything completed
+ */
+int cosmo_ring_wait(struct cosmo_ring *r, struct cosmo_ring_cqe *cqes, int max,
+                    int min) {
+  int n, need;
+  if (max < 0 || min < 0)
+    return einval();
+  min = MIN(min, max);
+  if (r->fd == -1)
+    return __ring_emu_wait(r, cqes, max, min);
+  for (n = 0;;) {
+    n += __ring_reap(r, cqes + n, max - n);
+    need = n < min ? min - n : 0;
+    if (!need && r->sqhead == r->sqtail &&
+        *r->ksqtail == atomic_load_explicit(r->ksqhead, memory_order_acquire))
+      return n;
+    if (__ring_enter(r, need) == -1)
+      return n ? n : -1;
+    if (!need)
+      return n + __ring_reap(r, cqes + n, max - n);
+  }
+}
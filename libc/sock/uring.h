@@ -0,0 +1,75 @@
+#ifndef COSMOPOLITAN_LIBC_SOCK_URING_H_
+#define COSMOPOLITAN_LIBC_SOCK_URING_H_
+
+#define COSMO_RING_EMULATE 1 /* use thread pool even if kernel has io_uring */
+
+#define COSMO_RING_FIXED_FILE 1 /* fd is index into cosmo_ring_register_files */
+#define COSMO_RING_DRAIN      2 /* wait for all earlier ops to complete */
+#define COSMO_RING_LINK       4 /* next op runs once this one succeeds */
+
+#define COSMO_RING_FSYNC_DATASYNC 1
+
+COSMOPOLITAN_C_START_
+
+struct iovec;
+struct sockaddr;
+struct cosmo_ring;
+struct cosmo_ring_sqe;
+
+struct cosmo_ring_cqe {
+  uint64_t data; /* user data passed when operation was queued */
+  int32_t res;   /* result of system call, or negative errno */
+  uint32_t flags;
+};
+
+struct cosmo_ring *cosmo_ring_create(unsigned, int) libcesque;
+void cosmo_ring_destroy(struct cosmo_ring *) libcesque;
+bool32 cosmo_ring_emulated(const struct cosmo_ring *) libcesque;
+int cosmo_ring_register_buffers(struct cosmo_ring *, const struct iovec *,
+                                unsigned) libcesque;
+int cosmo_ring_register_files(struct cosmo_ring *, const int *,
+                              unsigned) libcesque;
+int cosmo_ring_submit(struct cosmo_ring *) libcesque;
+int cosmo_ring_wait(struct cosmo_ring *, struct cosmo_ring_cqe *, int,
+                    int) libcesque;
+
+void cosmo_ring_sqe_flags(struct cosmo_ring_sqe *, unsigned) libcesque;
+struct cosmo_ring_sqe *cosmo_ring_nop(struct cosmo_ring *, uint64_t) libcesque;
+struct cosmo_ring_sqe *cosmo_ring_read(struct cosmo_ring *, int, void *, size_t,
+                                       int64_t, uint64_t) libcesque;
+struct cosmo_ring_sqe *cosmo_ring_write(struct cosmo_ring *, int, const void *,
+                                        size_t, int64_t, uint64_t) libcesque;
+struct cosmo_ring_sqe *cosmo_ring_readv(struct cosmo_ring *, int,
+                                        const struct iovec *, int, int64_t,
+                                        uint64_t) libcesque;
+struct cosmo_ring_sqe *cosmo_ring_writev(struct cosmo_ring *, int,
+                                         const struct iovec *, int, int64_t,
+                                         uint64_t) libcesque;
+struct cosmo_ring_sqe *cosmo_ring_read_fixed(struct cosmo_ring *, int, void *,
+                                             size_t, int64_t, int,
+                                             uint64_t) libcesque;
+struct cosmo_ring_sqe *cosmo_ring_write_fixed(struct cosmo_ring *, int,
+                                              const void *, size_t, int64_t,
+                                              int, uint64_t) libcesque;
+struct cosmo_ring_sqe *cosmo_ring_accept(struct cosmo_ring *, int,
+                                         struct sockaddr *, uint32_t *, int,
+                                         uint64_t) libcesque;
+struct cosmo_ring_sqe *cosmo_ring_connect(struct cosmo_ring *, int,
+                                          const struct sockaddr *, uint32_t,
+                                          uint64_t) libcesque;
+struct cosmo_ring_sqe *cosmo_ring_send(struct cosmo_ring *, int, const void *,
+                                       size_t, int, uint64_t) libcesque;
+struct cosmo_ring_sqe *cosmo_ring_recv(struct cosmo_ring *, int, void *, size_t,
+                                       int, uint64_t) libcesque;
+struct cosmo_ring_sqe *cosmo_ring_openat(struct cosmo_ring *, int, const char *,
+                                         int, unsigned, uint64_t) libcesque;
+struct cosmo_ring_sqe *cosmo_ring_close(struct cosmo_ring *, int,
+                                        uint64_t) libcesque;
+struct cosmo_ring_sqe *cosmo_ring_fsync(struct cosmo_ring *, int, unsigned,
+                                        uint64_t) libcesque;
+struct cosmo_ring_sqe *cosmo_ring_splice(struct cosmo_ring *, int, int64_t, int,
+                                         int64_t, size_t, unsigned,
+                                         uint64_t) libcesque;
+
+COSMOPOLITAN_C_END_
+#endif /* COSMOPOLITAN_LIBC_SOCK_URING_H_ */
@@ -0,0 +1,182 @@
+#ifndef COSMOPOLITAN_LIBC_SOCK_URING_INTERNAL_H_
+#define COSMOPOLITAN_LIBC_SOCK_URING_INTERNAL_H_
+#include "libc/atomic.h"
+#include "libc/calls/struct/iovec.h"
+#include "libc/sock/uring.h"
+#include "libc/thread/thread.h"
+COSMOPOLITAN_C_START_
+
+#define COSMO_RING_IGNORE       0xffffffffffffffffull
+
+#define IORING_OP_NOP           0
+#define IORING_OP_READV         1
+#define IORING_OP_WRITEV        2
+#define IORING_OP_FSYNC         3
+#define IORING_OP_READ_FIXED    4
+#define IORING_OP_WRITE_FIXED   5
+#define IORING_OP_ACCEPT        13
+#define IORING_OP_CONNECT       16
+#define IORING_OP_OPENAT        18
+#define IORING_OP_CLOSE         19
+#define IORING_OP_READ          22
+#define IORING_OP_WRITE         23
+#define IORING_OP_SEND          26
+#define IORING_OP_RECV          27
+#define IORING_OP_SPLICE        30
+
+#define IOSQE_FIXED_FILE        1
+#define IOSQE_IO_DRAIN          2
+#define IOSQE_IO_LINK           4
+#define SPLICE_F_FD_IN_FIXED    0x80000000u
+#define IORING_ENTER_GETEVENTS  1
+#define IORING_FEAT_SINGLE_MMAP 1
+#define IORING_FEAT_NODROP      2
+#define IORING_OFF_SQ_RING      0
+#define IORING_OFF_CQ_RING      0x8000000
+#define IORING_OFF_SQES         0x10000000
+#define IORING_REGISTER_BUFFERS 0
+#define IORING_REGISTER_FILES   2
+#define IORING_REGISTER_PROBE   8
+#define IO_URING_OP_SUPPORTED   1
+
+struct io_uring_sqe {
+  uint8_t opcode;
+  uint8_t flags;
+  uint16_t ioprio;
+  int32_t fd;
+  uint64_t off;  // or addr2
+  uint64_t addr;  // or splice_off_in
+  uint32_t len;
+  uint32_t op_flags;  // rw, fsync, msg, accept, open, or splice flags
+  uint64_t user_data;
+  uint16_t buf_index;
+  uint16_t personality;
+  int32_t splice_fd_in;
+  uint64_t __pad2[2];
+};
+
+struct io_uring_cqe {
+  uint64_t user_data;
+  int32_t res;
+  uint32_t flags;
+};
+
+struct io_sqring_offsets {
+  uint32_t head;
+  uint32_t tail;
+  uint32_t ring_mask;
+  uint32_t ring_entries;
+  uint32_t flags;
+  uint32_t dropped;
+  uint32_t array;
+  uint32_t resv1;
+  uint64_t resv2;
+};
+
+struct io_cqring_offsets {
+  uint32_t head;
+  uint32_t tail;
+  uint32_t ring_mask;
+  uint32_t ring_entries;
+  uint32_t overflow;
+  uint32_t cqes;
+  uint32_t flags;
+  uint32_t resv1;
+  uint64_t resv2;
+};
+
+struct io_uring_params {
+  uint32_t sq_entries;
+  uint32_t cq_entries;
+  uint32_t flags;
+  uint32_t sq_thread_cpu;
+  uint32_t sq_thread_idle;
+  uint32_t features;
+  uint32_t wq_fd;
+  uint32_t resv[3];
+  struct io_sqring_offsets sq_off;
+  struct io_cqring_offsets cq_off;
+};
+
+struct io_uring_probe_op {
+  uint8_t op;
+  uint8_t resv;
+  uint16_t flags;
+  uint32_t resv2;
+};
+
+struct io_uring_probe {
+  uint8_t last_op;
+  uint8_t ops_len;
+  uint16_t resv;
+  uint32_t resv2[3];
+  struct io_uring_probe_op ops[64];
+};
+
+struct RingJob {
+  struct RingJob *next;
+  unsigned n;
+  struct io_uring_sqe sqes[];
+};
+
+struct RingEmu {
+  pthread_mutex_t lock;
+  pthread_cond_t work;  // signaled when jobs are queued
+  pthread_cond_t done;  // signaled when completions are posted
+  atomic_bool stop;
+  bool draining;
+  int threads;
+  int idle;
+  int queued;
+  int running;
+  struct RingJob *head;
+  struct RingJob *tail;
+  struct cosmo_ring_cqe *cq;
+  unsigned cqcap;
+  unsigned cqhead;
+  unsigned cqlen;
+  pthread_t th[64];
+};
+
+struct cosmo_ring {
+  int fd;  // -1 if emulated
+  unsigned entries;
+  unsigned mask;
+  unsigned sqtail;  // prepared but not necessarily submitted
+  unsigned sqhead;  // submitted
+  struct io_uring_sqe *sqes;
+  _Atomic(unsigned) *ksqhead;
+  _Atomic(unsigned) *ksqtail;
+  _Atomic(unsigned) *kcqhead;
+  _Atomic(unsigned) *kcqtail;
+  unsigned kcqmask;
+  struct io_uring_cqe *kcqes;
+  void *sqring;
+  size_t sqringsize;
+  void *cqring;
+  size_t cqringsize;
+  size_t sqessize;
+  struct cosmo_ring_cqe *local;  // ops we had to run ourselves
+  unsigned nlocal;
+  unsigned caplocal;
+  pthread_mutex_t reglock;
+  int *files;
+  unsigned nfiles;
+  struct iovec *bufs;
+  unsigned nbufs;
+  struct RingEmu *emu;
+};
+
+int sys_io_uring_setup(uint32_t, struct io_uring_params *);
+int sys_io_uring_enter(int, uint32_t, uint32_t, uint32_t, const void *,
+                       size_t);
+int sys_io_uring_register(int, uint32_t, const void *, uint32_t);
+
+int32_t __ring_execute(struct cosmo_ring *, const struct io_uring_sqe *);
+int __ring_emu_init(struct cosmo_ring *);
+void __ring_emu_destroy(struct cosmo_ring *);
+int __ring_emu_submit(struct cosmo_ring *);
+int __ring_emu_wait(struct cosmo_ring *, struct cosmo_ring_cqe *, int, int);
+
+COSMOPOLITAN_C_END_
+#endif /* COSMOPOLITAN_LIBC_SOCK_URING_INTERNAL_H_ */
@@ -0,0 +1,341 @@
+/*-*- mode:c;indent-tabs-mode:nil;c-basic-offset:2;tab-width:8;coding:utf-8 -*-│
+│ vi: set et ft=c ts=2 sts=2 sw=2 fenc=utf-8                               :vi │
+╞══════════════════════════════════════════════════════════════════════════════╡
+│ Copyright 2024 Justine Alexandra Roberts Tunney                              │
+│                                                                              │
+│ Permission to use, copy, modify, and/or distribute this software for         │
+│ any purpose with or without fee is hereby granted, provided that the         │
+│ above copyright notice and this permission notice appear in all copies.      │
+│                                                                              │
+│ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL                │
+│ WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED                │
+│ WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE             │
+│ AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL         │
+│ DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR        │
+│ PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER               │
+│ TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR             │
+│ PERFORMANCE OF THIS SOFTWARE.                                                │
+╚─────────────────────────────────────────────────────────────────────────────*/
+#include "libc/calls/calls.h"
+#include "libc/calls/struct/iovec.h"
+#include "libc/errno.h"
+#include "libc/intrin/atomic.h"
+#include "libc/macros.internal.h"
+#include "libc/mem/mem.h"
+#include "libc/sock/sock.h"
+#include "libc/sock/struct/sockaddr.h"
+#include "libc/sock/uring.internal.h"
+#include "libc/str/str.h"
+#include "libc/sysv/errfuns.h"
+
+/**
+ * @fileoverview io_uring emulation for systems that don't have it
+ *
+ * Submitted operations are handed off to a pool of threads that grows
+ * on demand, since any of them might block indefinitely, e.g. accept().
+ * Linked operations are kept together as one job so they run in order
+ * on the same thread.
+ */
+
+static int __ring_file(struct cosmo_ring *r, int fd, bool fixed) {
+  if (!fixed)
+    return fd;
+  pthread_mutex_lock(&r->reglock);
+  fd = (unsigned)fd < r->nfiles ? r->files[fd] : -1;
+  pthread_mutex_unlock(&r->reglock);
+  return fd;
+}
+
+static bool __ring_buffer(struct cosmo_ring *r, unsigned i, uint64_t addr,
+                          uint32_t len) {
+  bool ok;
+  uintptr_t base;
+  pthread_mutex_lock(&r->reglock);
+  if ((ok = i < r->nbufs)) {
+    base = (uintptr_t)r->bufs[i].iov_base;
+    ok = addr >= base && addr - base <= r->bufs[i].iov_len &&
+         len <= r->bufs[i].iov_len - (addr - base);
+  }
+  pthread_mutex_unlock(&r->reglock);
+  return ok;
+}
+
+/**
+ * Performs operation synchronously.
+ *
+ * @return result of system call or negative errno
+ */
+int32_t __ring_execute(struct cosmo_ring *r, const struct io_uring_sqe *e) {
+  long rc;
+  int fd, infd, olderr;
+  int64_t inoff, outoff;
+  olderr = errno;
+  fd = __ring_file(r, e->fd, e->flags & IOSQE_FIXED_FILE);
+  switch (e->opcode) {
+    case IORING_OP_NOP:
+      rc = 0;
+      break;
+    case IORING_OP_READ_FIXED:
+    case IORING_OP_WRITE_FIXED:
+      if (!__ring_buffer(r, e->buf_index, e->addr, e->len)) {
+        rc = efault();
+        break;
+      }
+      // fallthrough
+    case IORING_OP_READ:
+    case IORING_OP_WRITE:
+      if (e->opcode == IORING_OP_READ || e->opcode == IORING_OP_READ_FIXED) {
+        if (e->off == -1)
+          rc = read(fd, (void *)e->addr, e->len);
+        else
+          rc = pread(fd, (void *)e->addr, e->len, e->off);
+      } else {
+        if (e->off == -1)
+          rc = write(fd, (void *)e->addr, e->len);
+        else
+          rc = pwrite(fd, (void *)e->addr, e->len, e->off);
+      }
+      break;
+    case IORING_OP_READV:
+      if (e->off == -1)
+        rc = readv(fd, (struct iovec *)e->addr, e->len);
+      else
+        rc = preadv(fd, (struct iovec *)e->addr, e->len, e->off);
+      break;
+    case IORING_OP_WRITEV:
+      if (e->off == -1)
+        rc = writev(fd, (struct iovec *)e->addr, e->len);
+      else
+        rc = pwritev(fd, (struct iovec *)e->addr, e->len, e->off);
+      break;
+    case IORING_OP_FSYNC:
+      if (e->op_flags & COSMO_RING_FSYNC_DATASYNC)
+        rc = fdatasync(fd);
+      else
+        rc = fsync(fd);
+      break;
+    case IORING_OP_ACCEPT:
+      rc = accept4(fd, (struct sockaddr *)e->addr, (uint32_t *)e->off,
+                   e->op_flags);
+      break;
+    case IORING_OP_CONNECT:
+      rc = connect(fd, (struct sockaddr *)e->addr, e->off);
+      break;
+    case IORING_OP_SEND:
+      rc = send(fd, (void *)e->addr, e->len, e->op_flags);
+      break;
+    case IORING_OP_RECV:
+      rc = recv(fd, (void *)e->addr, e->len, e->op_flags);
+      break;
+    case IORING_OP_OPENAT:
+      rc = openat(fd, (char *)e->addr, e->op_flags, e->len);
+      break;
+    case IORING_OP_CLOSE:
+      if (e->flags & IOSQE_FIXED_FILE) {
+        rc = ebadf();
+      } else {
+        rc = close(fd);
+      }
+      break;
+    case IORING_OP_SPLICE:
+      infd = __ring_file(r, e->splice_fd_in, e->op_flags & SPLICE_F_FD_IN_FIXED);
+      inoff = e->addr;
+      outoff = e->off;
+      rc = splice(infd, inoff == -1 ? 0 : &inoff, fd, outoff == -1 ? 0 : &outoff,
+                  e->len, e->op_flags & ~SPLICE_F_FD_IN_FIXED);
+      break;
+    default:
+      rc = einval();
+      break;
+  }
+  if (rc == -1)
+    rc = -errno;
+  errno = olderr;
+  return rc;
+}
+
+static void __ring_post(struct RingEmu *e, uint64_t data, int32_t res) {
+  unsigned i, cap;
+  struct cosmo_ring_cqe *cq;
+  if (e->cqlen == e->cqcap) {
+    cap = e->cqcap * 2;
+    if (!(cq = malloc(cap * sizeof(*cq))))
+      return;  // overflow
+    for (i = 0; i < e->cqlen; ++i)
+      cq[i] = e->cq[(e->cqhead + i) % e->cqcap];
+    free(e->cq);
+    e->cq = cq;
+    e->cqcap = cap;
+    e->cqhead = 0;
+  }
+  cq = e->cq + (e->cqhead + e->cqlen++) % e->cqcap;
+  cq->data = data;
+  cq->res = res;
+  cq->flags = 0;
+  pthread_cond_broadcast(&e->done);
+}
+
+static struct RingJob *__ring_take(struct RingEmu *e) {
+  struct RingJob *j;
+  if (!(j = e->head) || e->draining)
+    return 0;
+  if (j->sqes[0].flags & IOSQE_IO_DRAIN) {
+    if (e->running)
+      return 0;
+    e->draining = true;
+  }
+  if (!(e->head = j->next))
+    e->tail = 0;
+  --e->queued;
+  ++e->running;
+  return j;
+}
+
+// runs chain of linked operations, returning with lock held
+static void __ring_run(struct cosmo_ring *r, struct RingJob *j) {
+  unsigned i;
+  int32_t res;
+  struct RingEmu *e = r->emu;
+  for (res = 0, i = 0; i < j->n; ++i) {
+    if (res < 0 || atomic_load_explicit(&e->stop, memory_order_relaxed)) {
+      res = -ECANCELED;
+    } else {
+      res = __ring_execute(r, j->sqes + i);
+    }
+    pthread_mutex_lock(&e->lock);
+    __ring_post(e, j->sqes[i].user_data, res);
+    if (i + 1 < j->n)
+      pthread_mutex_unlock(&e->lock);
+  }
+  --e->running;
+  if (j->sqes[0].flags & IOSQE_IO_DRAIN)
+    e->draining = false;
+  if (e->head && e->idle)
+    pthread_cond_broadcast(&e->work);
+  free(j);
+}
+
+static void *__ring_worker(void *arg) {
+  struct RingJob *j;
+  struct cosmo_ring *r = arg;
+  struct RingEmu *e = r->emu;
+  // cosmo_ring_destroy() cancels us, which makes a blocking system
+  // call fail with ECANCELED rather than unwinding the whole thread
+  pthread_setcancelstate(PTHREAD_CANCEL_MASKED, 0);
+  pthread_mutex_lock(&e->lock);
+  while (!atomic_load_explicit(&e->stop, memory_order_relaxed)) {
+    if ((j = __ring_take(e))) {
+      pthread_mutex_unlock(&e->lock);
+      __ring_run(r, j);
+    } else {
+      ++e->idle;
+      pthread_cond_wait(&e->work, &e->lock);
+      --e->idle;
+    }
+  }
+  pthread_mutex_unlock(&e->lock);
+  return 0;
+}
+
+int __ring_emu_init(struct cosmo_ring *r) {
+  struct RingEmu *e;
+  if (!(e = calloc(1, sizeof(*e))))
+    return -1;
+  e->cqcap = r->entries * 2;
+  if (!(e->cq = malloc(e->cqcap * sizeof(*e->cq)))) {
+    free(e);
+    return -1;
+  }
+  pthread_mutex_init(&e->lock, 0);
+  pthread_cond_init(&e->work, 0);
+  pthread_cond_init(&e->done, 0);
+  r->emu = e;
+  return 0;
+}
+
+void __ring_emu_destroy(struct cosmo_ring *r) {
+  int i;
+  struct RingJob *j;
+  struct RingEmu *e = r->emu;
+  pthread_mutex_lock(&e->lock);
+  atomic_store_explicit(&e->stop, true, memory_order_relaxed);
+  pthread_cond_broadcast(&e->work);
+  pthread_mutex_unlock(&e->lock);
+  for (i = 0; i < e->threads; ++i)
+    pthread_cancel(e->th[i]);
+  for (i = 0; i < e->threads; ++i)
+    pthread_join(e->th[i], 0);
+  while ((j = e->head)) {
+    e->head = j->next;
+    free(j);
+  }
+  pthread_cond_destroy(&e->done);
+  pthread_cond_destroy(&e->work);
+  pthread_mutex_destroy(&e->lock);
+  free(e->cq);
+  free(e);
+}
+
+int __ring_emu_submit(struct cosmo_ring *r) {
+  struct RingJob *j;
+  int i, n, avail, submitted;
+  struct RingEmu *e = r->emu;
+  pthread_mutex_lock(&e->lock);
+  for (submitted = 0; r->sqhead != r->sqtail; submitted += n) {
+    for (n = 1; r->sqhead + n != r->sqtail &&
+                (r->sqes[(r->sqhead + n - 1) & r->mask].flags & IOSQE_IO_LINK);
+         ++n) {
+    }
+    if (!(j = malloc(sizeof(*j) + n * sizeof(*j->sqes))))
+      break;
+    j->next = 0;
+    j->n = n;
+    for (i = 0; i < n; ++i)
+      j->sqes[i] = r->sqes[r->sqhead++ & r->mask];
+    if (e->tail)
+      e->tail->next = j;
+    else
+      e->head = j;
+    e->tail = j;
+    ++e->queued;
+  }
+  for (avail = e->idle; avail < e->queued && e->threads < ARRAYLEN(e->th);
+       ++avail) {
+    if (pthread_create(e->th + e->threads, 0, __ring_worker, r))
+      break;
+    ++e->threads;
+  }
+  if (submitted)
+    pthread_cond_broadcast(&e->work);
+  pthread_mutex_unlock(&e->lock);
+  if (!e->threads) {
+    // we couldn't create any threads, so do the work ourself
+    pthread_mutex_lock(&e->lock);
+    while ((j = __ring_take(e))) {
+      pthread_mutex_unlock(&e->lock);
+      __ring_run(r, j);
+    }
+    pthread_mutex_unlock(&e->lock);
+  }
+  if (!submitted && r->sqhead != r->sqtail)
+    return enomem();
+  return submitted;
+}
+
+int __ring_emu_wait(struct cosmo_ring *r, struct cosmo_ring_cqe *cqes, int max,
+                    int min) {
+  int i, n;
+  struct RingEmu *e = r->emu;
+  if (__ring_emu_submit(r) == -1 && !e->cqlen)
+    return -1;
+  pthread_mutex_lock(&e->lock);
+  while (e->cqlen < min)
+    pthread_cond_wait(&e->done, &e->lock);
+  n = MIN(e->cqlen, max);
+  for (i = 0; i < n; ++i)
+    cqes[i] = e->cq[(e->cqhead + i) % e->cqcap];
+  e->cqhead = (e->cqhead + n) % e->cqcap;
+  e->cqlen -= n;
+  pthread_mutex_unlock(&e->lock);
+  return n;
+}
@@ -0,0 +1,270 @@
+/*-*- mode:c;indent-tabs-mode:nil;c-basic-offset:2;tab-width:8;coding:utf-8 -*-│
+│ vi: set et ft=c ts=2 sts=2 sw=2 fenc=utf-8                               :vi │
+╞══════════════════════════════════════════════════════════════════════════════╡
+│ Copyright 2024 Justine Alexandra Roberts Tunney                              │
+│                                                                              │
+│ Permission to use, copy, modify, and/or distribute this software for         │
+│ any purpose with or without fee is hereby granted, provided that the         │
+│ above copyright notice and this permission notice appear in all copies.      │
+│                                                                              │
+│ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL                │
+│ WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED                │
+│ WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE             │
+│ AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL         │
+│ DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR        │
+│ PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER               │
+│ TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR             │
+│ PERFORMANCE OF THIS SOFTWARE.                                                │
+╚─────────────────────────────────────────────────────────────────────────────*/
+#include "libc/errno.h"
+#include "libc/intrin/atomic.h"
+#include "libc/macros.internal.h"
+#include "libc/sock/uring.internal.h"
+#include "libc/str/str.h"
+
+static struct io_uring_sqe *cosmo_ring_get(struct cosmo_ring *r, int op,
+                                           int fd, uint64_t data) {
+  unsigned head;
+  struct io_uring_sqe *e;
+  if (r->fd == -1)
+    head = r->sqhead;
+  else
+    head = atomic_load_explicit(r->ksqhead, memory_order_acquire);
+  if (r->sqtail - head >= r->entries) {
+    errno = EBUSY;
+    return 0;
+  }
+  e = r->sqes + (r->sqtail++ & r->mask);
+  bzero(e, sizeof(*e));
+  e->opcode = op;
+  e->fd = fd;
+  e->user_data = data;
+  return e;
+}
+
+static struct io_uring_sqe *cosmo_ring_rw(struct cosmo_ring *r, int op, int fd,
+                                          const void *addr, unsigned len,
+                                          int64_t off, uint64_t data) {
+  struct io_uring_sqe *e;
+  if ((e = cosmo_ring_get(r, op, fd, data))) {
+    e->addr = (uintptr_t)addr;
+    e->len = len;
+    e->off = off;
+  }
+  return e;
+}
+
+/**
+ * Sets flags on queued operation.
+ *
+ * @param flags may have `COSMO_RING_FIXED_FILE` if the file descriptor
+ *     is an index into the table passed to cosmo_ring_register_files(),
+ *     `COSMO_RING_LINK` if the next operation should only start after
+ *     this one succeeds, or `COSMO_RING_DRAIN` to not start it until
+ *     everything submitted earlier has completed
+ */
+void cosmo_ring_sqe_flags(struct cosmo_ring_sqe *sqe, unsigned flags) {
+  ((struct io_uring_sqe *)sqe)->flags = flags;
+}
+
+/**
+ * Queues operation that does nothing.
+ *
+ * The functions below queue an operation on the submission ring, which
+ * happens until cosmo_ring_submit() or cosmo_ring_wait() is called. It
+ * returns `res` in the completion, which is what the equivalent system
+ * call would have returned, except errors are reported as `-errno`.
+ *
+ * @param data is passed along to completion as `data`
+ * @return handle for cosmo_ring_sqe_flags(), or null w/ errno
+ * @raise EBUSY if submission ring is full
+ */
+struct cosmo_ring_sqe *cosmo_ring_nop(struct cosmo_ring *r, uint64_t data) {
+  return (void *)cosmo_ring_get(r, IORING_OP_NOP, -1, data);
+}
+
+/**
+ * Queues read() if `off` is -1, otherwise pread().
+ */
+struct cosmo_ring_sqe *cosmo_ring_read(struct cosmo_ring *r, int fd, void *buf,
+                                       size_t size, int64_t off,
+                                       uint64_t data) {
+  return (void *)cosmo_ring_rw(r, IORING_OP_READ, fd, buf,
+                               MIN(size, 0x7ffff000), off, data);
+}
+
+/**
+ * Queues write() if `off` is -1, otherwise pwrite().
+ */
+struct cosmo_ring_sqe *cosmo_ring_write(struct cosmo_ring *r, int fd,
+                                        const void *buf, size_t size,
+                                        int64_t off, uint64_t data) {
+  return (void *)cosmo_ring_rw(r, IORING_OP_WRITE, fd, buf,
+                               MIN(size, 0x7ffff000), off, data);
+}
+
+/**
+ * Queues readv() if `off` is -1, otherwise preadv().
+ *
+ * The iovec array must stay valid until the operation completes.
+ */
+struct cosmo_ring_sqe *cosmo_ring_readv(struct cosmo_ring *r, int fd,
+                                        const struct iovec *iov, int iovlen,
+                                        int64_t off, uint64_t data) {
+  return (void *)cosmo_ring_rw(r, IORING_OP_READV, fd, iov, iovlen, off, data);
+}
+
+/**
+ * Queues writev() if `off` is -1, otherwise pwritev().
+ *
+ * The iovec array must stay valid until the operation completes.
+ */
+struct cosmo_ring_sqe *cosmo_ring_writev(struct cosmo_ring *r, int fd,
+                                         const struct iovec *iov, int iovlen,
+                                         int64_t off, uint64_t data) {
+  return (void *)cosmo_ring_rw(r, IORING_OP_WRITEV, fd, iov, iovlen, off,
+                               data);
+}
+
+/**
+ * Queues read into registered buffer.
+ *
+ * @param buf must lie within buffer `index` of the table passed to
+ *     cosmo_ring_register_buffers()
+ */
+struct cosmo_ring_sqe *cosmo_ring_read_fixed(struct cosmo_ring *r, int fd,
+                                             void *buf, size_t size,
+                                             int64_t off, int index,
+                                             uint64_t data) {
+  struct io_uring_sqe *e;
+  if ((e = cosmo_ring_rw(r, IORING_OP_READ_FIXED, fd, buf,
+                         MIN(size, 0x7ffff000), off, data)))
+    e->buf_index = index;
+  return (void *)e;
+}
+
+/**
+ * Queues write from registered buffer.
+ *
+ * @param buf must lie within buffer `index` of the table passed to
+ *     cosmo_ring_register_buffers()
+ */
+struct cosmo_ring_sqe *cosmo_ring_write_fixed(struct cosmo_ring *r, int fd,
+                                              const void *buf, size_t size,
+                                              int64_t off, int index,
+                                              uint64_t data) {
+  struct io_uring_sqe *e;
+  if ((e = cosmo_ring_rw(r, IORING_OP_WRITE_FIXED, fd, buf,
+                         MIN(size, 0x7ffff000), off, data)))
+    e->buf_index = index;
+  return (void *)e;
+}
+
+/**
+ * Queues accept4().
+ *
+ * @param flags may have `SOCK_CLOEXEC` and `SOCK_NONBLOCK`
+ */
+struct cosmo_ring_sqe *cosmo_ring_accept(struct cosmo_ring *r, int fd,
+                                         struct sockaddr *addr,
+                                         uint32_t *addrlen, int flags,
+                                         uint64_t data) {
+  struct io_uring_sqe *e;
+  if ((e = cosmo_ring_get(r, IORING_OP_ACCEPT, fd, data))) {
+    e->addr = (uintptr_t)addr;
+    e->off = (uintptr_t)addrlen;
+    e->op_flags = flags;
+  }
+  return (void *)e;
+}
+
+/**
+ * Queues connect().
+ */
+struct cosmo_ring_sqe *cosmo_ring_connect(struct cosmo_ring *r, int fd,
+                                          const struct sockaddr *addr,
+                                          uint32_t addrlen, uint64_t data) {
+  struct io_uring_sqe *e;
+  if ((e = cosmo_ring_get(r, IORING_OP_CONNECT, fd, data))) {
+    e->addr = (uintptr_t)addr;
+    e->off = addrlen;
+  }
+  return (void *)e;
+}
+
+/**
+ * Queues send().
+ */
+struct cosmo_ring_sqe *cosmo_ring_send(struct cosmo_ring *r, int fd,
+                                       const void *buf, size_t size, int flags,
+                                       uint64_t data) {
+  struct io_uring_sqe *e;
+  if ((e = cosmo_ring_rw(r, IORING_OP_SEND, fd, buf, MIN(size, 0x7ffff000), 0,
+                         data)))
+    e->op_flags = flags;
+  return (void *)e;
+}
+
+/**
+ * Queues recv().
+ */
+struct cosmo_ring_sqe *cosmo_ring_recv(struct cosmo_ring *r, int fd, void *buf,
+                                       size_t size, int flags, uint64_t data) {
+  struct io_uring_sqe *e;
+  if ((e = cosmo_ring_rw(r, IORING_OP_RECV, fd, buf, MIN(size, 0x7ffff000), 0,
+                         data)))
+    e->op_flags = flags;
+  return (void *)e;
+}
+
+/**
+ * Queues openat().
+ *
+ * The path must stay valid until the operation completes.
+ */
+struct cosmo_ring_sqe *cosmo_ring_openat(struct cosmo_ring *r, int dirfd,
+                                         const char *path, int flags,
+                                         unsigned mode, uint64_t data) {
+  struct io_uring_sqe *e;
+  if ((e = cosmo_ring_rw(r, IORING_OP_OPENAT, dirfd, path, mode, 0, data)))
+    e->op_flags = flags;
+  return (void *)e;
+}
+
+/**
+ * Queues close().
+ */
+struct cosmo_ring_sqe *cosmo_ring_close(struct cosmo_ring *r, int fd,
+                                        uint64_t data) {
+  return (void *)cosmo_ring_get(r, IORING_OP_CLOSE, fd, data);
+}
+
+/**
+ * Queues fsync(), or fdatasync() if `COSMO_RING_FSYNC_DATASYNC`.
+ */
+struct cosmo_ring_sqe *cosmo_ring_fsync(struct cosmo_ring *r, int fd,
+                                        unsigned flags, uint64_t data) {
+  struct io_uring_sqe *e;
+  if ((e = cosmo_ring_get(r, IORING_OP_FSYNC, fd, data)))
+    e->op_flags = flags;
+  return (void *)e;
+}
+
+/**
+ * Queues splice().
+ *
+ * @param inoff is offset into `infd` or -1 to use its file position
+ * @param outoff is offset into `outfd` or -1 to use its file position
+ */
+struct cosmo_ring_sqe *cosmo_ring_splice(struct cosmo_ring *r, int infd,
+                                         int64_t inoff, int outfd,
+                                         int64_t outoff, size_t size,
+                                         unsigned flags, uint64_t data) {
+  struct io_uring_sqe *e;
+  if ((e = cosmo_ring_rw(r, IORING_OP_SPLICE, outfd, (void *)inoff,
+                         MIN(size, 0x7ffff000), outoff, data))) {
+    e->splice_fd_in = infd;
+    e->op_flags = flags;
+  }
+  return (void *)e;
+}
@@ -37,6 +37,7 @@ LIBC_STDIO_A_DIRECTDEPS =				\
 	LIBC_STR					\
 	LIBC_SYSV					\
 	LIBC_SYSV_CALLS					\
+	LIBC_THREAD					\
 	THIRD_PARTY_GDTOA
 
 LIBC_STDIO_A_DEPS :=					\
@@ -421,7 +421,8 @@ static struct dirent *readdir_zipos(DIR *dir) {
       const char *s = ZIP_CFILE_NAME(dir->zip.zipos->map + dir->zip.offset);
       size_t n = ZIP_CFILE_NAMESIZE(dir->zip.zipos->map + dir->zip.offset);
       if (n > dir->zip.prefix.len &&
-          !memcmp(dir->zip.prefix.path, s, dir->zip.prefix.len)) {
+          !memcmp(dir->zip.prefix.path, s, dir->zip.prefix.len) &&
+          !__zipos_is_index(dir->zip.zipos->map + dir->zip.offset)) {
         s += dir->zip.prefix.len;
         n -= dir->zip.prefix.len;
         const char *p = memchr(s, '/', n);
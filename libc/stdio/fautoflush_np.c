@@ -0,0 +1,177 @@
+/*-*- mode:c;indent-tabs-mode:nil;c-basic-offset:2;tab-width:8;coding:utf-8 -*-│
+│ vi: set et ft=c ts=2 sts=2 sw=2 fenc=utf-8                               :vi │
+╞══════════════════════════════════════════════════════════════════════════════╡
+│ Copyright 2024 Justine Alexandra Roberts Tunney                              │
+│                                                                              │
+│ Permission to use, copy, modify, and/or distribute this software for         │
+│ any purpose with or without fee is hereby granted, provided that the         │
+│ above copyright notice and this permission notice appear in all copies.      │
+│                                                                              │
+│ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL                │
+│ WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED                │
+│ WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE             │
+│ AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL         │
+│ DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR        │
+│ PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER               │
+│ TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR             │
+│ PERFORMANCE OF THIS SOFTWARE.                                                │
+╚─────────────────────────────────────────────────────────────────────────────*/
+#include "libc/calls/calls.h"
+#include "libc/calls/struct/sigset.h"
+#include "libc/errno.h"
+#include "libc/macros.internal.h"
+#include "libc/stdio/fflush.internal.h"
+#include "libc/stdio/internal.h"
+#include "libc/stdio/stdio.h"
+#include "libc/sysv/consts/o.h"
+#include "libc/sysv/errfuns.h"
+#include "libc/thread/thread.h"
+#include "libc/thread/thread2.h"
+
+static struct {
+  bool started;
+  bool atfork;
+  int millis;
+} __autoflush;
+
+static void __autoflush_write(FILE *f) {
+  size_t i;
+  ssize_t rc;
+  if (f->fd == -1 || f->end || (f->iomode & O_ACCMODE) == O_RDONLY)
+    return;
+  for (i = 0; i < f->beg; i += rc) {
+    if ((rc = write(f->fd, f->buf + i, f->beg - i)) == -1) {
+      f->state = errno;
+      return;
+    }
+  }
+  f->beg = 0;
+}
+
+// locks a batch of streams with pending autoflush output, starting at
+// index `*i` of the handle list. holding a stream's lock keeps fclose()
+// from freeing it, so the batch can be flushed after the list lock has
+// been released. streams busy with i/o are skipped rather than waited
+// upon, so that this thread never gets in the way of those doing work
+static size_t __autoflush_batch(size_t *i, FILE **batch, size_t n,
+                                bool *active) {
+  FILE *f;
+  size_t m = 0;
+  for (; *i < __fflush.handles.i && m < n; ++*i) {
+    if (!(f = __fflush.handles.p[*i]))
+      continue;
+    if (ftrylockfile(f)) {
+      *active = true;
+      continue;
+    }
+    if (f->autoflush) {
+      *active = true;
+      if (f->bufmode == _IOFBF && f->beg) {
+        batch[m++] = f;
+        continue;
+      }
+    }
+    funlockfile(f);
+  }
+  return m;
+}
+
+static void *__autoflush_worker(void *arg) {
+  bool active;
+  size_t i, j, m;
+  FILE *batch[32];
+  int millis = (intptr_t)arg;
+  for (;;) {
+    usleep(millis * 1000);
+    active = false;
+    for (i = 0;;) {
+      __fflush_lock();
+      m = __autoflush_batch(&i, batch, ARRAYLEN(batch), &active);
+      if (!m) {
+        if (!active) {
+          // nothing has autoflush enabled anymore, so stop the thread;
+          // the next fautoflush_np() call will start a new one
+          __autoflush.started = false;
+          __autoflush.millis = 0;
+          __fflush_unlock();
+          return 0;
+        }
+        millis = __autoflush.millis;
+        __fflush_unlock();
+        break;
+      }
+      __fflush_unlock();
+      for (j = 0; j < m; ++j) {
+        __autoflush_write(batch[j]);
+        funlockfile(batch[j]);
+      }
+    }
+  }
+}
+
+static void __autoflush_child(void) {
+  __autoflush.started = false;
+}
+
+static int __autoflush_start(void) {
+  int err;
+  pthread_t th;
+  sigset_t mask;
+  pthread_attr_t attr;
+  sigfillset(&mask);
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+  pthread_attr_setsigmask_np(&attr, &mask);
+  err = pthread_create(&th, &attr, __autoflush_worker,
+                       (void *)(intptr_t)__autoflush.millis);
+  pthread_attr_destroy(&attr);
+  if (err)
+    return err;
+  pthread_setname_np(th, "autoflush");
+  if (!__autoflush.atfork) {
+    pthread_atfork(0, 0, __autoflush_child);
+    __autoflush.atfork = true;
+  }
+  __autoflush.started = true;
+  return 0;
+}
+
+/**
+ * Flushes fully buffered stream periodically from a background thread.
+ *
+ * This lets programs use a big buffer with setvbuf() for throughput,
+ * without data waiting in the buffer indefinitely when output is slow.
+ * A single thread is shared by all streams, and it wakes up at the
+ * shortest interval that's been requested. It won't wait for streams
+ * that are locked by other threads, and it doesn't hold the global
+ * stream list lock while writing. The thread exits once no streams
+ * have autoflush enabled. The thread isn't recreated in the child
+ * process after fork(), unless this function is called again.
+ *
+ * @param f is the stream, which must be using `_IOFBF` mode
+ * @param millis is how often to flush, or 0 to disable
+ * @return 0 on success, or -1 w/ errno
+ * @raise EINVAL if `millis` is negative
+ * @raise EAGAIN if thread couldn't be created
+ */
+int fautoflush_np(FILE *f, int millis) {
+  int err = 0;
+  if (millis < 0)
+    return einval();
+  flockfile(f);
+  f->autoflush = !!millis;
+  funlockfile(f);
+  if (!millis)
+    return 0;
+  __fflush_lock();
+  if (!__autoflush.millis || millis < __autoflush.millis)
+    __autoflush.millis = millis;
+  if (!__autoflush.started)
+    err = __autoflush_start();
+  __fflush_unlock();
+  if (err) {
+    errno = err;
+    return -1;
+  }
+  return 0;
+}
@@ -71,8 +71,8 @@ static ssize_t writevall(int fd, struct iovec *iov, int iovlen) {
 size_t fwrite_unlocked(const void *data, size_t stride, size_t count, FILE *f) {
   ldiv_t d;
   ssize_t rc;
-  size_t n, m;
   const char *p;
+  size_t n, m, beg;
   struct iovec iov[2];
   if (!stride || !count) {
     return 0;
@@ -86,13 +86,19 @@ size_t fwrite_unlocked(const void *data, size_t stride, size_t count, FILE *f) {
     return 0;
   }
   m = f->size - f->beg;
-  if (n <= m && f->bufmode != _IONBF) {
+  if (n <= m && f->bufmode != _IONBF && (f->fd == -1 || n < f->size / 2)) {
     // this isn't an unbuffered stream, and
-    // there's enough room in the buffer for the request
-    memcpy(f->buf + f->beg, data, n);
+    // there's enough room in the buffer for the request, and
+    // the request is small enough that copying it is worthwhile
+    beg = f->beg;
+    memcpy(f->buf + beg, data, n);
     f->beg += n;
+    // only the new data is searched for newlines. lines that an
+    // earlier short or interrupted write() left in the buffer are
+    // still written, since we write from the start of the buffer,
+    // but only once another newline arrives or the stream flushes
     if (f->fd != -1 && f->bufmode == _IOLBF &&
-        (p = memrchr(f->buf, '\n', f->beg))) {
+        (p = memrchr(f->buf + beg, '\n', n))) {
       // write out as many lines as possible
       n = p + 1 - f->buf;
       if ((rc = write(f->fd, f->buf, n)) == -1) {
@@ -114,8 +120,9 @@ size_t fwrite_unlocked(const void *data, size_t stride, size_t count, FILE *f) {
     return count;
   }
   // what's happening is either
-  // (1) a fully buffered stream, or
-  // (2) no room in buffer to hold full request
+  // (1) an unbuffered stream, or
+  // (2) a request so big it isn't worth copying, or
+  // (3) no room in buffer to hold full request
   if (f->fd == -1) {
     // this is an in-memory stream
     // store as much of request as we can hold
@@ -11,6 +11,7 @@ struct FILE {
   uint8_t bufmode; /* _IOFBF, etc. (ignored if fd=-1) */
   char noclose;    /* for fake dup() todo delete! */
   char dynamic;    /* did malloc() create this object? */
+  char autoflush;  /* flushed by background thread? */
   uint32_t iomode; /* O_RDONLY, etc. (ignored if fd=-1) */
   int32_t state;   /* 0=OK, -1=EOF, >0=errno */
   int fd;          /* ≥0=fd, -1=closed|buffer */
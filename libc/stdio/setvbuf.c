@@ -16,26 +16,69 @@
 │ TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR             │
 │ PERFORMANCE OF THIS SOFTWARE.                                                │
 ╚─────────────────────────────────────────────────────────────────────────────*/
+#include "libc/calls/calls.h"
 #include "libc/intrin/weaken.h"
+#include "libc/limits.h"
+#include "libc/macros.internal.h"
 #include "libc/mem/mem.h"
 #include "libc/runtime/runtime.h"
 #include "libc/stdio/internal.h"
 #include "libc/stdio/stdio.h"
+#include "libc/sysv/consts/madv.h"
 #include "libc/sysv/errfuns.h"
 
+#define HUGE 0x200000
+
+static char *__stdio_buffer(size_t size) {
+  char *p;
+  if (size < HUGE || !_weaken(memalign)) {
+    return _weaken(malloc)(size);
+  } else if ((p = _weaken(memalign)(HUGE, ROUNDUP(size, HUGE)))) {
+    madvise(p, ROUNDUP(size, HUGE), MADV_HUGEPAGE);
+  }
+  return p;
+}
+
 /**
  * Tunes buffering settings for an stdio stream.
  *
+ * If `buf` is NULL and `size` is nonzero, then the stream will use a
+ * buffer of that size which is allocated with malloc(). Buffers that
+ * are two megabytes or larger will be backed by huge pages if the os
+ * supports it. Larger buffers mean fewer system calls. Writes that are
+ * at least half the buffer size always bypass the buffer though, and
+ * get written together with the pending data using writev().
+ *
  * @param mode may be _IOFBF, _IOLBF, or _IONBF
  * @param buf may optionally be non-NULL to set the stream's underlying
  *     buffer which the caller still owns and won't free, otherwise the
  *     existing buffer is used
- * @param size is ignored if buf is NULL
+ * @param size is size of `buf`, or if `buf` is NULL, then it's the
+ *     size of buffer to allocate, or zero to keep the existing one
  * @return 0 on success or -1 on error
+ * @raise ENOMEM if buffer couldn't be allocated
+ * @raise EINVAL if `size` exceeds `UINT32_MAX`
  */
 int setvbuf(FILE *f, char *buf, int mode, size_t size) {
+  if (size > UINT32_MAX)
+    return einval();
   flockfile(f);
-  if (buf) {
+  if (!buf && size && size != f->size && mode != _IONBF && f->fd != -1) {
+    if (!_weaken(malloc) || !(buf = __stdio_buffer(size))) {
+      funlockfile(f);
+      return enomem();
+    }
+    if (__fflush_impl(f) == -1) {
+      _weaken(free)(buf);
+      funlockfile(f);
+      return -1;
+    }
+    if (!f->nofree && f->buf != f->mem)
+      _weaken(free)(f->buf);
+    f->buf = buf;
+    f->size = size;
+    f->nofree = false;
+  } else if (buf) {
     if (!size)
       size = BUFSIZ;
     if (!f->nofree &&        //
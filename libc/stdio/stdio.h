@@ -76,6 +76,7 @@ void setlinebuf(FILE *) libcesque;
 void setbuf(FILE *, char *) libcesque;
 void setbuffer(FILE *, char *, size_t) libcesque;
 int setvbuf(FILE *, char *, int, size_t) libcesque;
+int fautoflush_np(FILE *, int) libcesque;
 int pclose(FILE *) libcesque;
 char *ctermid(char *) libcesque;
 void perror(const char *) libcesque relegated;
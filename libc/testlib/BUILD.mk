@@ -51,6 +51,8 @@ LIBC_TESTLIB_A_SRCS_C =						\
 	libc/testlib/endswith.c					\
 	libc/testlib/extract.c					\
 	libc/testlib/ezbenchcontrol.c				\
+	libc/testlib/ezbenchfreq.c				\
+	libc/testlib/ezbenchrecord.c				\
 	libc/testlib/ezbenchreport.c				\
 	libc/testlib/ezbenchwarn.c				\
 	libc/testlib/fixturerunner.c				\
@@ -12,140 +12,199 @@ COSMOPOLITAN_C_START_
 #define EZBENCH_COUNT 128
 #endif
 
-#define EZBENCH_TRIES 10
+#define EZBENCH_TRIES   10
+#define EZBENCH_SAMPLES 256
 
-#define EZBENCH(INIT, EXPR) EZBENCH2(#EXPR, INIT, EXPR)
+/**
+ * Cycle counts of individual iterations of a benchmark loop.
+ *
+ * Only the last EZBENCH_SAMPLES iterations are retained, since some
+ * benchmarks redefine EZBENCH_COUNT to be quite large.
+ */
+struct EzBenchSamples {
+  unsigned long n;
+  int p[EZBENCH_SAMPLES];
+};
 
-#define EZBENCH2(NAME, INIT, EXPR)                                        \
-  do {                                                                    \
-    int Core, Tries, Interrupts;                                          \
-    double Speculative, MemoryStrict;                                     \
-    Tries = 0;                                                            \
-    do {                                                                  \
-      __testlib_yield();                                                  \
-      Core = __testlib_getcore();                                         \
-      Interrupts = __testlib_getinterrupts();                             \
-      INIT;                                                               \
-      EXPR;                                                               \
-      Speculative = BENCHLOOP(__startbench, __endbench, EZBENCH_COUNT, ({ \
-                                INIT;                                     \
-                                __polluteregisters();                     \
-                              }),                                         \
-                              (EXPR));                                    \
-    } while (++Tries < EZBENCH_TRIES &&                                   \
-             (__testlib_getcore() != Core &&                              \
-              __testlib_getinterrupts() > Interrupts));                   \
-    if (Tries == EZBENCH_TRIES)                                           \
-      __testlib_ezbenchwarn(" speculative");                              \
-    Tries = 0;                                                            \
-    do {                                                                  \
-      __testlib_yield();                                                  \
-      Core = __testlib_getcore();                                         \
-      Interrupts = __testlib_getinterrupts();                             \
-      INIT;                                                               \
-      EXPR;                                                               \
-      MemoryStrict = BENCHLOOP(__startbench_m, __endbench_m, 32, ({       \
-                                 INIT;                                    \
-                                 __polluteregisters();                    \
-                               }),                                        \
-                               (EXPR));                                   \
-    } while (++Tries < EZBENCH_TRIES &&                                   \
-             (__testlib_getcore() != Core &&                              \
-              __testlib_getinterrupts() > Interrupts));                   \
-    if (Tries == EZBENCH_TRIES)                                           \
-      __testlib_ezbenchwarn(" memory strict");                            \
-    __testlib_ezbenchreport(                                              \
-        NAME, MAX(.001, Speculative - __testlib_ezbenchcontrol()),        \
-        MAX(.001, MemoryStrict - __testlib_ezbenchcontrol()));            \
-  } while (0)
+/**
+ * Distribution of benchmark samples in nanoseconds.
+ */
+struct EzBenchStats {
+  unsigned long count;
+  double min;
+  double median;
+  double p99;
+  double mean;
+  double stddev;
+};
 
-#define EZBENCH3(NAME, NUM, INIT, EXPR)                              \
-  do {                                                               \
-    int Core, Tries, Interrupts;                                     \
-    double Speculative, MemoryStrict;                                \
-    Tries = 0;                                                       \
-    do {                                                             \
-      __testlib_yield();                                             \
-      Core = __testlib_getcore();                                    \
-      Interrupts = __testlib_getinterrupts();                        \
-      INIT;                                                          \
-      EXPR;                                                          \
-      Speculative = BENCHLOOP(__startbench, __endbench, NUM, ({      \
-                                INIT;                                \
-                                __polluteregisters();                \
-                              }),                                    \
-                              (EXPR));                               \
-    } while (++Tries < EZBENCH_TRIES &&                              \
-             (__testlib_getcore() != Core &&                         \
-              __testlib_getinterrupts() > Interrupts));              \
-    if (Tries == EZBENCH_TRIES)                                      \
-      __testlib_ezbenchwarn(" speculative");                         \
-    Tries = 0;                                                       \
-    do {                                                             \
-      __testlib_yield();                                             \
-      Core = __testlib_getcore();                                    \
-      Interrupts = __testlib_getinterrupts();                        \
+#define EZBENCH(INIT, EXPR) EZBENCH2(#EXPR, INIT, EXPR)
+
+#define EZBENCHLOOP(START, STOP, N, INIT, EXPR, SAMPLES)             \
+  ({                                                                 \
+    double Average;                                                  \
+    uint64_t Time1, Time2;                                           \
+    unsigned long Iter, Count;                                       \
+    for (Average = 1, Iter = 1, Count = (N); Iter < Count; ++Iter) { \
       INIT;                                                          \
+      Time1 = START();                                               \
+      asm volatile("" ::: "memory");                                 \
       EXPR;                                                          \
-      MemoryStrict = BENCHLOOP(__startbench_m, __endbench_m, NUM, ({ \
-                                 INIT;                               \
-                                 __polluteregisters();               \
-                               }),                                   \
-                               (EXPR));                              \
-    } while (++Tries < EZBENCH_TRIES &&                              \
-             (__testlib_getcore() != Core &&                         \
-              __testlib_getinterrupts() > Interrupts));              \
-    if (Tries == EZBENCH_TRIES)                                      \
-      __testlib_ezbenchwarn(" memory strict");                       \
-    __testlib_ezbenchreport(                                         \
-        NAME, MAX(.001, Speculative - __testlib_ezbenchcontrol()),   \
-        MAX(.001, MemoryStrict - __testlib_ezbenchcontrol()));       \
+      asm volatile("" ::: "memory");                                 \
+      Time2 = STOP();                                                \
+      Average += 1. / Iter * ((int)(Time2 - Time1) - Average);       \
+      (SAMPLES)->p[(Iter - 1) % EZBENCH_SAMPLES] = Time2 - Time1;    \
+    }                                                                \
+    (SAMPLES)->n = Iter - 1;                                         \
+    Average;                                                         \
+  })
+
+#define EZBENCH2(NAME, INIT, EXPR)                                            \
+  do {                                                                        \
+    int Core, Tries, Interrupts;                                              \
+    struct EzBenchSamples Samples;                                            \
+    double Speculative, MemoryStrict;                                         \
+    int64_t Switches;                                                         \
+    Tries = 0;                                                                \
+    do {                                                                      \
+      __testlib_yield();                                                      \
+      Core = __testlib_getcore();                                             \
+      Interrupts = __testlib_getinterrupts();                                 \
+      INIT;                                                                   \
+      EXPR;                                                                   \
+      Speculative =                                                           \
+          EZBENCHLOOP(__startbench, __endbench, EZBENCH_COUNT, ({             \
+                        INIT;                                                 \
+                        __polluteregisters();                                 \
+                      }),                                                     \
+                      (EXPR), &Samples);                                      \
+    } while (++Tries < EZBENCH_TRIES &&                                       \
+             (__testlib_getcore() != Core &&                                  \
+              __testlib_getinterrupts() > Interrupts));                       \
+    if (Tries == EZBENCH_TRIES)                                               \
+      __testlib_ezbenchwarn(" speculative");                                  \
+    Switches = __testlib_getinterrupts() - Interrupts;                        \
+    Tries = 0;                                                                \
+    do {                                                                      \
+      __testlib_yield();                                                      \
+      Core = __testlib_getcore();                                             \
+      Interrupts = __testlib_getinterrupts();                                 \
+      INIT;                                                                   \
+      EXPR;                                                                   \
+      MemoryStrict = BENCHLOOP(__startbench_m, __endbench_m, 32, ({           \
+                                 INIT;                                        \
+                                 __polluteregisters();                        \
+                               }),                                            \
+                               (EXPR));                                       \
+    } while (++Tries < EZBENCH_TRIES &&                                       \
+             (__testlib_getcore() != Core &&                                  \
+              __testlib_getinterrupts() > Interrupts));                       \
+    if (Tries == EZBENCH_TRIES)                                               \
+      __testlib_ezbenchwarn(" memory strict");                                \
+    __testlib_ezbenchreport(                                                  \
+        NAME, MAX(.001, Speculative - __testlib_ezbenchcontrol()),            \
+        MAX(.001, MemoryStrict - __testlib_ezbenchcontrol()));                \
+    __testlib_ezbenchrecord(NAME, 0, 0, &Samples, __testlib_ezbenchcontrol(), \
+                            Speculative, MemoryStrict, Core, Switches);       \
   } while (0)
 
-#define EZBENCH_C(NAME, CONTROL, EXPR)                                 \
-  do {                                                                 \
-    int Core, Tries, Interrupts;                                       \
-    double Control, Speculative, MemoryStrict;                         \
-    Tries = 0;                                                         \
-    do {                                                               \
-      __testlib_yield();                                               \
-      Core = __testlib_getcore();                                      \
-      Interrupts = __testlib_getinterrupts();                          \
-      Control = BENCHLOOP(__startbench_m, __endbench_m, EZBENCH_COUNT, \
-                          ({ __polluteregisters(); }), (CONTROL));     \
-    } while (++Tries < EZBENCH_TRIES &&                                \
-             (__testlib_getcore() != Core &&                           \
-              __testlib_getinterrupts() > Interrupts));                \
-    if (Tries == EZBENCH_TRIES)                                        \
-      __testlib_ezbenchwarn(" control");                               \
-    Tries = 0;                                                         \
-    do {                                                               \
-      __testlib_yield();                                               \
-      Core = __testlib_getcore();                                      \
-      Interrupts = __testlib_getinterrupts();                          \
-      EXPR;                                                            \
-      Speculative = BENCHLOOP(__startbench, __endbench, EZBENCH_COUNT, \
-                              __polluteregisters(), (EXPR));           \
-    } while (++Tries < EZBENCH_TRIES &&                                \
-             (__testlib_getcore() != Core &&                           \
-              __testlib_getinterrupts() > Interrupts));                \
-    if (Tries == EZBENCH_TRIES)                                        \
-      __testlib_ezbenchwarn(" speculative");                           \
-    Tries = 0;                                                         \
-    do {                                                               \
-      __testlib_yield();                                               \
-      Core = __testlib_getcore();                                      \
-      Interrupts = __testlib_getinterrupts();                          \
-      EXPR;                                                            \
-      MemoryStrict = BENCHLOOP(__startbench_m, __endbench_m, 8,        \
-                               ({ __polluteregisters(); }), (EXPR));   \
-    } while (++Tries < EZBENCH_TRIES &&                                \
-             (__testlib_getcore() != Core &&                           \
-              __testlib_getinterrupts() > Interrupts));                \
-    if (Tries == EZBENCH_TRIES)                                        \
-      __testlib_ezbenchwarn(" memory strict");                         \
-    __testlib_ezbenchreport(NAME, MAX(.001, Speculative - Control),    \
-                            MAX(.001, MemoryStrict - Control));        \
+#define EZBENCH3(NAME, NUM, INIT, EXPR)                                       \
+  do {                                                                        \
+    int Core, Tries, Interrupts;                                              \
+    struct EzBenchSamples Samples;                                            \
+    double Speculative, MemoryStrict;                                         \
+    int64_t Switches;                                                         \
+    Tries = 0;                                                                \
+    do {                                                                      \
+      __testlib_yield();                                                      \
+      Core = __testlib_getcore();                                             \
+      Interrupts = __testlib_getinterrupts();                                 \
+      INIT;                                                                   \
+      EXPR;                                                                   \
+      Speculative = EZBENCHLOOP(__startbench, __endbench, NUM, ({             \
+                                  INIT;                                       \
+                                  __polluteregisters();                       \
+                                }),                                           \
+                                (EXPR), &Samples);                            \
+    } while (++Tries < EZBENCH_TRIES &&                                       \
+             (__testlib_getcore() != Core &&                                  \
+              __testlib_getinterrupts() > Interrupts));                       \
+    if (Tries == EZBENCH_TRIES)                                               \
+      __testlib_ezbenchwarn(" speculative");                                  \
+    Switches = __testlib_getinterrupts() - Interrupts;                        \
+    Tries = 0;                                                                \
+    do {                                                                      \
+      __testlib_yield();                                                      \
+      Core = __testlib_getcore();                                             \
+      Interrupts = __testlib_getinterrupts();                                 \
+      INIT;                                                                   \
+      EXPR;                                                                   \
+      MemoryStrict = BENCHLOOP(__startbench_m, __endbench_m, NUM, ({          \
+                                 INIT;                                        \
+                                 __polluteregisters();                        \
+                               }),                                            \
+                               (EXPR));                                       \
+    } while (++Tries < EZBENCH_TRIES &&                                       \
+             (__testlib_getcore() != Core &&                                  \
+              __testlib_getinterrupts() > Interrupts));                       \
+    if (Tries == EZBENCH_TRIES)                                               \
+      __testlib_ezbenchwarn(" memory strict");                                \
+    __testlib_ezbenchreport(                                                  \
+        NAME, MAX(.001, Speculative - __testlib_ezbenchcontrol()),            \
+        MAX(.001, MemoryStrict - __testlib_ezbenchcontrol()));                \
+    __testlib_ezbenchrecord(NAME, 0, 0, &Samples, __testlib_ezbenchcontrol(), \
+                            Speculative, MemoryStrict, Core, Switches);       \
+  } while (0)
+
+#define EZBENCH_C(NAME, CONTROL, EXPR)                                   \
+  do {                                                                   \
+    int Core, Tries, Interrupts;                                         \
+    struct EzBenchSamples Samples;                                       \
+    double Control, Speculative, MemoryStrict;                           \
+    int64_t Switches;                                                    \
+    Tries = 0;                                                           \
+    do {                                                                 \
+      __testlib_yield();                                                 \
+      Core = __testlib_getcore();                                        \
+      Interrupts = __testlib_getinterrupts();                            \
+      Control = BENCHLOOP(__startbench_m, __endbench_m, EZBENCH_COUNT,   \
+                          ({ __polluteregisters(); }), (CONTROL));       \
+    } while (++Tries < EZBENCH_TRIES &&                                  \
+             (__testlib_getcore() != Core &&                             \
+              __testlib_getinterrupts() > Interrupts));                  \
+    if (Tries == EZBENCH_TRIES)                                          \
+      __testlib_ezbenchwarn(" control");                                 \
+    Tries = 0;                                                           \
+    do {                                                                 \
+      __testlib_yield();                                                 \
+      Core = __testlib_getcore();                                        \
+      Interrupts = __testlib_getinterrupts();                            \
+      EXPR;                                                              \
+      Speculative = EZBENCHLOOP(__startbench, __endbench, EZBENCH_COUNT, \
+                                __polluteregisters(), (EXPR), &Samples); \
+    } while (++Tries < EZBENCH_TRIES &&                                  \
+             (__testlib_getcore() != Core &&                             \
+              __testlib_getinterrupts() > Interrupts));                  \
+    if (Tries == EZBENCH_TRIES)                                          \
+      __testlib_ezbenchwarn(" speculative");                             \
+    Switches = __testlib_getinterrupts() - Interrupts;                   \
+    Tries = 0;                                                           \
+    do {                                                                 \
+      __testlib_yield();                                                 \
+      Core = __testlib_getcore();                                        \
+      Interrupts = __testlib_getinterrupts();                            \
+      EXPR;                                                              \
+      MemoryStrict = BENCHLOOP(__startbench_m, __endbench_m, 8,          \
+                               ({ __polluteregisters(); }), (EXPR));     \
+    } while (++Tries < EZBENCH_TRIES &&                                  \
+             (__testlib_getcore() != Core &&                             \
+              __testlib_getinterrupts() > Interrupts));                  \
+    if (Tries == EZBENCH_TRIES)                                          \
+      __testlib_ezbenchwarn(" memory strict");                           \
+    __testlib_ezbenchreport(NAME, MAX(.001, Speculative - Control),      \
+                            MAX(.001, MemoryStrict - Control));          \
+    __testlib_ezbenchrecord(NAME, 0, 0, &Samples, Control, Speculative,  \
+                            MemoryStrict, Core, Switches);               \
   } while (0)
 
 #define EZBENCH_N(NAME, N, EXPR)                                       \
@@ -158,28 +217,32 @@ COSMOPOLITAN_C_START_
       Core = __testlib_getcore();                                      \
       Interrupts = __testlib_getinterrupts();                          \
       (void)Toto;                                                      \
-      (void)Core;                                                      \
-      (void)Interrupts;                                                \
       EXPR;                                                            \
       Speculative = BENCHLOOPER(__startbench, __endbench, 32, (EXPR)); \
     } while (++Tries < EZBENCH_TRIES && !Speculative);                 \
     if (Tries == EZBENCH_TRIES)                                        \
       __testlib_ezbenchwarn("");                                       \
     __testlib_ezbenchreport_n(NAME, 'n', N, Speculative);              \
+    __testlib_ezbenchrecord(NAME, 'n', N, 0, 0, Speculative, 0, Core,  \
+                            __testlib_getinterrupts() - Interrupts);   \
   } while (0)
 
 #define EZBENCH_K(NAME, K, EXPR)                                        \
   do {                                                                  \
     int Core;                                                           \
     double Speculative;                                                 \
+    int64_t Interrupts;                                                 \
     do {                                                                \
       __testlib_yield();                                                \
       Core = __testlib_getcore();                                       \
+      Interrupts = __testlib_getinterrupts();                           \
       EXPR;                                                             \
       Speculative =                                                     \
           BENCHLOOPER(__startbench, __endbench, EZBENCH_COUNT, (EXPR)); \
     } while (Core != __testlib_getcore());                              \
     __testlib_ezbenchreport_n(NAME, 'k', K, Speculative);               \
+    __testlib_ezbenchrecord(NAME, 'k', K, 0, 0, Speculative, 0, Core,   \
+                            __testlib_getinterrupts() - Interrupts);    \
   } while (0)
 
 void __polluteregisters(void);
@@ -187,9 +250,15 @@ void __testlib_yield(void);
 int __testlib_getcore(void);
 int64_t __testlib_getinterrupts(void);
 double __testlib_ezbenchcontrol(void);
+double __testlib_ezbenchfreq(void);
 void __testlib_ezbenchwarn(const char *);
 void __testlib_ezbenchreport(const char *, double, double);
 void __testlib_ezbenchreport_n(const char *, char, size_t, double);
+void __testlib_ezbenchrecord(const char *, char, size_t,
+                             const struct EzBenchSamples *, double, double,
+                             double, int, int64_t);
+void __testlib_ezbenchstats(struct EzBenchStats *,
+                            const struct EzBenchSamples *, double);
 
 #ifdef __STRICT_ANSI__
 #undef EZBENCH2
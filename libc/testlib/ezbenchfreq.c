@@ -0,0 +1,52 @@
+/*-*- mode:c;indent-tabs-mode:nil;c-basic-offset:2;tab-width:8;coding:utf-8 -*-│
+│ vi: set et ft=c ts=2 sts=2 sw=2 fenc=utf-8                               :vi │
+╞══════════════════════════════════════════════════════════════════════════════╡
+│ Copyright 2024 Justine Alexandra Roberts Tunney                              │
+│                                                                              │
+│ Permission to use, copy, modify, and/or distribute this software for         │
+│ any purpose with or without fee is hereby granted, provided that the         │
+│ above copyright notice and this permission notice appear in all copies.      │
+│                                                                              │
+│ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL                │
+│ WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED                │
+│ WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE             │
+│ AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL         │
+│ DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR        │
+│ PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER               │
+│ TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR             │
+│ PERFORMANCE OF THIS SOFTWARE.                                                │
+╚─────────────────────────────────────────────────────────────────────────────*/
+#include "libc/calls/struct/timespec.h"
+#include "libc/nexgen32e/rdtsc.h"
+#include "libc/testlib/ezbench.h"
+
+static double g_ezbenchfreq;
+
+/**
+ * Returns number of timestamp counter ticks per nanosecond.
+ *
+ * The first call spends about ten milliseconds comparing the cpu
+ * timestamp counter against the monotonic clock. If that fails to
+ * produce a sane answer, then we assume a 3 GHz counter, which is the
+ * ratio the human readable reports used to hard code.
+ */
+double __testlib_ezbenchfreq(void) {
+  uint64_t t1, t2;
+  int64_t elapsed;
+  struct timespec s1, s2;
+  if (!g_ezbenchfreq) {
+    __testlib_yield();
+    s1 = timespec_mono();
+    t1 = rdtsc();
+    do {
+      s2 = timespec_mono();
+      elapsed = timespec_tonanos(timespec_sub(s2, s1));
+    } while (elapsed < 10000000);
+    t2 = rdtsc();
+    g_ezbenchfreq = (double)(t2 - t1) / elapsed;
+    if (!(g_ezbenchfreq > .001 && g_ezbenchfreq < 100)) {
+      g_ezbenchfreq = 3;
+    }
+  }
+  return g_ezbenchfreq;
+}
@@ -0,0 +1,199 @@
+/*-*- mode:c;indent-tabs-mode:nil;c-basic-offset:2;tab-width:8;coding:utf-8 -*-│
+│ vi: set et ft=c ts=2 sts=2 sw=2 fenc=utf-8                               :vi │
+╞══════════════════════════════════════════════════════════════════════════════╡
+│ Copyright 2024 Justine Alexandra Roberts Tunney                              │
+│                                                                              │
+│ Permission to use, copy, modify, and/or distribute this software for         │
+│ any purpose with or without fee is hereby granted, provided that the         │
+│ above copyright notice and this permission notice appear in all copies.      │
+│                                                                              │
+│ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL                │
+│ WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED                │
+│ WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE             │
+│ AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL         │
+│ DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR        │
+│ PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER               │
+│ TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR             │
+│ PERFORMANCE OF THIS SOFTWARE.                                                │
+╚─────────────────────────────────────────────────────────────────────────────*/
+#include "libc/calls/calls.h"
+#include "libc/errno.h"
+#include "libc/intrin/kprintf.h"
+#include "libc/mem/alg.h"
+#include "libc/mem/mem.h"
+#include "libc/runtime/runtime.h"
+#include "libc/stdio/append.h"
+#include "libc/str/str.h"
+#include "libc/sysv/consts/o.h"
+#include "libc/testlib/ezbench.h"
+
+/**
+ * @fileoverview machine readable benchmark results
+ *
+ * When the `EZBENCH_OUTPUT` environment variable is set, each EZBENCH
+ * macro appends one record to the named file. If the filename ends in
+ * `.csv` then comma separated values with a header row are written;
+ * otherwise each record is a single line json object, which also holds
+ * the individual samples. Multiple test binaries may append to the same
+ * file. Use `o//tool/build/benchdiff` to compare two such files.
+ */
+
+static const char kEzBenchCsvHeader[] =
+    "program,name,core,interrupts,ticks_per_ns,count,min_ns,median_ns,"
+    "p99_ns,mean_ns,stddev_ns,speculative_ns,strict_ns\n";
+
+static int g_ezbenchfd = -2;
+static bool g_ezbenchcsv;
+
+static int __testlib_ezbenchopen(void) {
+  int e;
+  size_t n;
+  const char *path;
+  if (g_ezbenchfd != -2)
+    return g_ezbenchfd;
+  g_ezbenchfd = -1;
+  if (!(path = getenv("EZBENCH_OUTPUT")) || !*path)
+    return -1;
+  e = errno;
+  if ((g_ezbenchfd = open(path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC,
+                          0644)) == -1) {
+    kprintf("%s: %m\n", path);
+    errno = e;
+    return -1;
+  }
+  n = strlen(path);
+  g_ezbenchcsv = n >= 4 && !strcasecmp(path + n - 4, ".csv");
+  if (g_ezbenchcsv && !lseek(g_ezbenchfd, 0, SEEK_END)) {
+    write(g_ezbenchfd, kEzBenchCsvHeader, sizeof(kEzBenchCsvHeader) - 1);
+  }
+  return g_ezbenchfd;
+}
+
+static int __testlib_ezbenchcmp(const void *a, const void *b) {
+  double x = *(const double *)a;
+  double y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+static double __testlib_ezbenchns(double cycles, double control) {
+  return MAX(.001, cycles - control) / __testlib_ezbenchfreq();
+}
+
+/**
+ * Computes distribution of benchmark samples.
+ *
+ * @param st receives statistics in nanoseconds
+ * @param s has cycle counts of individual iterations
+ * @param control is cycle overhead of measurement to subtract
+ */
+void __testlib_ezbenchstats(struct EzBenchStats *st,
+                            const struct EzBenchSamples *s, double control) {
+  double *v, sum, var;
+  unsigned long i, n;
+  bzero(st, sizeof(*st));
+  if (!(n = MIN(s->n, EZBENCH_SAMPLES)))
+    return;
+  if (!(v = malloc(n * sizeof(*v))))
+    return;
+  for (sum = i = 0; i < n; ++i)
+    sum += v[i] = __testlib_ezbenchns(s->p[i], control);
+  qsort(v, n, sizeof(*v), __testlib_ezbenchcmp);
+  st->count = n;
+  st->min = v[0];
+  st->median = n & 1 ? v[n / 2] : (v[n / 2 - 1] + v[n / 2]) / 2;
+  st->p99 = v[(n * 99 + 99) / 100 - 1];
+  st->mean = sum / n;
+  for (var = i = 0; i < n; ++i)
+    var += (v[i] - st->mean) * (v[i] - st->mean);
+  st->stddev = n > 1 ? sqrt(var / (n - 1)) : 0;
+  free(v);
+}
+
+static void __testlib_ezbenchquote(char **b, const char *s, bool csv) {
+  appendw(b, '"');
+  for (; *s; ++s) {
+    if (csv) {
+      if (*s == '"')
+        appendw(b, '"');
+      appendw(b, *s & 255);
+    } else if (*s == '"' || *s == '\\') {
+      appendw(b, '\\' | (*s & 255) << 8);
+    } else if ((*s & 255) < ' ') {
+      appendf(b, "\\u%04x", *s & 255);
+    } else {
+      appendw(b, *s & 255);
+    }
+  }
+  appendw(b, '"');
+}
+
+/**
+ * Appends benchmark result to `$EZBENCH_OUTPUT` if it's defined.
+ *
+ * @param form is name of benchmark
+ * @param z is 'n' or 'k' for sized benchmarks, otherwise 0
+ * @param n is size of sized benchmarks
+ * @param s has samples of speculative loop or null if unavailable
+ * @param control is cycle overhead of measurement
+ * @param c1 is average cycles of speculative loop
+ * @param c2 is average cycles of memory strict loop, or 0
+ * @param core is cpu on which benchmark ran
+ * @param interrupts is number of involuntary context switches
+ */
+void __testlib_ezbenchrecord(const char *form, char z, size_t n,
+                             const struct EzBenchSamples *s, double control,
+                             double c1, double c2, int core,
+                             int64_t interrupts) {
+  int fd;
+  char *b, *name;
+  unsigned long i;
+  struct EzBenchStats st;
+  if ((fd = __testlib_ezbenchopen()) == -1)
+    return;
+  if (s) {
+    __testlib_ezbenchstats(&st, s, control);
+  } else {
+    st.count = 1;
+    st.min = st.median = st.p99 = st.mean = __testlib_ezbenchns(c1, control);
+    st.stddev = 0;
+  }
+  b = 0;
+  name = 0;
+  if (z) {
+    appendf(&name, "%s %c=%zu", form, z, n);
+    form = name;
+  }
+  if (g_ezbenchcsv) {
+    __testlib_ezbenchquote(&b, program_invocation_short_name, true);
+    appendw(&b, ',');
+    __testlib_ezbenchquote(&b, form, true);
+    appendf(&b, ",%d,%ld,%.4f,%lu,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f\n", core,
+            interrupts, __testlib_ezbenchfreq(), st.count, st.min, st.median,
+            st.p99, st.mean, st.stddev, __testlib_ezbenchns(c1, control),
+            c2 ? __testlib_ezbenchns(c2, control) : 0.);
+  } else {
+    appends(&b, "{\"program\":");
+    __testlib_ezbenchquote(&b, program_invocation_short_name, false);
+    appends(&b, ",\"name\":");
+    __testlib_ezbenchquote(&b, form, false);
+    appendf(&b,
+            ",\"core\":%d,\"interrupts\":%ld,\"ticks_per_ns\":%.4f"
+            ",\"count\":%lu,\"min_ns\":%.3f,\"median_ns\":%.3f"
+            ",\"p99_ns\":%.3f,\"mean_ns\":%.3f,\"stddev_ns\":%.3f"
+            ",\"speculative_ns\":%.3f,\"strict_ns\":%.3f,\"samples_ns\":[",
+            core, interrupts, __testlib_ezbenchfreq(), st.count, st.min,
+            st.median, st.p99, st.mean, st.stddev,
+            __testlib_ezbenchns(c1, control),
+            c2 ? __testlib_ezbenchns(c2, control) : 0.);
+    if (s) {
+      for (i = 0; i < MIN(s->n, EZBENCH_SAMPLES); ++i) {
+        appendf(&b, "%s%.1f", i ? "," : "",
+                __testlib_ezbenchns(s->p[i], control));
+      }
+    }
+    appends(&b, "]}\n");
+  }
+  write(fd, b, appendz(b).i);
+  free(name);
+  free(b);
+}
@@ -20,11 +20,14 @@
 #include "libc/intrin/safemacros.internal.h"
 #include "libc/math.h"
 #include "libc/runtime/runtime.h"
+#include "libc/testlib/ezbench.h"
 
 void __testlib_ezbenchreport(const char *form, double c1, double c2) {
+  double f;
   __warn_if_powersave();
+  f = __testlib_ezbenchfreq();
   kprintf(" *     %-19s l: %,9luc %,9luns   m: %,9luc %,9luns\n", form,
-          lrint(c1), lrint(c1 / 3), lrint(c2), lrint(c2 / 3));
+          lrint(c1), lrint(c1 / f), lrint(c2), lrint(c2 / f));
 }
 
 void __testlib_ezbenchreport_n(const char *form, char z, size_t n, double c) {
@@ -33,7 +36,7 @@ void __testlib_ezbenchreport_n(const char *form, char z, size_t n, double c) {
   char msg[128];
   __warn_if_powersave();
   ksnprintf(msg, sizeof(msg), "%s %c=%d", form, z, n);
-  cn = max(lrint(c / 3), 1);
+  cn = max(lrint(c / __testlib_ezbenchfreq()), 1);
   if (!n) {
     kprintf("\n");
     kprintf(" *     %-28s", msg);
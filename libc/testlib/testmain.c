@@ -56,6 +56,10 @@ Flags:\n\
 \n\
   -b         run benchmarks if tests pass\n\
   -h         show this information\n\
+\n\
+Environment:\n\
+\n\
+  EZBENCH_OUTPUT   append benchmark results to json lines or csv file\n\
 \n"
 
 static bool runbenchmarks_;
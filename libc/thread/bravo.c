@@ -0,0 +1,166 @@
+/*-*- mode:c;indent-tabs-mode:nil;c-basic-offset:2;tab-width:8;coding:utf-8 -*-│
+│ vi: set et ft=c ts=2 sts=2 sw=2 fenc=utf-8                               :vi │
+╞══════════════════════════════════════════════════════════════════════════════╡
+│ Copyright 2024 Justine Alexandra Roberts Tunney                              │
+│                                                                              │
+│ Permission to use, copy, modify, and/or distribute this software for         │
+│ any purpose with or without fee is hereby granted, provided that the         │
+│ above copyright notice and this permission notice appear in all copies.      │
+│                                                                              │
+│ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL                │
+│ WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED                │
+│ WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE             │
+│ AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL         │
+│ DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR        │
+│ PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER               │
+│ TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR             │
+│ PERFORMANCE OF THIS SOFTWARE.                                                │
+╚─────────────────────────────────────────────────────────────────────────────*/
+#include "libc/calls/struct/timespec.h"
+#include "libc/intrin/atomic.h"
+#include "libc/macros.internal.h"
+#include "libc/thread/bravo.internal.h"
+#include "libc/thread/thread.h"
+#include "libc/thread/tls.h"
+
+/**
+ * @fileoverview biased reader-writer locks
+ *
+ * Read-write locks created with PTHREAD_RWLOCK_BIASED_READER_NP let
+ * readers avoid writing to the lock itself. Instead, when the lock is
+ * in reader bias mode, a reader publishes the lock address in a slot of
+ * a global table that's chosen by hashing its thread and the lock. Each
+ * reader on each core therefore touches its own cache line, and read
+ * mostly data structures keep scaling as cores are added.
+ *
+ * When a writer comes along, it takes the underlying nsync lock, turns
+ * reader bias off, and waits for the table to drain of that lock. This
+ * is expensive, so the lock isn't biased again until after a duration
+ * of nine times whatever the revocation cost. Readers that can't use
+ * the table (hash collision, bias off) just use the nsync lock.
+ *
+ * @see Dice and Kogan, "BRAVO — Biased Locking for Reader-Writer Locks",
+ *     USENIX ATC 2019
+ */
+
+#define BRAVO_SLOTS   4096  // size of global visible readers table
+#define BRAVO_HELD    8     // max fast read locks held by a thread
+#define BRAVO_INHIBIT 9     // penalty multiplier for revocation
+
+static _Atomic(pthread_rwlock_t *) __bravo_table[BRAVO_SLOTS];
+
+static _Thread_local struct {
+  unsigned n;
+  _Atomic(pthread_rwlock_t *) *slot[BRAVO_HELD];
+} __bravo_held;
+
+static int64_t __bravo_nanos(void) {
+  return timespec_tonanos(timespec_mono());
+}
+
+static _Atomic(pthread_rwlock_t *) *__bravo_slot(pthread_rwlock_t *rw) {
+  uint64_t x;
+  x = (uintptr_t)rw;
+  x ^= (uintptr_t)__get_tls() >> 6;
+  x *= 0x9e3779b97f4a7c15;
+  return __bravo_table + (x >> 52);
+}
+
+/**
+ * Attempts to acquire read lock without touching lock memory.
+ */
+bool __bravo_rdlock(pthread_rwlock_t *rw) {
+  pthread_rwlock_t *expect;
+  _Atomic(pthread_rwlock_t *) *slot;
+  if (!atomic_load_explicit(&rw->_rbias, memory_order_relaxed))
+    return false;
+  if (__bravo_held.n == BRAVO_HELD)
+    return false;
+  slot = __bravo_slot(rw);
+  expect = 0;
+  if (!atomic_compare_exchange_strong(slot, &expect, rw))
+    return false;
+  // a writer clears _rbias before scanning, and we publish before
+  // checking it, so one of us is guaranteed to see the other
+  if (!atomic_load(&rw->_rbias)) {
+    atomic_store_explicit(slot, 0, memory_order_relaxed);
+    return false;
+  }
+  __bravo_held.slot[__bravo_held.n++] = slot;
+  return true;
+}
+
+/**
+ * Releases read lock if it was acquired by __bravo_rdlock().
+ */
+bool __bravo_unlock(pthread_rwlock_t *rw) {
+  unsigned i;
+  for (i = __bravo_held.n; i--;) {
+    if (atomic_load_explicit(__bravo_held.slot[i], memory_order_relaxed) ==
+        rw) {
+      atomic_store_explicit(__bravo_held.slot[i], 0, memory_order_release);
+      __bravo_held.slot[i] = __bravo_held.slot[--__bravo_held.n];
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Turns reader bias back on once inhibition period has passed.
+ *
+ * This must be called while holding the underlying lock for reading.
+ */
+void __bravo_rebias(pthread_rwlock_t *rw) {
+  if (rw->_biased &&
+      !atomic_load_explicit(&rw->_rbias, memory_order_relaxed) &&
+      __bravo_nanos() >= rw->_inhibit) {
+    atomic_store_explicit(&rw->_rbias, 1, memory_order_relaxed);
+  }
+}
+
+static bool __bravo_hasreaders(pthread_rwlock_t *rw) {
+  int i;
+  for (i = 0; i < BRAVO_SLOTS; ++i)
+    if (atomic_load_explicit(__bravo_table + i, memory_order_acquire) == rw)
+      return true;
+  return false;
+}
+
+/**
+ * Turns off reader bias and waits for fast readers to leave.
+ *
+ * This must be called while holding the underlying lock for writing.
+ */
+void __bravo_revoke(pthread_rwlock_t *rw) {
+  int i;
+  int64_t start, now;
+  if (!atomic_load_explicit(&rw->_rbias, memory_order_relaxed))
+    return;
+  atomic_store(&rw->_rbias, 0);
+  start = __bravo_nanos();
+  for (i = 0; i < BRAVO_SLOTS; ++i)
+    while (atomic_load_explicit(__bravo_table + i, memory_order_acquire) ==
+           rw)
+      pthread_pause_np();
+  now = __bravo_nanos();
+  rw->_inhibit = now + (now - start) * BRAVO_INHIBIT;
+}
+
+/**
+ * Turns off reader bias unless there are fast readers.
+ *
+ * This must be called while holding the underlying lock for writing.
+ * If false is returned, then bias remains on and the caller must back
+ * out of its write lock.
+ */
+bool __bravo_tryrevoke(pthread_rwlock_t *rw) {
+  if (!atomic_load_explicit(&rw->_rbias, memory_order_relaxed))
+    return true;
+  atomic_store(&rw->_rbias, 0);
+  if (__bravo_hasreaders(rw)) {
+    atomic_store_explicit(&rw->_rbias, 1, memory_order_relaxed);
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,13 @@
+#ifndef COSMOPOLITAN_LIBC_THREAD_BRAVO_INTERNAL_H_
+#define COSMOPOLITAN_LIBC_THREAD_BRAVO_INTERNAL_H_
+#include "libc/thread/thread.h"
+COSMOPOLITAN_C_START_
+
+bool __bravo_rdlock(pthread_rwlock_t *);
+bool __bravo_unlock(pthread_rwlock_t *);
+void __bravo_rebias(pthread_rwlock_t *);
+void __bravo_revoke(pthread_rwlock_t *);
+bool __bravo_tryrevoke(pthread_rwlock_t *);
+
+COSMOPOLITAN_C_END_
+#endif /* COSMOPOLITAN_LIBC_THREAD_BRAVO_INTERNAL_H_ */
@@ -0,0 +1,541 @@
+/*-*- mode:c;indent-tabs-mode:nil;c-basic-offset:2;tab-width:8;coding:utf-8 -*-│
+│ vi: set et ft=c ts=2 sts=2 sw=2 fenc=utf-8                               :vi │
+╞══════════════════════════════════════════════════════════════════════════════╡
+│ Copyright 2024 Justine Alexandra Roberts Tunney                              │
+│                                                                              │
+│ Permission to use, copy, modify, and/or distribute this software for         │
+│ any purpose with or without fee is hereby granted, provided that the         │
+│ above copyright notice and this permission notice appear in all copies.      │
+│                                                                              │
+│ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL                │
+│ WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED                │
+│ WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE             │
+│ AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL         │
+│ DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR        │
+│ PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER               │
+│ TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR             │
+│ PERFORMANCE OF THIS SOFTWARE.                                                │
+╚─────────────────────────────────────────────────────────────────────────────*/
+#include "libc/thread/executor.h"
+#include "libc/calls/struct/cpuset.h"
+#include "libc/errno.h"
+#include "libc/intrin/atomic.h"
+#include "libc/limits.h"
+#include "libc/macros.internal.h"
+#include "libc/mem/mem.h"
+#include "libc/runtime/runtime.h"
+#include "libc/str/str.h"
+#include "libc/thread/thread.h"
+#include "libc/thread/thread2.h"
+#include "third_party/nsync/futex.internal.h"
+
+/**
+ * @fileoverview work stealing thread pool
+ *
+ * Every worker owns a Chase-Lev deque. Tasks submitted by a worker are
+ * pushed on the bottom of its own deque, which it pops without locking
+ * so recently forked work runs while it's still hot in cache. Workers
+ * that run dry steal from the top of a random victim's deque, and then
+ * park on a futex once nothing turns up. Threads that aren't workers
+ * submit to a shared inbox instead.
+ *
+ * Joining a task that hasn't started yet runs it on the joining thread
+ * which means nested fork/join never deadlocks, even if all workers are
+ * blocked in joins. Workers that join a running task help out with the
+ * other work in the pool until it finishes.
+ */
+
+#define DEQUE       1024
+#define SPINS       64
+#define MAX_THREADS 256
+#define OVERSPLIT   8
+
+enum {
+  kTaskPending,
+  kTaskRunning,
+  kTaskWaiting,
+  kTaskDone,
+};
+
+struct cosmo_task {
+  cosmo_task_f *func;
+  void *arg;
+  void *res;
+  struct cosmo_task *next;
+  atomic_int state;
+  atomic_int refs;
+};
+
+struct ExecutorDeque {
+  forcealign(64) atomic_long top;  // thieves take from here
+  forcealign(64) atomic_long bot;  // owner pushes and pops here
+  _Atomic(struct cosmo_task *) tasks[DEQUE];
+};
+
+struct ExecutorWorker {
+  struct ExecutorDeque q;
+  struct cosmo_executor *ex;
+  pthread_t th;
+  bool started;
+  int cpu;
+  uint64_t rand;
+};
+
+struct cosmo_executor {
+  int n;
+  int threads;
+  atomic_int stop;
+  atomic_int idle;
+  atomic_int signal;
+  atomic_long queued;
+  pthread_spinlock_t lock;
+  struct cosmo_task *head;
+  struct cosmo_task *tail;
+  struct ExecutorWorker *w;
+};
+
+struct ExecutorLoop {
+  atomic_long next;
+  long chunks;
+  unsigned long begin;
+  unsigned long end;
+  unsigned long chunk;
+  cosmo_for_f *func;
+  cosmo_map_f *map;
+  void *arg;
+  char *accs;
+  size_t size;
+};
+
+static _Thread_local struct ExecutorWorker *__executor_self;
+
+static bool cosmo_executor_push(struct ExecutorDeque *q, struct cosmo_task *t) {
+  long b, t0;
+  b = atomic_load_explicit(&q->bot, memory_order_relaxed);
+  t0 = atomic_load_explicit(&q->top, memory_order_acquire);
+  if (b - t0 >= DEQUE)
+    return false;
+  atomic_store_explicit(&q->tasks[b % DEQUE], t, memory_order_relaxed);
+  atomic_store_explicit(&q->bot, b + 1, memory_order_release);
+  return true;
+}
+
+static struct cosmo_task *cosmo_executor_pop(struct ExecutorDeque *q) {
+  long b, t0;
+  struct cosmo_task *t;
+  b = atomic_load_explicit(&q->bot, memory_order_relaxed) - 1;
+  atomic_store_explicit(&q->bot, b, memory_order_relaxed);
+  atomic_thread_fence(memory_order_seq_cst);
+  t0 = atomic_load_explicit(&q->top, memory_order_relaxed);
+  if (t0 > b) {
+    atomic_store_explicit(&q->bot, b + 1, memory_order_relaxed);
+    return 0;
+  }
+  t = atomic_load_explicit(&q->tasks[b % DEQUE], memory_order_relaxed);
+  if (t0 == b) {
+    // last item is being raced for by thieves
+    if (!atomic_compare_exchange_strong_explicit(&q->top, &t0, t0 + 1,
+                                                 memory_order_seq_cst,
+                                                 memory_order_relaxed))
+      t = 0;
+    atomic_store_explicit(&q->bot, b + 1, memory_order_relaxed);
+  }
+  return t;
+}
+
+static struct cosmo_task *cosmo_executor_steal(struct ExecutorDeque *q) {
+  long b, t0;
+  struct cosmo_task *t;
+  t0 = atomic_load_explicit(&q->top, memory_order_acquire);
+  atomic_thread_fence(memory_order_seq_cst);
+  b = atomic_load_explicit(&q->bot, memory_order_acquire);
+  if (t0 >= b)
+    return 0;
+  t = atomic_load_explicit(&q->tasks[t0 % DEQUE], memory_order_relaxed);
+  if (!atomic_compare_exchange_strong_explicit(&q->top, &t0, t0 + 1,
+                                               memory_order_seq_cst,
+                                               memory_order_relaxed))
+    return 0;
+  return t;
+}
+
+static void cosmo_executor_inject(struct cosmo_executor *ex,
+                                  struct cosmo_task *t) {
+  pthread_spin_lock(&ex->lock);
+  if (ex->tail)
+    ex->tail->next = t;
+  else
+    ex->head = t;
+  ex->tail = t;
+  atomic_fetch_add_explicit(&ex->queued, 1, memory_order_release);
+  pthread_spin_unlock(&ex->lock);
+}
+
+static struct cosmo_task *cosmo_executor_eject(struct cosmo_executor *ex) {
+  struct cosmo_task *t;
+  if (!atomic_load_explicit(&ex->queued, memory_order_acquire))
+    return 0;
+  pthread_spin_lock(&ex->lock);
+  if ((t = ex->head)) {
+    if (!(ex->head = t->next))
+      ex->tail = 0;
+    atomic_fetch_sub_explicit(&ex->queued, 1, memory_order_relaxed);
+  }
+  pthread_spin_unlock(&ex->lock);
+  return t;
+}
+
+static struct cosmo_task *cosmo_executor_take(struct cosmo_executor *ex,
+                                              struct ExecutorWorker *w) {
+  int i, j, n;
+  struct cosmo_task *t;
+  if ((t = cosmo_executor_pop(&w->q)))
+    return t;
+  if ((t = cosmo_executor_eject(ex)))
+    return t;
+  if ((n = ex->n) > 1) {
+    w->rand = w->rand * 6364136223846793005 + 1442695040888963407;
+    for (j = (w->rand >> 33) % n, i = 0; i < n; ++i, j = (j + 1) % n)
+      if (ex->w + j != w && (t = cosmo_executor_steal(&ex->w[j].q)))
+        return t;
+  }
+  return 0;
+}
+
+static void cosmo_executor_wake(struct cosmo_executor *ex) {
+  atomic_thread_fence(memory_order_seq_cst);
+  if (atomic_load_explicit(&ex->idle, memory_order_relaxed)) {
+    atomic_fetch_add_explicit(&ex->signal, 1, memory_order_release);
+    nsync_futex_wake_(&ex->signal, 1, PTHREAD_PROCESS_PRIVATE);
+  }
+}
+
+static void cosmo_task_unref(struct cosmo_task *t) {
+  if (atomic_fetch_sub_explicit(&t->refs, 1, memory_order_acq_rel) == 1)
+    free(t);
+}
+
+static void cosmo_task_run(struct cosmo_task *t) {
+  t->res = t->func(t->arg);
+  if (atomic_exchange_explicit(&t->state, kTaskDone, memory_order_acq_rel) ==
+      kTaskWaiting)
+    nsync_futex_wake_(&t->state, INT_MAX, PTHREAD_PROCESS_PRIVATE);
+}
+
+static void cosmo_task_execute(struct cosmo_task *t) {
+  int s = kTaskPending;
+  if (atomic_compare_exchange_strong_explicit(&t->state, &s, kTaskRunning,
+                                              memory_order_acquire,
+                                              memory_order_relaxed))
+    cosmo_task_run(t);
+  cosmo_task_unref(t);
+}
+
+static void *cosmo_executor_worker(void *arg) {
+  int seq, spins = 0;
+  struct cosmo_task *t;
+  struct ExecutorWorker *w = arg;
+  struct cosmo_executor *ex = w->ex;
+  __executor_self = w;
+  if (w->cpu >= 0) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(w->cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+  }
+  for (;;) {
+    if ((t = cosmo_executor_take(ex, w))) {
+      cosmo_task_execute(t);
+      spins = 0;
+    } else if (spins < SPINS) {
+      pthread_pause_np();
+      ++spins;
+    } else {
+      // announce we're going to sleep, then look once more for work,
+      // so a submitter either sees us as idle or we see its task.
+      seq = atomic_load_explicit(&ex->signal, memory_order_acquire);
+      atomic_fetch_add_explicit(&ex->idle, 1, memory_order_relaxed);
+      atomic_thread_fence(memory_order_seq_cst);
+      if ((t = cosmo_executor_take(ex, w))) {
+        atomic_fetch_sub_explicit(&ex->idle, 1, memory_order_relaxed);
+        cosmo_task_execute(t);
+      } else if (atomic_load_explicit(&ex->stop, memory_order_acquire)) {
+        atomic_fetch_sub_explicit(&ex->idle, 1, memory_order_relaxed);
+        break;
+      } else {
+        nsync_futex_wait_(&ex->signal, seq, PTHREAD_PROCESS_PRIVATE, 0);
+        atomic_fetch_sub_explicit(&ex->idle, 1, memory_order_relaxed);
+      }
+      spins = 0;
+    }
+  }
+  __executor_self = 0;
+  return 0;
+}
+
+/**
+ * Creates work stealing thread pool.
+ *
+ * Executors aren't inherited across fork(), since the child process
+ * won't have any of the worker threads.
+ *
+ * @param threads is number of workers, or zero to use one per cpu
+ * @param flags may have `COSMO_EXECUTOR_PIN` to set cpu affinity of
+ *     each worker, which is ignored on platforms that don't support it
+ * @return new executor, or null w/ errno
+ */
+struct cosmo_executor *cosmo_executor_create(int threads, int flags) {
+  int i, e, ncpu;
+  struct cosmo_executor *ex;
+  ncpu = __get_cpu_count();
+  if (threads <= 0)
+    threads = ncpu;
+  threads = MIN(MAX(threads, 1), MAX_THREADS);
+  if (!(ex = calloc(1, sizeof(*ex))))
+    return 0;
+  if (!(ex->w = memalign(64, threads * sizeof(*ex->w)))) {
+    free(ex);
+    return 0;
+  }
+  bzero(ex->w, threads * sizeof(*ex->w));
+  pthread_spin_init(&ex->lock, 0);
+  ex->n = threads;
+  for (i = 0; i < threads; ++i) {
+    ex->w[i].ex = ex;
+    ex->w[i].rand = i + 1;
+    ex->w[i].cpu = (flags & COSMO_EXECUTOR_PIN) ? i % MAX(ncpu, 1) : -1;
+  }
+  for (e = i = 0; i < threads; ++i) {
+    if (!(e = pthread_create(&ex->w[i].th, 0, cosmo_executor_worker,
+                             ex->w + i))) {
+      ex->w[i].started = true;
+      ++ex->threads;
+    } else {
+      break;
+    }
+  }
+  if (!ex->threads) {
+    cosmo_executor_destroy(ex);
+    errno = e;
+    return 0;
+  }
+  return ex;
+}
+
+/**
+ * Waits for submitted tasks to finish and destroys thread pool.
+ *
+ * Tasks which haven't been joined or detached may still be joined
+ * after the executor is destroyed.
+ */
+void cosmo_executor_destroy(struct cosmo_executor *ex) {
+  int i;
+  if (!ex)
+    return;
+  atomic_store_explicit(&ex->stop, 1, memory_order_release);
+  atomic_fetch_add_explicit(&ex->signal, 1, memory_order_release);
+  nsync_futex_wake_(&ex->signal, INT_MAX, PTHREAD_PROCESS_PRIVATE);
+  for (i = 0; i < ex->n; ++i)
+    if (ex->w[i].started)
+      pthread_join(ex->w[i].th, 0);
+  pthread_spin_destroy(&ex->lock);
+  free(ex->w);
+  free(ex);
+}
+
+/**
+ * Returns number of worker threads in pool.
+ */
+int cosmo_executor_threads(const struct cosmo_executor *ex) {
+  return ex->threads;
+}
+
+/**
+ * Schedules `func(arg)` to be called on thread pool.
+ *
+ * The returned handle must be passed to either cosmo_task_join() or
+ * cosmo_task_detach() exactly once, otherwise it leaks.
+ *
+ * @return task handle, or null w/ errno if out of memory
+ */
+struct cosmo_task *cosmo_executor_submit(struct cosmo_executor *ex,
+                                         cosmo_task_f *func, void *arg) {
+  struct cosmo_task *t;
+  struct ExecutorWorker *w;
+  if (!(t = malloc(sizeof(*t))))
+    return 0;
+  t->func = func;
+  t->arg = arg;
+  t->res = 0;
+  t->next = 0;
+  atomic_init(&t->state, kTaskPending);
+  atomic_init(&t->refs, 2);
+  if (!((w = __executor_self) && w->ex == ex && cosmo_executor_push(&w->q, t)))
+    cosmo_executor_inject(ex, t);
+  cosmo_executor_wake(ex);
+  return t;
+}
+
+/**
+ * Waits for task to finish and returns its result.
+ *
+ * If no worker has picked up the task yet, then it's run on the calling
+ * thread. If the caller is a worker, then it'll run other tasks in its
+ * pool while waiting. The handle is freed.
+ *
+ * @return value returned by task function
+ */
+void *cosmo_task_join(struct cosmo_task *t) {
+  int s;
+  void *res;
+  struct cosmo_task *u;
+  struct ExecutorWorker *w;
+  s = kTaskPending;
+  if (atomic_compare_exchange_strong_explicit(&t->state, &s, kTaskRunning,
+                                              memory_order_acquire,
+                                              memory_order_relaxed)) {
+    cosmo_task_run(t);
+  } else {
+    w = __executor_self;
+    while ((s = atomic_load_explicit(&t->state, memory_order_acquire)) !=
+           kTaskDone) {
+      if (w && (u = cosmo_executor_take(w->ex, w))) {
+        cosmo_task_execute(u);
+      } else if (s == kTaskWaiting ||
+                 atomic_compare_exchange_weak_explicit(
+                     &t->state, &s, kTaskWaiting, memory_order_relaxed,
+                     memory_order_relaxed)) {
+        nsync_futex_wait_(&t->state, kTaskWaiting, PTHREAD_PROCESS_PRIVATE,
+                          0);
+      }
+    }
+  }
+  res = t->res;
+  cosmo_task_unref(t);
+  return res;
+}
+
+/**
+ * Releases task handle without waiting for it to finish.
+ */
+void cosmo_task_detach(struct cosmo_task *t) {
+  cosmo_task_unref(t);
+}
+
+/**
+ * Returns true if task has finished.
+ */
+bool32 cosmo_task_done(const struct cosmo_task *t) {
+  return atomic_load_explicit(&t->state, memory_order_acquire) == kTaskDone;
+}
+
+static void *cosmo_executor_loop(void *arg) {
+  long i;
+  unsigned long b, e;
+  struct ExecutorLoop *l = arg;
+  while ((i = atomic_fetch_add_explicit(&l->next, 1, memory_order_relaxed)) <
+         l->chunks) {
+    b = l->begin + i * l->chunk;
+    e = l->end - b > l->chunk ? b + l->chunk : l->end;
+    if (l->map) {
+      l->map(l->arg, b, e, l->accs + i * l->size);
+    } else {
+      l->func(l->arg, b, e);
+    }
+  }
+  return 0;
+}
+
+static void cosmo_executor_split(struct cosmo_executor *ex,
+                                 struct ExecutorLoop *l, long begin, long end,
+                                 long grain) {
+  unsigned long n, chunks;
+  n = (unsigned long)end - (unsigned long)begin;
+  grain = MAX(grain, 1);
+  chunks = n / grain + !!(n % grain);
+  chunks = MIN(chunks, (ex->threads + 1ul) * OVERSPLIT);
+  l->chunk = n / chunks + !!(n % chunks);
+  l->chunks = n / l->chunk + !!(n % l->chunk);
+  l->begin = begin;
+  l->end = end;
+  atomic_init(&l->next, 0);
+}
+
+static void cosmo_executor_fanout(struct cosmo_executor *ex,
+                                  struct ExecutorLoop *l) {
+  int i, n;
+  struct cosmo_task *h[MAX_THREADS];
+  n = MIN(l->chunks - 1, ex->threads);
+  for (i = 0; i < n; ++i)
+    if (!(h[i] = cosmo_executor_submit(ex, cosmo_executor_loop, l)))
+      break;
+  cosmo_executor_loop(l);
+  while (i)
+    cosmo_task_join(h[--i]);
+}
+
+/**
+ * Calls `func(arg, b, e)` on disjoint subranges covering `[begin,end)`.
+ *
+ * The range is split into chunks of at least `grain` items, which are
+ * handed out dynamically to the calling thread and the pool workers.
+ * This function returns once all chunks have been processed.
+ *
+ * @param grain is smallest number of items worth giving a thread
+ * @return 0 on success, or EINVAL if `end < begin`
+ */
+errno_t cosmo_executor_parallel_for(struct cosmo_executor *ex, long begin,
+                                    long end, long grain, cosmo_for_f *func,
+                                    void *arg) {
+  struct ExecutorLoop l;
+  if (end < begin)
+    return EINVAL;
+  if (end == begin)
+    return 0;
+  cosmo_executor_split(ex, &l, begin, end, grain);
+  l.func = func;
+  l.map = 0;
+  l.arg = arg;
+  cosmo_executor_fanout(ex, &l);
+  return 0;
+}
+
+/**
+ * Reduces `[begin,end)` in parallel.
+ *
+ * Each chunk of the range gets its own accumulator of `size` bytes,
+ * initialized by copying `acc`, which `map(arg, b, e, chunkacc)` adds
+ * the items in its subrange to. The chunk accumulators are then folded
+ * into `acc` in order with `reduce(arg, acc, chunkacc)`. The result is
+ * deterministic for a given executor, even if `reduce` isn't
+ * commutative, but it may change with the number of threads.
+ *
+ * @param acc must hold the identity element on entry and receives the
+ *     result on return
+ * @return 0 on success, EINVAL if `end < begin`, or ENOMEM
+ */
+errno_t cosmo_executor_parallel_reduce(struct cosmo_executor *ex, long begin,
+                                       long end, long grain, void *acc,
+                                       size_t size, cosmo_map_f *map,
+                                       cosmo_reduce_f *reduce, void *arg) {
+  long i;
+  struct ExecutorLoop l;
+  if (end < begin)
+    return EINVAL;
+  if (end == begin)
+    return 0;
+  cosmo_executor_split(ex, &l, begin, end, grain);
+  if (!(l.accs = malloc(l.chunks * size)))
+    return ENOMEM;
+  for (i = 0; i < l.chunks; ++i)
+    memcpy(l.accs + i * size, acc, size);
+  l.func = 0;
+  l.map = map;
+  l.arg = arg;
+  l.size = size;
+  cosmo_executor_fanout(ex, &l);
+  for (i = 0; i < l.chunks; ++i)
+    reduce(arg, acc, l.accs + i * size);
+  free(l.accs);
+  return 0;
+}
@@ -0,0 +1,31 @@
+#ifndef COSMOPOLITAN_LIBC_THREAD_EXECUTOR_H_
+#define COSMOPOLITAN_LIBC_THREAD_EXECUTOR_H_
+
+#define COSMO_EXECUTOR_PIN 1 /* pin worker i to cpu i modulo ncpus */
+
+COSMOPOLITAN_C_START_
+
+struct cosmo_task;
+struct cosmo_executor;
+
+typedef void *cosmo_task_f(void *);
+typedef void cosmo_for_f(void *, long, long);
+typedef void cosmo_map_f(void *, long, long, void *);
+typedef void cosmo_reduce_f(void *, void *, const void *);
+
+struct cosmo_executor *cosmo_executor_create(int, int) libcesque;
+void cosmo_executor_destroy(struct cosmo_executor *) libcesque;
+int cosmo_executor_threads(const struct cosmo_executor *) libcesque;
+struct cosmo_task *cosmo_executor_submit(struct cosmo_executor *,
+                                         cosmo_task_f *, void *) libcesque;
+errno_t cosmo_executor_parallel_for(struct cosmo_executor *, long, long, long,
+                                    cosmo_for_f *, void *) libcesque;
+errno_t cosmo_executor_parallel_reduce(struct cosmo_executor *, long, long,
+                                       long, void *, size_t, cosmo_map_f *,
+                                       cosmo_reduce_f *, void *) libcesque;
+void *cosmo_task_join(struct cosmo_task *) libcesque;
+void cosmo_task_detach(struct cosmo_task *) libcesque;
+bool32 cosmo_task_done(const struct cosmo_task *) libcesque;
+
+COSMOPOLITAN_C_END_
+#endif /* COSMOPOLITAN_LIBC_THREAD_EXECUTOR_H_ */
@@ -0,0 +1,233 @@
+/*-*- mode:c;indent-tabs-mode:nil;c-basic-offset:2;tab-width:8;coding:utf-8 -*-│
+│ vi: set et ft=c ts=2 sts=2 sw=2 fenc=utf-8                               :vi │
+╞══════════════════════════════════════════════════════════════════════════════╡
+│ Copyright 2024 Justine Alexandra Roberts Tunney                              │
+│                                                                              │
+│ Permission to use, copy, modify, and/or distribute this software for         │
+│ any purpose with or without fee is hereby granted, provided that the         │
+│ above copyright notice and this permission notice appear in all copies.      │
+│                                                                              │
+│ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL                │
+│ WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED                │
+│ WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE             │
+│ AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL         │
+│ DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR        │
+│ PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER               │
+│ TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR             │
+│ PERFORMANCE OF THIS SOFTWARE.                                                │
+╚─────────────────────────────────────────────────────────────────────────────*/
+#include "libc/errno.h"
+#include "libc/intrin/atomic.h"
+#include "libc/macros.internal.h"
+#include "libc/mem/alg.h"
+#include "libc/mem/mem.h"
+#include "libc/runtime/runtime.h"
+#include "libc/str/str.h"
+#include "libc/sysv/errfuns.h"
+#include "libc/thread/executor.h"
+
+#define GRAIN 262144  // bytes of items a task should sort serially
+
+struct Msort {
+  size_t size;
+  size_t grain;
+  int (*cmp)(const void *, const void *, void *);
+  void *arg;
+  atomic_int err;
+  struct cosmo_executor *ex;
+};
+
+// sorts src, leaving the result in dst if todst, otherwise in src
+struct MsortSort {
+  struct Msort *m;
+  char *src, *dst;
+  size_t n;
+  bool todst;
+};
+
+// merges sorted arrays a and b into c
+struct MsortMerge {
+  struct Msort *m;
+  char *a, *b, *c;
+  size_t na, nb;
+};
+
+static void msort_par_merge(struct Msort *m, char *a, size_t na, char *b,
+                            size_t nb, char *c) {
+  size_t s = m->size;
+  char *ae = a + na * s, *be = b + nb * s;
+  while (a < ae && b < be) {
+    if (m->cmp(a, b, m->arg) <= 0) {
+      memcpy(c, a, s);
+      a += s;
+    } else {
+      memcpy(c, b, s);
+      b += s;
+    }
+    c += s;
+  }
+  memcpy(c, a, ae - a);
+  memcpy(c + (ae - a), b, be - b);
+}
+
+// returns number of items in sorted array a that are less than x, or
+// if upper is true, the number of items that are less than or equal
+static size_t msort_par_bisect(struct Msort *m, char *a, size_t n, char *x,
+                               bool upper) {
+  int c;
+  size_t l = 0, r = n, i;
+  while (l < r) {
+    i = l + (r - l) / 2;
+    c = m->cmp(a + i * m->size, x, m->arg);
+    if (c < 0 || (upper && !c)) {
+      l = i + 1;
+    } else {
+      r = i;
+    }
+  }
+  return l;
+}
+
+// runs func on a copy of arg in the thread pool, or returns null if it
+// had to run inline. the task's result is the copy, which joiners free
+static struct cosmo_task *msort_par_fork(struct Msort *m, void *func(void *),
+                                         void *arg, size_t size) {
+  void *u;
+  struct cosmo_task *h;
+  if ((u = malloc(size))) {
+    memcpy(u, arg, size);
+    if ((h = cosmo_executor_submit(m->ex, func, u)))
+      return h;
+    free(u);
+  }
+  func(arg);
+  return 0;
+}
+
+static void *msort_par_merge_task(void *arg) {
+  size_t i, k, s;
+  struct cosmo_task *h;
+  struct MsortMerge *t = arg, u;
+  s = t->m->size;
+  if (t->na + t->nb <= t->m->grain) {
+    msort_par_merge(t->m, t->a, t->na, t->b, t->nb, t->c);
+    return t;
+  }
+  // split the bigger array down the middle, and find where its
+  // middle item goes in the other array. when items are equal,
+  // the ones in `a` must stay on the left to keep sort stable.
+  if (t->na >= t->nb) {
+    i = t->na / 2;
+    k = msort_par_bisect(t->m, t->b, t->nb, t->a + i * s, false);
+  } else {
+    k = t->nb / 2;
+    i = msort_par_bisect(t->m, t->a, t->na, t->b + k * s, true);
+  }
+  u = *t;
+  u.a += i * s;
+  u.na -= i;
+  u.b += k * s;
+  u.nb -= k;
+  u.c += (i + k) * s;
+  h = msort_par_fork(t->m, msort_par_merge_task, &u, sizeof(u));
+  u = *t;
+  u.na = i;
+  u.nb = k;
+  msort_par_merge_task(&u);
+  if (h)
+    free(cosmo_task_join(h));
+  return t;
+}
+
+static void *msort_par_sort_task(void *arg) {
+  size_t h, s;
+  struct cosmo_task *f;
+  struct MsortMerge j;
+  struct MsortSort *t = arg, u;
+  s = t->m->size;
+  if (t->n <= t->m->grain) {
+    if (mergesort_r(t->src, t->n, s, t->m->cmp, t->m->arg) == -1)
+      atomic_store_explicit(&t->m->err, errno, memory_order_relaxed);
+    if (t->todst)
+      memcpy(t->dst, t->src, t->n * s);
+    return t;
+  }
+  // halves get sorted into whichever buffer we aren't merging into
+  h = t->n / 2;
+  u = *t;
+  u.src += h * s;
+  u.dst += h * s;
+  u.n -= h;
+  u.todst = !t->todst;
+  f = msort_par_fork(t->m, msort_par_sort_task, &u, sizeof(u));
+  u = *t;
+  u.n = h;
+  u.todst = !t->todst;
+  msort_par_sort_task(&u);
+  if (f)
+    free(cosmo_task_join(f));
+  j.m = t->m;
+  j.a = t->todst ? t->src : t->dst;
+  j.na = h;
+  j.b = j.a + h * s;
+  j.nb = t->n - h;
+  j.c = t->todst ? t->dst : t->src;
+  msort_par_merge_task(&j);
+  return t;
+}
+
+/**
+ * Sorts array using all the cores in your computer.
+ *
+ * This is a parallel merge sort. The array is split into pieces that a
+ * cosmo_executor thread pool sorts with mergesort_r(), while its idle
+ * workers steal from one another. The sorted pieces are then merged,
+ * and big merges are also split up between threads, by bisecting for
+ * where the middle of one array lands in the other. Small arrays are
+ * sorted on the calling thread without creating any threads.
+ *
+ * This function is stable, i.e. items that compare equal will stay in
+ * the same order. It needs `nmemb * size` bytes of extra memory.
+ *
+ * @param base is base of array
+ * @param nmemb is item count
+ * @param size is item width
+ * @param cmp is a callback returning <0, 0, or >0 and must be safe to
+ *     call from multiple threads at the same time
+ * @param arg will optionally be passed as the third argument to cmp
+ * @return 0 on success, or -1 w/ errno
+ * @raise ENOMEM if memory couldn't be allocated
+ * @raise EINVAL if size is too small
+ * @see qsort_r_par()
+ * @see mergesort_r()
+ */
+int mergesort_r_par(void *base, size_t nmemb, size_t size,
+                    int (*cmp)(const void *, const void *, void *),
+                    void *arg) {
+  size_t threads;
+  struct MsortSort t;
+  struct Msort m = {size, MAX(GRAIN / (size ? size : 1), 1024), cmp, arg};
+  if (size < sizeof(void *) / 2)
+    return einval();
+  threads = MIN((size_t)__get_cpu_count(), nmemb / m.grain);
+  if (threads <= 1)
+    return mergesort_r(base, nmemb, size, cmp, arg);
+  if (!(t.dst = malloc(nmemb * size)))
+    return -1;
+  if (!(m.ex = cosmo_executor_create(threads, 0))) {
+    free(t.dst);
+    return mergesort_r(base, nmemb, size, cmp, arg);
+  }
+  t.m = &m;
+  t.src = base;
+  t.n = nmemb;
+  t.todst = false;
+  msort_par_sort_task(&t);
+  cosmo_executor_destroy(m.ex);
+  free(t.dst);
+  if (m.err) {
+    errno = m.err;
+    return -1;
+  }
+  return 0;
+}
@@ -48,9 +48,9 @@ static char *_mktls_finish(struct CosmoTib **out_tib, char *mem,
   return mem;
 }
 
-static char *_mktls_below(struct CosmoTib **out_tib) {
+static char *_mktls_below(char *mem, struct CosmoTib **out_tib) {
   size_t siz;
-  char *mem, *tls;
+  char *tls;
   struct CosmoTib *tib;
 
   // Here's the TLS memory layout on x86_64
@@ -68,7 +68,8 @@ static char *_mktls_below(struct CosmoTib **out_tib) {
 
   siz = ROUNDUP(I(_tls_size) + sizeof(*tib), _Alignof(struct CosmoTib));
   siz = ROUNDUP(siz, _Alignof(struct CosmoTib));
-  mem = memalign(_Alignof(struct CosmoTib), siz);
+  if (!mem && !(mem = memalign(_Alignof(struct CosmoTib), siz)))
+    return 0;
 
   tib = (struct CosmoTib *)(mem + siz - sizeof(*tib));
   tls = mem + siz - sizeof(*tib) - I(_tls_size);
@@ -86,7 +87,7 @@ static char *_mktls_below(struct CosmoTib **out_tib) {
   return _mktls_finish(out_tib, mem, tib);
 }
 
-static char *_mktls_above(struct CosmoTib **out_tib) {
+static char *_mktls_above(char *mem, struct CosmoTib **out_tib) {
 
   // Here's the TLS memory layout on aarch64
   //
@@ -106,8 +107,7 @@ static char *_mktls_above(struct CosmoTib **out_tib) {
                 ROUNDUP(I(_tdata_size), I(_tbss_align)) +          //
                 I(_tbss_size);
 
-  char *mem = memalign(I(_tls_align), size);
-  if (!mem)
+  if (!mem && !(mem = memalign(I(_tls_align), size)))
     return 0;
 
   struct CosmoTib *tib =
@@ -140,8 +140,21 @@ static char *_mktls_above(struct CosmoTib **out_tib) {
  */
 char *_mktls(struct CosmoTib **out_tib) {
 #ifdef __x86_64__
-  return _mktls_below(out_tib);
+  return _mktls_below(0, out_tib);
+#else
+  return _mktls_above(0, out_tib);
+#endif
+}
+
+/**
+ * Reinitializes thread-local storage memory for reuse by new thread.
+ * @param mem was returned by an earlier call to _mktls()
+ * @return mem
+ */
+char *_mktls_reuse(char *mem, struct CosmoTib **out_tib) {
+#ifdef __x86_64__
+  return _mktls_below(mem, out_tib);
 #else
-  return _mktls_above(out_tib);
+  return _mktls_above(mem, out_tib);
 #endif
 }
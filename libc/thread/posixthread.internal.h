@@ -91,9 +91,16 @@ struct PosixThread {
   pthread_attr_t pt_attr;
 };
 
+struct PosixThreadCache {
+  int count;         // number of dead threads in list
+  int limit;         // see pthread_setcachesize_np()
+  struct Dll *list;  // most recently freed thread is first
+};
+
 typedef void (*atfork_f)(void);
 
 extern struct Dll *_pthread_list;
+extern struct PosixThreadCache _pthread_cache;
 extern struct PosixThread _pthread_static;
 extern _Atomic(pthread_key_dtor) _pthread_key_dtor[PTHREAD_KEYS_MAX];
 
@@ -103,6 +110,7 @@ int _pthread_setschedparam_freebsd(int, int, const struct sched_param *);
 int _pthread_tid(struct PosixThread *) libcesque;
 intptr_t _pthread_syshand(struct PosixThread *) libcesque;
 long _pthread_cancel_ack(void) libcesque;
+void _pthread_cache_trim(void) libcesque;
 void _pthread_decimate(void) libcesque;
 void _pthread_free(struct PosixThread *, bool) libcesque;
 void _pthread_init(void) libcesque;
@@ -67,12 +67,87 @@ __static_yoink("_pthread_onfork_child");
 #define MAP_ANON_OPENBSD  0x1000
 #define MAP_STACK_OPENBSD 0x4000
 
+struct PosixThreadCache _pthread_cache = {.limit = 16};
+
+static void _pthread_release(struct PosixThread *pt) {
+  if (pt->pt_flags & PT_OWNSTACK)
+    unassert(!munmap(pt->pt_attr.__stackaddr, pt->pt_attr.__stacksize));
+  free(pt->pt_tls);
+  free(pt);
+}
+
+// holds on to memory of dead thread so pthread_create() can reuse it
+static bool _pthread_cache_put(struct PosixThread *pt) {
+  bool cached = false;
+  _pthread_lock();
+  if (_pthread_cache.count < _pthread_cache.limit) {
+    dll_make_first(&_pthread_cache.list, &pt->list);
+    ++_pthread_cache.count;
+    cached = true;
+  }
+  _pthread_unlock();
+  return cached;
+}
+
+// takes dead thread from cache, preferring one with a compatible stack
+// if the object we get has a stack, then it's the one `attr` requested
+static struct PosixThread *_pthread_cache_take(const pthread_attr_t *attr) {
+  bool fits;
+  struct Dll *e;
+  size_t guardsize;
+  struct PosixThread *pt, *got;
+  fits = false;
+  got = 0;
+  guardsize = ROUNDUP(attr->__guardsize, getauxval(AT_PAGESZ));
+  _pthread_lock();
+  for (e = dll_first(_pthread_cache.list); e;
+       e = dll_next(_pthread_cache.list, e)) {
+    pt = POSIXTHREAD_CONTAINER(e);
+    if (!got)
+      got = pt;
+    if (attr->__stackaddr ? !(pt->pt_flags & PT_OWNSTACK)
+                          : ((pt->pt_flags & PT_OWNSTACK) &&
+                             pt->pt_attr.__stacksize == attr->__stacksize &&
+                             pt->pt_attr.__guardsize == guardsize)) {
+      got = pt;
+      fits = true;
+      break;
+    }
+  }
+  if (got) {
+    dll_remove(&_pthread_cache.list, &got->list);
+    --_pthread_cache.count;
+  }
+  _pthread_unlock();
+  if (got && !fits && (got->pt_flags & PT_OWNSTACK)) {
+    unassert(!munmap(got->pt_attr.__stackaddr, got->pt_attr.__stacksize));
+    got->pt_flags &= ~PT_OWNSTACK;
+  }
+  return got;
+}
+
+/**
+ * Releases stacks and memory of exited threads kept for reuse.
+ *
+ * This is called by malloc_trim().
+ */
+void _pthread_cache_trim(void) {
+  struct Dll *e, *list;
+  _pthread_lock();
+  list = _pthread_cache.list;
+  _pthread_cache.list = 0;
+  _pthread_cache.count = 0;
+  _pthread_unlock();
+  while ((e = dll_first(list))) {
+    dll_remove(&list, e);
+    _pthread_release(POSIXTHREAD_CONTAINER(e));
+  }
+}
+
 void _pthread_free(struct PosixThread *pt, bool isfork) {
   unassert(dll_is_alone(&pt->list) && &pt->list != _pthread_list);
   if (pt->pt_flags & PT_STATIC)
     return;
-  if (pt->pt_flags & PT_OWNSTACK)
-    unassert(!munmap(pt->pt_attr.__stackaddr, pt->pt_attr.__stacksize));
   if (!isfork) {
     uint64_t syshand =
         atomic_load_explicit(&pt->tib->tib_syshand, memory_order_acquire);
@@ -83,8 +158,8 @@ void _pthread_free(struct PosixThread *pt, bool isfork) {
         __syslib->__pthread_join(syshand, 0);
     }
   }
-  free(pt->pt_tls);
-  free(pt);
+  if (!_pthread_cache_put(pt))
+    _pthread_release(pt);
 }
 
 void _pthread_decimate(void) {
@@ -171,10 +246,30 @@ static errno_t pthread_create_impl(pthread_t *thread,
                                    void *(*start_routine)(void *), void *arg,
                                    sigset_t oldsigs) {
   int rc, e = errno;
+  char *tls;
+  pthread_attr_t defattr;
   struct PosixThread *pt;
 
-  // create posix thread object
-  if (!(pt = calloc(1, sizeof(struct PosixThread)))) {
+  if (!attr) {
+    pthread_attr_init(&defattr);
+    attr = &defattr;
+  }
+
+  // create posix thread object and thread local storage memory
+  // memory of a recently joined thread is recycled, if possible
+  if ((pt = _pthread_cache_take(attr))) {
+    int flags = pt->pt_flags & PT_OWNSTACK;
+    tls = pt->pt_tls;
+    bzero(pt, offsetof(struct PosixThread, pt_attr));
+    pt->pt_flags = flags;
+    pt->pt_tls = _mktls_reuse(tls, &pt->tib);
+  } else if ((pt = calloc(1, sizeof(struct PosixThread)))) {
+    if (!(pt->pt_tls = _mktls(&pt->tib))) {
+      free(pt);
+      errno = e;
+      return EAGAIN;
+    }
+  } else {
     errno = e;
     return EAGAIN;
   }
@@ -182,34 +277,37 @@ static errno_t pthread_create_impl(pthread_t *thread,
   pt->pt_start = start_routine;
   pt->pt_arg = arg;
 
-  // create thread local storage memory
-  if (!(pt->pt_tls = _mktls(&pt->tib))) {
-    free(pt);
-    errno = e;
-    return EAGAIN;
-  }
-
-  // setup attributes
-  if (attr) {
-    pt->pt_attr = *attr;
-    attr = 0;
-  } else {
-    pthread_attr_init(&pt->pt_attr);
-  }
-
   // setup stack
-  if (pt->pt_attr.__stackaddr) {
+  if (attr->__stackaddr) {
     // caller supplied their own stack
     // assume they know what they're doing as much as possible
+    pt->pt_attr = *attr;
     if (IsOpenbsd()) {
       if ((rc = FixupCustomStackOnOpenbsd(&pt->pt_attr))) {
         _pthread_free(pt, false);
         return rc;
       }
     }
+  } else if (pt->pt_flags & PT_OWNSTACK) {
+    // reuse stack of a joined thread, which has the same size and guard
+    void *stackaddr = pt->pt_attr.__stackaddr;
+    size_t guardsize = pt->pt_attr.__guardsize;
+    pt->pt_attr = *attr;
+    pt->pt_attr.__stackaddr = stackaddr;
+    pt->pt_attr.__guardsize = guardsize;
+    if (IsWindows() && guardsize) {
+      // windows guard pages only fire once, so the previous thread may
+      // have consumed it, whereas mprotect() stays in effect elsewhere
+      uint32_t oldattr;
+      if (!VirtualProtect(stackaddr, guardsize,
+                          kNtPageReadwrite | kNtPageGuard, &oldattr)) {
+        notpossible;
+      }
+    }
   } else {
     // cosmo is managing the stack
     int pagesize = getauxval(AT_PAGESZ);
+    pt->pt_attr = *attr;
     pt->pt_attr.__guardsize = ROUNDUP(pt->pt_attr.__guardsize, pagesize);
     pt->pt_attr.__stacksize = pt->pt_attr.__stacksize;
     if (pt->pt_attr.__guardsize + pagesize > pt->pt_attr.__stacksize) {
@@ -255,6 +353,7 @@ static errno_t pthread_create_impl(pthread_t *thread,
     }
     pt->pt_flags |= PT_OWNSTACK;
   }
+  attr = 0;
 
   // set initial status
   pt->tib->tib_pthread = (pthread_t)pt;
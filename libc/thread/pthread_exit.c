@@ -33,6 +33,7 @@
 #include "libc/thread/posixthread.internal.h"
 #include "libc/thread/thread.h"
 #include "libc/thread/tls.h"
+#include "third_party/dlmalloc/dlmalloc.h"
 #include "third_party/nsync/futex.internal.h"
 #include "third_party/nsync/wait_s.internal.h"
 
@@ -83,6 +84,8 @@ wontreturn void pthread_exit(void *rc) {
   // free resources
   __cxa_thread_finalize();
   _pthread_decimate();
+  if (_weaken(dlmalloc_thread_exit))
+    _weaken(dlmalloc_thread_exit)();
 
   // run atexit handlers if orphaned thread
   if (pthread_orphan_np()) {
@@ -23,9 +23,16 @@
  *
  * @param attr may be null
  * @return 0 on success, or error number on failure
+ * @see pthread_rwlockattr_setkind_np()
  */
 errno_t pthread_rwlock_init(pthread_rwlock_t *rwlock,
                             const pthread_rwlockattr_t *attr) {
+  int kind;
   *rwlock = (pthread_rwlock_t){0};
+  if (attr && !pthread_rwlockattr_getkind_np(attr, &kind) &&
+      kind == PTHREAD_RWLOCK_BIASED_READER_NP) {
+    rwlock->_biased = 1;
+    rwlock->_rbias = 1;
+  }
   return 0;
 }
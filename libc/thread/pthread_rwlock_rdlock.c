@@ -16,6 +16,7 @@
 │ TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR             │
 │ PERFORMANCE OF THIS SOFTWARE.                                                │
 ╚─────────────────────────────────────────────────────────────────────────────*/
+#include "libc/thread/bravo.internal.h"
 #include "libc/thread/thread.h"
 #include "third_party/nsync/mu.h"
 
@@ -25,6 +26,13 @@
  * @return 0 on success, or errno on error
  */
 errno_t pthread_rwlock_rdlock(pthread_rwlock_t *rwlock) {
+  if (rwlock->_biased) {
+    if (__bravo_rdlock(rwlock))
+      return 0;
+    nsync_mu_rlock((nsync_mu *)rwlock);
+    __bravo_rebias(rwlock);
+    return 0;
+  }
   nsync_mu_rlock((nsync_mu *)rwlock);
   return 0;
 }
@@ -17,6 +17,7 @@
 │ PERFORMANCE OF THIS SOFTWARE.                                                │
 ╚─────────────────────────────────────────────────────────────────────────────*/
 #include "libc/errno.h"
+#include "libc/thread/bravo.internal.h"
 #include "libc/thread/thread.h"
 #include "third_party/nsync/mu.h"
 
@@ -29,7 +30,11 @@
  * @raise EINVAL if `rwlock` doesn't refer to an initialized r/w lock
  */
 errno_t pthread_rwlock_tryrdlock(pthread_rwlock_t *rwlock) {
+  if (rwlock->_biased && __bravo_rdlock(rwlock))
+    return 0;
   if (nsync_mu_rtrylock((nsync_mu *)rwlock)) {
+    if (rwlock->_biased)
+      __bravo_rebias(rwlock);
     return 0;
   } else {
     return EBUSY;
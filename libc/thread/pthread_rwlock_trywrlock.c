@@ -17,6 +17,7 @@
 │ PERFORMANCE OF THIS SOFTWARE.                                                │
 ╚─────────────────────────────────────────────────────────────────────────────*/
 #include "libc/errno.h"
+#include "libc/thread/bravo.internal.h"
 #include "libc/thread/thread.h"
 #include "third_party/nsync/mu.h"
 
@@ -29,6 +30,10 @@
  */
 errno_t pthread_rwlock_trywrlock(pthread_rwlock_t *rwlock) {
   if (nsync_mu_trylock((nsync_mu *)rwlock)) {
+    if (rwlock->_biased && !__bravo_tryrevoke(rwlock)) {
+      nsync_mu_unlock((nsync_mu *)rwlock);
+      return EBUSY;
+    }
     rwlock->_iswrite = 1;
     return 0;
   } else {
@@ -16,6 +16,7 @@
 │ TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR             │
 │ PERFORMANCE OF THIS SOFTWARE.                                                │
 ╚─────────────────────────────────────────────────────────────────────────────*/
+#include "libc/thread/bravo.internal.h"
 #include "libc/thread/thread.h"
 #include "third_party/nsync/mu.h"
 
@@ -29,7 +30,7 @@ errno_t pthread_rwlock_unlock(pthread_rwlock_t *rwlock) {
   if (rwlock->_iswrite) {
     rwlock->_iswrite = 0;
     nsync_mu_unlock((nsync_mu *)rwlock);
-  } else {
+  } else if (!rwlock->_biased || !__bravo_unlock(rwlock)) {
     nsync_mu_runlock((nsync_mu *)rwlock);
   }
   return 0;
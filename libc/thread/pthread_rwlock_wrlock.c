@@ -16,6 +16,7 @@
 │ TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR             │
 │ PERFORMANCE OF THIS SOFTWARE.                                                │
 ╚─────────────────────────────────────────────────────────────────────────────*/
+#include "libc/thread/bravo.internal.h"
 #include "libc/thread/thread.h"
 #include "third_party/nsync/mu.h"
 
@@ -26,6 +27,8 @@
  */
 errno_t pthread_rwlock_wrlock(pthread_rwlock_t *rwlock) {
   nsync_mu_lock((nsync_mu *)rwlock);
+  if (rwlock->_biased)
+    __bravo_revoke(rwlock);
   rwlock->_iswrite = 1;
   return 0;
 }
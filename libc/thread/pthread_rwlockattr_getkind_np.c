@@ -0,0 +1,36 @@
+/*-*- mode:c;indent-tabs-mode:nil;c-basic-offset:2;tab-width:8;coding:utf-8 -*-│
+│ vi: set et ft=c ts=2 sts=2 sw=2 fenc=utf-8                               :vi │
+╞══════════════════════════════════════════════════════════════════════════════╡
+│ Copyright 2024 Justine Alexandra Roberts Tunney                              │
+│                                                                              │
+│ Permission to use, copy, modify, and/or distribute this software for         │
+│ any purpose with or without fee is hereby granted, provided that the         │
+│ above copyright notice and this permission notice appear in all copies.      │
+│                                                                              │
+│ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL                │
+│ WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED                │
+│ WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE             │
+│ AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL         │
+│ DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR        │
+│ PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER               │
+│ TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR             │
+│ PERFORMANCE OF THIS SOFTWARE.                                                │
+╚─────────────────────────────────────────────────────────────────────────────*/
+#include "libc/thread/thread.h"
+
+/**
+ * Gets read-write lock preference.
+ *
+ * @param kind is set to one of the following
+ *     - `PTHREAD_RWLOCK_PREFER_READER_NP` (default)
+ *     - `PTHREAD_RWLOCK_PREFER_WRITER_NP`
+ *     - `PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP`
+ *     - `PTHREAD_RWLOCK_BIASED_READER_NP`
+ * @return 0 on success, or error on failure
+ * @see pthread_rwlockattr_setkind_np()
+ */
+errno_t pthread_rwlockattr_getkind_np(const pthread_rwlockattr_t *attr,
+                                      int *kind) {
+  *kind = *attr >> 1 & 3;
+  return 0;
+}
@@ -28,6 +28,6 @@
  */
 errno_t pthread_rwlockattr_getpshared(const pthread_rwlockattr_t *attr,
                                       int *pshared) {
-  *pshared = *attr;
+  *pshared = *attr & 1;
   return 0;
 }
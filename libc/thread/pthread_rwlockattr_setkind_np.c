@@ -0,0 +1,49 @@
+/*-*- mode:c;indent-tabs-mode:nil;c-basic-offset:2;tab-width:8;coding:utf-8 -*-│
+│ vi: set et ft=c ts=2 sts=2 sw=2 fenc=utf-8                               :vi │
+╞══════════════════════════════════════════════════════════════════════════════╡
+│ Copyright 2024 Justine Alexandra Roberts Tunney                              │
+│                                                                              │
+│ Permission to use, copy, modify, and/or distribute this software for         │
+│ any purpose with or without fee is hereby granted, provided that the         │
+│ above copyright notice and this permission notice appear in all copies.      │
+│                                                                              │
+│ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL                │
+│ WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED                │
+│ WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE             │
+│ AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL         │
+│ DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR        │
+│ PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER               │
+│ TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR             │
+│ PERFORMANCE OF THIS SOFTWARE.                                                │
+╚─────────────────────────────────────────────────────────────────────────────*/
+#include "libc/errno.h"
+#include "libc/thread/thread.h"
+
+/**
+ * Sets read-write lock preference.
+ *
+ * @param kind can be one of
+ *     - `PTHREAD_RWLOCK_PREFER_READER_NP` (default)
+ *     - `PTHREAD_RWLOCK_PREFER_WRITER_NP`
+ *     - `PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP`
+ *     - `PTHREAD_RWLOCK_BIASED_READER_NP` makes read locking scale
+ *       linearly with the number of cores, by having readers announce
+ *       themselves in a global table rather than modifying the lock;
+ *       in exchange, write locking becomes very expensive whenever it
+ *       needs to revoke that bias, so only use it on locks that are
+ *       hardly ever written
+ * @return 0 on success, or error on failure
+ * @raises EINVAL if `kind` is invalid
+ */
+errno_t pthread_rwlockattr_setkind_np(pthread_rwlockattr_t *attr, int kind) {
+  switch (kind) {
+    case PTHREAD_RWLOCK_PREFER_READER_NP:
+    case PTHREAD_RWLOCK_PREFER_WRITER_NP:
+    case PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP:
+    case PTHREAD_RWLOCK_BIASED_READER_NP:
+      *attr = (*attr & 1) | kind << 1;
+      return 0;
+    default:
+      return EINVAL;
+  }
+}
@@ -31,7 +31,7 @@
 errno_t pthread_rwlockattr_setpshared(pthread_rwlockattr_t *attr, int pshared) {
   switch (pshared) {
     case PTHREAD_PROCESS_PRIVATE:
-      *attr = pshared;
+      *attr = (*attr & ~1) | pshared;
       return 0;
     default:
       return EINVAL;
@@ -0,0 +1,46 @@
+/*-*- mode:c;indent-tabs-mode:nil;c-basic-offset:2;tab-width:8;coding:utf-8 -*-│
+│ vi: set et ft=c ts=2 sts=2 sw=2 fenc=utf-8                               :vi │
+╞══════════════════════════════════════════════════════════════════════════════╡
+│ Copyright 2024 Justine Alexandra Roberts Tunney                              │
+│                                                                              │
+│ Permission to use, copy, modify, and/or distribute this software for         │
+│ any purpose with or without fee is hereby granted, provided that the         │
+│ above copyright notice and this permission notice appear in all copies.      │
+│                                                                              │
+│ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL                │
+│ WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED                │
+│ WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE             │
+│ AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL         │
+│ DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR        │
+│ PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER               │
+│ TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR             │
+│ PERFORMANCE OF THIS SOFTWARE.                                                │
+╚─────────────────────────────────────────────────────────────────────────────*/
+#include "libc/thread/posixthread.internal.h"
+#include "libc/thread/thread.h"
+
+/**
+ * Sets maximum number of exited threads whose memory is kept for reuse.
+ *
+ * When a thread is joined, or a detached thread exits, its stack and
+ * thread local storage are cached, so that a later pthread_create()
+ * wanting the same stack size and guard size needn't mmap(), mprotect()
+ * and munmap() them again. This matters for programs that spawn many
+ * short-lived threads. The cache holds 16 threads by default. It's
+ * emptied by malloc_trim().
+ *
+ * @param count is the new limit, or negative to leave it unchanged,
+ *     where lowering it releases everything that's currently cached
+ * @return previous limit
+ */
+int pthread_setcachesize_np(int count) {
+  int old;
+  _pthread_lock();
+  old = _pthread_cache.limit;
+  if (count >= 0)
+    _pthread_cache.limit = count;
+  _pthread_unlock();
+  if (0 <= count && count < old)
+    _pthread_cache_trim();
+  return old;
+}
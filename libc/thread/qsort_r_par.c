@@ -0,0 +1,166 @@
+/*-*- mode:c;indent-tabs-mode:nil;c-basic-offset:2;tab-width:8;coding:utf-8 -*-│
+│ vi: set et ft=c ts=2 sts=2 sw=2 fenc=utf-8                               :vi │
+╞══════════════════════════════════════════════════════════════════════════════╡
+│ Copyright 2024 Justine Alexandra Roberts Tunney                              │
+│                                                                              │
+│ Permission to use, copy, modify, and/or distribute this software for         │
+│ any purpose with or without fee is hereby granted, provided that the         │
+│ above copyright notice and this permission notice appear in all copies.      │
+│                                                                              │
+│ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL                │
+│ WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED                │
+│ WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE             │
+│ AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL         │
+│ DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR        │
+│ PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER               │
+│ TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR             │
+│ PERFORMANCE OF THIS SOFTWARE.                                                │
+╚─────────────────────────────────────────────────────────────────────────────*/
+#include "libc/macros.internal.h"
+#include "libc/mem/alg.h"
+#include "libc/mem/mem.h"
+#include "libc/runtime/runtime.h"
+#include "libc/thread/executor.h"
+
+#define GRAIN 262144  // bytes of items a task should sort serially
+
+struct Qsort {
+  size_t size;
+  size_t grain;
+  int (*cmp)(const void *, const void *, void *);
+  void *arg;
+  struct cosmo_executor *ex;
+};
+
+struct QsortTask {
+  struct Qsort *q;
+  char *base;
+  size_t n;
+  int depth;
+};
+
+static void qsort_par_swap(char *a, char *b, size_t n) {
+  if (!(((uintptr_t)a | (uintptr_t)b | n) & (sizeof(long) - 1))) {
+    long t, *x = (long *)a, *y = (long *)b;
+    for (n /= sizeof(long); n--; ++x, ++y)
+      t = *x, *x = *y, *y = t;
+  } else {
+    char t;
+    for (; n--; ++a, ++b)
+      t = *a, *a = *b, *b = t;
+  }
+}
+
+static char *qsort_par_med3(struct Qsort *q, char *a, char *b, char *c) {
+  return q->cmp(a, b, q->arg) < 0
+             ? (q->cmp(b, c, q->arg) < 0   ? b
+                : q->cmp(a, c, q->arg) < 0 ? c
+                                           : a)
+             : (q->cmp(b, c, q->arg) > 0   ? b
+                : q->cmp(a, c, q->arg) > 0 ? c
+                                           : a);
+}
+
+// partitions array around pseudomedian and returns its final index
+// afterwards a[0,j) <= a[j] <= a[j+1,n) holds true
+static size_t qsort_par_partition(struct Qsort *q, char *a, size_t n) {
+  size_t i, j, s = q->size, d = n / 8;
+  char *lo = a, *mi = a + n / 2 * s, *hi = a + (n - 1) * s;
+  lo = qsort_par_med3(q, lo, lo + d * s, lo + 2 * d * s);
+  mi = qsort_par_med3(q, mi - d * s, mi, mi + d * s);
+  hi = qsort_par_med3(q, hi - 2 * d * s, hi - d * s, hi);
+  qsort_par_swap(a, qsort_par_med3(q, lo, mi, hi), s);
+  // sedgewick partition stops on equal keys in both directions, so it
+  // splits arrays with lots of duplicates down the middle
+  i = 0, j = n;
+  for (;;) {
+    while (++i < n && q->cmp(a + i * s, a, q->arg) < 0) {
+    }
+    while (q->cmp(a + --j * s, a, q->arg) > 0) {
+    }
+    if (i >= j)
+      break;
+    qsort_par_swap(a + i * s, a + j * s, s);
+  }
+  qsort_par_swap(a, a + j * s, s);
+  return j;
+}
+
+static void *qsort_par_task(void *arg) {
+  size_t j;
+  char *base;
+  int i, forks;
+  struct QsortTask *t, *u;
+  struct cosmo_task *h[128];
+  t = arg;
+  for (forks = 0; t->n > t->q->grain && t->depth;) {
+    --t->depth;
+    j = qsort_par_partition(t->q, t->base, t->n);
+    if (!(u = malloc(sizeof(*u))))
+      break;
+    // fork the bigger half, so it's what other threads tend to steal
+    // and continue with the smaller half, which bounds deque growth
+    base = t->base + (j + 1) * t->q->size;
+    *u = *t;
+    if (j < t->n - j - 1) {
+      u->base = base;
+      u->n = t->n - j - 1;
+      t->n = j;
+    } else {
+      u->n = j;
+      t->base = base;
+      t->n = t->n - j - 1;
+    }
+    if ((h[forks] = cosmo_executor_submit(t->q->ex, qsort_par_task, u))) {
+      ++forks;
+    } else {
+      qsort_par_task(u);
+    }
+  }
+  qsort_r(t->base, t->n, t->q->size, t->q->cmp, t->q->arg);
+  for (i = forks; i--;)
+    cosmo_task_join(h[i]);
+  free(t);
+  return 0;
+}
+
+/**
+ * Sorts array using all the cores in your computer.
+ *
+ * This is a parallel quicksort. The array is partitioned in place and
+ * the pieces are forked onto a cosmo_executor thread pool, whose idle
+ * workers steal from each other when they run out. Pieces smaller than
+ * a few hundred kilobytes are finished with qsort_r(). Small arrays are
+ * sorted on the calling thread without creating any threads.
+ *
+ * This function isn't stable. Use mergesort_r_par() for that.
+ *
+ * @param base is base of array
+ * @param nmemb is item count
+ * @param size is item width
+ * @param cmp is a callback returning <0, 0, or >0 and must be safe to
+ *     call from multiple threads at the same time
+ * @param arg will optionally be passed as the third argument to cmp
+ * @see mergesort_r_par()
+ * @see qsort_r()
+ */
+void qsort_r_par(void *base, size_t nmemb, size_t size,
+                 int (*cmp)(const void *, const void *, void *), void *arg) {
+  size_t threads;
+  struct QsortTask *t;
+  struct Qsort q = {size, MAX(GRAIN / (size ? size : 1), 1024), cmp, arg};
+  threads = MIN((size_t)__get_cpu_count(), nmemb / q.grain);
+  if (threads > 1 && (t = malloc(sizeof(*t)))) {
+    if ((q.ex = cosmo_executor_create(threads, 0))) {
+      t->q = &q;
+      t->base = base;
+      t->n = nmemb;
+      t->depth = 2 * (64 - __builtin_clzll(nmemb));
+      qsort_par_task(t);
+      cosmo_executor_destroy(q.ex);
+      return;
+    }
+    free(t);
+  }
+  qsort_r(base, nmemb, size, cmp, arg);
+}
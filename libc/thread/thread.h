@@ -17,6 +17,11 @@
 #define PTHREAD_PROCESS_PRIVATE 0
 #define PTHREAD_PROCESS_SHARED  1
 
+#define PTHREAD_RWLOCK_PREFER_READER_NP              0
+#define PTHREAD_RWLOCK_PREFER_WRITER_NP              1
+#define PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP 2
+#define PTHREAD_RWLOCK_BIASED_READER_NP              3
+
 #define PTHREAD_CREATE_JOINABLE 0
 #define PTHREAD_CREATE_DETACHED 1
 
@@ -85,6 +90,9 @@ typedef struct pthread_cond_s {
 typedef struct pthread_rwlock_s {
   void *_nsync[2];
   char _iswrite;
+  char _biased;
+  _Atomic(char) _rbias;
+  int64_t _inhibit;
 } pthread_rwlock_t;
 
 typedef struct pthread_barrier_s {
@@ -179,11 +187,14 @@ int pthread_rwlock_trywrlock(pthread_rwlock_t *) libcesque paramsnonnull();
 int pthread_rwlock_unlock(pthread_rwlock_t *) libcesque paramsnonnull();
 int pthread_rwlock_wrlock(pthread_rwlock_t *) libcesque paramsnonnull();
 int pthread_rwlockattr_destroy(pthread_rwlockattr_t *) libcesque paramsnonnull();
+int pthread_rwlockattr_getkind_np(const pthread_rwlockattr_t *, int *) libcesque paramsnonnull();
 int pthread_rwlockattr_getpshared(const pthread_rwlockattr_t *, int *) libcesque paramsnonnull();
 int pthread_rwlockattr_init(pthread_rwlockattr_t *) libcesque paramsnonnull();
+int pthread_rwlockattr_setkind_np(pthread_rwlockattr_t *, int) libcesque paramsnonnull();
 int pthread_rwlockattr_setpshared(pthread_rwlockattr_t *, int) libcesque paramsnonnull();
 int pthread_setcancelstate(int, int *) libcesque;
 int pthread_setcanceltype(int, int *) libcesque;
+int pthread_setcachesize_np(int) libcesque;
 int pthread_setname_np(pthread_t, const char *) libcesque paramsnonnull();
 int pthread_setschedprio(pthread_t, int) libcesque;
 int pthread_setspecific(pthread_key_t, const void *) libcesque;
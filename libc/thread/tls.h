@@ -47,6 +47,7 @@ extern char __tls_morphed;
 extern unsigned __tls_index;
 
 char *_mktls(struct CosmoTib **) libcesque;
+char *_mktls_reuse(char *, struct CosmoTib **) libcesque;
 void __bootstrap_tls(struct CosmoTib *, char *) libcesque;
 
 #ifdef __x86_64__
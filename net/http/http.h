@@ -170,6 +170,44 @@ struct HttpMessage {
   struct HttpHeaders xheaders;
 };
 
+struct HttpStreamSlice {
+  const char *p;
+  size_t n;
+};
+
+struct HttpStreamHeader {
+  struct HttpStreamSlice k;
+  struct HttpStreamSlice v;
+};
+
+struct HttpStream {
+  int t, status;
+  unsigned char type;
+  unsigned char version;
+  uint64_t method;
+  size_t i, limit;
+  struct HttpStreamSlice uri;
+  struct HttpStreamSlice message;
+  struct HttpStreamSlice headers[kHttpHeadersMax];
+  struct {
+    unsigned n, c;
+    struct HttpStreamHeader *p;
+  } xheaders;
+  /* private */
+  int a;
+  size_t w;
+  const char *f;
+  struct HttpStreamSlice k;
+  struct {
+    size_t n, c;
+    char *p;
+  } spill;
+  struct {
+    unsigned n, c;
+    char **p;
+  } owned;
+};
+
 struct HttpUnchunker {
   int t;
   size_t i;
@@ -188,6 +226,10 @@ void DestroyHttpMessage(struct HttpMessage *) libcesque;
 void ResetHttpMessage(struct HttpMessage *, int) libcesque;
 int ParseHttpMessage(struct HttpMessage *, const char *, size_t,
                      size_t) libcesque;
+void InitHttpStream(struct HttpStream *, int, size_t) libcesque;
+void ResetHttpStream(struct HttpStream *, int) libcesque;
+void DestroyHttpStream(struct HttpStream *) libcesque;
+ssize_t ParseHttpStream(struct HttpStream *, const char *, size_t) libcesque;
 bool HeaderHas(struct HttpMessage *, const char *, int, const char *,
                size_t) libcesque;
 int64_t ParseContentLength(const char *, size_t) libcesque;
@@ -28,6 +28,7 @@
 #include "libc/sysv/errfuns.h"
 #include "libc/x/x.h"
 #include "net/http/http.h"
+#include "net/http/scan.internal.h"
 
 /**
  * Initializes HTTP message parser.
@@ -92,6 +93,11 @@ void ResetHttpMessage(struct HttpMessage *r, int type) {
  * fragmented. If a message is valid but incomplete, this function will
  * return zero so that it can be resumed as soon as more data arrives.
  *
+ * Runs of ordinary characters inside the uri, reason phrase, header
+ * names, and header values are skipped sixteen bytes at a time using
+ * SSE2 or NEON. Only bytes that could end the field, or which need to
+ * be rejected, are handed to the state machine.
+ *
  * This parser takes about 400 nanoseconds to parse a 403 byte Chrome
  * HTTP request under MODE=rel on a Core i9 which is about three cycles
  * per byte or a gigabyte per second of throughput per core.
@@ -105,6 +111,7 @@ void ResetHttpMessage(struct HttpMessage *r, int type) {
  * @see HTTP/1.0 RFC1945
  */
 int ParseHttpMessage(struct HttpMessage *r, const char *p, size_t n, size_t c) {
+  size_t j;
   int h, i, ch;
   if (n > c)
     return einval();
@@ -139,9 +146,9 @@ int ParseHttpMessage(struct HttpMessage *r, const char *p, size_t n, size_t c) {
           ch = kToUpper[ch];
           r->method |= (uint64_t)ch << r->a;
           r->a += 8;
-          if (++r->i == n)
+          if (r->i + 1 == n)
             break;
-          ch = p[r->i] & 255;
+          ch = p[++r->i] & 255;
         }
         break;
       case kHttpStateUri:
@@ -162,9 +169,11 @@ int ParseHttpMessage(struct HttpMessage *r, const char *p, size_t n, size_t c) {
           } else if (ch < 0x20 || (0x7F <= ch && ch < 0xA0)) {
             return ebadmsg();
           }
-          if (++r->i == n)
+          if ((j = ScanHttpUri(p, r->i + 1, n)) == n) {
+            r->i = n - 1;
             break;
-          ch = p[r->i] & 255;
+          }
+          ch = p[(r->i = j)] & 255;
         }
         break;
       case kHttpStateVersion:
@@ -203,9 +212,9 @@ int ParseHttpMessage(struct HttpMessage *r, const char *p, size_t n, size_t c) {
           } else {
             return ebadmsg();
           }
-          if (++r->i == n)
+          if (r->i + 1 == n)
             break;
-          ch = p[r->i] & 255;
+          ch = p[++r->i] & 255;
         }
         break;
       case kHttpStateMessage:
@@ -218,9 +227,11 @@ int ParseHttpMessage(struct HttpMessage *r, const char *p, size_t n, size_t c) {
           } else if (ch < 0x20 || (0x7F <= ch && ch < 0xA0)) {
             return ebadmsg();
           }
-          if (++r->i == n)
+          if ((j = ScanHttpText(p, r->i + 1, n)) == n) {
+            r->i = n - 1;
             break;
-          ch = p[r->i] & 255;
+          }
+          ch = p[(r->i = j)] & 255;
         }
         break;
       case kHttpStateCr:
@@ -251,9 +262,11 @@ int ParseHttpMessage(struct HttpMessage *r, const char *p, size_t n, size_t c) {
           } else if (!kHttpToken[ch]) {
             return ebadmsg();
           }
-          if (++r->i == n)
+          if ((j = ScanHttpToken(p, r->i + 1, n)) == n) {
+            r->i = n - 1;
             break;
-          ch = p[r->i] & 255;
+          }
+          ch = p[(r->i = j)] & 255;
         }
         break;
       case kHttpStateColon:
@@ -301,9 +314,11 @@ int ParseHttpMessage(struct HttpMessage *r, const char *p, size_t n, size_t c) {
           } else if ((ch < 0x20 && ch != '\t') || (0x7F <= ch && ch < 0xA0)) {
             return ebadmsg();
           }
-          if (++r->i == n)
+          if ((j = ScanHttpText(p, r->i + 1, n)) == n) {
+            r->i = n - 1;
             break;
-          ch = p[r->i] & 255;
+          }
+          ch = p[(r->i = j)] & 255;
         }
         break;
       case kHttpStateLf2:
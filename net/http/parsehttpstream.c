@@ -0,0 +1,409 @@
+/*-*- mode:c;indent-tabs-mode:nil;c-basic-offset:2;tab-width:8;coding:utf-8 -*-│
+│ vi: set et ft=c ts=2 sts=2 sw=2 fenc=utf-8                               :vi │
+╞══════════════════════════════════════════════════════════════════════════════╡
+│ Copyright 2024 Justine Alexandra Roberts Tunney                              │
+│                                                                              │
+│ Permission to use, copy, modify, and/or distribute this software for         │
+│ any purpose with or without fee is hereby granted, provided that the         │
+│ above copyright notice and this permission notice appear in all copies.      │
+│                                                                              │
+│ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL                │
+│ WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED                │
+│ WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE             │
+│ AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL         │
+│ DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR        │
+│ PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER               │
+│ TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR             │
+│ PERFORMANCE OF THIS SOFTWARE.                                                │
+╚─────────────────────────────────────────────────────────────────────────────*/
+#include "libc/assert.h"
+#include "libc/macros.internal.h"
+#include "libc/mem/mem.h"
+#include "libc/serialize.h"
+#include "libc/str/str.h"
+#include "libc/str/tab.internal.h"
+#include "libc/sysv/errfuns.h"
+#include "net/http/http.h"
+#include "net/http/scan.internal.h"
+
+/**
+ * Initializes streaming HTTP message parser.
+ *
+ * @param type is kHttpRequest or kHttpResponse
+ * @param limit is maximum number of bytes the message head may have
+ */
+void InitHttpStream(struct HttpStream *s, int type, size_t limit) {
+  unassert(type == kHttpRequest || type == kHttpResponse);
+  bzero(s, sizeof(*s));
+  s->type = type;
+  s->limit = limit;
+}
+
+/**
+ * Destroys streaming HTTP message parser.
+ */
+void DestroyHttpStream(struct HttpStream *s) {
+  ResetHttpStream(s, s->type);
+  free(s->xheaders.p);
+  free(s->spill.p);
+  free(s->owned.p);
+  bzero(s, sizeof(*s));
+}
+
+/**
+ * Resets streaming HTTP message parser, so it can be re-used.
+ *
+ * Slices from the previous message are invalidated. The memory used to
+ * hold them is retained to amortize the cost of malloc().
+ */
+void ResetHttpStream(struct HttpStream *s, int type) {
+  size_t limit;
+  unsigned xc, oc;
+  size_t sc;
+  char *sp, **op;
+  struct HttpStreamHeader *xp;
+  unassert(type == kHttpRequest || type == kHttpResponse);
+  while (s->owned.n)
+    free(s->owned.p[--s->owned.n]);
+  limit = s->limit;
+  xc = s->xheaders.c, xp = s->xheaders.p;
+  sc = s->spill.c, sp = s->spill.p;
+  oc = s->owned.c, op = s->owned.p;
+  bzero(s, sizeof(*s));
+  s->type = type;
+  s->limit = limit;
+  s->xheaders.c = xc, s->xheaders.p = xp;
+  s->spill.c = sc, s->spill.p = sp;
+  s->owned.c = oc, s->owned.p = op;
+}
+
+static bool IsFieldState(int t) {
+  return t == kHttpStateUri ||      //
+         t == kHttpStateVersion ||  //
+         t == kHttpStateMessage ||  //
+         t == kHttpStateName ||     //
+         t == kHttpStateValue;
+}
+
+// saves part of a field that's about to leave the caller's buffer
+static bool SpillHttpField(struct HttpStream *s, const char *p, size_t n) {
+  char *q;
+  size_t c;
+  if (!n)
+    return true;
+  if (s->spill.n + n > s->spill.c) {
+    c = MAX(64, MAX(s->spill.c * 2, s->spill.n + n));
+    if (!(q = realloc(s->spill.p, c)))
+      return false;
+    s->spill.p = q;
+    s->spill.c = c;
+  }
+  memcpy(s->spill.p + s->spill.n, p, n);
+  s->spill.n += n;
+  return true;
+}
+
+// finishes field that started at s->f, or in an earlier buffer
+static bool EndHttpField(struct HttpStream *s, const char *e,
+                         struct HttpStreamSlice *out) {
+  char *q, **p2;
+  unsigned c2;
+  if (!s->spill.n) {
+    out->p = s->f;
+    out->n = e - s->f;
+    return true;
+  }
+  if (!SpillHttpField(s, s->f, e - s->f))
+    return false;
+  if (s->owned.n == s->owned.c) {
+    c2 = s->owned.c ? s->owned.c * 2 : 4;
+    if (!(p2 = realloc(s->owned.p, c2 * sizeof(*p2))))
+      return false;
+    s->owned.p = p2;
+    s->owned.c = c2;
+  }
+  if (!(q = malloc(s->spill.n)))
+    return false;
+  memcpy(q, s->spill.p, s->spill.n);
+  s->owned.p[s->owned.n++] = q;
+  out->p = q;
+  out->n = s->spill.n;
+  s->spill.n = 0;
+  return true;
+}
+
+static bool AddHttpStreamHeader(struct HttpStream *s, struct HttpStreamSlice v) {
+  int h;
+  unsigned c2;
+  struct HttpStreamHeader *p2;
+  if ((h = GetHttpHeader(s->k.p, s->k.n)) != -1 &&
+      (!s->headers[h].p || !kHttpRepeatable[h])) {
+    s->headers[h] = v;
+    return true;
+  }
+  if (s->xheaders.n == s->xheaders.c) {
+    c2 = s->xheaders.c ? s->xheaders.c * 2 : 4;
+    if (!(p2 = realloc(s->xheaders.p, c2 * sizeof(*p2))))
+      return false;
+    s->xheaders.p = p2;
+    s->xheaders.c = c2;
+  }
+  s->xheaders.p[s->xheaders.n].k = s->k;
+  s->xheaders.p[s->xheaders.n].v = v;
+  ++s->xheaders.n;
+  return true;
+}
+
+/**
+ * Parses HTTP request or response that arrives in pieces.
+ *
+ * This is an incremental version of ParseHttpMessage() for messages
+ * whose head doesn't fit in a single buffer, or which is larger than
+ * the 32kb ParseHttpMessage() allows. Each call consumes one buffer,
+ * which can be the next element of an iovec, or the next contiguous
+ * region of a ring buffer, and no byte is ever looked at twice.
+ *
+ *     struct HttpStream s;
+ *     InitHttpStream(&s, kHttpRequest, 1024 * 1024);
+ *     for (;;) {
+ *       p = NextBuffer(&n);
+ *       if ((rc = ParseHttpStream(&s, p, n)) == -1) Fail();
+ *       if (rc) break;  // p+rc is where the message body starts
+ *     }
+ *     Serve(&s);
+ *     DestroyHttpStream(&s);
+ *
+ * Slices point directly into the buffers that were passed, so those
+ * buffers need to stay alive and unmodified until the parser is reset
+ * or destroyed. The exception is a field which straddles two buffers;
+ * it's reassembled in memory owned by the parser. Message syntax is
+ * the same as ParseHttpMessage(), and so is the meaning of fields. A
+ * header is absent if its `p` is NULL.
+ *
+ * @param p is the next piece of the message
+ * @param n is the number of bytes at `p`
+ * @return number of bytes consumed from `p` once the head of message
+ *     is complete, which may be less than `n`; or 0 if more pieces are
+ *     needed; or -1 w/ errno
+ * @raise EBADMSG if message is malformed
+ * @raise EMSGSIZE if head of message exceeds the limit
+ * @raise ENOMEM if a straddling field couldn't be reassembled
+ * @see ParseHttpMessage()
+ */
+ssize_t ParseHttpStream(struct HttpStream *s, const char *p, size_t n) {
+  int ch;
+  size_t i, j, k, m;
+  struct HttpStreamSlice x;
+  if (s->i >= s->limit)
+    return emsgsize();
+  m = MIN(n, s->limit - s->i);
+  if (IsFieldState(s->t))
+    s->f = p;
+  for (i = 0; i < m; ++i) {
+    ch = p[i] & 255;
+    switch (s->t) {
+      case kHttpStateStart:
+        if (ch == '\r' || ch == '\n')
+          break;  // RFC7230 § 3.5
+        if (!kHttpToken[ch])
+          return ebadmsg();
+        if (s->type == kHttpRequest) {
+          s->t = kHttpStateMethod;
+          s->method = kToUpper[ch];
+          s->a = 8;
+        } else {
+          s->t = kHttpStateVersion;
+          s->f = p + i;
+        }
+        break;
+      case kHttpStateMethod:
+        for (;;) {
+          if (ch == ' ') {
+            s->f = p + i + 1;
+            s->t = kHttpStateUri;
+            break;
+          } else if (s->a == 64 || !kHttpToken[ch]) {
+            return ebadmsg();
+          }
+          ch = kToUpper[ch];
+          s->method |= (uint64_t)ch << s->a;
+          s->a += 8;
+          if (i + 1 == m)
+            break;
+          ch = p[++i] & 255;
+        }
+        break;
+      case kHttpStateUri:
+        for (;;) {
+          if (ch == ' ' || ch == '\r' || ch == '\n') {
+            if (!EndHttpField(s, p + i, &s->uri))
+              return -1;
+            if (!s->uri.n)
+              return ebadmsg();
+            if (ch == ' ') {
+              s->f = p + i + 1;
+              s->t = kHttpStateVersion;
+            } else {
+              s->version = 9;
+              s->t = ch == '\r' ? kHttpStateCr : kHttpStateLf1;
+            }
+            break;
+          } else if (ch < 0x20 || (0x7F <= ch && ch < 0xA0)) {
+            return ebadmsg();
+          }
+          if ((j = ScanHttpUri(p, i + 1, m)) == m) {
+            i = m - 1;
+            break;
+          }
+          ch = p[(i = j)] & 255;
+        }
+        break;
+      case kHttpStateVersion:
+        if (ch == ' ' || ch == '\r' || ch == '\n') {
+          if (!EndHttpField(s, p + i, &x))
+            return -1;
+          if (x.n == 8 &&
+              (READ64BE(x.p) & 0xFFFFFFFFFF00FF00) == 0x485454502F002E00 &&
+              isdigit(x.p[5]) && isdigit(x.p[7])) {
+            s->version = (x.p[5] - '0') * 10 + (x.p[7] - '0');
+            if (s->type == kHttpRequest) {
+              s->t = ch == '\r' ? kHttpStateCr : kHttpStateLf1;
+            } else {
+              s->t = kHttpStateStatus;
+            }
+          } else {
+            return ebadmsg();
+          }
+        } else if (s->spill.n + (p + i - s->f) >= 8) {
+          return ebadmsg();
+        }
+        break;
+      case kHttpStateStatus:
+        for (;;) {
+          if (ch == ' ' || ch == '\r' || ch == '\n') {
+            if (s->status < 100)
+              return ebadmsg();
+            if (ch == ' ') {
+              s->f = p + i + 1;
+              s->t = kHttpStateMessage;
+            } else {
+              s->t = ch == '\r' ? kHttpStateCr : kHttpStateLf1;
+            }
+            break;
+          } else if ('0' <= ch && ch <= '9') {
+            s->status *= 10;
+            s->status += ch - '0';
+            if (s->status > 999)
+              return ebadmsg();
+          } else {
+            return ebadmsg();
+          }
+          if (i + 1 == m)
+            break;
+          ch = p[++i] & 255;
+        }
+        break;
+      case kHttpStateMessage:
+        for (;;) {
+          if (ch == '\r' || ch == '\n') {
+            if (!EndHttpField(s, p + i, &s->message))
+              return -1;
+            s->t = ch == '\r' ? kHttpStateCr : kHttpStateLf1;
+            break;
+          } else if (ch < 0x20 || (0x7F <= ch && ch < 0xA0)) {
+            return ebadmsg();
+          }
+          if ((j = ScanHttpText(p, i + 1, m)) == m) {
+            i = m - 1;
+            break;
+          }
+          ch = p[(i = j)] & 255;
+        }
+        break;
+      case kHttpStateCr:
+        if (ch != '\n')
+          return ebadmsg();
+        s->t = kHttpStateLf1;
+        break;
+      case kHttpStateLf1:
+        if (ch == '\r') {
+          s->t = kHttpStateLf2;
+          break;
+        } else if (ch == '\n') {
+          s->i += ++i;
+          return i;
+        } else if (!kHttpToken[ch]) {
+          // 1. Forbid empty header name (RFC2616 §2.2)
+          // 2. Forbid line folding (RFC7230 §3.2.4)
+          return ebadmsg();
+        }
+        s->f = p + i;
+        s->t = kHttpStateName;
+        break;
+      case kHttpStateName:
+        for (;;) {
+          if (ch == ':') {
+            if (!EndHttpField(s, p + i, &s->k))
+              return -1;
+            s->t = kHttpStateColon;
+            break;
+          } else if (!kHttpToken[ch]) {
+            return ebadmsg();
+          }
+          if ((j = ScanHttpToken(p, i + 1, m)) == m) {
+            i = m - 1;
+            break;
+          }
+          ch = p[(i = j)] & 255;
+        }
+        break;
+      case kHttpStateColon:
+        if (ch == ' ' || ch == '\t')
+          break;
+        s->f = p + i;
+        s->w = 0;
+        s->t = kHttpStateValue;
+        // fallthrough
+      case kHttpStateValue:
+        for (;;) {
+          if (ch == '\r' || ch == '\n') {
+            if (!EndHttpField(s, p + i, &x))
+              return -1;
+            x.n = s->w;  // trim trailing whitespace
+            if (!AddHttpStreamHeader(s, x))
+              return -1;
+            s->t = ch == '\r' ? kHttpStateCr : kHttpStateLf1;
+            break;
+          } else if ((ch < 0x20 && ch != '\t') || (0x7F <= ch && ch < 0xA0)) {
+            return ebadmsg();
+          }
+          if (ch != ' ' && ch != '\t')
+            s->w = s->spill.n + (p + i + 1 - s->f);
+          j = ScanHttpText(p, i + 1, m);
+          for (k = j; k > i + 1 && p[k - 1] == ' ';)
+            --k;
+          if (k > i + 1)
+            s->w = s->spill.n + (p + k - s->f);
+          if (j == m) {
+            i = m - 1;
+            break;
+          }
+          ch = p[(i = j)] & 255;
+        }
+        break;
+      case kHttpStateLf2:
+        if (ch == '\n') {
+          s->i += ++i;
+          return i;
+        }
+        return ebadmsg();
+      default:
+        __builtin_unreachable();
+    }
+  }
+  if (IsFieldState(s->t) && !SpillHttpField(s, s->f, p + m - s->f))
+    return -1;
+  if ((s->i += m) >= s->limit)
+    return emsgsize();
+  return 0;
+}
@@ -0,0 +1,106 @@
+#ifndef COSMOPOLITAN_NET_HTTP_SCAN_INTERNAL_H_
+#define COSMOPOLITAN_NET_HTTP_SCAN_INTERNAL_H_
+#include "net/http/http.h"
+COSMOPOLITAN_C_START_
+
+#if defined(__GNUC__) && !defined(__chibicc__)
+
+typedef unsigned char httpxmm_t
+    __attribute__((__vector_size__(16), __aligned__(1)));
+typedef char httpxmmsb_t __attribute__((__vector_size__(16)));
+typedef uint64_t httpxmm64_t __attribute__((__vector_size__(16)));
+
+// returns index of first nonzero byte in vector mask, or 16 if none
+static inline int FirstHttpSpecial(httpxmm_t m) {
+#ifdef __x86_64__
+  unsigned x;
+  if ((x = __builtin_ia32_pmovmskb128((httpxmmsb_t)m)))
+    return __builtin_ctz(x);
+#else
+  httpxmm64_t w = (httpxmm64_t)m;
+  if (w[0])
+    return __builtin_ctzll(w[0]) >> 3;
+  if (w[1])
+    return 8 + (__builtin_ctzll(w[1]) >> 3);
+#endif
+  return 16;
+}
+
+// C0 and C1 control codes, which includes tab
+static inline httpxmm_t IsHttpControl(httpxmm_t v) {
+  return (httpxmm_t)(v < 0x20) | (httpxmm_t)((httpxmm_t)(v - 0x7F) < 0x21);
+}
+
+// anything not in kHttpToken
+static inline httpxmm_t IsHttpSeparator(httpxmm_t v) {
+  return (httpxmm_t)(v <= 0x20) | (httpxmm_t)(v >= 0x7F) |
+         (httpxmm_t)(v == '"') | (httpxmm_t)((httpxmm_t)(v - '(') < 2) |
+         (httpxmm_t)(v == ',') | (httpxmm_t)(v == '/') |
+         (httpxmm_t)((httpxmm_t)(v - ':') < 7) |
+         (httpxmm_t)((httpxmm_t)(v - '[') < 3) | (httpxmm_t)(v == '{') |
+         (httpxmm_t)(v == '}');
+}
+
+// returns index of first byte in p[i,n) that `f` flags, otherwise n
+//
+// Bytes beyond `n` are never read. The last partial chunk is padded
+// with NUL, which every predicate flags, so the loop always stops.
+static inline size_t ScanHttp(const char *p, size_t i, size_t n,
+                              httpxmm_t f(httpxmm_t)) {
+  int k;
+  httpxmm_t v;
+  for (;;) {
+    if (i + 16 <= n) {
+      v = *(const httpxmm_t *)(p + i);
+    } else {
+      unsigned char b[16] = {0};
+      __builtin_memcpy(b, p + i, n - i);
+      v = *(const httpxmm_t *)b;
+    }
+    if ((k = FirstHttpSpecial(f(v))) < 16)
+      return i + k < n ? i + k : n;
+    i += 16;
+  }
+}
+
+static inline httpxmm_t IsHttpUriSpecial(httpxmm_t v) {
+  return IsHttpControl(v) | (httpxmm_t)(v == ' ');
+}
+
+#define ScanHttpUri(p, i, n)   ScanHttp(p, i, n, IsHttpUriSpecial)
+#define ScanHttpText(p, i, n)  ScanHttp(p, i, n, IsHttpControl)
+#define ScanHttpToken(p, i, n) ScanHttp(p, i, n, IsHttpSeparator)
+
+#else
+
+static inline size_t ScanHttpUri(const char *p, size_t i, size_t n) {
+  int c;
+  for (; i < n; ++i) {
+    c = p[i] & 255;
+    if (c <= ' ' || (0x7F <= c && c < 0xA0))
+      break;
+  }
+  return i;
+}
+
+static inline size_t ScanHttpText(const char *p, size_t i, size_t n) {
+  int c;
+  for (; i < n; ++i) {
+    c = p[i] & 255;
+    if (c < ' ' || (0x7F <= c && c < 0xA0))
+      break;
+  }
+  return i;
+}
+
+static inline size_t ScanHttpToken(const char *p, size_t i, size_t n) {
+  for (; i < n; ++i)
+    if (!kHttpToken[p[i] & 255])
+      break;
+  return i;
+}
+
+#endif
+
+COSMOPOLITAN_C_END_
+#endif /* COSMOPOLITAN_NET_HTTP_SCAN_INTERNAL_H_ */
@@ -13,8 +13,13 @@ TEST_CTL_TESTS = $(TEST_CTL_COMS:%=%.ok)
 
 TEST_CTL_DIRECTDEPS =				\
 	CTL					\
+	LIBC_CALLS				\
+	LIBC_FMT				\
 	LIBC_INTRIN				\
 	LIBC_MEM				\
+	LIBC_STDIO				\
+	LIBC_THREAD				\
+	THIRD_PARTY_LIBCXX			\
 
 TEST_CTL_DEPS :=				\
 	$(call uniq,$(foreach x,$(TEST_CTL_DIRECTDEPS),$($(x))))
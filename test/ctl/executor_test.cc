@@ -0,0 +1,97 @@
+// -*- mode:c++; indent-tabs-mode:nil; c-basic-offset:4; coding:utf-8 -*-
+// vi: set et ft=cpp ts=4 sts=4 sw=4 fenc=utf-8 :vi
+//
+// Copyright 2024 Justine Alexandra Roberts Tunney
+//
+// Permission to use, copy, modify, and/or distribute this software for
+// any purpose with or without fee is hereby granted, provided that the
+// above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+// WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE
+// AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+// DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR
+// PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+// TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include "ctl/executor.h"
+#include "ctl/string.h"
+#include "ctl/vector.h"
+#include "libc/mem/leaks.h"
+
+static long
+fib(ctl::executor& ex, long n)
+{
+    if (n < 2)
+        return n;
+    auto t = ex.submit([&ex, n] { return fib(ex, n - 1); });
+    long b = fib(ex, n - 2);
+    return t.get() + b;
+}
+
+int
+main()
+{
+
+    {
+        ctl::executor ex(4);
+        if (ex.threads() != 4)
+            return 1;
+        if (fib(ex, 20) != 6765)
+            return 2;
+    }
+
+    {
+        ctl::executor ex;
+        auto t = ex.submit([] { return ctl::string("hello"); });
+        if (t.get() != "hello")
+            return 3;
+        if (t.valid())
+            return 4;
+        if (!t.done())
+            return 8;
+        ctl::task<int> u;
+        if (!u.done())
+            return 9;
+    }
+
+    {
+        int x = 0;
+        ctl::executor ex(2);
+        {
+            auto t = ex.submit([&x] { x = 42; });
+        }
+        if (x != 42)
+            return 5;
+    }
+
+    {
+        ctl::executor ex(3);
+        ctl::vector<long> v;
+        v.resize(10000);
+        ex.parallel_for(0, v.size(), [&v](long b, long e) {
+            for (; b < e; ++b)
+                v[b] = b * 2;
+        });
+        for (long i = 0; i < 10000; ++i)
+            if (v[i] != i * 2)
+                return 6;
+        long sum = ex.parallel_reduce(
+          0,
+          v.size(),
+          0L,
+          [&v](long b, long e) {
+              long s = 0;
+              for (; b < e; ++b)
+                  s += v[b];
+              return s;
+          },
+          [](long a, long b) { return a + b; });
+        if (sum != 9999L * 10000)
+            return 7;
+    }
+
+    CheckForMemoryLeaks();
+}
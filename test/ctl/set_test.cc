@@ -17,9 +17,11 @@
 // PERFORMANCE OF THIS SOFTWARE.
 
 #include "ctl/set.h"
+#include "ctl/string.h"
 #include "libc/mem/leaks.h"
 
 // #include <set>
+// #include <string>
 // #define ctl std
 // #define check() size()
 
@@ -302,5 +304,50 @@ main()
             return 34;
     }
 
+    {
+        // nodes freed by erase get reused by insert
+        ctl::set<int> s;
+        for (int i = 0; i < 1000; ++i)
+            s.insert(i);
+        for (int i = 0; i < 1000; i += 2)
+            s.erase(i);
+        for (int i = 0; i < 1000; i += 2)
+            s.insert(i);
+        s.check();
+        if (s.size() != 1000)
+            return 35;
+        int expect = 0;
+        for (int x : s)
+            if (x != expect++)
+                return 36;
+    }
+
+    {
+        // strings are destroyed by clear() and by the destructor
+        ctl::set<ctl::string> s;
+        for (int i = 0; i < 100; ++i)
+            s.insert(ctl::string(8, 'a' + i % 26) + ctl::string(1, i));
+        s.clear();
+        if (!s.empty() || s.begin() != s.end())
+            return 37;
+        s.insert("hello");
+        ctl::set<ctl::string> t(s);
+        ctl::set<ctl::string> u(ctl::move(s));
+        if (!s.empty() || t != u)
+            return 38;
+        t.insert("world");
+        u.swap(t);
+        if (u.size() != 2 || t.size() != 1)
+            return 39;
+        s = ctl::move(u);
+        s.check();
+        if (s.size() != 2 || !u.empty())
+            return 40;
+        u.insert("x");
+        u.erase("x");
+        if (!u.empty())
+            return 41;
+    }
+
     CheckForMemoryLeaks();
 }
@@ -0,0 +1,106 @@
+// -*- mode:c++; indent-tabs-mode:nil; c-basic-offset:4; coding:utf-8 -*-
+// vi: set et ft=cpp ts=4 sts=4 sw=4 fenc=utf-8 :vi
+//
+// Copyright 2024 Justine Alexandra Roberts Tunney
+//
+// Permission to use, copy, modify, and/or distribute this software for
+// any purpose with or without fee is hereby granted, provided that the
+// above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+// WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE
+// AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+// DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR
+// PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+// TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include "ctl/sort.h"
+#include "ctl/string.h"
+#include "ctl/vector.h"
+#include "libc/mem/leaks.h"
+#include "libc/stdio/rand.h"
+
+// #include <algorithm>
+// #include <string>
+// #include <vector>
+// #define ctl std
+
+template<typename T>
+static bool
+is_sorted(const ctl::vector<T>& v)
+{
+    for (size_t i = 1; i < v.size(); ++i)
+        if (v[i] < v[i - 1])
+            return false;
+    return true;
+}
+
+int
+main()
+{
+
+    {
+        ctl::vector<unsigned long> v;
+        for (int i = 0; i < 1000; ++i)
+            v.push_back(lemur64());
+        ctl::sort(v.begin(), v.end());
+        if (!is_sorted(v))
+            return 1;
+    }
+
+    {
+        ctl::vector<int> v;
+        for (int i = 0; i < 1000; ++i)
+            v.push_back(lemur64());
+        ctl::sort(v.begin(), v.end());
+        if (!is_sorted(v))
+            return 2;
+    }
+
+    {
+        ctl::vector<double> v;
+        for (int i = 0; i < 1000; ++i)
+            v.push_back((double)(long)lemur64() / 7);
+        ctl::sort(v.begin(), v.end());
+        if (!is_sorted(v))
+            return 3;
+    }
+
+    {
+        ctl::vector<ctl::pair<unsigned long, unsigned long>> v;
+        for (int i = 0; i < 1000; ++i)
+            v.push_back({ lemur64() % 10, lemur64() % 10 });
+        ctl::sort(v.begin(), v.end());
+        for (size_t i = 1; i < v.size(); ++i)
+            if (v[i].first < v[i - 1].first ||
+                (v[i].first == v[i - 1].first &&
+                 v[i].second < v[i - 1].second))
+                return 4;
+    }
+
+    {
+        ctl::vector<ctl::string> v;
+        for (int i = 0; i < 1000; ++i) {
+            char buf[8] = { (char)('a' + lemur64() % 26),
+                            (char)('a' + lemur64() % 26) };
+            v.push_back(buf);
+        }
+        ctl::sort(v.begin(), v.end());
+        if (!is_sorted(v))
+            return 5;
+    }
+
+    {
+        ctl::vector<int> v;
+        for (int i = 0; i < 1000; ++i)
+            v.push_back(i);
+        ctl::sort(v.begin(), v.end(), [](int a, int b) { return a > b; });
+        for (int i = 0; i < 1000; ++i)
+            if (v[i] != 999 - i)
+                return 6;
+    }
+
+    CheckForMemoryLeaks();
+}
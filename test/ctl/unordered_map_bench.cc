@@ -0,0 +1,85 @@
+// -*- mode:c++; indent-tabs-mode:nil; c-basic-offset:4; coding:utf-8 -*-
+// vi: set et ft=cpp ts=4 sts=4 sw=4 fenc=utf-8 :vi
+//
+// Copyright 2024 Justine Alexandra Roberts Tunney
+//
+// Permission to use, copy, modify, and/or distribute this software for
+// any purpose with or without fee is hereby granted, provided that the
+// above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+// WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE
+// AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+// DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR
+// PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+// TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+
+#include "ctl/map.h"
+#include "ctl/unordered_map.h"
+#include "ctl/vector.h"
+#include "libc/calls/struct/timespec.h"
+#include "libc/fmt/conv.h"
+#include "libc/stdio/rand.h"
+#include "libc/stdio/stdio.h"
+
+#include <unordered_map>
+
+// compares ctl::unordered_map against ctl::map and libcxx
+//
+//     make -j8 o//test/ctl/unordered_map_bench
+//     o//test/ctl/unordered_map_bench 10000000
+//
+// the optional argument is the largest key count to measure, which
+// defaults to 100000 so running the test suite doesn't take forever
+
+#define BENCH(N, NAME, CODE)                                                   \
+    do {                                                                       \
+        struct timespec start = timespec_real();                               \
+        CODE;                                                                  \
+        struct timespec took = timespec_sub(timespec_real(), start);           \
+        double nanos = (double)timespec_tonanos(took) / (N);                   \
+        printf("%10g ns %-20s %-8s %ld\n", nanos, name, NAME, (long)(N));      \
+    } while (0)
+
+volatile long sink;
+
+template<typename M>
+void
+Measure(const char* name, const ctl::vector<long>& keys,
+        const ctl::vector<long>& misses)
+{
+    M m;
+    long n = keys.size();
+    long hits = 0;
+    BENCH(n, "insert", for (long k : keys) m[k] = k);
+    BENCH(n, "hit", for (long k : keys) hits += m.find(k) != m.end());
+    BENCH(n, "miss", for (long k : misses) hits += m.find(k) != m.end());
+    BENCH(n, "iterate", for (const auto& e : m) hits += e.second);
+    BENCH(n, "erase", for (long k : keys) m.erase(k));
+    sink = hits;
+}
+
+int
+main(int argc, char* argv[])
+{
+    long max = argc > 1 ? atol(argv[1]) : 100000;
+    for (long n = 1000; n <= max; n *= 10) {
+        ctl::vector<long> keys;
+        ctl::vector<long> misses;
+        keys.reserve(n);
+        misses.reserve(n);
+        for (long i = 0; i < n; ++i) {
+            keys.push_back(lemur64() | 1);
+            misses.push_back(lemur64() & -2);
+        }
+        Measure<ctl::unordered_map<long, long>>(
+          "ctl::unordered_map", keys, misses);
+        Measure<ctl::map<long, long>>("ctl::map", keys, misses);
+        Measure<std::unordered_map<long, long>>(
+          "std::unordered_map", keys, misses);
+        printf("\n");
+    }
+}
@@ -0,0 +1,246 @@
+// -*- mode:c++; indent-tabs-mode:nil; c-basic-offset:4; coding:utf-8 -*-
+// vi: set et ft=cpp ts=4 sts=4 sw=4 fenc=utf-8 :vi
+//
+// Copyright 2024 Justine Alexandra Roberts Tunney
+//
+// Permission to use, copy, modify, and/or distribute this software for
+// any purpose with or without fee is hereby granted, provided that the
+// above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+// WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE
+// AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+// DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR
+// PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+// TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include "ctl/string.h"
+#include "ctl/unordered_map.h"
+#include "libc/mem/leaks.h"
+#include "libc/stdio/stdio.h"
+
+// #include <string>
+// #include <unordered_map>
+// #define ctl std
+
+struct BadHash
+{
+    size_t operator()(int) const
+    {
+        return 42;
+    }
+};
+
+int
+main()
+{
+
+    {
+        ctl::unordered_map<int, double> m;
+        if (!m.empty())
+            return 1;
+        if (m.size())
+            return 2;
+        if (m.find(1) != m.end())
+            return 3;
+        if (m.begin() != m.end())
+            return 4;
+        m[1] = 10;
+        m[2] = 20;
+        m[3] = 3.14;
+        if (m.size() != 3)
+            return 5;
+        if (m[1] != 10)
+            return 6;
+        if (m[2] != 20)
+            return 7;
+        if (m.at(3) != 3.14)
+            return 8;
+    }
+
+    {
+        ctl::unordered_map<ctl::string, int> m;
+        m["one"] = 1;
+        m["two"] = 2;
+        m["three"] = 3;
+        int sum = 0;
+        for (const auto& entry : m)
+            sum += entry.second;
+        if (sum != 6)
+            return 9;
+        if (!m.contains("two"))
+            return 10;
+        if (m.count("four"))
+            return 11;
+        if (m.erase("two") != 1)
+            return 12;
+        if (m.erase("two") != 0)
+            return 13;
+        if (m.size() != 2)
+            return 14;
+        if (m.contains("two"))
+            return 15;
+    }
+
+    {
+        ctl::unordered_map<int, int> m;
+        for (int i = 0; i < 100000; ++i)
+            m[i] = i * 2;
+        if (m.size() != 100000)
+            return 16;
+        for (int i = 0; i < 100000; ++i) {
+            auto it = m.find(i);
+            if (it == m.end())
+                return 17;
+            if (it->first != i || it->second != i * 2)
+                return 18;
+        }
+        if (m.find(100000) != m.end())
+            return 19;
+        if (m.load_factor() > m.max_load_factor())
+            return 20;
+        for (int i = 0; i < 100000; i += 2)
+            if (m.erase(i) != 1)
+                return 21;
+        if (m.size() != 50000)
+            return 22;
+        for (int i = 0; i < 100000; ++i)
+            if (m.contains(i) != (i & 1))
+                return 23;
+        size_t n = 0;
+        for (auto it = m.begin(); it != m.end(); ++it) {
+            if (!(it->first & 1))
+                return 24;
+            ++n;
+        }
+        if (n != 50000)
+            return 25;
+    }
+
+    {
+        // churn exercises tombstone reuse without growth
+        ctl::unordered_map<int, int> m;
+        m.reserve(100);
+        size_t buckets = m.bucket_count();
+        for (int i = 0; i < 100000; ++i) {
+            m[i] = i;
+            if (i >= 50)
+                m.erase(i - 50);
+        }
+        if (m.size() != 50)
+            return 26;
+        if (m.bucket_count() != buckets)
+            return 27;
+        for (int i = 100000 - 50; i < 100000; ++i)
+            if (m.at(i) != i)
+                return 28;
+    }
+
+    {
+        ctl::unordered_map<int, ctl::string> m;
+        auto [it, inserted] = m.try_emplace(1, "hello");
+        if (!inserted || it->second != "hello")
+            return 29;
+        auto r = m.try_emplace(1, "world");
+        if (r.second || r.first->second != "hello")
+            return 30;
+        auto r2 = m.insert_or_assign(1, "world");
+        if (r2.second || m[1] != "world")
+            return 31;
+        auto r3 = m.insert({ 2, "two" });
+        if (!r3.second || m[2] != "two")
+            return 32;
+        auto r4 = m.emplace(3, "three");
+        if (!r4.second || r4.first->second != "three")
+            return 33;
+        auto r5 = m.emplace(3, "tres");
+        if (r5.second || r5.first->second != "three")
+            return 34;
+    }
+
+    {
+        ctl::unordered_map<int, ctl::string> a = { { 1, "one" },
+                                                   { 2, "two" },
+                                                   { 3, "three" } };
+        ctl::unordered_map<int, ctl::string> b(a);
+        if (a != b)
+            return 35;
+        b[2] = "deux";
+        if (a == b)
+            return 36;
+        ctl::unordered_map<int, ctl::string> c(ctl::move(b));
+        if (!b.empty())
+            return 37;
+        if (c[2] != "deux")
+            return 38;
+        b = c;
+        if (b != c)
+            return 39;
+        a.swap(c);
+        if (a[2] != "deux" || c[2] != "two")
+            return 40;
+        a.clear();
+        if (!a.empty() || a.begin() != a.end())
+            return 41;
+        a[7] = "seven";
+        if (a.size() != 1)
+            return 42;
+    }
+
+    {
+        // every key collides but lookups must still work
+        ctl::unordered_map<int, int, BadHash> m;
+        for (int i = 0; i < 1000; ++i)
+            m[i] = -i;
+        for (int i = 0; i < 1000; ++i)
+            if (m.at(i) != -i)
+                return 43;
+        for (int i = 0; i < 1000; i += 3)
+            m.erase(i);
+        for (int i = 0; i < 1000; ++i)
+            if (m.contains(i) != !!(i % 3))
+                return 44;
+    }
+
+    {
+        ctl::unordered_map<int, int> m;
+        for (int i = 0; i < 100; ++i)
+            m[i] = i;
+        for (auto it = m.begin(); it != m.end();) {
+            if (it->first % 10)
+                it = m.erase(it);
+            else
+                ++it;
+        }
+        if (m.size() != 10)
+            return 45;
+        m.erase(m.begin(), m.end());
+        if (!m.empty())
+            return 46;
+        m.rehash(0);
+        if (m.bucket_count())
+            return 47;
+    }
+
+    {
+        ctl::unordered_map<ctl::string, ctl::string> m;
+        for (int i = 0; i < 1000; ++i) {
+            char buf[32];
+            snprintf(buf, sizeof(buf), "key%d", i);
+            m[buf] = ctl::string(buf) + " value that is not small";
+        }
+        for (int i = 0; i < 1000; ++i) {
+            char buf[32];
+            snprintf(buf, sizeof(buf), "key%d", i);
+            if (m[buf] != ctl::string(buf) + " value that is not small")
+                return 48;
+        }
+        const auto& cm = m;
+        if (cm.find("key7") == cm.end())
+            return 49;
+    }
+
+    CheckForMemoryLeaks();
+}
@@ -0,0 +1,135 @@
+// -*- mode:c++; indent-tabs-mode:nil; c-basic-offset:4; coding:utf-8 -*-
+// vi: set et ft=cpp ts=4 sts=4 sw=4 fenc=utf-8 :vi
+//
+// Copyright 2024 Justine Alexandra Roberts Tunney
+//
+// Permission to use, copy, modify, and/or distribute this software for
+// any purpose with or without fee is hereby granted, provided that the
+// above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+// WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE
+// AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+// DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR
+// PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+// TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+
+#include "ctl/string.h"
+#include "ctl/unordered_set.h"
+#include "libc/mem/leaks.h"
+
+// #include <string>
+// #include <unordered_set>
+// #define ctl std
+
+struct Point
+{
+    int x, y;
+
+    bool operator==(const Point& other) const
+    {
+        return x == other.x && y == other.y;
+    }
+};
+
+template<>
+struct ctl::hash<Point>
+{
+    size_t operator()(const Point& p) const
+    {
+        return (size_t)p.x << 32 | (unsigned)p.y;
+    }
+};
+
+int
+main()
+{
+
+    {
+        ctl::unordered_set<int> s;
+        if (!s.empty())
+            return 1;
+        if (!s.insert(5).second)
+            return 2;
+        if (s.insert(5).second)
+            return 3;
+        if (*s.find(5) != 5)
+            return 4;
+        if (s.size() != 1)
+            return 5;
+        if (s.erase(5) != 1)
+            return 6;
+        if (!s.empty())
+            return 7;
+    }
+
+    {
+        ctl::unordered_set<ctl::string> s = { "a", "b", "c", "a" };
+        if (s.size() != 3)
+            return 8;
+        if (!s.contains("b"))
+            return 9;
+        if (s.contains("d"))
+            return 10;
+        ctl::string all;
+        for (const auto& x : s)
+            all += x;
+        if (all.size() != 3)
+            return 11;
+        ctl::unordered_set<ctl::string> t = s;
+        if (t != s)
+            return 12;
+        t.erase("a");
+        if (t == s)
+            return 13;
+    }
+
+    {
+        ctl::unordered_set<Point> s;
+        for (int y = 0; y < 100; ++y)
+            for (int x = 0; x < 100; ++x)
+                s.emplace(Point{ x, y });
+        if (s.size() != 10000)
+            return 14;
+        if (!s.contains(Point{ 42, 77 }))
+            return 15;
+        if (s.contains(Point{ 100, 0 }))
+            return 16;
+    }
+
+    {
+        ctl::unordered_set<long> s;
+        s.reserve(1000);
+        size_t buckets = s.bucket_count();
+        if (buckets < 1000)
+            return 17;
+        for (long i = 0; i < 1000; ++i)
+            s.insert(i * 0x100000000);
+        if (s.bucket_count() != buckets)
+            return 18;
+        for (long i = 0; i < 1000; ++i)
+            if (!s.count(i * 0x100000000))
+                return 19;
+        s.clear();
+        if (s.size() || s.begin() != s.end())
+            return 20;
+    }
+
+    {
+        ctl::unordered_set<ctl::string> a, b;
+        a.insert("x");
+        b.insert("y");
+        b.insert("z");
+        swap(a, b);
+        if (a.size() != 2 || b.size() != 1)
+            return 21;
+        b = ctl::move(a);
+        if (b.size() != 2 || !b.contains("z"))
+            return 22;
+    }
+
+    CheckForMemoryLeaks();
+}
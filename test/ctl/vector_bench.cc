@@ -0,0 +1,129 @@
+// -*- mode:c++; indent-tabs-mode:nil; c-basic-offset:4; coding:utf-8 -*-
+// vi: set et ft=cpp ts=4 sts=4 sw=4 fenc=utf-8 :vi
+//
+// Copyright 2024 Justine Alexandra Roberts Tunney
+//
+// Permission to use, copy, modify, and/or distribute this software for
+// any purpose with or without fee is hereby granted, provided that the
+// above copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL
+// WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE
+// AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL
+// DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR
+// PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER
+// TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+// PERFORMANCE OF THIS SOFTWARE.
+
+#include "ctl/string.h"
+#include "ctl/vector.h"
+#include "libc/calls/struct/timespec.h"
+#include "libc/stdio/stdio.h"
+
+#include <string>
+#include <vector>
+
+// compares ctl::vector against libcxx std::vector
+//
+//     make -j8 o//test/ctl/vector_bench
+//     o//test/ctl/vector_bench
+//
+
+#define BENCH(ITERATIONS, WORK_PER_RUN, CODE)                                  \
+    do {                                                                       \
+        struct timespec start = timespec_real();                               \
+        for (int __i = 0; __i < ITERATIONS; ++__i) {                           \
+            asm volatile("" ::: "memory");                                     \
+            CODE;                                                              \
+        }                                                                      \
+        struct timespec took = timespec_sub(timespec_real(), start);           \
+        long long work = (WORK_PER_RUN) * (ITERATIONS);                        \
+        double nanos = (double)timespec_tonanos(took) / work;                  \
+        printf("%10g ns %2dx %s\n", nanos, (ITERATIONS), #CODE);               \
+    } while (0)
+
+struct Widget
+{
+    long a = 1;
+    long b = 2;
+
+    Widget() = default;
+    Widget(const Widget&) = default;
+    Widget(Widget&& other) : a(other.a), b(other.b)
+    {
+        other.a = 0;
+    }
+    Widget& operator=(const Widget&) = default;
+    Widget& operator=(Widget&&) = default;
+    ~Widget()
+    {
+        asm volatile("" ::: "memory");
+    }
+};
+
+template<typename V>
+void
+PushBackInts(int n)
+{
+    V v;
+    for (int i = 0; i < n; ++i)
+        v.push_back(i);
+}
+
+template<typename V, typename S>
+void
+PushBackStrings(int n)
+{
+    V v;
+    for (int i = 0; i < n; ++i)
+        v.push_back(S("hello there this is a string"));
+}
+
+template<typename V>
+void
+ReserveWidgets(int n)
+{
+    V v;
+    v.reserve(n);
+    v.emplace_back();
+}
+
+template<typename V>
+void
+InsertFront(int n)
+{
+    V v;
+    for (int i = 0; i < n; ++i)
+        v.insert(v.begin(), i);
+}
+
+template<typename V>
+void
+EraseFront(int n)
+{
+    V v(n);
+    while (!v.empty())
+        v.erase(v.begin());
+}
+
+int
+main()
+{
+    BENCH(100, 100000, PushBackInts<ctl::vector<int>>(100000));
+    BENCH(100, 100000, PushBackInts<std::vector<int>>(100000));
+
+    BENCH(10, 100000,
+          (PushBackStrings<ctl::vector<ctl::string>, ctl::string>(100000)));
+    BENCH(10, 100000,
+          (PushBackStrings<std::vector<std::string>, std::string>(100000)));
+
+    BENCH(100, 1, ReserveWidgets<ctl::vector<Widget>>(1 << 20));
+    BENCH(100, 1, ReserveWidgets<std::vector<Widget>>(1 << 20));
+
+    BENCH(10, 1000, InsertFront<ctl::vector<int>>(1000));
+    BENCH(10, 1000, InsertFront<std::vector<int>>(1000));
+
+    BENCH(10, 1000, EraseFront<ctl::vector<Widget>>(1000));
+    BENCH(10, 1000, EraseFront<std::vector<Widget>>(1000));
+}
@@ -27,6 +27,47 @@
 // #include <vector>
 // #define ctl std
 
+static int g_ctors;
+static int g_dtors;
+
+struct Counted
+{
+    int x;
+
+    Counted() : x(0)
+    {
+        ++g_ctors;
+    }
+
+    Counted(int x) : x(x)
+    {
+        ++g_ctors;
+    }
+
+    Counted(const Counted& other) : x(other.x)
+    {
+        ++g_ctors;
+    }
+
+    Counted(Counted&& other) : x(other.x)
+    {
+        ++g_ctors;
+    }
+
+    Counted& operator=(const Counted&) = default;
+    Counted& operator=(Counted&&) = default;
+
+    ~Counted()
+    {
+        ++g_dtors;
+    }
+};
+
+struct alignas(64) Aligned
+{
+    int x;
+};
+
 int
 main()
 {
@@ -315,6 +356,93 @@ main()
             return 69;
     }
 
+    {
+        ctl::vector<Counted> A;
+        A.reserve(1 << 20);
+        if (g_ctors != 0)
+            return 70;
+        A.emplace_back(1);
+        A.emplace_back(2);
+        if (g_ctors != 2)
+            return 71;
+        A.clear();
+        if (g_dtors != 2)
+            return 72;
+        A.resize(3);
+        A.shrink_to_fit();
+        if (A.capacity() != 3)
+            return 73;
+    }
+    if (g_ctors != g_dtors)
+        return 74;
+
+    {
+        ctl::vector<int> A;
+        for (int i = 0; i < 5; ++i)
+            A.push_back(i);
+        ctl::vector<int>::iterator it = A.insert(A.begin() + 2, 9);
+        if (*it != 9 || A.size() != 6)
+            return 75;
+        if (A[0] != 0 || A[1] != 1 || A[2] != 9 || A[3] != 2 || A[5] != 4)
+            return 76;
+        it = A.erase(A.begin() + 1);
+        if (*it != 9 || A.size() != 5)
+            return 77;
+        A.insert(A.end(), 3, 7);
+        if (A.size() != 8 || A[5] != 7 || A[7] != 7)
+            return 78;
+        A.erase(A.begin(), A.begin() + 4);
+        if (A.size() != 4 || A[0] != 4 || A[3] != 7)
+            return 79;
+        A.insert(A.begin(), A[3]);
+        if (A.size() != 5 || A[0] != 7 || A[1] != 4)
+            return 80;
+    }
+
+    {
+        ctl::vector<ctl::string> A;
+        A.push_back("a");
+        A.push_back("c");
+        A.insert(A.begin() + 1, "b");
+        A.emplace(A.begin(), "z");
+        if (A.size() != 4)
+            return 81;
+        if (A[0] != "z" || A[1] != "a" || A[2] != "b" || A[3] != "c")
+            return 82;
+        A.erase(A.begin());
+        if (A.size() != 3 || A[0] != "a" || A[2] != "c")
+            return 83;
+        A.push_back(A[0]);
+        if (A.size() != 4 || A[3] != "a")
+            return 84;
+        A.shrink_to_fit();
+        if (A.capacity() != 4)
+            return 85;
+    }
+
+    {
+        ctl::vector<Aligned> A;
+        for (int i = 0; i < 10; ++i)
+            A.push_back(Aligned{ i });
+        if ((uintptr_t)A.data() & 63)
+            return 86;
+        if (A[9].x != 9)
+            return 87;
+    }
+
+    {
+        ctl::vector<int> A(3, 5);
+        ctl::vector<int> B(10, 1);
+        B = A;
+        if (B.size() != 3 || B[2] != 5)
+            return 88;
+        A.shrink_to_fit();
+        A.clear();
+        A.shrink_to_fit();
+        if (A.capacity() != 0 || A.data() != nullptr)
+            return 89;
+    }
+
     CheckForMemoryLeaks();
     return 0;
 }
@@ -0,0 +1,151 @@
+/*-*- mode:c;indent-tabs-mode:nil;c-basic-offset:2;tab-width:8;coding:utf-8 -*-│
+│ vi: set et ft=c ts=2 sts=2 sw=2 fenc=utf-8                               :vi │
+╞══════════════════════════════════════════════════════════════════════════════╡
+│ Copyright 2024 Justine Alexandra Roberts Tunney                              │
+│                                                                              │
+│ Permission to use, copy, modify, and/or distribute this software for         │
+│ any purpose with or without fee is hereby granted, provided that the         │
+│ above copyright notice and this permission notice appear in all copies.      │
+│                                                                              │
+│ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL                │
+│ WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED                │
+│ WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE             │
+│ AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL         │
+│ DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR        │
+│ PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER               │
+│ TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR             │
+│ PERFORMANCE OF THIS SOFTWARE.                                                │
+╚─────────────────────────────────────────────────────────────────────────────*/
+#include "libc/calls/calls.h"
+#include "libc/dce.h"
+#include "libc/errno.h"
+#include "libc/mem/gc.h"
+#include "libc/mem/mem.h"
+#include "libc/runtime/runtime.h"
+#include "libc/sock/sock.h"
+#include "libc/stdio/rand.h"
+#include "libc/str/str.h"
+#include "libc/sysv/consts/af.h"
+#include "libc/sysv/consts/o.h"
+#include "libc/sysv/consts/sock.h"
+#include "libc/testlib/ezbench.h"
+#include "libc/testlib/subprocess.h"
+#include "libc/testlib/testlib.h"
+#include "libc/x/x.h"
+
+#define N (3 * 1048576 + 77)
+
+char *data;
+
+void SetUpOnce(void) {
+  testlib_enable_tmp_setup_teardown();
+}
+
+void SetUp(void) {
+  int fd;
+  data = gc(malloc(N));
+  rngset(data, N, lemur64, -1);
+  ASSERT_NE(-1, (fd = creat("foo", 0644)));
+  ASSERT_SYS(0, N, write(fd, data, N));
+  ASSERT_SYS(0, 0, close(fd));
+}
+
+void CheckBar(size_t off, size_t n) {
+  size_t m;
+  char *p = gc(xslurp("bar", &m));
+  ASSERT_EQ(n, m);
+  ASSERT_EQ(0, memcmp(data + off, p, n));
+}
+
+TEST(copyfd, fileToFile) {
+  ASSERT_SYS(0, 3, open("foo", O_RDONLY));
+  ASSERT_SYS(0, 4, creat("bar", 0644));
+  ASSERT_SYS(0, N, copyfd(3, 4, -1));
+  ASSERT_SYS(0, N, lseek(3, 0, SEEK_CUR));
+  ASSERT_SYS(0, N, lseek(4, 0, SEEK_CUR));
+  ASSERT_SYS(0, 0, copyfd(3, 4, -1));
+  ASSERT_SYS(0, 0, close(4));
+  ASSERT_SYS(0, 0, close(3));
+  CheckBar(0, N);
+}
+
+TEST(copyfd, fromFilePosition_copiesUpToCount) {
+  ASSERT_SYS(0, 3, open("foo", O_RDONLY));
+  ASSERT_SYS(0, 4, creat("bar", 0644));
+  ASSERT_SYS(0, 7, lseek(3, 7, SEEK_SET));
+  ASSERT_SYS(0, 100000, copyfd(3, 4, 100000));
+  ASSERT_SYS(0, 100007, lseek(3, 0, SEEK_CUR));
+  ASSERT_SYS(0, 0, close(4));
+  ASSERT_SYS(0, 0, close(3));
+  CheckBar(7, 100000);
+}
+
+TEST(copyfd, appendOnlyOutput_fallsBack) {
+  ASSERT_SYS(0, 3, open("foo", O_RDONLY));
+  ASSERT_SYS(0, 4, open("bar", O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644));
+  ASSERT_SYS(0, N, copyfd(3, 4, -1));
+  ASSERT_SYS(0, 0, close(4));
+  ASSERT_SYS(0, 0, close(3));
+  CheckBar(0, N);
+}
+
+TEST(copyfd, pipeToFile) {
+  int fds[2];
+  ASSERT_SYS(0, 0, pipe(fds));
+  SPAWN(fork);
+  ASSERT_SYS(0, 0, close(fds[0]));
+  ASSERT_SYS(0, 3, open("foo", O_RDONLY));
+  ASSERT_SYS(0, N, copyfd(3, fds[1], -1));
+  PARENT();
+  ASSERT_SYS(0, 0, close(fds[1]));
+  ASSERT_SYS(0, 4, creat("bar", 0644));
+  ASSERT_SYS(0, N, copyfd(fds[0], 4, -1));
+  ASSERT_SYS(0, 0, close(4));
+  ASSERT_SYS(0, 0, close(fds[0]));
+  WAIT(exit, 0);
+  CheckBar(0, N);
+}
+
+TEST(copyfd, fileToSocket) {
+  int fds[2];
+  ASSERT_SYS(0, 0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+  SPAWN(fork);
+  ASSERT_SYS(0, 0, close(fds[0]));
+  ASSERT_SYS(0, 3, open("foo", O_RDONLY));
+  ASSERT_SYS(0, N, copyfd(3, fds[1], -1));
+  PARENT();
+  ASSERT_SYS(0, 0, close(fds[1]));
+  ASSERT_SYS(0, 4, creat("bar", 0644));
+  ASSERT_SYS(0, N, copyfd(fds[0], 4, -1));
+  ASSERT_SYS(0, 0, close(4));
+  ASSERT_SYS(0, 0, close(fds[0]));
+  WAIT(exit, 0);
+  CheckBar(0, N);
+}
+
+TEST(copyfd, pseudoFile_isntMistakenForEmpty) {
+  if (!IsLinux())
+    return;
+  ASSERT_SYS(0, 3, open("/proc/self/stat", O_RDONLY));
+  ASSERT_SYS(0, 4, creat("bar", 0644));
+  ASSERT_NE(0, copyfd(3, 4, -1));
+  ASSERT_SYS(0, 0, close(4));
+  ASSERT_SYS(0, 0, close(3));
+}
+
+TEST(copyfd, badFd) {
+  ASSERT_SYS(EBADF, -1, copyfd(-1, 1, -1));
+}
+
+void Rewind(void) {
+  lseek(3, 0, SEEK_SET);
+  lseek(4, 0, SEEK_SET);
+}
+
+BENCH(copyfd, bench) {
+  ASSERT_SYS(0, 3, open("foo", O_RDONLY));
+  ASSERT_SYS(0, 4, creat("bar", 0644));
+  EZBENCH2("copyfd 3mb", Rewind(), copyfd(3, 4, -1));
+  ASSERT_SYS(0, 0, close(4));
+  ASSERT_SYS(0, 0, close(3));
+}
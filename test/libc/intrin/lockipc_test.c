@@ -43,7 +43,7 @@ void Worker(void) {
   }
 }
 
-TEST(lockipc, mutex) {
+void TestSharedMutex(int type) {
   int e, rc, ws, pid;
 
   // create shared memory
@@ -52,7 +52,7 @@ TEST(lockipc, mutex) {
   // create shared mutex
   pthread_mutexattr_t mattr;
   pthread_mutexattr_init(&mattr);
-  pthread_mutexattr_settype(&mattr, PTHREAD_MUTEX_NORMAL);
+  pthread_mutexattr_settype(&mattr, type);
   pthread_mutexattr_setpshared(&mattr, PTHREAD_PROCESS_SHARED);
   pthread_mutex_init(&shm->mutex, &mattr);
   pthread_mutexattr_destroy(&mattr);
@@ -88,3 +88,11 @@ TEST(lockipc, mutex) {
   ASSERT_EQ(0, pthread_mutex_destroy(&shm->mutex));
   ASSERT_SYS(0, 0, munmap(shm, __granularity()));
 }
+
+TEST(lockipc, mutex) {
+  TestSharedMutex(PTHREAD_MUTEX_NORMAL);
+}
+
+TEST(lockipc, recursiveMutex) {
+  TestSharedMutex(PTHREAD_MUTEX_RECURSIVE);
+}
@@ -440,3 +440,33 @@ BENCH(mmap, bench) {
   EZBENCH2("mmap", donothing, BenchMmapPrivate());
   EZBENCH2("munmap", donothing, BenchUnmap());
 }
+
+// linux won't let a process have more than 65530 mappings by default,
+// so we keep a window of regions alive while churning through the rest
+#define STRESS_REGIONS 100000
+#define STRESS_LIVE    30000
+
+char *stress[STRESS_LIVE];
+
+void StressMaps(void) {
+  int i, j;
+  for (i = 0; i < STRESS_REGIONS; ++i) {
+    j = i < STRESS_LIVE ? i : rand() % STRESS_LIVE;
+    if (stress[j] && munmap(stress[j], granularity))
+      __builtin_trap();
+    // alternate protection so the kernel and our tracker can't merge
+    stress[j] = mmap(0, granularity, i & 1 ? PROT_READ : PROT_READ | PROT_WRITE,
+                     MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+    if (stress[j] == MAP_FAILED)
+      __builtin_trap();
+  }
+  for (i = 0; i < STRESS_LIVE; ++i) {
+    if (munmap(stress[i], granularity))
+      __builtin_trap();
+    stress[i] = 0;
+  }
+}
+
+BENCH(mmap, stress) {
+  EZBENCH_N("mmap+munmap 100k", STRESS_REGIONS, StressMaps());
+}
@@ -23,6 +23,7 @@
 #include "libc/intrin/atomic.h"
 #include "libc/mem/gc.h"
 #include "libc/mem/mem.h"
+#include "libc/runtime/runtime.h"
 #include "libc/testlib/ezbench.h"
 #include "libc/testlib/testlib.h"
 #include "libc/thread/posixthread.internal.h"
@@ -75,11 +76,12 @@ void *MutexWorker(void *p) {
   return 0;
 }
 
-TEST(pthread_mutex_lock, contention) {
+void TestContention(int type, int pshared) {
   int i;
   pthread_t *th = gc(malloc(sizeof(pthread_t) * THREADS));
   pthread_mutexattr_init(&attr);
-  pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_NORMAL);
+  pthread_mutexattr_settype(&attr, type);
+  pthread_mutexattr_setpshared(&attr, pshared);
   pthread_mutex_init(&lock, &attr);
   pthread_mutexattr_destroy(&attr);
   count = 0;
@@ -97,6 +99,26 @@ TEST(pthread_mutex_lock, contention) {
   EXPECT_EQ(0, pthread_mutex_destroy(&lock));
 }
 
+TEST(pthread_mutex_lock, contention) {
+  TestContention(PTHREAD_MUTEX_NORMAL, PTHREAD_PROCESS_PRIVATE);
+}
+
+TEST(pthread_mutex_lock, contentionRecursive) {
+  TestContention(PTHREAD_MUTEX_RECURSIVE, PTHREAD_PROCESS_PRIVATE);
+}
+
+TEST(pthread_mutex_lock, contentionErrorcheck) {
+  TestContention(PTHREAD_MUTEX_ERRORCHECK, PTHREAD_PROCESS_PRIVATE);
+}
+
+TEST(pthread_mutex_lock, contentionShared) {
+  TestContention(PTHREAD_MUTEX_NORMAL, PTHREAD_PROCESS_SHARED);
+}
+
+TEST(pthread_mutex_lock, contentionSharedRecursive) {
+  TestContention(PTHREAD_MUTEX_RECURSIVE, PTHREAD_PROCESS_SHARED);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // BENCHMARKS
 
@@ -148,6 +170,15 @@ BENCH(pthread_mutex_lock, bench_uncontended) {
     pthread_mutex_init(&m, &attr);
     EZBENCH2("errorcheck 1x", donothing, BenchLockUnlock(&m));
   }
+  {
+    pthread_mutex_t m;
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_NORMAL);
+    pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    pthread_mutex_init(&m, &attr);
+    EZBENCH2("shared 1x", donothing, BenchLockUnlock(&m));
+  }
 }
 
 struct SpinContentionArgs {
@@ -264,4 +295,73 @@ BENCH(pthread_mutex_lock, bench_contended) {
     a.done = true;
     pthread_join(t, 0);
   }
+  {
+    pthread_mutex_t m;
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_NORMAL);
+    pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    pthread_mutex_init(&m, &attr);
+    struct MutexContentionArgs a = {&m};
+    pthread_create(&t, 0, MutexContentionWorker, &a);
+    while (!a.ready)
+      sched_yield();
+    EZBENCH2("shared 2x", donothing, BenchLockUnlock(&m));
+    a.done = true;
+    pthread_join(t, 0);
+  }
+  {
+    pthread_mutex_t m;
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    pthread_mutex_init(&m, &attr);
+    struct MutexContentionArgs a = {&m};
+    pthread_create(&t, 0, MutexContentionWorker, &a);
+    while (!a.ready)
+      sched_yield();
+    EZBENCH2("shared recursive 2x", donothing, BenchLockUnlock(&m));
+    a.done = true;
+    pthread_join(t, 0);
+  }
+}
+
+// runs more lockers than there are cpus, which is where spinning
+// without ever going to sleep used to fall over
+void BenchOversubscribed(const char *name, int type, int pshared) {
+  int i, n;
+  pthread_t *th;
+  pthread_mutex_t m;
+  pthread_mutexattr_t attr;
+  pthread_mutexattr_init(&attr);
+  pthread_mutexattr_settype(&attr, type);
+  pthread_mutexattr_setpshared(&attr, pshared);
+  pthread_mutex_init(&m, &attr);
+  pthread_mutexattr_destroy(&attr);
+  n = __get_cpu_count() * 2;
+  th = gc(malloc(sizeof(pthread_t) * n));
+  struct MutexContentionArgs a = {&m};
+  for (i = 0; i < n; ++i)
+    pthread_create(th + i, 0, MutexContentionWorker, &a);
+  while (!a.ready)
+    sched_yield();
+  EZBENCH2(name, donothing, BenchLockUnlock(&m));
+  a.done = true;
+  for (i = 0; i < n; ++i)
+    pthread_join(th[i], 0);
+  pthread_mutex_destroy(&m);
+}
+
+BENCH(pthread_mutex_lock, bench_oversubscribed) {
+  BenchOversubscribed("normal 2n", PTHREAD_MUTEX_NORMAL,
+                      PTHREAD_PROCESS_PRIVATE);
+  BenchOversubscribed("recursive 2n", PTHREAD_MUTEX_RECURSIVE,
+                      PTHREAD_PROCESS_PRIVATE);
+  BenchOversubscribed("errorcheck 2n", PTHREAD_MUTEX_ERRORCHECK,
+                      PTHREAD_PROCESS_PRIVATE);
+  BenchOversubscribed("shared 2n", PTHREAD_MUTEX_NORMAL,
+                      PTHREAD_PROCESS_SHARED);
+  BenchOversubscribed("shared recursive 2n", PTHREAD_MUTEX_RECURSIVE,
+                      PTHREAD_PROCESS_SHARED);
 }
@@ -0,0 +1,89 @@
+/*-*- mode:c;indent-tabs-mode:nil;c-basic-offset:2;tab-width:8;coding:utf-8 -*-│
+│ vi: set et ft=c ts=2 sts=2 sw=2 fenc=utf-8                               :vi │
+╞══════════════════════════════════════════════════════════════════════════════╡
+│ Copyright 2024 Justine Alexandra Roberts Tunney                              │
+│                                                                              │
+│ Permission to use, copy, modify, and/or distribute this software for         │
+│ any purpose with or without fee is hereby granted, provided that the         │
+│ above copyright notice and this permission notice appear in all copies.      │
+│                                                                              │
+│ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL                │
+│ WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED                │
+│ WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE             │
+│ AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL         │
+│ DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR        │
+│ PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER               │
+│ TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR             │
+│ PERFORMANCE OF THIS SOFTWARE.                                                │
+╚─────────────────────────────────────────────────────────────────────────────*/
+#include "libc/intrin/tree.h"
+#include "libc/macros.internal.h"
+#include "libc/stdio/rand.h"
+#include "libc/testlib/testlib.h"
+
+struct Number {
+  int x;
+  struct Tree elem;
+};
+
+#define NUMBER_CONTAINER(e) TREE_CONTAINER(struct Number, elem, e)
+
+int CompareNumbers(const struct Tree *ra, const struct Tree *rb) {
+  int a = NUMBER_CONTAINER(ra)->x;
+  int b = NUMBER_CONTAINER(rb)->x;
+  return (a > b) - (a < b);
+}
+
+// returns black height of subtree, or fails the test
+int CheckTree(struct Tree *node, struct Tree *parent) {
+  int left, right;
+  if (!node)
+    return 1;
+  ASSERT_EQ(parent, node->parent);
+  if (node->red) {
+    ASSERT_TRUE(!node->left || !node->left->red);
+    ASSERT_TRUE(!node->right || !node->right->red);
+  }
+  left = CheckTree(node->left, node);
+  right = CheckTree(node->right, node);
+  ASSERT_EQ(left, right);
+  return left + !node->red;
+}
+
+TEST(tree, empty) {
+  struct Tree *root = 0;
+  EXPECT_EQ(NULL, tree_first(root));
+  EXPECT_EQ(NULL, tree_last(root));
+}
+
+TEST(tree, insertThenRemove_staysBalancedAndOrdered) {
+  int i, j, n, count, last;
+  struct Tree *root = 0, *e;
+  bool present[1000] = {0};
+  static struct Number numbers[1000];
+  for (count = i = 0; i < 50000; ++i) {
+    j = rand() % ARRAYLEN(numbers);
+    if (present[j]) {
+      tree_remove(&root, &numbers[j].elem);
+      present[j] = false;
+      --count;
+    } else {
+      numbers[j].x = rand() % 100;
+      tree_insert(&root, &numbers[j].elem, CompareNumbers);
+      present[j] = true;
+      ++count;
+    }
+    if (i % 100)
+      continue;
+    ASSERT_TRUE(!root || !root->red);
+    CheckTree(root, 0);
+    for (n = 0, last = -1, e = tree_first(root); e; e = tree_next(e), ++n) {
+      ASSERT_LE(last, NUMBER_CONTAINER(e)->x);
+      last = NUMBER_CONTAINER(e)->x;
+    }
+    ASSERT_EQ(count, n);
+    for (n = 0, e = tree_last(root); e; e = tree_prev(e))
+      ++n;
+    ASSERT_EQ(count, n);
+  }
+}
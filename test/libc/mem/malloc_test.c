@@ -41,6 +41,7 @@
 #include "libc/testlib/subprocess.h"
 #include "libc/testlib/testlib.h"
 #include "libc/thread/thread.h"
+#include "libc/thread/thread2.h"
 #include "libc/time.h"
 
 #define N 1024
@@ -151,6 +152,147 @@ TEST(malloc, test) {
     close(fds[i]);
 }
 
+TEST(mallinfo, reportsThreadCache) {
+  char *p;
+  malloc_trim(0);
+  ASSERT_EQ(0, mallinfo().smblks);
+  ASSERT_NE(NULL, (p = malloc(16)));
+  free(p);
+  if (!mallinfo().smblks)
+    return;  // thread cache is disabled
+  ASSERT_EQ(1, mallinfo().smblks);
+  ASSERT_LE(16, mallinfo().fsmblks);
+  ASSERT_EQ(p, malloc(16));
+  ASSERT_EQ(0, mallinfo().smblks);
+  free(p);
+  malloc_trim(0);
+  ASSERT_EQ(0, mallinfo().smblks);
+  ASSERT_EQ(0, mallinfo().fsmblks);
+}
+
+static void CountInUse(void *start, void *end, size_t used, void *arg) {
+  *(size_t *)arg += used;
+}
+
+// returns bytes allocated across all arenas, after flushing caches
+static size_t InUse(void) {
+  size_t n = 0;
+  malloc_trim(0);
+  malloc_inspect_all(CountInUse, &n);
+  return n;
+}
+
+static void *ChurnWorker(void *arg) {
+  char *p[64];
+  for (int j = 0; j < 100; ++j) {
+    for (int i = 0; i < ARRAYLEN(p); ++i) {
+      ASSERT_NE(NULL, (p[i] = malloc(i * 8)));
+      memset(p[i], i, i * 8);
+    }
+    for (int i = 0; i < ARRAYLEN(p); ++i)
+      free(p[i]);
+  }
+  return 0;
+}
+
+TEST(malloc, threadCacheIsReleasedOnExit) {
+  size_t before;
+  pthread_t th[4];
+  // warm up, since the first thread switches malloc to many arenas
+  ASSERT_EQ(0, pthread_create(th, 0, ChurnWorker, 0));
+  ASSERT_EQ(0, pthread_join(th[0], 0));
+  before = InUse();
+  for (int i = 0; i < ARRAYLEN(th); ++i)
+    ASSERT_EQ(0, pthread_create(th + i, 0, ChurnWorker, 0));
+  for (int i = 0; i < ARRAYLEN(th); ++i)
+    ASSERT_EQ(0, pthread_join(th[i], 0));
+  // chunks left in a dead thread's cache would still count as in use
+  ASSERT_EQ(before, InUse());
+}
+
+static void *BulkWorker(void *arg) {
+  void **p = arg;
+  for (int i = 0; i < 256; ++i)
+    ASSERT_NE(NULL, (p[i] = malloc(i + 1)));
+  return 0;
+}
+
+TEST(bulk_free, pointersFromManyThreads_areAllFreedAndCleared) {
+  pthread_t th[4];
+  static void *p[4][256];
+  for (int i = 0; i < ARRAYLEN(th); ++i)
+    ASSERT_EQ(0, pthread_create(th + i, 0, BulkWorker, p[i]));
+  for (int i = 0; i < ARRAYLEN(th); ++i)
+    ASSERT_EQ(0, pthread_join(th[i], 0));
+  free(p[1][7]);
+  p[1][7] = 0;
+  ASSERT_EQ(0, bulk_free(&p[0][0], 4 * 256));
+  for (int i = 0; i < 4 * 256; ++i)
+    ASSERT_EQ(NULL, (&p[0][0])[i]);
+}
+
+static void *RemoteFreeWorker(void *arg) {
+  free(arg);
+  return 0;
+}
+
+TEST(free, fromOtherThread) {
+  size_t before;
+  pthread_t th;
+  ASSERT_EQ(0, pthread_create(&th, 0, RemoteFreeWorker, malloc(16)));
+  ASSERT_EQ(0, pthread_join(th, 0));
+  before = InUse();
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_EQ(0, pthread_create(&th, 0, RemoteFreeWorker, malloc(i * 16)));
+    ASSERT_EQ(0, pthread_join(th, 0));
+    free(malloc(i * 16));
+  }
+  // remotely freed chunks must find their way back to the owning arena
+  ASSERT_EQ(before, InUse());
+}
+
+static void *ManyRemoteFreesWorker(void *arg) {
+  cpu_set_t cs;
+  void **p = arg;
+  CPU_ZERO(&cs);
+  CPU_SET(1, &cs);
+  ASSERT_EQ(0, pthread_setaffinity_np(pthread_self(), sizeof(cs), &cs));
+  for (int i = 0; i < 1000; ++i)
+    free(p[i]);
+  return 0;
+}
+
+TEST(free, manyFromOtherThread_areDrainedInBatches) {
+  if (!IsLinux() || __get_cpu_count() < 2)
+    return;
+  SPAWN(fork);
+  size_t before;
+  pthread_t th;
+  cpu_set_t cs;
+  static void *p[1000];
+  // pin the threads to different cpus so they use different arenas
+  CPU_ZERO(&cs);
+  CPU_SET(0, &cs);
+  ASSERT_EQ(0, pthread_setaffinity_np(pthread_self(), sizeof(cs), &cs));
+  before = InUse();
+  // chunks this big bypass the thread cache and go on the remote queue
+  for (int i = 0; i < ARRAYLEN(p); ++i) {
+    ASSERT_NE(NULL, (p[i] = malloc(1024)));
+    memset(p[i], i, 1024);
+  }
+  ASSERT_EQ(0, pthread_create(&th, 0, ManyRemoteFreesWorker, p));
+  ASSERT_EQ(0, pthread_join(th, 0));
+  // the queue is many batches long and gets drained by the owning thread
+  for (int i = 0; i < ARRAYLEN(p); ++i) {
+    ASSERT_NE(NULL, (p[i] = malloc(1024)));
+    memset(p[i], i, 1024);
+  }
+  for (int i = 0; i < ARRAYLEN(p); ++i)
+    free(p[i]);
+  ASSERT_EQ(before, InUse());
+  EXITS(0);
+}
+
 TEST(memalign, roundsUpAlignmentToTwoPower) {
   char *volatile p = memalign(129, 1);
   ASSERT_EQ(0, (intptr_t)p & 255);
@@ -40,7 +40,8 @@ TEST_LIBC_RUNTIME_DIRECTDEPS =						\
 	LIBC_X								\
 	TOOL_BUILD_LIB							\
 	THIRD_PARTY_XED							\
-	THIRD_PARTY_ZLIB
+	THIRD_PARTY_ZLIB						\
+	THIRD_PARTY_ZSTD
 
 TEST_LIBC_RUNTIME_DEPS :=						\
 	$(call uniq,$(foreach x,$(TEST_LIBC_RUNTIME_DIRECTDEPS),$($(x))))
@@ -53,6 +54,7 @@ o/$(MODE)/test/libc/runtime/%.dbg:					\
 		$(TEST_LIBC_RUNTIME_DEPS)				\
 		o/$(MODE)/test/libc/mem/prog/life.elf.zip.o		\
 		o/$(MODE)/test/libc/runtime/prog/ftraceasm.txt.zip.o	\
+		o/$(MODE)/test/libc/runtime/hyperion.zst.zip.o		\
 		o/$(MODE)/test/libc/runtime/%.o				\
 		o/$(MODE)/test/libc/runtime/runtime.pkg			\
 		o/$(MODE)/test/libc/runtime/runtime.pkg			\
@@ -70,6 +72,16 @@ o/$(MODE)/test/libc/runtime/ape_test.dbg:				\
 		$(APE_NO_MODIFY_SELF)
 	@$(APELINK)
 
+o/$(MODE)/test/libc/runtime/zipos_stream_test.dbg:			\
+		$(TEST_LIBC_RUNTIME_DEPS)				\
+		o/$(MODE)/test/libc/runtime/unicodedata.txt.zip.o	\
+		o/$(MODE)/test/libc/runtime/zipos_stream_test.o		\
+		o/$(MODE)/test/libc/runtime/runtime.pkg			\
+		$(LIBC_TESTMAIN)					\
+		$(CRT)							\
+		$(APE_NO_MODIFY_SELF)
+	@$(APELINK)
+
 $(TEST_LIBC_RUNTIME_OBJS): private					\
 	DEFAULT_CCFLAGS +=						\
 		-fno-builtin
@@ -100,6 +112,21 @@ o/$(MODE)/test/libc/runtime/prog/ftraceasm.txt.zip.o: private		\
 		ZIPOBJ_FLAGS +=						\
 			-B
 
+o/$(MODE)/test/libc/runtime/hyperion.zst.zip.o: private		\
+		ZIPOBJ_FLAGS +=						\
+			-z						\
+			-N test/libc/runtime/hyperion.zst
+o/$(MODE)/test/libc/runtime/hyperion.zst.zip.o:			\
+		libc/testlib/hyperion.txt
+	@$(COMPILE) -wAZIPOBJ $(ZIPOBJ) $(ZIPOBJ_FLAGS) $(OUTPUT_OPTION) $<
+
+o/$(MODE)/test/libc/runtime/unicodedata.txt.zip.o: private		\
+		ZIPOBJ_FLAGS +=						\
+			-N test/libc/runtime/unicodedata.txt
+o/$(MODE)/test/libc/runtime/unicodedata.txt.zip.o:			\
+		libc/str/unicodedata.txt
+	@$(COMPILE) -wAZIPOBJ $(ZIPOBJ) $(ZIPOBJ_FLAGS) $(OUTPUT_OPTION) $<
+
 .PHONY: o/$(MODE)/test/libc/runtime
 o/$(MODE)/test/libc/runtime:						\
 		$(TEST_LIBC_RUNTIME_BINS)				\
@@ -0,0 +1,212 @@
+/*-*- mode:c;indent-tabs-mode:nil;c-basic-offset:2;tab-width:8;coding:utf-8 -*-│
+│ vi: set et ft=c ts=2 sts=2 sw=2 fenc=utf-8                               :vi │
+╞══════════════════════════════════════════════════════════════════════════════╡
+│ Copyright 2024 Justine Alexandra Roberts Tunney                              │
+│                                                                              │
+│ Permission to use, copy, modify, and/or distribute this software for         │
+│ any purpose with or without fee is hereby granted, provided that the         │
+│ above copyright notice and this permission notice appear in all copies.      │
+│                                                                              │
+│ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL                │
+│ WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED                │
+│ WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE             │
+│ AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL         │
+│ DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR        │
+│ PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER               │
+│ TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR             │
+│ PERFORMANCE OF THIS SOFTWARE.                                                │
+╚─────────────────────────────────────────────────────────────────────────────*/
+#include "libc/calls/struct/dirent.h"
+#include "libc/macros.internal.h"
+#include "libc/runtime/zipos.internal.h"
+#include "libc/serialize.h"
+#include "libc/str/str.h"
+#include "libc/sysv/consts/s.h"
+#include "libc/testlib/testlib.h"
+#include "libc/zip.internal.h"
+#include "tool/build/lib/zipindex.h"
+
+__static_yoink("zipos");
+
+#define PREFIX 100
+
+static const char *const kNames[] = {
+    "z",
+    "dir/c.txt",
+    "a.txt",
+    "dir/b.txt",
+};
+
+uint64_t lo, hi;
+struct Zipos z;
+uint8_t *idx, map[8192];
+size_t lfiles[ARRAYLEN(kNames)], cfiles[ARRAYLEN(kNames)];
+size_t lfileoff, lfilesize, cdiroff, cdirsize, eocdoff;
+
+static size_t AddLfile(size_t o, const char *name) {
+  uint8_t *p = map + o;
+  p = WRITE32LE(p, kZipLfileHdrMagic);
+  *p++ = kZipEra1989;
+  *p++ = kZipOsDos;
+  p = WRITE16LE(p, 0); /* gflags */
+  p = WRITE16LE(p, kZipCompressionNone);
+  p = WRITE16LE(p, 0); /* mtime */
+  p = WRITE16LE(p, 0); /* mdate */
+  p = WRITE32LE(p, 0); /* crc32 */
+  p = WRITE32LE(p, 0); /* compressed size */
+  p = WRITE32LE(p, 0); /* uncompressed size */
+  p = WRITE16LE(p, strlen(name));
+  p = WRITE16LE(p, 0); /* extra size */
+  p = mempcpy(p, name, strlen(name));
+  return p - map;
+}
+
+static size_t AddCfile(size_t o, const char *name, size_t lf) {
+  uint8_t *p = map + o;
+  p = WRITE32LE(p, kZipCfileHdrMagic);
+  *p++ = kZipCosmopolitanVersion;
+  *p++ = kZipOsUnix;
+  *p++ = kZipEra1989;
+  *p++ = kZipOsDos;
+  p = WRITE16LE(p, 0); /* gflags */
+  p = WRITE16LE(p, kZipCompressionNone);
+  p = WRITE16LE(p, 0); /* mtime */
+  p = WRITE16LE(p, 0); /* mdate */
+  p = WRITE32LE(p, 0); /* crc32 */
+  p = WRITE32LE(p, 0); /* compressed size */
+  p = WRITE32LE(p, 0); /* uncompressed size */
+  p = WRITE16LE(p, strlen(name));
+  p = WRITE16LE(p, 0); /* extra size */
+  p = WRITE16LE(p, 0); /* comment size */
+  p = WRITE16LE(p, 0); /* disk */
+  p = WRITE16LE(p, kZipIattrBinary);
+  p = WRITE32LE(p, (uint32_t)(S_IFREG | 0644) << 16);
+  p = WRITE32LE(p, lf);
+  p = mempcpy(p, name, strlen(name));
+  return p - map;
+}
+
+// lays out [junk][local files][index][central directory][index][eocd]
+void SetUp(void) {
+  size_t i, o;
+  bzero(map, sizeof(map));
+  memset(map, 'x', PREFIX);
+  for (o = PREFIX, i = 0; i < ARRAYLEN(kNames); ++i) {
+    lfiles[i] = o;
+    o = AddLfile(o, kNames[i]);
+  }
+  lfileoff = o;
+  lfilesize = GetZipIndexLfileSize(ARRAYLEN(kNames));
+  cdiroff = o = lfileoff + lfilesize;
+  for (i = 0; i < ARRAYLEN(kNames); ++i) {
+    cfiles[i] = o;
+    o = AddCfile(o, kNames[i], lfiles[i]);
+  }
+  cdirsize = o - cdiroff;
+  CreateZipIndex(map + lfileoff, map + cdiroff, cdirsize, ARRAYLEN(kNames),
+                 PREFIX, lfileoff, cdiroff);
+  cdirsize += GetZipIndexCfileSize();
+  eocdoff = cdiroff + cdirsize;
+  WRITE32LE(map + eocdoff, kZipCdirHdrMagic);
+  WRITE16LE(map + eocdoff + kZipCdirRecordsOnDiskOffset, ARRAYLEN(kNames) + 1);
+  WRITE16LE(map + eocdoff + kZipCdirRecordsOffset, ARRAYLEN(kNames) + 1);
+  WRITE32LE(map + eocdoff + kZipCdirSizeOffset, cdirsize);
+  WRITE32LE(map + eocdoff + kZipCdirOffsetOffset, cdiroff);
+  ASSERT_LE(eocdoff + kZipCdirHdrMinSize, sizeof(map));
+  idx = ZIP_LFILE_CONTENT(map + lfileoff);
+  bzero(&z, sizeof(z));
+  z.map = map;
+  z.cdir = map + eocdoff;
+  z.cdiroff = cdiroff;
+  z.records = ARRAYLEN(kNames) + 1;
+}
+
+static ssize_t Scan(const char *path) {
+  struct ZiposUri name;
+  name.len = strlen(path);
+  memcpy(name.path, path, name.len + 1);
+  return __zipos_scan(&z, &name);
+}
+
+TEST(__zipos_load_index, loadsIndexWrittenByTools) {
+  ASSERT_TRUE(__zipos_load_index(&z, &lo, &hi));
+  EXPECT_EQ(PREFIX, lo);
+  EXPECT_EQ(lfileoff + lfilesize, hi);
+  EXPECT_EQ(__zipos_index_slots(z.records) - 1, z.hashmask);
+  EXPECT_EQ(idx + ZIPOS_INDEX_HDRSIZE, z.index);
+}
+
+TEST(__zipos_load_index, indexIsSortedByName) {
+  ASSERT_TRUE(__zipos_load_index(&z, &lo, &hi));
+  EXPECT_EQ(cdiroff + cdirsize - GetZipIndexCfileSize(),
+            cdiroff + READ32LE(z.index + 0 * 4));
+  EXPECT_EQ(cfiles[2], cdiroff + READ32LE(z.index + 1 * 4));
+  EXPECT_EQ(cfiles[3], cdiroff + READ32LE(z.index + 2 * 4));
+  EXPECT_EQ(cfiles[1], cdiroff + READ32LE(z.index + 3 * 4));
+  EXPECT_EQ(cfiles[0], cdiroff + READ32LE(z.index + 4 * 4));
+}
+
+TEST(__zipos_scan, findsEntriesUsingIndex) {
+  ASSERT_TRUE(__zipos_load_index(&z, &lo, &hi));
+  EXPECT_EQ(cfiles[0], Scan("z"));
+  EXPECT_EQ(cfiles[1], Scan("dir/c.txt"));
+  EXPECT_EQ(cfiles[2], Scan("a.txt"));
+  EXPECT_EQ(cfiles[3], Scan("dir/b.txt/"));
+  EXPECT_EQ(ZIPOS_SYNTHETIC_DIRECTORY, Scan("dir"));
+  EXPECT_EQ(ZIPOS_SYNTHETIC_DIRECTORY, Scan(""));
+  EXPECT_EQ(-1, Scan("dir/a.txt"));
+  EXPECT_EQ(-1, Scan("b.txt"));
+  EXPECT_EQ(-1, Scan("zz"));
+}
+
+TEST(__zipos_load_index, rejectsWrongHashMask) {
+  WRITE32LE(idx + 12, READ32LE(idx + 12) * 2 + 1);
+  EXPECT_FALSE(__zipos_load_index(&z, &lo, &hi));
+  EXPECT_EQ(NULL, z.index);
+}
+
+TEST(__zipos_load_index, rejectsFullHashTable) {
+  size_t i, slots = __zipos_index_slots(z.records);
+  uint8_t *table = idx + ZIPOS_INDEX_HDRSIZE + z.records * 4;
+  for (i = 0; i < slots; ++i)
+    if (!READ32LE(table + i * 4))
+      WRITE32LE(table + i * 4, 1);
+  EXPECT_FALSE(__zipos_load_index(&z, &lo, &hi));
+}
+
+TEST(__zipos_load_index, rejectsOffsetsOutsideCentralDirectory) {
+  WRITE32LE(idx + ZIPOS_INDEX_HDRSIZE, cdirsize);
+  EXPECT_FALSE(__zipos_load_index(&z, &lo, &hi));
+}
+
+TEST(__zipos_load_index, rejectsExtentThatWouldUnmapLocalFiles) {
+  WRITE32LE(idx + 16, cdiroff - lfiles[1]);
+  EXPECT_FALSE(__zipos_load_index(&z, &lo, &hi));
+}
+
+TEST(__zipos_load_index, rejectsExtentThatWouldDropIndex) {
+  WRITE32LE(idx + 20, cdiroff - lfileoff);
+  EXPECT_FALSE(__zipos_load_index(&z, &lo, &hi));
+}
+
+TEST(__zipos_load_index, rejectsStaleIndex) {
+  WRITE32LE(idx + 8, cdirsize + 1);
+  EXPECT_FALSE(__zipos_load_index(&z, &lo, &hi));
+}
+
+TEST(__zipos_load_index, rejectsMissingIndex) {
+  --z.records;
+  WRITE16LE(map + eocdoff + kZipCdirRecordsOffset, z.records);
+  WRITE32LE(map + eocdoff + kZipCdirSizeOffset,
+            cdirsize - GetZipIndexCfileSize());
+  EXPECT_FALSE(__zipos_load_index(&z, &lo, &hi));
+}
+
+TEST(readdir, hidesIndex) {
+  DIR *dir;
+  struct dirent *e;
+  ASSERT_NE(NULL, (dir = opendir("/zip/")));
+  while ((e = readdir(dir)))
+    EXPECT_STRNE(ZIPOS_INDEX_NAME, e->d_name);
+  ASSERT_EQ(0, closedir(dir));
+}
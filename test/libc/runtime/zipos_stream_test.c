@@ -0,0 +1,152 @@
+/*-*- mode:c;indent-tabs-mode:nil;c-basic-offset:2;tab-width:8;coding:utf-8 -*-│
+│ vi: set et ft=c ts=2 sts=2 sw=2 fenc=utf-8                               :vi │
+╞══════════════════════════════════════════════════════════════════════════════╡
+│ Copyright 2024 Justine Alexandra Roberts Tunney                              │
+│                                                                              │
+│ Permission to use, copy, modify, and/or distribute this software for         │
+│ any purpose with or without fee is hereby granted, provided that the         │
+│ above copyright notice and this permission notice appear in all copies.      │
+│                                                                              │
+│ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL                │
+│ WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED                │
+│ WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE             │
+│ AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL         │
+│ DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR        │
+│ PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER               │
+│ TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR             │
+│ PERFORMANCE OF THIS SOFTWARE.                                                │
+╚─────────────────────────────────────────────────────────────────────────────*/
+#include "libc/calls/calls.h"
+#include "libc/calls/internal.h"
+#include "libc/calls/struct/stat.h"
+#include "libc/macros.internal.h"
+#include "libc/mem/mem.h"
+#include "libc/runtime/runtime.h"
+#include "libc/runtime/zipos.internal.h"
+#include "libc/stdio/rand.h"
+#include "libc/str/str.h"
+#include "libc/sysv/consts/map.h"
+#include "libc/sysv/consts/o.h"
+#include "libc/sysv/consts/prot.h"
+#include "libc/testlib/testlib.h"
+
+__static_yoink("zipos");
+__static_yoink("test/libc/runtime/unicodedata.txt");
+__static_yoink("_Cz_inflate");
+__static_yoink("_Cz_inflateInit2");
+__static_yoink("_Cz_inflateEnd");
+__static_yoink("_Cz_inflateReset2");
+__static_yoink("_Cz_inflatePrime");
+__static_yoink("_Cz_inflateSetDictionary");
+__static_yoink("_Cz_inflateGetDictionary");
+
+#define PATH "/zip/test/libc/runtime/unicodedata.txt"
+
+#define FIRST_LINE "0000;<control>;Cc;0;BN;;;;;N;NULL;;;;\n"
+#define LAST_LINE  "10FFFD;<Plane 16 Private Use, Last>;Co;0;L;;;;;N;;;;;\n"
+
+size_t size;
+char *content;
+
+void SetUpOnce(void) {
+  int fd;
+  struct stat st;
+  // disable the inflate cache so large members are always streamed
+  setenv("COSMOPOLITAN_ZIPOS_CACHE", "0", true);
+  ASSERT_NE(-1, (fd = open(PATH, O_RDONLY)));
+  ASSERT_SYS(0, 0, fstat(fd, &st));
+  size = st.st_size;
+  ASSERT_GT(size, 1024 * 1024);
+  content = malloc(size);
+  ASSERT_EQ(size, read(fd, content, size));
+  ASSERT_SYS(0, 0, close(fd));
+}
+
+void TearDownOnce(void) {
+  free(content);
+}
+
+TEST(zipos_stream, isStreamed) {
+  struct ZiposHandle *h;
+  ASSERT_SYS(0, 3, open(PATH, O_RDONLY));
+  h = (struct ZiposHandle *)(intptr_t)g_fds.p[3].handle;
+  EXPECT_NE(NULL, h->stream);
+  EXPECT_EQ(NULL, h->mem);
+  ASSERT_SYS(0, 0, close(3));
+}
+
+static size_t CountLines(const char *p, size_t n) {
+  size_t i, c;
+  for (c = i = 0; i < n; ++i)
+    c += p[i] == '\n';
+  return c;
+}
+
+TEST(zipos_stream, sequentialRead_inflatesWholeFile) {
+  EXPECT_EQ(0, memcmp(content, FIRST_LINE, strlen(FIRST_LINE)));
+  EXPECT_EQ(0, memcmp(content + size - strlen(LAST_LINE), LAST_LINE,
+                      strlen(LAST_LINE)));
+  EXPECT_EQ(34924, CountLines(content, size));
+}
+
+TEST(zipos_stream, smallSequentialReads) {
+  size_t i;
+  ssize_t rc;
+  char buf[1000];
+  ASSERT_SYS(0, 3, open(PATH, O_RDONLY));
+  for (i = 0; (rc = read(3, buf, sizeof(buf))); i += rc) {
+    ASSERT_NE(-1, rc);
+    ASSERT_EQ(0, memcmp(content + i, buf, rc));
+  }
+  ASSERT_EQ(size, i);
+  ASSERT_SYS(0, 0, close(3));
+}
+
+TEST(zipos_stream, seekBackwards_rewindsAndReinflates) {
+  char buf[4096];
+  ASSERT_SYS(0, 3, open(PATH, O_RDONLY));
+  ASSERT_EQ(size - 100, lseek(3, size - 100, SEEK_SET));
+  ASSERT_SYS(0, 100, read(3, buf, sizeof(buf)));
+  ASSERT_EQ(0, memcmp(content + size - 100, buf, 100));
+  // before first checkpoint
+  ASSERT_SYS(0, 0, lseek(3, 0, SEEK_SET));
+  ASSERT_SYS(0, sizeof(buf), read(3, buf, sizeof(buf)));
+  ASSERT_EQ(0, memcmp(content, buf, sizeof(buf)));
+  ASSERT_EQ(size - 4096, lseek(3, size - 4096, SEEK_SET));
+  ASSERT_SYS(0, sizeof(buf), read(3, buf, sizeof(buf)));
+  ASSERT_EQ(0, memcmp(content + size - 4096, buf, sizeof(buf)));
+  // after first checkpoint, which is placed around the first megabyte
+  ASSERT_EQ(1100000, lseek(3, 1100000, SEEK_SET));
+  ASSERT_SYS(0, sizeof(buf), read(3, buf, sizeof(buf)));
+  ASSERT_EQ(0, memcmp(content + 1100000, buf, sizeof(buf)));
+  ASSERT_SYS(0, 0, close(3));
+}
+
+TEST(zipos_stream, preadAtRandomOffsets) {
+  int i;
+  char buf[3000];
+  size_t off, len;
+  ASSERT_SYS(0, 3, open(PATH, O_RDONLY));
+  for (i = 0; i < 200; ++i) {
+    off = lemur64() % size;
+    len = MIN(sizeof(buf), size - off);
+    ASSERT_EQ(len, pread(3, buf, sizeof(buf), off));
+    ASSERT_EQ(0, memcmp(content + off, buf, len));
+  }
+  ASSERT_SYS(0, 0, pread(3, buf, sizeof(buf), size));
+  ASSERT_SYS(0, 0, lseek(3, 0, SEEK_CUR));
+  ASSERT_SYS(0, 0, close(3));
+}
+
+TEST(zipos_stream, mmap) {
+  char *p;
+  ASSERT_SYS(0, 3, open(PATH, O_RDONLY));
+  ASSERT_NE(MAP_FAILED, (p = mmap(0, size, PROT_READ, MAP_PRIVATE, 3, 0)));
+  EXPECT_EQ(0, memcmp(content, p, size));
+  EXPECT_SYS(0, 0, munmap(p, size));
+  ASSERT_NE(MAP_FAILED,
+            (p = mmap(0, 65536, PROT_READ, MAP_PRIVATE, 3, 1048576)));
+  EXPECT_EQ(0, memcmp(content + 1048576, p, 65536));
+  EXPECT_SYS(0, 0, munmap(p, 65536));
+  ASSERT_SYS(0, 0, close(3));
+}
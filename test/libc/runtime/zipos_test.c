@@ -17,6 +17,7 @@
 │ PERFORMANCE OF THIS SOFTWARE.                                                │
 ╚─────────────────────────────────────────────────────────────────────────────*/
 #include "libc/calls/calls.h"
+#include "libc/calls/internal.h"
 #include "libc/calls/struct/stat.h"
 #include "libc/errno.h"
 #include "libc/limits.h"
@@ -26,6 +27,7 @@
 #include "libc/runtime/zipos.internal.h"
 #include "libc/str/str.h"
 #include "libc/sysv/consts/o.h"
+#include "libc/testlib/ezbench.h"
 #include "libc/testlib/hyperion.h"
 #include "libc/testlib/subprocess.h"
 #include "libc/testlib/testlib.h"
@@ -36,6 +38,7 @@ __static_yoink("libc/testlib/hyperion.txt");
 __static_yoink("_Cz_inflate");
 __static_yoink("_Cz_inflateInit2");
 __static_yoink("_Cz_inflateEnd");
+__static_yoink("ZSTD_decompress");
 
 void *Worker(void *arg) {
   int i, fd;
@@ -181,3 +184,31 @@ TEST(zipos, ultraPosixAtomicSeekRead) {
   EXPECT_EQ(960, lseek(3, 0, SEEK_CUR));
   ASSERT_SYS(0, 0, close(3));
 }
+
+TEST(zipos, inflatedContentIsShared) {
+  struct ZiposHandle *h3, *h4;
+  ASSERT_SYS(0, 3, open("/zip/libc/testlib/hyperion.txt", O_RDONLY));
+  ASSERT_SYS(0, 4, open("/zip/libc/testlib/hyperion.txt", O_RDONLY));
+  h3 = (struct ZiposHandle *)g_fds.p[3].handle;
+  h4 = (struct ZiposHandle *)g_fds.p[4].handle;
+  ASSERT_NE(h3, h4);
+  EXPECT_EQ(h3->mem, h4->mem);
+  EXPECT_SYS(0, 0, close(3));
+  EXPECT_EQ(0, memcmp(h4->mem, kHyperion, kHyperionSize));
+  EXPECT_SYS(0, 0, close(4));
+}
+
+TEST(zipos, zstd) {
+  char *data = gc(malloc(kHyperionSize));
+  ASSERT_SYS(0, 3, open("/zip/test/libc/runtime/hyperion.zst", O_RDONLY));
+  EXPECT_SYS(0, kHyperionSize, read(3, data, kHyperionSize));
+  EXPECT_EQ(0, memcmp(data, kHyperion, kHyperionSize));
+  EXPECT_SYS(0, 0, close(3));
+}
+
+BENCH(zipos, bench) {
+  EZBENCH2("open+close deflated", donothing,
+           close(open("/zip/libc/testlib/hyperion.txt", O_RDONLY)));
+  EZBENCH2("open+close zstd", donothing,
+           close(open("/zip/test/libc/runtime/hyperion.zst", O_RDONLY)));
+}
@@ -0,0 +1,247 @@
+/*-*- mode:c;indent-tabs-mode:nil;c-basic-offset:2;tab-width:8;coding:utf-8 -*-│
+│ vi: set et ft=c ts=2 sts=2 sw=2 fenc=utf-8                               :vi │
+╞══════════════════════════════════════════════════════════════════════════════╡
+│ Copyright 2024 Justine Alexandra Roberts Tunney                              │
+│                                                                              │
+│ Permission to use, copy, modify, and/or distribute this software for         │
+│ any purpose with or without fee is hereby granted, provided that the         │
+│ above copyright notice and this permission notice appear in all copies.      │
+│                                                                              │
+│ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL                │
+│ WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED                │
+│ WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE             │
+│ AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL         │
+│ DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR        │
+│ PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER               │
+│ TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR             │
+│ PERFORMANCE OF THIS SOFTWARE.                                                │
+╚─────────────────────────────────────────────────────────────────────────────*/
+#include "libc/sock/uring.h"
+#include "libc/calls/calls.h"
+#include "libc/calls/struct/iovec.h"
+#include "libc/dce.h"
+#include "libc/errno.h"
+#include "libc/sock/sock.h"
+#include "libc/sock/struct/sockaddr.h"
+#include "libc/str/str.h"
+#include "libc/sysv/consts/af.h"
+#include "libc/sysv/consts/at.h"
+#include "libc/sysv/consts/f.h"
+#include "libc/sysv/consts/inaddr.h"
+#include "libc/sysv/consts/ipproto.h"
+#include "libc/sysv/consts/o.h"
+#include "libc/sysv/consts/sock.h"
+#include "libc/testlib/ezbench.h"
+#include "libc/testlib/testlib.h"
+
+#define FOR_EACH_RING(r)                                          \
+  for (int emu_ = 0; emu_ < 2; ++emu_)                            \
+    for (struct cosmo_ring *r =                                   \
+             cosmo_ring_create(8, emu_ ? COSMO_RING_EMULATE : 0); \
+         r; cosmo_ring_destroy(r), r = 0)
+
+struct cosmo_ring_cqe cqe[16];
+
+void SetUpOnce(void) {
+  testlib_enable_tmp_setup_teardown();
+}
+
+// waits for n completions and sorts them by user data
+void Wait(struct cosmo_ring *r, int n) {
+  int i, j, k;
+  struct cosmo_ring_cqe t;
+  for (i = 0; i < n; i += k)
+    ASSERT_GT((k = cosmo_ring_wait(r, cqe + i, 16 - i, n - i)), 0);
+  for (i = 1; i < n; ++i)
+    for (j = i; j && cqe[j - 1].data > cqe[j].data; --j)
+      t = cqe[j], cqe[j] = cqe[j - 1], cqe[j - 1] = t;
+}
+
+TEST(uring, nop) {
+  FOR_EACH_RING(r) {
+    ASSERT_NE(NULL, cosmo_ring_nop(r, 7));
+    Wait(r, 1);
+    EXPECT_EQ(7, cqe[0].data);
+    EXPECT_EQ(0, cqe[0].res);
+    EXPECT_EQ(0, cosmo_ring_wait(r, cqe, 16, 0));
+  }
+}
+
+TEST(uring, fullSubmissionQueue_raisesEbusy) {
+  FOR_EACH_RING(r) {
+    for (int i = 0; i < 8; ++i)
+      ASSERT_NE(NULL, cosmo_ring_nop(r, i));
+    EXPECT_EQ(NULL, cosmo_ring_nop(r, 8));
+    EXPECT_EQ(EBUSY, errno);
+    EXPECT_EQ(8, cosmo_ring_submit(r));
+    Wait(r, 8);
+    for (int i = 0; i < 8; ++i)
+      EXPECT_EQ(i, cqe[i].data);
+  }
+}
+
+TEST(uring, linkedPipeWriteRead) {
+  int p[2];
+  char buf[8] = {0};
+  FOR_EACH_RING(r) {
+    ASSERT_SYS(0, 0, pipe(p));
+    cosmo_ring_sqe_flags(cosmo_ring_write(r, p[1], "hello", 5, -1, 1),
+                         COSMO_RING_LINK);
+    cosmo_ring_read(r, p[0], buf, sizeof(buf), -1, 2);
+    Wait(r, 2);
+    EXPECT_EQ(5, cqe[0].res);
+    EXPECT_EQ(5, cqe[1].res);
+    EXPECT_STREQ("hello", buf);
+    ASSERT_SYS(0, 0, close(p[1]));
+    ASSERT_SYS(0, 0, close(p[0]));
+  }
+}
+
+TEST(uring, failedLink_cancelsRest) {
+  char c;
+  FOR_EACH_RING(r) {
+    cosmo_ring_sqe_flags(cosmo_ring_read(r, 999, &c, 1, -1, 1),
+                         COSMO_RING_LINK);
+    cosmo_ring_nop(r, 2);
+    Wait(r, 2);
+    EXPECT_EQ(-EBADF, cqe[0].res);
+    EXPECT_EQ(-ECANCELED, cqe[1].res);
+  }
+}
+
+TEST(uring, fileOperations) {
+  int fd;
+  char a[2], b[3], buf[8];
+  struct iovec wv[2] = {{"12", 2}, {"345", 3}};
+  struct iovec rv[2] = {{a, 2}, {b, 3}};
+  FOR_EACH_RING(r) {
+    cosmo_ring_openat(r, AT_FDCWD, "file", O_RDWR | O_CREAT | O_TRUNC, 0644,
+                      1);
+    Wait(r, 1);
+    ASSERT_GE((fd = cqe[0].res), 0);
+    cosmo_ring_sqe_flags(cosmo_ring_write(r, fd, "abcdef", 6, 100, 1),
+                         COSMO_RING_LINK);
+    cosmo_ring_sqe_flags(cosmo_ring_fsync(r, fd, COSMO_RING_FSYNC_DATASYNC, 2),
+                         COSMO_RING_LINK);
+    cosmo_ring_read(r, fd, buf, 3, 102, 3);
+    Wait(r, 3);
+    EXPECT_EQ(6, cqe[0].res);
+    EXPECT_EQ(0, cqe[1].res);
+    EXPECT_EQ(3, cqe[2].res);
+    EXPECT_EQ(0, memcmp(buf, "cde", 3));
+    cosmo_ring_writev(r, fd, wv, 2, 0, 1);
+    Wait(r, 1);
+    EXPECT_EQ(5, cqe[0].res);
+    cosmo_ring_readv(r, fd, rv, 2, 0, 1);
+    Wait(r, 1);
+    EXPECT_EQ(5, cqe[0].res);
+    EXPECT_EQ(0, memcmp(a, "12", 2));
+    EXPECT_EQ(0, memcmp(b, "345", 3));
+    cosmo_ring_close(r, fd, 1);
+    Wait(r, 1);
+    EXPECT_EQ(0, cqe[0].res);
+    EXPECT_SYS(EBADF, -1, fcntl(fd, F_GETFD));
+  }
+}
+
+TEST(uring, registeredBuffersAndFiles) {
+  int fd;
+  char buf[8];
+  static char mem[4096];
+  struct iovec reg = {mem, sizeof(mem)};
+  FOR_EACH_RING(r) {
+    ASSERT_NE(-1, (fd = open("file", O_RDWR | O_CREAT | O_TRUNC, 0644)));
+    ASSERT_SYS(0, 6, pwrite(fd, "abcdef", 6, 0));
+    ASSERT_SYS(0, 0, cosmo_ring_register_buffers(r, &reg, 1));
+    ASSERT_SYS(EBUSY, -1, cosmo_ring_register_buffers(r, &reg, 1));
+    ASSERT_SYS(0, 0, cosmo_ring_register_files(r, &fd, 1));
+    cosmo_ring_sqe_flags(cosmo_ring_read_fixed(r, 0, mem + 10, 6, 0, 0, 1),
+                         COSMO_RING_FIXED_FILE);
+    Wait(r, 1);
+    EXPECT_EQ(6, cqe[0].res);
+    EXPECT_EQ(0, memcmp(mem + 10, "abcdef", 6));
+    cosmo_ring_write_fixed(r, fd, mem + 10, 6, 6, 0, 1);
+    Wait(r, 1);
+    EXPECT_EQ(6, cqe[0].res);
+    cosmo_ring_read_fixed(r, fd, buf, 6, 0, 0, 1);
+    Wait(r, 1);
+    EXPECT_EQ(-EFAULT, cqe[0].res);
+    ASSERT_SYS(0, 0, close(fd));
+  }
+}
+
+TEST(uring, splice) {
+  int fd, p[2];
+  char buf[8];
+  if (!IsLinux())
+    return;
+  FOR_EACH_RING(r) {
+    ASSERT_SYS(0, 0, pipe(p));
+    ASSERT_NE(-1, (fd = open("file", O_RDWR | O_CREAT | O_TRUNC, 0644)));
+    ASSERT_SYS(0, 6, pwrite(fd, "abcdef", 6, 0));
+    cosmo_ring_splice(r, fd, 2, p[1], -1, 4, 0, 1);
+    Wait(r, 1);
+    EXPECT_EQ(4, cqe[0].res);
+    ASSERT_SYS(0, 4, read(p[0], buf, 4));
+    EXPECT_EQ(0, memcmp(buf, "cdef", 4));
+    ASSERT_SYS(0, 0, close(fd));
+    ASSERT_SYS(0, 0, close(p[1]));
+    ASSERT_SYS(0, 0, close(p[0]));
+  }
+}
+
+TEST(uring, sockets) {
+  char buf[8];
+  int ls, cs, as;
+  uint32_t addrlen;
+  struct sockaddr_in addr, peer;
+  FOR_EACH_RING(r) {
+    addrlen = sizeof(addr);
+    bzero(&addr, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASSERT_NE(-1, (ls = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP)));
+    ASSERT_SYS(0, 0, bind(ls, (struct sockaddr *)&addr, sizeof(addr)));
+    ASSERT_SYS(0, 0, getsockname(ls, (struct sockaddr *)&addr, &addrlen));
+    ASSERT_SYS(0, 0, listen(ls, 10));
+    ASSERT_NE(-1, (cs = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP)));
+    addrlen = sizeof(peer);
+    cosmo_ring_accept(r, ls, (struct sockaddr *)&peer, &addrlen, SOCK_CLOEXEC,
+                      1);
+    cosmo_ring_connect(r, cs, (struct sockaddr *)&addr, sizeof(addr), 2);
+    Wait(r, 2);
+    ASSERT_GE((as = cqe[0].res), 0);
+    EXPECT_EQ(0, cqe[1].res);
+    EXPECT_EQ(sizeof(peer), addrlen);
+    cosmo_ring_recv(r, as, buf, sizeof(buf), 0, 1);
+    cosmo_ring_send(r, cs, "ping", 4, 0, 2);
+    Wait(r, 2);
+    EXPECT_EQ(4, cqe[0].res);
+    EXPECT_EQ(4, cqe[1].res);
+    EXPECT_EQ(0, memcmp(buf, "ping", 4));
+    // blocking operation that's still in flight gets canceled
+    cosmo_ring_recv(r, as, buf, 1, 0, 3);
+    EXPECT_EQ(1, cosmo_ring_submit(r));
+    ASSERT_SYS(0, 0, close(as));
+    ASSERT_SYS(0, 0, close(cs));
+    ASSERT_SYS(0, 0, close(ls));
+  }
+}
+
+BENCH(uring, bench) {
+  int fd;
+  char buf[64];
+  ASSERT_NE(-1, (fd = open("/dev/zero", O_RDONLY)));
+  FOR_EACH_RING(r) {
+    EZBENCH2(emu_ ? "pread (emulated)" : "pread (io_uring)", donothing, ({
+               for (int i = 0; i < 8; ++i)
+                 cosmo_ring_read(r, fd, buf, sizeof(buf), 0, i);
+               Wait(r, 8);
+             }));
+  }
+  EZBENCH2("pread x8", donothing, ({
+             for (int i = 0; i < 8; ++i)
+               pread(fd, buf, sizeof(buf), 0);
+           }));
+  close(fd);
+}
@@ -17,6 +17,7 @@
 │ PERFORMANCE OF THIS SOFTWARE.                                                │
 ╚─────────────────────────────────────────────────────────────────────────────*/
 #include "libc/calls/calls.h"
+#include "libc/calls/struct/stat.h"
 #include "libc/calls/struct/sigaction.h"
 #include "libc/calls/struct/sigset.h"
 #include "libc/dce.h"
@@ -26,9 +27,12 @@
 #include "libc/runtime/runtime.h"
 #include "libc/stdio/rand.h"
 #include "libc/stdio/stdio.h"
+#include "libc/stdio/stdio_ext.h"
 #include "libc/str/str.h"
 #include "libc/sysv/consts/sig.h"
 #include "libc/testlib/testlib.h"
+#include "libc/thread/posixthread.internal.h"
+#include "libc/thread/thread.h"
 #include "libc/time.h"
 
 #define PATH "hog"
@@ -139,6 +143,96 @@ TEST(fwrite, testNoBuffer) {
   EXPECT_NE(-1, fclose(f));
 }
 
+int64_t FileSize(const char *path) {
+  struct stat st;
+  if (stat(path, &st))
+    return -1;
+  return st.st_size;
+}
+
+TEST(fwrite, testBigWritesBypassBuffer) {
+  char *mem = gc(malloc(3000));
+  rngset(mem, 3000, _rand64, -1);
+  ASSERT_NE(NULL, (f = fopen(PATH, "wb")));
+  EXPECT_EQ(5, fwrite("hello", 1, 5, f));
+  EXPECT_EQ(3000, fwrite(mem, 1, 3000, f));
+  EXPECT_EQ(3005, FileSize(PATH));
+  EXPECT_EQ(5, fwrite("hello", 1, 5, f));
+  EXPECT_EQ(3005, FileSize(PATH));
+  EXPECT_NE(-1, fclose(f));
+  ASSERT_NE(NULL, (f = fopen(PATH, "r")));
+  char *got = gc(malloc(3010));
+  EXPECT_EQ(3010, fread(got, 1, 3010, f));
+  EXPECT_EQ(0, memcmp(got, "hello", 5));
+  EXPECT_EQ(0, memcmp(got + 5, mem, 3000));
+  EXPECT_EQ(0, memcmp(got + 3005, "hello", 5));
+  EXPECT_NE(-1, fclose(f));
+}
+
+TEST(setvbuf, allocatesBuffer) {
+  ASSERT_NE(NULL, (f = fopen(PATH, "wb")));
+  ASSERT_EQ(0, setvbuf(f, NULL, _IOFBF, 100000));
+  EXPECT_EQ(100000, __fbufsize(f));
+  EXPECT_EQ(5, fwrite("hello", 1, 5, f));
+  ASSERT_EQ(0, setvbuf(f, NULL, _IOFBF, 4 * 1024 * 1024));
+  EXPECT_EQ(4 * 1024 * 1024, __fbufsize(f));
+  EXPECT_EQ(5, FileSize(PATH));
+  EXPECT_EQ(5, fwrite("there", 1, 5, f));
+  EXPECT_NE(-1, fclose(f));
+  ASSERT_NE(NULL, (f = fopen(PATH, "r")));
+  EXPECT_EQ(10, fread(buf, 1, sizeof(buf), f));
+  EXPECT_EQ(0, memcmp(buf, "hellothere", 10));
+  EXPECT_NE(-1, fclose(f));
+}
+
+TEST(fautoflush_np, test) {
+  int i;
+  ASSERT_NE(NULL, (f = fopen(PATH, "wb")));
+  ASSERT_EQ(0, setvbuf(f, NULL, _IOFBF, 100000));
+  ASSERT_EQ(0, fautoflush_np(f, 1));
+  EXPECT_EQ(5, fwrite("hello", 1, 5, f));
+  for (i = 0; i < 1000 && FileSize(PATH) != 5; ++i)
+    usleep(1000);
+  EXPECT_EQ(5, FileSize(PATH));
+  ASSERT_EQ(0, fautoflush_np(f, 0));
+  EXPECT_NE(-1, fclose(f));
+  // thread should go away once no streams want it
+  for (i = 0; i < 1000 && !pthread_orphan_np(); ++i) {
+    usleep(1000);
+    _pthread_decimate();
+  }
+  EXPECT_TRUE(pthread_orphan_np());
+}
+
+TEST(fautoflush_np, closingStreamStopsThread) {
+  int i;
+  ASSERT_NE(NULL, (f = fopen(PATH, "wb")));
+  ASSERT_EQ(0, setvbuf(f, NULL, _IOFBF, 100000));
+  ASSERT_EQ(0, fautoflush_np(f, 1));
+  EXPECT_EQ(5, fwrite("hello", 1, 5, f));
+  EXPECT_NE(-1, fclose(f));
+  EXPECT_EQ(5, FileSize(PATH));
+  for (i = 0; i < 1000 && !pthread_orphan_np(); ++i) {
+    usleep(1000);
+    _pthread_decimate();
+  }
+  EXPECT_TRUE(pthread_orphan_np());
+  // and it comes back when asked for again
+  ASSERT_NE(NULL, (f = fopen(PATH, "wb")));
+  ASSERT_EQ(0, setvbuf(f, NULL, _IOFBF, 100000));
+  ASSERT_EQ(0, fautoflush_np(f, 1));
+  EXPECT_EQ(3, fwrite("bye", 1, 3, f));
+  for (i = 0; i < 1000 && FileSize(PATH) != 3; ++i)
+    usleep(1000);
+  EXPECT_EQ(3, FileSize(PATH));
+  EXPECT_NE(-1, fclose(f));
+  for (i = 0; i < 1000 && !pthread_orphan_np(); ++i) {
+    usleep(1000);
+    _pthread_decimate();
+  }
+  EXPECT_TRUE(pthread_orphan_np());
+}
+
 void MeatyReadWriteTest(void) {
   size_t n;
   char *mem, *buf;
@@ -0,0 +1,155 @@
+/*-*- mode:c;indent-tabs-mode:nil;c-basic-offset:2;tab-width:8;coding:utf-8 -*-│
+│ vi: set et ft=c ts=2 sts=2 sw=2 fenc=utf-8                               :vi │
+╞══════════════════════════════════════════════════════════════════════════════╡
+│ Copyright 2024 Justine Alexandra Roberts Tunney                              │
+│                                                                              │
+│ Permission to use, copy, modify, and/or distribute this software for         │
+│ any purpose with or without fee is hereby granted, provided that the         │
+│ above copyright notice and this permission notice appear in all copies.      │
+│                                                                              │
+│ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL                │
+│ WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED                │
+│ WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE             │
+│ AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL         │
+│ DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR        │
+│ PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER               │
+│ TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR             │
+│ PERFORMANCE OF THIS SOFTWARE.                                                │
+╚─────────────────────────────────────────────────────────────────────────────*/
+#include "libc/math.h"
+#include "libc/mem/alg.h"
+#include "libc/mem/gc.h"
+#include "libc/mem/mem.h"
+#include "libc/stdio/rand.h"
+#include "libc/stdio/stdio.h"
+#include "libc/str/str.h"
+#include "libc/testlib/ezbench.h"
+#include "libc/testlib/testlib.h"
+#include "third_party/vqsort/vqsort.h"
+
+int CompareUint64(const void *a, const void *b) {
+  const uint64_t *x = a;
+  const uint64_t *y = b;
+  if (*x < *y)
+    return -1;
+  if (*x > *y)
+    return +1;
+  return 0;
+}
+
+int CompareDouble(const void *a, const void *b) {
+  const double *x = a;
+  const double *y = b;
+  if (*x < *y)
+    return -1;
+  if (*x > *y)
+    return +1;
+  return 0;
+}
+
+int CompareKv64(const void *a, const void *b) {
+  const struct vqsort_kv64 *x = a;
+  const struct vqsort_kv64 *y = b;
+  if (x->key != y->key)
+    return x->key < y->key ? -1 : +1;
+  if (x->value != y->value)
+    return x->value < y->value ? -1 : +1;
+  return 0;
+}
+
+TEST(vqsort_uint64, test) {
+  size_t i, n = 5000;
+  uint64_t *a = gc(malloc(n * sizeof(uint64_t)));
+  uint64_t *b = gc(malloc(n * sizeof(uint64_t)));
+  for (i = 0; i < n; ++i)
+    a[i] = b[i] = lemur64();
+  qsort(a, n, sizeof(uint64_t), CompareUint64);
+  vqsort_uint64(b, n);
+  ASSERT_EQ(0, memcmp(a, b, n * sizeof(uint64_t)));
+}
+
+TEST(vqsort_uint32, test) {
+  size_t i, n = 5000;
+  uint32_t *a = gc(malloc(n * sizeof(uint32_t)));
+  for (i = 0; i < n; ++i)
+    a[i] = lemur64();
+  vqsort_uint32(a, n);
+  for (i = 1; i < n; ++i)
+    ASSERT_LE(a[i - 1], a[i]);
+}
+
+TEST(vqsort_double, test) {
+  size_t i, n = 5000;
+  double *a = gc(malloc(n * sizeof(double)));
+  double *b = gc(malloc(n * sizeof(double)));
+  for (i = 0; i < n; ++i)
+    a[i] = b[i] = (double)(int64_t)lemur64() / (lemur64() | 1);
+  a[0] = b[0] = -INFINITY;
+  a[1] = b[1] = INFINITY;
+  a[2] = b[2] = 0;
+  qsort(a, n, sizeof(double), CompareDouble);
+  vqsort_double(b, n);
+  ASSERT_EQ(0, memcmp(a, b, n * sizeof(double)));
+}
+
+TEST(vqsort_double, negativeZeroComesFirst) {
+  double a[] = {0., -0., 1., -1.};
+  vqsort_double(a, 4);
+  ASSERT_TRUE(a[0] == -1 && signbit(a[1]) && !signbit(a[2]) && a[3] == 1);
+}
+
+TEST(vqsort_float, test) {
+  size_t i, n = 5000;
+  float *a = gc(malloc(n * sizeof(float)));
+  for (i = 0; i < n; ++i)
+    a[i] = (float)(int32_t)lemur64() / 3;
+  vqsort_float(a, n);
+  for (i = 1; i < n; ++i)
+    ASSERT_LE(a[i - 1], a[i]);
+}
+
+void CheckKv64(uint64_t keymask) {
+  size_t i, n = 5000;
+  struct vqsort_kv64 *a = gc(malloc(n * sizeof(struct vqsort_kv64)));
+  struct vqsort_kv64 *b = gc(malloc(n * sizeof(struct vqsort_kv64)));
+  for (i = 0; i < n; ++i) {
+    a[i].key = b[i].key = lemur64() & keymask;
+    a[i].value = b[i].value = lemur64() % 100;
+  }
+  qsort(a, n, sizeof(struct vqsort_kv64), CompareKv64);
+  vqsort_kv64(b, n);
+  ASSERT_EQ(0, memcmp(a, b, n * sizeof(struct vqsort_kv64)));
+}
+
+TEST(vqsort_kv64, smallKeys) {
+  CheckKv64(1023);
+}
+
+TEST(vqsort_kv64, bigKeys) {
+  CheckKv64(-1);
+}
+
+TEST(vqsort_kv64, sameKeys) {
+  CheckKv64(0);
+}
+
+BENCH(vqsort_kv64, bench) {
+  size_t i, n = 1000000;
+  struct vqsort_kv64 *p1 = gc(malloc(n * sizeof(struct vqsort_kv64)));
+  struct vqsort_kv64 *p2 = gc(malloc(n * sizeof(struct vqsort_kv64)));
+  printf("\n");
+  for (i = 0; i < n; ++i) {
+    p1[i].key = lemur64() % n;
+    p1[i].value = lemur64();
+  }
+  EZBENCH2("qsort kv64 small", memcpy(p2, p1, n * sizeof(*p1)),
+           qsort(p2, n, sizeof(*p2), CompareKv64));
+  EZBENCH2("vqsort_kv64 small", memcpy(p2, p1, n * sizeof(*p1)),
+           vqsort_kv64(p2, n));
+  for (i = 0; i < n; ++i)
+    p1[i].key = lemur64();
+  EZBENCH2("qsort kv64 big", memcpy(p2, p1, n * sizeof(*p1)),
+           qsort(p2, n, sizeof(*p2), CompareKv64));
+  EZBENCH2("vqsort_kv64 big", memcpy(p2, p1, n * sizeof(*p1)),
+           vqsort_kv64(p2, n));
+}
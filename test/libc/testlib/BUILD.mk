@@ -0,0 +1,54 @@
+#-*-mode:makefile-gmake;indent-tabs-mode:t;tab-width:8;coding:utf-8-*-┐
+#── vi: set noet ft=make ts=8 sw=8 fenc=utf-8 :vi ────────────────────┘
+
+PKGS += TEST_LIBC_TESTLIB
+
+TEST_LIBC_TESTLIB_SRCS := $(wildcard test/libc/testlib/*.c)
+TEST_LIBC_TESTLIB_SRCS_TEST = $(filter %_test.c,$(TEST_LIBC_TESTLIB_SRCS))
+TEST_LIBC_TESTLIB_BINS =				\
+	$(TEST_LIBC_TESTLIB_COMS)			\
+	$(TEST_LIBC_TESTLIB_COMS:%=%.dbg)
+
+TEST_LIBC_TESTLIB_OBJS =				\
+	$(TEST_LIBC_TESTLIB_SRCS:%.c=o/$(MODE)/%.o)
+
+TEST_LIBC_TESTLIB_COMS =				\
+	$(TEST_LIBC_TESTLIB_SRCS:%.c=o/$(MODE)/%)
+
+TEST_LIBC_TESTLIB_TESTS = $(TEST_LIBC_TESTLIB_SRCS_TEST:%.c=o/$(MODE)/%.ok)
+TEST_LIBC_TESTLIB_CHECKS =				\
+	$(TEST_LIBC_TESTLIB_SRCS_TEST:%.c=o/$(MODE)/%.runs)
+
+TEST_LIBC_TESTLIB_DIRECTDEPS =				\
+	LIBC_CALLS					\
+	LIBC_INTRIN					\
+	LIBC_LOG					\
+	LIBC_MEM					\
+	LIBC_NEXGEN32E					\
+	LIBC_PROC					\
+	LIBC_RUNTIME					\
+	LIBC_STR					\
+	LIBC_SYSV					\
+	LIBC_TESTLIB					\
+	LIBC_X
+
+TEST_LIBC_TESTLIB_DEPS :=				\
+	$(call uniq,$(foreach x,$(TEST_LIBC_TESTLIB_DIRECTDEPS),$($(x))))
+
+o/$(MODE)/test/libc/testlib/testlib.pkg:		\
+		$(TEST_LIBC_TESTLIB_OBJS)		\
+		$(foreach x,$(TEST_LIBC_TESTLIB_DIRECTDEPS),$($(x)_A).pkg)
+
+o/$(MODE)/test/libc/testlib/%.dbg:			\
+		$(TEST_LIBC_TESTLIB_DEPS)		\
+		o/$(MODE)/test/libc/testlib/%.o		\
+		o/$(MODE)/test/libc/testlib/testlib.pkg	\
+		$(LIBC_TESTMAIN)			\
+		$(CRT)					\
+		$(APE_NO_MODIFY_SELF)
+	@$(APELINK)
+
+.PHONY: o/$(MODE)/test/libc/testlib
+o/$(MODE)/test/libc/testlib:				\
+		$(TEST_LIBC_TESTLIB_BINS)		\
+		$(TEST_LIBC_TESTLIB_CHECKS)
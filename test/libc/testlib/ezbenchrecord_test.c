@@ -0,0 +1,155 @@
+/*-*- mode:c;indent-tabs-mode:nil;c-basic-offset:2;tab-width:8;coding:utf-8 -*-│
+│ vi: set et ft=c ts=2 sts=2 sw=2 fenc=utf-8                               :vi │
+╞══════════════════════════════════════════════════════════════════════════════╡
+│ Copyright 2024 Justine Alexandra Roberts Tunney                              │
+│                                                                              │
+│ Permission to use, copy, modify, and/or distribute this software for         │
+│ any purpose with or without fee is hereby granted, provided that the         │
+│ above copyright notice and this permission notice appear in all copies.      │
+│                                                                              │
+│ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL                │
+│ WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED                │
+│ WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE             │
+│ AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL         │
+│ DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR        │
+│ PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER               │
+│ TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR             │
+│ PERFORMANCE OF THIS SOFTWARE.                                                │
+╚─────────────────────────────────────────────────────────────────────────────*/
+#include "libc/mem/gc.h"
+#include "libc/mem/mem.h"
+#include "libc/runtime/runtime.h"
+#include "libc/str/str.h"
+#include "libc/testlib/ezbench.h"
+#include "libc/testlib/subprocess.h"
+#include "libc/testlib/testlib.h"
+#include "libc/x/x.h"
+
+// name that needs escaping in both output formats
+#define NAME "a\"b\\c\nd,e"
+
+struct EzBenchStats st;
+struct EzBenchSamples s;
+
+void SetUpOnce(void) {
+  testlib_enable_tmp_setup_teardown_once();
+}
+
+void SetUp(void) {
+  bzero(&st, sizeof(st));
+  bzero(&s, sizeof(s));
+}
+
+static double Ns(double cycles) {
+  return cycles / __testlib_ezbenchfreq();
+}
+
+static char *Record(const char *path) {
+  s.n = 3;
+  s.p[0] = 3000;
+  s.p[1] = 1000;
+  s.p[2] = 2000;
+  SPAWN(fork);
+  ASSERT_SYS(0, 0, setenv("EZBENCH_OUTPUT", path, true));
+  __testlib_ezbenchrecord(NAME, 0, 0, &s, 0, 1500, 0, 1, 2);
+  __testlib_ezbenchrecord(NAME, 0, 0, &s, 0, 1500, 0, 1, 2);
+  EXITS(0);
+  return xslurp(path, 0);
+}
+
+TEST(__testlib_ezbenchstats, oddCount_medianIsMiddleSample) {
+  s.n = 5;
+  s.p[0] = 5000;
+  s.p[1] = 1000;
+  s.p[2] = 4000;
+  s.p[3] = 2000;
+  s.p[4] = 3000;
+  __testlib_ezbenchstats(&st, &s, 0);
+  EXPECT_EQ(5, st.count);
+  EXPECT_DOUBLE_EQ(Ns(1000), st.min);
+  EXPECT_DOUBLE_EQ(Ns(3000), st.median);
+  EXPECT_DOUBLE_EQ(Ns(5000), st.p99);
+  EXPECT_DOUBLE_EQ(Ns(3000), st.mean);
+}
+
+TEST(__testlib_ezbenchstats, evenCount_medianIsAverageOfMiddle) {
+  int i;
+  s.n = 100;
+  for (i = 0; i < 100; ++i)
+    s.p[i] = (100 - i) * 1000;
+  __testlib_ezbenchstats(&st, &s, 0);
+  EXPECT_EQ(100, st.count);
+  EXPECT_DOUBLE_EQ(Ns(1000), st.min);
+  EXPECT_DOUBLE_EQ(Ns(50500), st.median);
+  EXPECT_DOUBLE_EQ(Ns(99000), st.p99);
+  EXPECT_DOUBLE_EQ(Ns(50500), st.mean);
+}
+
+TEST(__testlib_ezbenchstats, p99_roundsUpToSlowestOfSmallSets) {
+  int i;
+  s.n = 10;
+  for (i = 0; i < 10; ++i)
+    s.p[i] = (i + 1) * 1000;
+  __testlib_ezbenchstats(&st, &s, 0);
+  EXPECT_DOUBLE_EQ(Ns(10000), st.p99);
+  EXPECT_DOUBLE_EQ(Ns(5500), st.median);
+}
+
+TEST(__testlib_ezbenchstats, subtractsControl) {
+  s.n = 2;
+  s.p[0] = 1100;
+  s.p[1] = 100;
+  __testlib_ezbenchstats(&st, &s, 600);
+  EXPECT_DOUBLE_EQ(Ns(.001), st.min);
+  EXPECT_DOUBLE_EQ(Ns(500), st.p99);
+}
+
+TEST(__testlib_ezbenchstats, singleSample_hasNoDeviation) {
+  s.n = 1;
+  s.p[0] = 7000;
+  __testlib_ezbenchstats(&st, &s, 0);
+  EXPECT_EQ(1, st.count);
+  EXPECT_DOUBLE_EQ(Ns(7000), st.median);
+  EXPECT_DOUBLE_EQ(Ns(7000), st.p99);
+  EXPECT_DOUBLE_EQ(0, st.stddev);
+}
+
+TEST(__testlib_ezbenchstats, onlyKeepsRetainedSamples) {
+  int i;
+  s.n = EZBENCH_SAMPLES * 2;
+  for (i = 0; i < EZBENCH_SAMPLES; ++i)
+    s.p[i] = 1000;
+  __testlib_ezbenchstats(&st, &s, 0);
+  EXPECT_EQ(EZBENCH_SAMPLES, st.count);
+  EXPECT_DOUBLE_EQ(Ns(1000), st.p99);
+  EXPECT_DOUBLE_EQ(0, st.stddev);
+}
+
+TEST(__testlib_ezbenchstats, noSamples) {
+  __testlib_ezbenchstats(&st, &s, 0);
+  EXPECT_EQ(0, st.count);
+  EXPECT_DOUBLE_EQ(0, st.median);
+}
+
+TEST(__testlib_ezbenchrecord, json) {
+  char *p = gc(Record("bench.json"));
+  EXPECT_TRUE(startswith(p, "{\"program\":\""));
+  EXPECT_NE(NULL, strstr(p, ",\"name\":\"a\\\"b\\\\c\\u000ad,e\","));
+  EXPECT_NE(NULL, strstr(p, ",\"core\":1,\"interrupts\":2,"));
+  EXPECT_NE(NULL, strstr(p, ",\"count\":3,"));
+  EXPECT_NE(NULL, strstr(p, ",\"samples_ns\":["));
+  EXPECT_TRUE(endswith(p, "]}\n"));
+  // one object per line
+  EXPECT_EQ(p + strlen(p) / 2 - 1, strchr(p, '\n'));
+}
+
+TEST(__testlib_ezbenchrecord, csv) {
+  char *p;
+  free(Record("bench.csv"));
+  p = gc(Record("bench.csv"));
+  // header is only written once, even when appending from another process
+  EXPECT_TRUE(startswith(p, "program,name,core,interrupts,"));
+  EXPECT_EQ(NULL, strstr(p + 1, "program,"));
+  // quotes are doubled and newlines are kept inside quoted field
+  EXPECT_NE(NULL, strstr(p, ",\"a\"\"b\\c\nd,e\",1,2,"));
+}
@@ -0,0 +1,155 @@
+/*-*- mode:c;indent-tabs-mode:nil;c-basic-offset:2;tab-width:8;coding:utf-8 -*-│
+│ vi: set et ft=c ts=2 sts=2 sw=2 fenc=utf-8                               :vi │
+╞══════════════════════════════════════════════════════════════════════════════╡
+│ Copyright 2024 Justine Alexandra Roberts Tunney                              │
+│                                                                              │
+│ Permission to use, copy, modify, and/or distribute this software for         │
+│ any purpose with or without fee is hereby granted, provided that the         │
+│ above copyright notice and this permission notice appear in all copies.      │
+│                                                                              │
+│ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL                │
+│ WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED                │
+│ WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE             │
+│ AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL         │
+│ DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR        │
+│ PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER               │
+│ TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR             │
+│ PERFORMANCE OF THIS SOFTWARE.                                                │
+╚─────────────────────────────────────────────────────────────────────────────*/
+#include "libc/thread/executor.h"
+#include "libc/atomic.h"
+#include "libc/errno.h"
+#include "libc/intrin/atomic.h"
+#include "libc/testlib/ezbench.h"
+#include "libc/testlib/testlib.h"
+
+struct cosmo_executor *ex;
+
+void SetUp(void) {
+  ASSERT_NE(NULL, (ex = cosmo_executor_create(4, 0)));
+}
+
+void TearDown(void) {
+  cosmo_executor_destroy(ex);
+}
+
+void *Fib(void *arg) {
+  long a, b, n = (long)arg;
+  struct cosmo_task *t;
+  if (n < 2)
+    return arg;
+  ASSERT_NE(NULL, (t = cosmo_executor_submit(ex, Fib, (void *)(n - 1))));
+  b = (long)Fib((void *)(n - 2));
+  a = (long)cosmo_task_join(t);
+  return (void *)(a + b);
+}
+
+TEST(executor, threads) {
+  EXPECT_EQ(4, cosmo_executor_threads(ex));
+}
+
+TEST(executor, nestedForkJoin) {
+  struct cosmo_task *t;
+  ASSERT_NE(NULL, (t = cosmo_executor_submit(ex, Fib, (void *)20)));
+  EXPECT_EQ(6765, (long)cosmo_task_join(t));
+  EXPECT_EQ(6765, (long)Fib((void *)20));
+}
+
+atomic_int detached;
+
+void *Count(void *arg) {
+  atomic_fetch_add(&detached, 1);
+  return 0;
+}
+
+TEST(executor, destroy_waitsForDetachedTasks) {
+  int i;
+  struct cosmo_executor *ex2;
+  detached = 0;
+  ASSERT_NE(NULL, (ex2 = cosmo_executor_create(2, COSMO_EXECUTOR_PIN)));
+  for (i = 0; i < 5000; ++i)
+    cosmo_task_detach(cosmo_executor_submit(ex2, Count, 0));
+  cosmo_executor_destroy(ex2);
+  EXPECT_EQ(5000, detached);
+}
+
+void Mark(void *arg, long b, long e) {
+  for (; b < e; ++b)
+    atomic_fetch_add((atomic_char *)arg + b, 1);
+}
+
+TEST(executor, parallel_for_touchesEachItemOnce) {
+  int i;
+  atomic_char seen[10007] = {0};
+  EXPECT_EQ(0, cosmo_executor_parallel_for(ex, 0, 10007, 1, Mark, seen));
+  for (i = 0; i < 10007; ++i)
+    ASSERT_EQ(1, seen[i]);
+  EXPECT_EQ(0, cosmo_executor_parallel_for(ex, 5, 5, 1, Mark, seen));
+  EXPECT_EQ(EINVAL, cosmo_executor_parallel_for(ex, 5, 4, 1, Mark, seen));
+}
+
+void *Nest(void *arg) {
+  cosmo_executor_parallel_for(ex, 0, 100, 1, Mark, arg);
+  return 0;
+}
+
+TEST(executor, parallel_for_canNest) {
+  int i;
+  atomic_char seen[100] = {0};
+  struct cosmo_task *t[16];
+  for (i = 0; i < 16; ++i)
+    ASSERT_NE(NULL, (t[i] = cosmo_executor_submit(ex, Nest, seen)));
+  for (i = 0; i < 16; ++i)
+    cosmo_task_join(t[i]);
+  for (i = 0; i < 100; ++i)
+    ASSERT_EQ(16, seen[i]);
+}
+
+void Sum(void *arg, long b, long e, void *acc) {
+  for (; b < e; ++b)
+    *(long *)acc += b;
+}
+
+void Add(void *arg, void *acc, const void *x) {
+  *(long *)acc += *(const long *)x;
+}
+
+void Concat(void *arg, long b, long e, void *acc) {
+  for (; b < e; ++b)
+    *(long *)acc = *(long *)acc * 10 + b;
+}
+
+void Shift(void *arg, void *acc, const void *x) {
+  long y, x2 = *(const long *)x;
+  for (y = x2; y; y /= 10)
+    *(long *)acc *= 10;
+  *(long *)acc += x2;
+}
+
+TEST(executor, parallel_reduce) {
+  long acc = 0;
+  EXPECT_EQ(0, cosmo_executor_parallel_reduce(ex, 0, 1000000, 1, &acc,
+                                               sizeof(acc), Sum, Add, 0));
+  EXPECT_EQ(999999L * 1000000 / 2, acc);
+}
+
+TEST(executor, parallel_reduce_keepsOrder) {
+  long acc = 0;
+  EXPECT_EQ(0, cosmo_executor_parallel_reduce(ex, 1, 10, 1, &acc, sizeof(acc),
+                                               Concat, Shift, 0));
+  EXPECT_EQ(123456789, acc);
+}
+
+void *Nothing(void *arg) {
+  return arg;
+}
+
+BENCH(executor, bench) {
+  long acc;
+  EZBENCH2("submit+join", donothing,
+           cosmo_task_join(cosmo_executor_submit(ex, Nothing, 0)));
+  EZBENCH2("fib(20)", donothing, Fib((void *)20));
+  EZBENCH2("reduce(1e6)", acc = 0,
+           cosmo_executor_parallel_reduce(ex, 0, 1000000, 1000, &acc,
+                                          sizeof(acc), Sum, Add, 0));
+}
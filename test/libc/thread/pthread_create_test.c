@@ -254,6 +254,53 @@ TEST(pthread_cleanup, pthread_normal) {
   ASSERT_TRUE(g_cleanup2);
 }
 
+static void *GetStackAddr(void *arg) {
+  void *addr;
+  size_t size, guard;
+  pthread_attr_t attr;
+  ASSERT_EQ(0, pthread_getattr_np(pthread_self(), &attr));
+  ASSERT_EQ(0, pthread_attr_getstack(&attr, &addr, &size));
+  ASSERT_EQ(0, pthread_attr_getguardsize(&attr, &guard));
+  ASSERT_EQ(0, pthread_attr_destroy(&attr));
+  ASSERT_EQ(327680, size);
+  ASSERT_EQ((uintptr_t)arg, guard);
+  return addr;
+}
+
+static void *CreateJoinStack(size_t stacksize, size_t guardsize) {
+  void *addr;
+  pthread_t id;
+  pthread_attr_t attr;
+  ASSERT_EQ(0, pthread_attr_init(&attr));
+  ASSERT_EQ(0, pthread_attr_setstacksize(&attr, stacksize));
+  ASSERT_EQ(0, pthread_attr_setguardsize(&attr, guardsize));
+  ASSERT_EQ(0, pthread_create(&id, &attr, GetStackAddr, (void *)guardsize));
+  ASSERT_EQ(0, pthread_attr_destroy(&attr));
+  ASSERT_EQ(0, pthread_join(id, &addr));
+  return addr;
+}
+
+TEST(pthread_create, joinedThreadStackIsReused) {
+  void *a = CreateJoinStack(327680, 65536);
+  void *b = CreateJoinStack(327680, 65536);
+  ASSERT_EQ(a, b);
+  CreateJoinStack(327680, 131072);  // mustn't get cached 64kb guard
+  CreateJoinStack(327680, 65536);   // mustn't get cached 128kb guard
+}
+
+TEST(pthread_setcachesize_np, test) {
+  int old = pthread_setcachesize_np(0);
+  ASSERT_EQ(0, pthread_setcachesize_np(-1));
+  ASSERT_EQ(0, _pthread_cache.count);
+  CreateJoinStack(327680, 65536);
+  ASSERT_EQ(0, _pthread_cache.count);
+  ASSERT_EQ(0, pthread_setcachesize_np(old));
+  CreateJoinStack(327680, 65536);
+  ASSERT_LT(0, _pthread_cache.count);
+  malloc_trim(0);
+  ASSERT_EQ(0, _pthread_cache.count);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // BENCHMARKS
 
@@ -17,6 +17,10 @@
 │ PERFORMANCE OF THIS SOFTWARE.                                                │
 ╚─────────────────────────────────────────────────────────────────────────────*/
 #include "libc/atomic.h"
+#include "libc/calls/struct/timespec.h"
+#include "libc/errno.h"
+#include "libc/intrin/kprintf.h"
+#include "libc/macros.internal.h"
 #include "libc/mem/gc.h"
 #include "libc/mem/mem.h"
 #include "libc/testlib/testlib.h"
@@ -51,7 +55,7 @@ void *Writer(void *arg) {
   return 0;
 }
 
-TEST(pthread_rwlock_rdlock, test) {
+void RunReadersAndWriters(void) {
   int i;
   pthread_t *t = gc(malloc(sizeof(pthread_t) * (READERS + WRITERS)));
   ASSERT_EQ(0, pthread_barrier_init(&barrier, 0, READERS + WRITERS));
@@ -66,3 +70,99 @@ TEST(pthread_rwlock_rdlock, test) {
   EXPECT_EQ(WRITERS * ITERATIONS, writes);
   ASSERT_EQ(0, pthread_barrier_destroy(&barrier));
 }
+
+void InitLock(pthread_rwlock_t *lk, int kind) {
+  pthread_rwlockattr_t attr;
+  ASSERT_EQ(0, pthread_rwlockattr_init(&attr));
+  ASSERT_EQ(0, pthread_rwlockattr_setkind_np(&attr, kind));
+  ASSERT_EQ(0, pthread_rwlock_init(lk, &attr));
+  ASSERT_EQ(0, pthread_rwlockattr_destroy(&attr));
+}
+
+TEST(pthread_rwlock_rdlock, test) {
+  reads = writes = 0;
+  ASSERT_EQ(0, pthread_rwlock_init(&lock, 0));
+  RunReadersAndWriters();
+  ASSERT_EQ(0, pthread_rwlock_destroy(&lock));
+}
+
+TEST(pthread_rwlock_rdlock, biased) {
+  reads = writes = 0;
+  InitLock(&lock, PTHREAD_RWLOCK_BIASED_READER_NP);
+  RunReadersAndWriters();
+  ASSERT_EQ(0, pthread_rwlock_destroy(&lock));
+}
+
+TEST(pthread_rwlock_rdlock, biasedTrylock) {
+  pthread_rwlock_t lk;
+  InitLock(&lk, PTHREAD_RWLOCK_BIASED_READER_NP);
+  ASSERT_EQ(0, pthread_rwlock_rdlock(&lk));
+  ASSERT_EQ(EBUSY, pthread_rwlock_trywrlock(&lk));
+  ASSERT_EQ(0, pthread_rwlock_tryrdlock(&lk));
+  ASSERT_EQ(EBUSY, pthread_rwlock_trywrlock(&lk));
+  ASSERT_EQ(0, pthread_rwlock_unlock(&lk));
+  ASSERT_EQ(EBUSY, pthread_rwlock_trywrlock(&lk));
+  ASSERT_EQ(0, pthread_rwlock_unlock(&lk));
+  ASSERT_EQ(0, pthread_rwlock_trywrlock(&lk));
+  ASSERT_EQ(EBUSY, pthread_rwlock_tryrdlock(&lk));
+  ASSERT_EQ(0, pthread_rwlock_unlock(&lk));
+  ASSERT_EQ(0, pthread_rwlock_rdlock(&lk));
+  ASSERT_EQ(0, pthread_rwlock_unlock(&lk));
+  ASSERT_EQ(0, pthread_rwlock_destroy(&lk));
+}
+
+TEST(pthread_rwlockattr_setkind_np, test) {
+  int kind, pshared;
+  pthread_rwlockattr_t attr;
+  ASSERT_EQ(0, pthread_rwlockattr_init(&attr));
+  ASSERT_EQ(0, pthread_rwlockattr_getkind_np(&attr, &kind));
+  ASSERT_EQ(PTHREAD_RWLOCK_PREFER_READER_NP, kind);
+  ASSERT_EQ(EINVAL, pthread_rwlockattr_setkind_np(&attr, 4));
+  ASSERT_EQ(0, pthread_rwlockattr_setkind_np(
+                   &attr, PTHREAD_RWLOCK_BIASED_READER_NP));
+  ASSERT_EQ(0, pthread_rwlockattr_getkind_np(&attr, &kind));
+  ASSERT_EQ(PTHREAD_RWLOCK_BIASED_READER_NP, kind);
+  ASSERT_EQ(0, pthread_rwlockattr_getpshared(&attr, &pshared));
+  ASSERT_EQ(PTHREAD_PROCESS_PRIVATE, pshared);
+  ASSERT_EQ(0, pthread_rwlockattr_destroy(&attr));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// BENCHMARKS
+
+#define SCALE_ITERATIONS 200000
+
+void *ScaleReader(void *arg) {
+  pthread_barrier_wait(&barrier);
+  for (int i = 0; i < SCALE_ITERATIONS; ++i) {
+    pthread_rwlock_rdlock(&lock);
+    pthread_rwlock_unlock(&lock);
+  }
+  return 0;
+}
+
+void ReadScaling(const char *name, int kind) {
+  int i, n;
+  struct timespec t;
+  pthread_t *th = gc(malloc(sizeof(pthread_t) * 128));
+  InitLock(&lock, kind);
+  for (n = 1; n <= 128; n *= 2) {
+    ASSERT_EQ(0, pthread_barrier_init(&barrier, 0, n + 1));
+    for (i = 0; i < n; ++i)
+      ASSERT_EQ(0, pthread_create(th + i, 0, ScaleReader, 0));
+    t = timespec_mono();
+    pthread_barrier_wait(&barrier);
+    for (i = 0; i < n; ++i)
+      ASSERT_EQ(0, pthread_join(th[i], 0));
+    t = timespec_sub(timespec_mono(), t);
+    kprintf("%-8s %3d threads %,12ld reads/ms\n", name, n,
+            (long)n * SCALE_ITERATIONS / MAX(1, timespec_tomillis(t)));
+    ASSERT_EQ(0, pthread_barrier_destroy(&barrier));
+  }
+  ASSERT_EQ(0, pthread_rwlock_destroy(&lock));
+}
+
+BENCH(pthread_rwlock_rdlock, scaling) {
+  ReadScaling("nsync", PTHREAD_RWLOCK_PREFER_READER_NP);
+  ReadScaling("biased", PTHREAD_RWLOCK_BIASED_READER_NP);
+}
@@ -0,0 +1,128 @@
+/*-*- mode:c;indent-tabs-mode:nil;c-basic-offset:2;tab-width:8;coding:utf-8 -*-│
+│ vi: set et ft=c ts=2 sts=2 sw=2 fenc=utf-8                               :vi │
+╞══════════════════════════════════════════════════════════════════════════════╡
+│ Copyright 2024 Justine Alexandra Roberts Tunney                              │
+│                                                                              │
+│ Permission to use, copy, modify, and/or distribute this software for         │
+│ any purpose with or without fee is hereby granted, provided that the         │
+│ above copyright notice and this permission notice appear in all copies.      │
+│                                                                              │
+│ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL                │
+│ WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED                │
+│ WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE             │
+│ AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL         │
+│ DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR        │
+│ PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER               │
+│ TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR             │
+│ PERFORMANCE OF THIS SOFTWARE.                                                │
+╚─────────────────────────────────────────────────────────────────────────────*/
+#include "libc/mem/alg.h"
+#include "libc/mem/gc.h"
+#include "libc/mem/mem.h"
+#include "libc/stdio/rand.h"
+#include "libc/stdio/stdio.h"
+#include "libc/str/str.h"
+#include "libc/testlib/ezbench.h"
+#include "libc/testlib/testlib.h"
+
+// big enough that the sorts actually use threads
+#define N (1024 * 1024)
+
+struct Record {
+  unsigned key;
+  unsigned seq;
+};
+
+int CompareLong(const void *a, const void *b, void *arg) {
+  const long *x = a;
+  const long *y = b;
+  if (*x < *y)
+    return -1;
+  if (*x > *y)
+    return +1;
+  return 0;
+}
+
+int CompareRecord(const void *a, const void *b, void *arg) {
+  const struct Record *x = a;
+  const struct Record *y = b;
+  if (x->key < y->key)
+    return -1;
+  if (x->key > y->key)
+    return +1;
+  return 0;
+}
+
+TEST(qsort_r_par, equivalence) {
+  size_t i;
+  long *a = gc(malloc(N * sizeof(long)));
+  long *b = gc(malloc(N * sizeof(long)));
+  for (i = 0; i < N; ++i)
+    a[i] = b[i] = lemur64();
+  qsort_r(a, N, sizeof(long), CompareLong, 0);
+  qsort_r_par(b, N, sizeof(long), CompareLong, 0);
+  ASSERT_EQ(0, memcmp(a, b, N * sizeof(long)));
+}
+
+TEST(qsort_r_par, duplicates) {
+  size_t i;
+  long *a = gc(malloc(N * sizeof(long)));
+  long *b = gc(malloc(N * sizeof(long)));
+  for (i = 0; i < N; ++i)
+    a[i] = b[i] = lemur64() % 3;
+  qsort_r(a, N, sizeof(long), CompareLong, 0);
+  qsort_r_par(b, N, sizeof(long), CompareLong, 0);
+  ASSERT_EQ(0, memcmp(a, b, N * sizeof(long)));
+}
+
+TEST(qsort_r_par, small) {
+  long a[] = {3, 1, 2};
+  long b[] = {1, 2, 3};
+  qsort_r_par(a, 3, sizeof(long), CompareLong, 0);
+  ASSERT_EQ(0, memcmp(a, b, sizeof(a)));
+  qsort_r_par(a, 0, sizeof(long), CompareLong, 0);
+}
+
+TEST(mergesort_r_par, equivalence) {
+  size_t i;
+  long *a = gc(malloc(N * sizeof(long)));
+  long *b = gc(malloc(N * sizeof(long)));
+  for (i = 0; i < N; ++i)
+    a[i] = b[i] = N - i;
+  ASSERT_EQ(0, mergesort_r(a, N, sizeof(long), CompareLong, 0));
+  ASSERT_EQ(0, mergesort_r_par(b, N, sizeof(long), CompareLong, 0));
+  ASSERT_EQ(0, memcmp(a, b, N * sizeof(long)));
+}
+
+TEST(mergesort_r_par, stability) {
+  size_t i;
+  struct Record *a = gc(malloc(N * sizeof(struct Record)));
+  for (i = 0; i < N; ++i) {
+    a[i].key = lemur64() % 1000;
+    a[i].seq = i;
+  }
+  ASSERT_EQ(0, mergesort_r_par(a, N, sizeof(struct Record), CompareRecord, 0));
+  for (i = 1; i < N; ++i) {
+    ASSERT_LE(a[i - 1].key, a[i].key);
+    if (a[i - 1].key == a[i].key) {
+      ASSERT_LT(a[i - 1].seq, a[i].seq);
+    }
+  }
+}
+
+BENCH(qsort_r_par, bench) {
+  size_t i;
+  long *p1 = gc(malloc(N * sizeof(long)));
+  long *p2 = gc(malloc(N * sizeof(long)));
+  printf("\n");
+  for (i = 0; i < N; ++i)
+    p1[i] = lemur64();
+  EZBENCH2("qsort_r", memcpy(p2, p1, N * sizeof(long)),
+           qsort_r(p2, N, sizeof(long), CompareLong, 0));
+  EZBENCH2("qsort_r_par", memcpy(p2, p1, N * sizeof(long)),
+           qsort_r_par(p2, N, sizeof(long), CompareLong, 0));
+  EZBENCH2("mergesort_r", memcpy(p2, p1, N * sizeof(long)),
+           mergesort_r(p2, N, sizeof(long), CompareLong, 0));
+  EZBENCH2("mergesort_r_par", memcpy(p2, p1, N * sizeof(long)),
+           mergesort_r_par(p2, N, sizeof(long), CompareLong, 0));
+}
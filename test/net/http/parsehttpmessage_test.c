@@ -21,6 +21,7 @@
 #include "libc/mem/gc.h"
 #include "libc/mem/mem.h"
 #include "libc/serialize.h"
+#include "libc/stdio/stdio.h"
 #include "libc/str/str.h"
 #include "libc/testlib/ezbench.h"
 #include "libc/testlib/testlib.h"
@@ -434,6 +435,54 @@ TEST(ParseHttpResponse, testHttp100) {
   EXPECT_EQ(10, req->version);
 }
 
+TEST(ParseHttpMessage, testFragmented_resumesWhereItLeftOff) {
+  static const char m[] = "\
+GET /tool/net/redbean.png HTTP/1.1\r\n\
+Host: 10.10.10.124:8080\r\n\
+User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36\r\n\
+X-Foo:  \tbar baz\t \r\n\
+\r\n";
+  size_t i;
+  int rc = 0;
+  InitHttpMessage(req, kHttpRequest);
+  for (i = 1; i <= strlen(m) && !rc; ++i)
+    rc = ParseHttpMessage(req, m, i, strlen(m));
+  EXPECT_EQ(strlen(m), rc);
+  EXPECT_STREQ("GET", method());
+  EXPECT_STREQ("/tool/net/redbean.png", gc(slice(m, req->uri)));
+  EXPECT_EQ(11, req->version);
+  EXPECT_STREQ("10.10.10.124:8080", gc(slice(m, req->headers[kHttpHost])));
+  EXPECT_STREQ("Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36",
+               gc(slice(m, req->headers[kHttpUserAgent])));
+  ASSERT_EQ(1, req->xheaders.n);
+  EXPECT_STREQ("X-Foo", gc(slice(m, req->xheaders.p[0].k)));
+  EXPECT_STREQ("bar baz", gc(slice(m, req->xheaders.p[0].v)));
+}
+
+TEST(ParseHttpMessage, testControlCodeDeepInsideLongField_isRejected) {
+  int i, j;
+  char m[256];
+  static const char *const kTemplates[] = {
+      "GET /%.*s%c%.*s HTTP/1.1\r\n\r\n",
+      "GET / HTTP/1.1\r\nX-%.*s%c%.*s: hi\r\n\r\n",
+      "GET / HTTP/1.1\r\nX: %.*s%c%.*s\r\n\r\n",
+  };
+  static const char kBad[] = {'\0', '\1', '\v', '\177', '\205', '\237'};
+  static const char kA[] = "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa";
+  for (i = 0; i < ARRAYLEN(kTemplates); ++i) {
+    for (j = 0; j < 40; ++j) {
+      int n = snprintf(m, sizeof(m), kTemplates[i], j, kA, 'a', 40 - j, kA);
+      InitHttpMessage(req, kHttpRequest);
+      EXPECT_EQ(n, ParseHttpMessage(req, m, n, n));
+      DestroyHttpMessage(req);
+      m[(strchr(m, 'a') - m) + j] = kBad[j % ARRAYLEN(kBad)];
+      InitHttpMessage(req, kHttpRequest);
+      EXPECT_SYS(EBADMSG, -1, ParseHttpMessage(req, m, n, n));
+      DestroyHttpMessage(req);
+    }
+  }
+}
+
 void DoTiniestHttpRequest(void) {
   static const char m[] = "\
 GET /\r\n\
@@ -560,6 +609,96 @@ BENCH(ParseHttpMessage, bench) {
   DestroyHttpMessage(req);
 }
 
+// requests as sent by popular clients, or as seen behind a proxy
+static const char *const kHttpCorpus[] = {
+    "GET / HTTP/1.1\r\n"
+    "Host: justine.lol\r\n"
+    "User-Agent: curl/8.5.0\r\n"
+    "Accept: */*\r\n"
+    "\r\n",
+    "GET /redbean/index.html HTTP/1.1\r\n"
+    "Host: redbean.dev\r\n"
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:125.0) Gecko/20100101 "
+    "Firefox/125.0\r\n"
+    "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,image/"
+    "avif,image/webp,*/*;q=0.8\r\n"
+    "Accept-Language: en-US,en;q=0.5\r\n"
+    "Accept-Encoding: gzip, deflate, br\r\n"
+    "Connection: keep-alive\r\n"
+    "Upgrade-Insecure-Requests: 1\r\n"
+    "Sec-Fetch-Dest: document\r\n"
+    "Sec-Fetch-Mode: navigate\r\n"
+    "Sec-Fetch-Site: none\r\n"
+    "Sec-Fetch-User: ?1\r\n"
+    "\r\n",
+    "GET /api/v1/notifications?limit=20&since_id=110534523 HTTP/1.1\r\n"
+    "Host: mastodon.example\r\n"
+    "sec-ch-ua: \"Chromium\";v=\"124\", \"Google Chrome\";v=\"124\", "
+    "\"Not-A.Brand\";v=\"99\"\r\n"
+    "sec-ch-ua-mobile: ?0\r\n"
+    "Authorization: Bearer "
+    "eyJhbGciOiJIUzI1NiIsInR5cCI6IkpXVCJ9.eyJzdWIiOiIxMjM0NTY3ODkwIiwibmFtZS"
+    "I6IkpvaG4gRG9lIiwiaWF0IjoxNTE2MjM5MDIyfQ.SflKxwRJSMeKKF2QT4fwpMeJf36POk6"
+    "yJV_adQssw5c\r\n"
+    "User-Agent: Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 "
+    "(KHTML, like Gecko) Chrome/124.0.0.0 Safari/537.36\r\n"
+    "sec-ch-ua-platform: \"Windows\"\r\n"
+    "Accept: application/json, text/plain, */*\r\n"
+    "Sec-Fetch-Site: same-origin\r\n"
+    "Sec-Fetch-Mode: cors\r\n"
+    "Sec-Fetch-Dest: empty\r\n"
+    "Referer: https://mastodon.example/notifications\r\n"
+    "Accept-Encoding: gzip, deflate, br, zstd\r\n"
+    "Accept-Language: en-US,en;q=0.9\r\n"
+    "Cookie: _session_id=2f1c3b0e9d8a7f6e5d4c3b2a1f0e9d8c; "
+    "_mastodon_session=Qk9HVVMgU0VTU0lPTiBEQVRBIEZPUiBCRU5DSE1BUktJTkcgT05MWQ"
+    "%3D%3D--0123456789abcdef0123456789abcdef01234567; "
+    "remember_user_token=eyJfcmFpbHMiOnsibWVzc2FnZSI6IlcxczFYU3dpSkRKaEpERXdK"
+    "In19--fedcba9876543210\r\n"
+    "\r\n",
+    "POST /v2/objects/batch HTTP/1.1\r\n"
+    "Host: storage.example.com:8443\r\n"
+    "User-Agent: Go-http-client/1.1\r\n"
+    "Content-Length: 1873\r\n"
+    "Content-Type: application/json\r\n"
+    "X-Request-Id: 6f9619ff-8b86-d011-b42d-00c04fc964ff\r\n"
+    "Accept-Encoding: gzip\r\n"
+    "\r\n",
+    "GET /static/app.3f2a1b.js HTTP/1.1\r\n"
+    "Host: 127.0.0.1:8080\r\n"
+    "X-Real-IP: 203.0.113.195\r\n"
+    "X-Forwarded-For: 203.0.113.195, 70.41.3.18, 150.172.238.178\r\n"
+    "X-Forwarded-Proto: https\r\n"
+    "X-Forwarded-Host: www.example.com\r\n"
+    "Connection: close\r\n"
+    "User-Agent: Mozilla/5.0 (iPhone; CPU iPhone OS 17_4 like Mac OS X) "
+    "AppleWebKit/605.1.15 (KHTML, like Gecko) Version/17.4 Mobile/15E148 "
+    "Safari/604.1\r\n"
+    "Accept: */*\r\n"
+    "Referer: https://www.example.com/\r\n"
+    "If-None-Match: W/\"5e15153d-120f\"\r\n"
+    "If-Modified-Since: Wed, 08 Jan 2020 23:11:55 GMT\r\n"
+    "\r\n",
+};
+
+void DoHttpCorpus(void) {
+  int i, n;
+  for (i = 0; i < ARRAYLEN(kHttpCorpus); ++i) {
+    n = strlen(kHttpCorpus[i]);
+    ResetHttpMessage(req, kHttpRequest);
+    CHECK_EQ(n, ParseHttpMessage(req, kHttpCorpus[i], n, n));
+  }
+}
+
+BENCH(ParseHttpMessage, corpus) {
+  int i, n;
+  for (n = i = 0; i < ARRAYLEN(kHttpCorpus); ++i)
+    n += strlen(kHttpCorpus[i]);
+  InitHttpMessage(req, kHttpRequest);
+  EZBENCH_N("ParseHttpMessage corpus", n, DoHttpCorpus());
+  DestroyHttpMessage(req);
+}
+
 BENCH(HeaderHas, bench) {
   static const char m[] = "\
 GET / HTTP/1.1\r\n\
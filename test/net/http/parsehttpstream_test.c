@@ -0,0 +1,141 @@
+/*-*- mode:c;indent-tabs-mode:nil;c-basic-offset:2;tab-width:8;coding:utf-8 -*-│
+│ vi: set et ft=c ts=2 sts=2 sw=2 fenc=utf-8                               :vi │
+╞══════════════════════════════════════════════════════════════════════════════╡
+│ Copyright 2024 Justine Alexandra Roberts Tunney                              │
+│                                                                              │
+│ Permission to use, copy, modify, and/or distribute this software for         │
+│ any purpose with or without fee is hereby granted, provided that the         │
+│ above copyright notice and this permission notice appear in all copies.      │
+│                                                                              │
+│ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL                │
+│ WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED                │
+│ WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE             │
+│ AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL         │
+│ DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR        │
+│ PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER               │
+│ TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR             │
+│ PERFORMANCE OF THIS SOFTWARE.                                                │
+╚─────────────────────────────────────────────────────────────────────────────*/
+#include "libc/errno.h"
+#include "libc/mem/gc.h"
+#include "libc/mem/mem.h"
+#include "libc/str/str.h"
+#include "libc/testlib/ezbench.h"
+#include "libc/testlib/testlib.h"
+#include "libc/x/x.h"
+#include "net/http/http.h"
+
+struct HttpStream s[1];
+
+static char *str(struct HttpStreamSlice x) {
+  return xstrndup(x.p, x.n);
+}
+
+void TearDown(void) {
+  DestroyHttpStream(s);
+}
+
+TEST(ParseHttpStream, testOneBuffer_slicesPointIntoIt) {
+  static const char m[] = "\
+POST /foo?bar%20hi HTTP/1.1\r\n\
+Host: foo.example\r\n\
+Content-Length: 4\r\n\
+X-Foo: \t bar  \r\n\
+\r\n\
+body";
+  InitHttpStream(s, kHttpRequest, 65536);
+  EXPECT_EQ(strlen(m) - 4, ParseHttpStream(s, m, strlen(m)));
+  EXPECT_EQ(strlen(m) - 4, s->i);
+  EXPECT_EQ(kHttpPost, s->method);
+  EXPECT_EQ(11, s->version);
+  EXPECT_EQ(m + 5, s->uri.p);
+  EXPECT_STREQ("/foo?bar%20hi", gc(str(s->uri)));
+  EXPECT_STREQ("foo.example", gc(str(s->headers[kHttpHost])));
+  EXPECT_STREQ("4", gc(str(s->headers[kHttpContentLength])));
+  EXPECT_EQ(NULL, s->headers[kHttpEtag].p);
+  ASSERT_EQ(1, s->xheaders.n);
+  EXPECT_STREQ("X-Foo", gc(str(s->xheaders.p[0].k)));
+  EXPECT_STREQ("bar", gc(str(s->xheaders.p[0].v)));
+}
+
+TEST(ParseHttpStream, testByteAtATime) {
+  size_t i;
+  ssize_t rc = 0;
+  static const char m[] = "\
+HTTP/1.0 404 Not Found\r\n\
+Content-Type: text/plain\r\n\
+Vary: Accept-Encoding  \r\n\
+\r\n";
+  InitHttpStream(s, kHttpResponse, 65536);
+  for (i = 0; i < strlen(m) && !rc; ++i)
+    rc = ParseHttpStream(s, m + i, 1);
+  EXPECT_EQ(1, rc);
+  EXPECT_EQ(strlen(m), s->i);
+  EXPECT_EQ(10, s->version);
+  EXPECT_EQ(404, s->status);
+  EXPECT_STREQ("Not Found", gc(str(s->message)));
+  EXPECT_STREQ("text/plain", gc(str(s->headers[kHttpContentType])));
+  EXPECT_STREQ("Accept-Encoding", gc(str(s->headers[kHttpVary])));
+}
+
+TEST(ParseHttpStream, testHugeCookie_spansManyBuffers) {
+  int i;
+  char *m;
+  size_t n, off;
+  ssize_t rc = 0;
+  m = gc(xmalloc(200000));
+  n = stpcpy(m, "GET / HTTP/1.1\r\nCookie: ") - m;
+  for (i = 0; i < 150000; ++i)
+    m[n++] = 'a' + i % 26;
+  n = stpcpy(m + n, "\r\nHost: x\r\n\r\n") - m;
+  InitHttpStream(s, kHttpRequest, 1024 * 1024);
+  for (off = 0; off < n && !rc; off += 4096)
+    rc = ParseHttpStream(s, m + off, MIN(4096, n - off));
+  EXPECT_EQ(n, s->i);
+  ASSERT_EQ(150000, s->headers[kHttpCookie].n);
+  EXPECT_EQ(0, memcmp(m + 24, s->headers[kHttpCookie].p, 150000));
+  EXPECT_STREQ("x", gc(str(s->headers[kHttpHost])));
+}
+
+TEST(ParseHttpStream, testLimit) {
+  static const char m[] = "GET / HTTP/1.1\r\nCookie: aaaaaaaaaaaaaaaaaaaa";
+  InitHttpStream(s, kHttpRequest, 32);
+  EXPECT_SYS(EMSGSIZE, -1, ParseHttpStream(s, m, strlen(m)));
+}
+
+TEST(ParseHttpStream, testBusted) {
+  InitHttpStream(s, kHttpRequest, 65536);
+  EXPECT_EQ(0, ParseHttpStream(s, "GET /", 5));
+  EXPECT_SYS(EBADMSG, -1, ParseHttpStream(s, "\1 HTTP/1.1\r\n\r\n", 14));
+}
+
+TEST(ParseHttpStream, testReset_reusesParser) {
+  static const char m[] = "GET /a HTTP/1.1\r\nHost: a\r\n\r\n";
+  InitHttpStream(s, kHttpRequest, 65536);
+  EXPECT_EQ(0, ParseHttpStream(s, m, 10));
+  ResetHttpStream(s, kHttpRequest);
+  EXPECT_EQ(0, ParseHttpStream(s, m, 20));
+  EXPECT_EQ(strlen(m) - 20, ParseHttpStream(s, m + 20, strlen(m) - 20));
+  EXPECT_STREQ("a", gc(str(s->headers[kHttpHost])));
+}
+
+BENCH(ParseHttpStream, bench) {
+  static const char m[] = "\
+GET /tool/net/redbean.png HTTP/1.1\r\n\
+Host: 10.10.10.124:8080\r\n\
+Connection: keep-alive\r\n\
+User-Agent: Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/89.0.4389.90 Safari/537.36\r\n\
+Accept: image/avif,image/webp,image/apng,image/svg+xml,image/*,*/*;q=0.8\r\n\
+Referer: http://10.10.10.124:8080/\r\n\
+Accept-Encoding: gzip, deflate\r\n\
+Accept-Language: en-US,en;q=0.9\r\n\
+\r\n";
+  InitHttpStream(s, kHttpRequest, 65536);
+  EZBENCH2("ParseHttpStream", ResetHttpStream(s, kHttpRequest),
+           ParseHttpStream(s, m, sizeof(m) - 1));
+  EZBENCH2("ParseHttpStream 64", ResetHttpStream(s, kHttpRequest), ({
+             size_t i;
+             for (i = 0; i < sizeof(m) - 1; i += 64)
+               ParseHttpStream(s, m + i, MIN(64, sizeof(m) - 1 - i));
+           }));
+}
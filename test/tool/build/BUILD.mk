@@ -1,6 +1,68 @@
 #-*-mode:makefile-gmake;indent-tabs-mode:t;tab-width:8;coding:utf-8-*-┐
 #── vi: set noet ft=make ts=8 sw=8 fenc=utf-8 :vi ────────────────────┘
 
+PKGS += TEST_TOOL_BUILD
+
+TEST_TOOL_BUILD_SRCS := $(wildcard test/tool/build/*.c)
+TEST_TOOL_BUILD_SRCS_TEST = $(filter %_test.c,$(TEST_TOOL_BUILD_SRCS))
+
+TEST_TOOL_BUILD_OBJS =					\
+	$(TEST_TOOL_BUILD_SRCS:%.c=o/$(MODE)/%.o)
+
+TEST_TOOL_BUILD_COMS =					\
+	$(TEST_TOOL_BUILD_SRCS:%.c=o/$(MODE)/%)
+
+TEST_TOOL_BUILD_BINS =					\
+	$(TEST_TOOL_BUILD_COMS)				\
+	$(TEST_TOOL_BUILD_COMS:%=%.dbg)
+
+TEST_TOOL_BUILD_TESTS =					\
+	$(TEST_TOOL_BUILD_SRCS_TEST:%.c=o/$(MODE)/%.ok)
+
+TEST_TOOL_BUILD_CHECKS =				\
+	$(TEST_TOOL_BUILD_SRCS_TEST:%.c=o/$(MODE)/%.runs)
+
+TEST_TOOL_BUILD_DIRECTDEPS =				\
+	LIBC_CALLS					\
+	LIBC_INTRIN					\
+	LIBC_LOG					\
+	LIBC_MEM					\
+	LIBC_NEXGEN32E					\
+	LIBC_PROC					\
+	LIBC_RUNTIME					\
+	LIBC_STR					\
+	LIBC_SYSV					\
+	LIBC_TESTLIB					\
+	LIBC_X
+
+TEST_TOOL_BUILD_DEPS :=					\
+	$(call uniq,$(foreach x,$(TEST_TOOL_BUILD_DIRECTDEPS),$($(x))))
+
+o/$(MODE)/test/tool/build/build.pkg:			\
+		$(TEST_TOOL_BUILD_OBJS)			\
+		$(foreach x,$(TEST_TOOL_BUILD_DIRECTDEPS),$($(x)_A).pkg)
+
+o/$(MODE)/test/tool/build/%.dbg:			\
+		$(TEST_TOOL_BUILD_DEPS)			\
+		o/$(MODE)/test/tool/build/%.o		\
+		o/$(MODE)/test/tool/build/build.pkg	\
+		$(LIBC_TESTMAIN)			\
+		$(CRT)					\
+		$(APE_NO_MODIFY_SELF)
+	@$(APELINK)
+
+o/$(MODE)/test/tool/build/benchdiff_test.dbg:		\
+		$(TEST_TOOL_BUILD_DEPS)			\
+		o/$(MODE)/test/tool/build/benchdiff_test.o	\
+		o/$(MODE)/test/tool/build/build.pkg	\
+		o/$(MODE)/tool/build/benchdiff.zip.o	\
+		$(LIBC_TESTMAIN)			\
+		$(CRT)					\
+		$(APE_NO_MODIFY_SELF)
+	@$(APELINK)
+
 .PHONY:		o/$(MODE)/test/tool/build
-o/$(MODE)/test/tool/build:			\
-		o/$(MODE)/test/tool/build/lib
+o/$(MODE)/test/tool/build:				\
+		o/$(MODE)/test/tool/build/lib		\
+		$(TEST_TOOL_BUILD_BINS)			\
+		$(TEST_TOOL_BUILD_CHECKS)
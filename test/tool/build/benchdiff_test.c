@@ -0,0 +1,103 @@
+/*-*- mode:c;indent-tabs-mode:nil;c-basic-offset:2;tab-width:8;coding:utf-8 -*-│
+│ vi: set et ft=c ts=2 sts=2 sw=2 fenc=utf-8                               :vi │
+╞══════════════════════════════════════════════════════════════════════════════╡
+│ Copyright 2024 Justine Alexandra Roberts Tunney                              │
+│                                                                              │
+│ Permission to use, copy, modify, and/or distribute this software for         │
+│ any purpose with or without fee is hereby granted, provided that the         │
+│ above copyright notice and this permission notice appear in all copies.      │
+│                                                                              │
+│ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL                │
+│ WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED                │
+│ WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE             │
+│ AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL         │
+│ DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR        │
+│ PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER               │
+│ TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR             │
+│ PERFORMANCE OF THIS SOFTWARE.                                                │
+╚─────────────────────────────────────────────────────────────────────────────*/
+#include "libc/calls/calls.h"
+#include "libc/runtime/runtime.h"
+#include "libc/str/str.h"
+#include "libc/sysv/consts/o.h"
+#include "libc/testlib/testlib.h"
+#include "libc/x/x.h"
+
+__static_yoink("zipos");
+
+static const char kOld[] = "\
+{\"program\":\"str_test\",\"name\":\"memcpy\",\"median_ns\":100.0}\n\
+{\"program\":\"str_test\",\"name\":\"say \\\"hi\\\"\",\"median_ns\":10.0}\n\
+{\"program\":\"str_test\",\"name\":\"tiny\",\"median_ns\":1.0}\n";
+
+static const char kOldCsv[] = "\
+program,name,core,median_ns\n\
+str_test,memcpy,0,100.0\n\
+str_test,\"say \"\"hi\"\"\",0,10.0\n\
+str_test,tiny,0,1.0\n";
+
+void SetUpOnce(void) {
+  testlib_enable_tmp_setup_teardown_once();
+  testlib_extract("/zip/benchdiff", "benchdiff", 0755);
+  ASSERT_SYS(0, 0, xbarf("old.json", kOld, -1));
+  ASSERT_SYS(0, 0, xbarf("old.csv", kOldCsv, -1));
+}
+
+// runs benchdiff on old file and new records, returning exit status
+static int BenchDiff(const char *opts, const char *old, const char *news) {
+  int ws, pid;
+  ASSERT_SYS(0, 0, xbarf("new.json", news, -1));
+  ASSERT_NE(-1, (pid = fork()));
+  if (!pid) {
+    dup2(open("/dev/null", O_WRONLY), 1);
+    dup2(1, 2);
+    if (*opts) {
+      execl("./benchdiff", "benchdiff", opts, old, "new.json", NULL);
+    } else {
+      execl("./benchdiff", "benchdiff", old, "new.json", NULL);
+    }
+    _Exit(127);
+  }
+  ASSERT_EQ(pid, waitpid(pid, &ws, 0));
+  ASSERT_TRUE(WIFEXITED(ws));
+  return WEXITSTATUS(ws);
+}
+
+TEST(benchdiff, unchanged_exitsZero) {
+  EXPECT_EQ(0, BenchDiff("", "old.json", kOld));
+  EXPECT_EQ(0, BenchDiff("", "old.csv", kOld));
+}
+
+TEST(benchdiff, slower_exitsOne) {
+  EXPECT_EQ(1, BenchDiff("", "old.json", "\
+{\"program\":\"str_test\",\"name\":\"memcpy\",\"median_ns\":150.0}\n"));
+  EXPECT_EQ(1, BenchDiff("", "old.csv", "\
+{\"program\":\"str_test\",\"name\":\"say \\\"hi\\\"\",\"median_ns\":12.0}\n"));
+}
+
+TEST(benchdiff, thresholdFlag) {
+  EXPECT_EQ(0, BenchDiff("-t60", "old.json", "\
+{\"program\":\"str_test\",\"name\":\"memcpy\",\"median_ns\":150.0}\n"));
+}
+
+TEST(benchdiff, tinyDeltasAreIgnored) {
+  EXPECT_EQ(0, BenchDiff("", "old.json", "\
+{\"program\":\"str_test\",\"name\":\"tiny\",\"median_ns\":1.5}\n"));
+}
+
+TEST(benchdiff, fastestOfRepeatedRunsIsUsed) {
+  EXPECT_EQ(0, BenchDiff("", "old.json", "\
+{\"program\":\"str_test\",\"name\":\"memcpy\",\"median_ns\":150.0}\n\
+{\"program\":\"str_test\",\"name\":\"memcpy\",\"median_ns\":99.0}\n"));
+}
+
+TEST(benchdiff, newBenchmarks_areNotRegressions) {
+  EXPECT_EQ(0, BenchDiff("", "old.json", "\
+{\"program\":\"str_test\",\"name\":\"memmove\",\"median_ns\":1000.0}\n"));
+}
+
+TEST(benchdiff, badInput_exitsTwo) {
+  EXPECT_EQ(2, BenchDiff("", "missing.json", kOld));
+  EXPECT_EQ(2, BenchDiff("-mp99_ns", "old.json", kOld));
+  EXPECT_EQ(2, BenchDiff("", "old.json", "{\"program\":\"str_test\"}\n"));
+}
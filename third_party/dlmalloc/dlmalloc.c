@@ -66,11 +66,6 @@
 #include "locks.inc"
 #include "chunks.inc"
 #include "headfoot.inc"
-
-#if ONLY_MSPACES
-#include "threaded.inc"
-#endif
-
 #include "global.inc"
 #include "system.inc"
 #include "hooks.inc"
@@ -78,6 +73,11 @@
 #include "indexing.inc"
 #include "binmaps.inc"
 #include "runtimechecks.inc"
+
+#if ONLY_MSPACES
+#include "threaded.inc"
+#endif
+
 #include "init.inc"
 #include "debuglib.inc"
 #include "statistics.inc"
@@ -16,6 +16,7 @@
 #define dlmalloc_max_footprint       __dlmalloc_max_footprint
 #define dlmalloc_set_footprint_limit __dlmalloc_set_footprint_limit
 #define dlmalloc_stats               __dlmalloc_stats
+#define dlmalloc_thread_exit         __dlmalloc_thread_exit
 #define dlmalloc_trim                __dlmalloc_trim
 #define dlmalloc_usable_size         __dlmalloc_usable_size
 #define dlmallopt                    __dlmallopt
@@ -528,6 +529,7 @@ void mspace_inspect_all(mspace msp,
                         void* arg);
 
 void dlmalloc_atfork(void);
+void dlmalloc_thread_exit(void);
 void dlmalloc_abort(void) relegated wontreturn;
 
 COSMOPOLITAN_C_END_
@@ -2,6 +2,11 @@
 #define COSMOPOLITAN_THIRD_PARTY_VQSORT_H_
 COSMOPOLITAN_C_START_
 
+struct vqsort_kv64 {
+  uint64_t key;
+  uint64_t value;
+};
+
 void vqsort_int64(int64_t *, size_t);
 void vqsort_int64_avx2(int64_t *, size_t);
 void vqsort_int64_sse4(int64_t *, size_t);
@@ -14,5 +19,11 @@ void vqsort_int32_sse4(int32_t *, size_t);
 void vqsort_int32_ssse3(int32_t *, size_t);
 void vqsort_int32_sse2(int32_t *, size_t);
 
+void vqsort_uint64(uint64_t *, size_t);
+void vqsort_uint32(uint32_t *, size_t);
+void vqsort_double(double *, size_t);
+void vqsort_float(float *, size_t);
+void vqsort_kv64(struct vqsort_kv64 *, size_t);
+
 COSMOPOLITAN_C_END_
 #endif /* COSMOPOLITAN_THIRD_PARTY_VQSORT_H_ */
@@ -0,0 +1,146 @@
+/*-*- mode:c;indent-tabs-mode:nil;c-basic-offset:2;tab-width:8;coding:utf-8 -*-│
+│ vi: set et ft=c ts=2 sts=2 sw=2 fenc=utf-8                               :vi │
+╞══════════════════════════════════════════════════════════════════════════════╡
+│ Copyright 2024 Justine Alexandra Roberts Tunney                              │
+│                                                                              │
+│ Permission to use, copy, modify, and/or distribute this software for         │
+│ any purpose with or without fee is hereby granted, provided that the         │
+│ above copyright notice and this permission notice appear in all copies.      │
+│                                                                              │
+│ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL                │
+│ WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED                │
+│ WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE             │
+│ AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL         │
+│ DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR        │
+│ PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER               │
+│ TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR             │
+│ PERFORMANCE OF THIS SOFTWARE.                                                │
+╚─────────────────────────────────────────────────────────────────────────────*/
+#include "libc/mem/alg.h"
+#include "libc/mem/mem.h"
+#include "libc/str/str.h"
+#include "third_party/vqsort/vqsort.h"
+
+#define SIGN 0x8000000000000000
+
+static int vqsort_kv64_compare(const void *a, const void *b) {
+  const struct vqsort_kv64 *x = a;
+  const struct vqsort_kv64 *y = b;
+  if (x->key != y->key)
+    return x->key < y->key ? -1 : +1;
+  if (x->value != y->value)
+    return x->value < y->value ? -1 : +1;
+  return 0;
+}
+
+// sorts by key with the item index packed into the low bits, so the
+// hard work can be done by vqsort_int64(). this is only possible if
+// the keys are small enough, and returns false otherwise.
+static bool vqsort_kv64_packed(struct vqsort_kv64 *A, size_t n) {
+  size_t i;
+  uint64_t k, *K, *V, bits, mask, keys = 0;
+  bits = 64 - __builtin_clzll(n - 1);
+  for (i = 0; i < n; ++i)
+    keys |= A[i].key;
+  if (bits >= 64 || keys >> (64 - bits))
+    return false;
+  if (!(K = malloc(n * sizeof(*K))))
+    return false;
+  if (!(V = malloc(n * sizeof(*V)))) {
+    free(K);
+    return false;
+  }
+  for (i = 0; i < n; ++i) {
+    K[i] = (A[i].key << bits | i) ^ SIGN;
+    V[i] = A[i].value;
+  }
+  vqsort_int64((int64_t *)K, n);
+  mask = ((uint64_t)1 << bits) - 1;
+  for (i = 0; i < n; ++i) {
+    k = K[i] ^ SIGN;
+    A[i].key = k >> bits;
+    A[i].value = V[k & mask];
+  }
+  free(V);
+  free(K);
+  return true;
+}
+
+// sorts by key using lsd radix sort, skipping digits that are the same
+// for every key, e.g. the high bytes of keys that are smallish numbers
+static bool vqsort_kv64_radix(struct vqsort_kv64 *A, size_t n) {
+  int d;
+  size_t i, s, t, *h, *H;
+  struct vqsort_kv64 *T, *src, *dst, *tmp;
+  if (!(H = calloc(8 * 256, sizeof(*H))))
+    return false;
+  if (!(T = malloc(n * sizeof(*T)))) {
+    free(H);
+    return false;
+  }
+  for (i = 0; i < n; ++i)
+    for (d = 0; d < 8; ++d)
+      ++H[d * 256 + (A[i].key >> (d * 8) & 255)];
+  src = A;
+  dst = T;
+  for (d = 0; d < 8; ++d) {
+    h = H + d * 256;
+    if (h[A[0].key >> (d * 8) & 255] == n)
+      continue;
+    for (s = i = 0; i < 256; ++i) {
+      t = h[i];
+      h[i] = s;
+      s += t;
+    }
+    for (i = 0; i < n; ++i)
+      dst[h[src[i].key >> (d * 8) & 255]++] = src[i];
+    tmp = src;
+    src = dst;
+    dst = tmp;
+  }
+  if (src != A)
+    memcpy(A, src, n * sizeof(*A));
+  free(T);
+  free(H);
+  return true;
+}
+
+// sorts values of items having the same key
+static void vqsort_kv64_ties(struct vqsort_kv64 *A, size_t n) {
+  uint64_t *V;
+  size_t i, j, k;
+  for (i = 0; i < n; i = j) {
+    for (j = i + 1; j < n && A[j].key == A[i].key; ++j) {
+    }
+    if (j - i < 2)
+      continue;
+    if (j - i <= 16 || !(V = malloc((j - i) * sizeof(*V)))) {
+      qsort(A + i, j - i, sizeof(*A), vqsort_kv64_compare);
+      continue;
+    }
+    for (k = i; k < j; ++k)
+      V[k - i] = A[k].value;
+    vqsort_uint64(V, j - i);
+    for (k = i; k < j; ++k)
+      A[k].value = V[k - i];
+    free(V);
+  }
+}
+
+/**
+ * Sorts array of key value pairs.
+ *
+ * Items are ordered by key and then by value. When keys are less than
+ * `2**(64-log2(n))` this runs at the speed of vqsort_int64(), and it
+ * uses a radix sort otherwise. The array is sorted in place using
+ * qsort() if the `n*16` bytes of temporary memory can't be allocated.
+ */
+void vqsort_kv64(struct vqsort_kv64 *A, size_t n) {
+  if (n < 2)
+    return;
+  if (n > 64 && (vqsort_kv64_packed(A, n) || vqsort_kv64_radix(A, n))) {
+    vqsort_kv64_ties(A, n);
+  } else {
+    qsort(A, n, sizeof(*A), vqsort_kv64_compare);
+  }
+}
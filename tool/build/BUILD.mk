@@ -78,6 +78,7 @@ o/$(MODE)/tool/build/%.dbg:						\
 	@$(APELINK)
 
 o/$(MODE)/tool/build/dso/sandbox-$(ARCH).so.zip.o			\
+o/$(MODE)/tool/build/benchdiff.zip.o					\
 o/$(MODE)/tool/build/false.zip.o					\
 o/$(MODE)/tool/build/echo.zip.o						\
 o/$(MODE)/tool/build/cocmd.zip.o: private				\
@@ -52,6 +52,7 @@
 #include "third_party/getopt/getopt.internal.h"
 #include "third_party/zlib/zlib.h"
 #include "tool/build/lib/lib.h"
+#include "tool/build/lib/zipindex.h"
 
 #define VERSION                     \
   "apelink v0.1\n"                  \
@@ -1789,7 +1790,8 @@ static void IndexZipAssetsFromElf(struct Input *in) {
     if (lfile + ZIP_LFILE_SIZE(lfile) > eof) {
       Die(in->path, "zip local file content overlaps image eof");
     }
-    if (!IsZipFileNamed(lfile, ".symtab") && !HasZipAsset(lfile)) {
+    if (!IsZipFileNamed(lfile, ".symtab") && !IsZipIndex(cfile) &&
+        !HasZipAsset(lfile)) {
       AppendZipAsset(lfile, cfile);
     }
   }
@@ -1806,32 +1808,40 @@ static void CopyZips(Elf64_Off offset) {
   if (!assets.n) {
     return;  // nothing to do
   }
-  if (offset + assets.total_local_file_bytes + assets.total_centraldir_bytes +
+  size_t index_bytes = GetZipIndexLfileSize(assets.n);
+  size_t cdir_bytes = assets.total_centraldir_bytes + GetZipIndexCfileSize();
+  if (offset + assets.total_local_file_bytes + index_bytes + cdir_bytes +
           kZipCdirHdrMinSize >
       INT_MAX) {
     Die(outpath, "more than 2gb of zip files not supported yet");
   }
   Elf64_Off lp = offset;
-  Elf64_Off midpoint = offset + assets.total_local_file_bytes;
-  Elf64_Off cp = midpoint;
+  Elf64_Off midpoint = offset + assets.total_local_file_bytes + index_bytes;
+  unsigned char *cdir = Malloc(cdir_bytes);
+  unsigned char *cp = cdir;
   for (i = 0; i < assets.n; ++i) {
     unsigned char *cfile = assets.p[i].cfile;
     WRITE32LE(cfile + kZipCfileOffsetOffset, lp);
     unsigned char *lfile = assets.p[i].lfile;
     Pwrite(lfile, ZIP_LFILE_SIZE(lfile), lp);
     lp += ZIP_LFILE_SIZE(lfile);
-    Pwrite(cfile, ZIP_CFILE_HDRSIZE(cfile), cp);
-    cp += ZIP_CFILE_HDRSIZE(cfile);
+    cp = mempcpy(cp, cfile, ZIP_CFILE_HDRSIZE(cfile));
   }
+  unsigned char *index = Malloc(index_bytes);
+  CreateZipIndex(index, cdir, cp - cdir, assets.n, offset, lp, midpoint);
+  Pwrite(index, index_bytes, lp);
+  lp += index_bytes;
   unassert(lp == midpoint);
+  Pwrite(cdir, cdir_bytes, midpoint);
   unsigned char eocd[kZipCdirHdrMinSize] = {0};
   WRITE32LE(eocd, kZipCdirHdrMagic);
-  WRITE32LE(eocd + kZipCdirRecordsOnDiskOffset, assets.n);
-  WRITE32LE(eocd + kZipCdirRecordsOffset, assets.n);
-  WRITE32LE(eocd + kZipCdirSizeOffset, assets.total_centraldir_bytes);
-  WRITE32LE(eocd + kZipCdirOffsetOffset,
-            offset + assets.total_local_file_bytes);
-  Pwrite(eocd, sizeof(eocd), cp);
+  WRITE32LE(eocd + kZipCdirRecordsOnDiskOffset, assets.n + 1);
+  WRITE32LE(eocd + kZipCdirRecordsOffset, assets.n + 1);
+  WRITE32LE(eocd + kZipCdirSizeOffset, cdir_bytes);
+  WRITE32LE(eocd + kZipCdirOffsetOffset, midpoint);
+  Pwrite(eocd, sizeof(eocd), midpoint + cdir_bytes);
+  free(index);
+  free(cdir);
 }
 
 int main(int argc, char *argv[]) {
@@ -255,47 +255,14 @@ static void MakeArHeader(struct ar_hdr *h,  //
 
 // copies data between file descriptors until end of file
 // - assumes signal handlers aren't in play
-// - uses copy_file_range() if possible
+// - uses copy_file_range() or sendfile() if possible
 // - returns number of bytes exchanged
 // - dies if operation fails
-static int64_t CopyFileOrDie(const char *inpath, int infd,  //
-                             const char *outpath, int outfd) {
-  int64_t toto;
-  char buf[512];
-  size_t exchanged;
-  ssize_t got, wrote;
-  enum { CFR, RW } mode;
-  for (mode = CFR, toto = 0;; toto += exchanged) {
-    if (mode == CFR) {
-      got = copy_file_range(infd, 0, outfd, 0, 4194304, 0);
-      if (!got)
-        break;
-      if (got != -1) {
-        exchanged = got;
-      } else if (errno == EXDEV ||       // different partitions
-                 errno == ENOSYS ||      // not linux or freebsd
-                 errno == ENOTSUP ||     // probably a /zip file
-                 errno == EOPNOTSUPP) {  // technically the same
-        exchanged = 0;
-        mode = RW;
-      } else {
-        SysDie(inpath, "copy_file_range");
-      }
-    } else {
-      got = read(infd, buf, sizeof(buf));
-      if (!got)
-        break;
-      if (got == -1)
-        SysDie(inpath, "read");
-      wrote = write(outfd, buf, got);
-      if (wrote == -1)
-        SysDie(outpath, "write");
-      if (wrote != got)
-        Die(outpath, "posix violated");
-      exchanged = wrote;
-    }
-  }
-  return toto;
+static int64_t CopyFileOrDie(const char *inpath, int infd, int outfd) {
+  ssize_t rc;
+  if ((rc = copyfd(infd, outfd, -1)) == -1)
+    SysDie(inpath, "copyfd");
+  return rc;
 }
 
 int main(int argc, char *argv[]) {
@@ -490,7 +457,7 @@ int main(int argc, char *argv[]) {
       SysDie(outpath, "writev[2]");
     }
     outsize += sizes.p[i];
-    if (CopyFileOrDie(inpath, fd, outpath, outfd) != sizes.p[i]) {
+    if (CopyFileOrDie(inpath, fd, outfd) != sizes.p[i]) {
       Die(inpath, "file size changed");
     }
     if (close(fd)) {
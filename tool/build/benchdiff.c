@@ -0,0 +1,403 @@
+/*-*- mode:c;indent-tabs-mode:nil;c-basic-offset:2;tab-width:8;coding:utf-8 -*-│
+│ vi: set et ft=c ts=2 sts=2 sw=2 fenc=utf-8                               :vi │
+╞══════════════════════════════════════════════════════════════════════════════╡
+│ Copyright 2024 Justine Alexandra Roberts Tunney                              │
+│                                                                              │
+│ Permission to use, copy, modify, and/or distribute this software for         │
+│ any purpose with or without fee is hereby granted, provided that the         │
+│ above copyright notice and this permission notice appear in all copies.      │
+│                                                                              │
+│ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL                │
+│ WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED                │
+│ WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE             │
+│ AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL         │
+│ DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR        │
+│ PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER               │
+│ TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR             │
+│ PERFORMANCE OF THIS SOFTWARE.                                                │
+╚─────────────────────────────────────────────────────────────────────────────*/
+#include "libc/calls/calls.h"
+#include "libc/fmt/conv.h"
+#include "libc/macros.internal.h"
+#include "libc/mem/alg.h"
+#include "libc/mem/mem.h"
+#include "libc/runtime/runtime.h"
+#include "libc/stdio/append.h"
+#include "libc/stdio/stdio.h"
+#include "libc/str/str.h"
+#include "third_party/getopt/getopt.internal.h"
+
+/**
+ * @fileoverview benchmark regression checker
+ *
+ * Compares two files of results written by EZBENCH when the tests are
+ * run with `EZBENCH_OUTPUT=FILE` and `-b` set, e.g.
+ *
+ *     EZBENCH_OUTPUT=/tmp/old.json o//test/libc/str/memcpy_test -b
+ *     ... rebuild ...
+ *     EZBENCH_OUTPUT=/tmp/new.json o//test/libc/str/memcpy_test -b
+ *     o//tool/build/benchdiff /tmp/old.json /tmp/new.json
+ *
+ * Both json lines and csv files are understood. Benchmarks are matched
+ * by program and name. If a benchmark appears more than once in a file
+ * (e.g. because several runs were appended) then its fastest result is
+ * used. The exit status is 1 if any benchmark got slower by more than
+ * the threshold, 2 if the files couldn't be read, otherwise 0.
+ */
+
+#define USAGE \
+  " [-hq] [-t PERCENT] [-f NANOS] [-m METRIC] OLD NEW\n\
+\n\
+Flags:\n\
+\n\
+  -h          show this information\n\
+  -q          only print regressions\n\
+  -t PERCENT  slowdown considered a regression [default 10]\n\
+  -f NANOS    ignore differences smaller than this [default 1]\n\
+  -m METRIC   min_ns, median_ns, p99_ns, mean_ns, speculative_ns, or\n\
+              strict_ns [default median_ns]\n\
+\n"
+
+struct Bench {
+  char *key;
+  double ns;
+};
+
+struct Benches {
+  size_t n, c;
+  struct Bench *p;
+};
+
+static bool g_quiet;
+static double g_floor = 1;
+static double g_threshold = 10;
+static const char *g_metric = "median_ns";
+static const char *prog;
+
+static wontreturn void PrintUsage(int rc, int fd) {
+  tinyprint(fd, "Usage: ", prog, USAGE, NULL);
+  exit(rc);
+}
+
+static void GetOpts(int argc, char *argv[]) {
+  int opt;
+  while ((opt = getopt(argc, argv, "hqt:f:m:")) != -1) {
+    switch (opt) {
+      case 'q':
+        g_quiet = true;
+        break;
+      case 't':
+        g_threshold = strtod(optarg, 0);
+        break;
+      case 'f':
+        g_floor = strtod(optarg, 0);
+        break;
+      case 'm':
+        g_metric = optarg;
+        break;
+      case 'h':
+        PrintUsage(0, 1);
+      default:
+        PrintUsage(2, 2);
+    }
+  }
+  if (argc - optind != 2)
+    PrintUsage(2, 2);
+}
+
+static const char *SkipSpace(const char *s) {
+  while (*s == ' ' || *s == '\t' || *s == '\r' || *s == '\n')
+    ++s;
+  return s;
+}
+
+// parses json string at `s` into `*out` and returns end, or null
+static const char *ParseJsonString(const char *s, char **out) {
+  int c;
+  char hex[5];
+  if (*s++ != '"')
+    return 0;
+  for (;;) {
+    switch ((c = *s++ & 255)) {
+      case 0:
+        return 0;
+      case '"':
+        if (!*out)
+          appendr(out, 0);
+        return s;
+      case '\\':
+        switch ((c = *s++ & 255)) {
+          case 'n':
+            c = '\n';
+            break;
+          case 't':
+            c = '\t';
+            break;
+          case 'r':
+            c = '\r';
+            break;
+          case 'u':
+            if (strlen(s) < 4)
+              return 0;
+            memcpy(hex, s, 4);
+            hex[4] = 0;
+            c = strtol(hex, 0, 16) & 255;
+            s += 4;
+            break;
+          case 0:
+            return 0;
+          default:
+            break;
+        }
+        // fallthrough
+      default:
+        appendd(out, &c, 1);
+        break;
+    }
+  }
+}
+
+// skips json value at `s` and returns end, or null
+static const char *SkipJsonValue(const char *s) {
+  int depth;
+  char *tmp;
+  if (*s == '"') {
+    tmp = 0;
+    s = ParseJsonString(s, &tmp);
+    free(tmp);
+    return s;
+  }
+  for (depth = 0; *s; ++s) {
+    if (*s == '[' || *s == '{') {
+      ++depth;
+    } else if (*s == ']' || *s == '}') {
+      if (!depth)
+        return s;
+      --depth;
+    } else if (*s == ',' && !depth) {
+      return s;
+    } else if (*s == '"') {
+      tmp = 0;
+      if (!(s = ParseJsonString(s, &tmp)))
+        return 0;
+      free(tmp);
+      --s;
+    }
+  }
+  return s;
+}
+
+// returns pointer to value of top-level `key` in json object, or null
+static const char *FindJsonField(const char *s, const char *key) {
+  bool match;
+  char *name;
+  s = SkipSpace(s);
+  if (*s++ != '{')
+    return 0;
+  for (;;) {
+    name = 0;
+    if (!(s = ParseJsonString(SkipSpace(s), &name)))
+      return 0;
+    match = !strcmp(name, key);
+    free(name);
+    s = SkipSpace(s);
+    if (*s++ != ':')
+      return 0;
+    s = SkipSpace(s);
+    if (match)
+      return s;
+    if (!(s = SkipJsonValue(s)))
+      return 0;
+    s = SkipSpace(s);
+    if (*s++ != ',')
+      return 0;
+  }
+}
+
+// splits csv line into fields, which the caller must free
+static char **SplitCsv(const char *s) {
+  char **v = 0;
+  size_t n = 0;
+  char *field;
+  for (;;) {
+    field = 0;
+    appendr(&field, 0);
+    if (*s == '"') {
+      for (++s; *s; ++s) {
+        if (*s == '"') {
+          if (s[1] != '"') {
+            ++s;
+            break;
+          }
+          ++s;
+        }
+        appendd(&field, s, 1);
+      }
+    }
+    for (; *s && *s != ',' && *s != '\r' && *s != '\n'; ++s)
+      appendd(&field, s, 1);
+    v = realloc(v, (n + 2) * sizeof(*v));
+    v[n++] = field;
+    v[n] = 0;
+    if (*s != ',')
+      return v;
+    ++s;
+  }
+}
+
+static void FreeCsv(char **v) {
+  char **p;
+  if (v) {
+    for (p = v; *p; ++p)
+      free(*p);
+    free(v);
+  }
+}
+
+static int GetCsvColumn(char **header, const char *name) {
+  int i;
+  for (i = 0; header && header[i]; ++i)
+    if (!strcmp(header[i], name))
+      return i;
+  return -1;
+}
+
+static void AddBench(struct Benches *b, const char *program, const char *name,
+                     double ns) {
+  size_t i;
+  char *key = 0;
+  appendf(&key, "%s:%s", program, name);
+  for (i = 0; i < b->n; ++i) {
+    if (!strcmp(b->p[i].key, key)) {
+      b->p[i].ns = MIN(b->p[i].ns, ns);
+      free(key);
+      return;
+    }
+  }
+  if (b->n == b->c) {
+    b->c = b->c ? b->c * 2 : 64;
+    if (!(b->p = realloc(b->p, b->c * sizeof(*b->p)))) {
+      perror("realloc");
+      exit(2);
+    }
+  }
+  b->p[b->n].key = key;
+  b->p[b->n].ns = ns;
+  ++b->n;
+}
+
+static void LoadJsonLine(struct Benches *b, const char *path, long lineno,
+                         const char *line) {
+  const char *p;
+  char *program, *name;
+  program = name = 0;
+  if (!(p = FindJsonField(line, "program")) || !ParseJsonString(p, &program) ||
+      !(p = FindJsonField(line, "name")) || !ParseJsonString(p, &name) ||
+      !(p = FindJsonField(line, g_metric))) {
+    fprintf(stderr, "%s:%ld: bad record or missing %s\n", path, lineno,
+            g_metric);
+    exit(2);
+  }
+  AddBench(b, program, name, strtod(p, 0));
+  free(program);
+  free(name);
+}
+
+static void LoadCsvLine(struct Benches *b, const char *path, long lineno,
+                        char **header, const char *line) {
+  char **v;
+  int i, program, name, metric;
+  program = GetCsvColumn(header, "program");
+  name = GetCsvColumn(header, "name");
+  metric = GetCsvColumn(header, g_metric);
+  if (program == -1 || name == -1 || metric == -1) {
+    fprintf(stderr, "%s: csv header lacks program, name, or %s\n", path,
+            g_metric);
+    exit(2);
+  }
+  v = SplitCsv(line);
+  i = 0;
+  while (v[i])
+    ++i;
+  if (i <= MAX(program, MAX(name, metric))) {
+    fprintf(stderr, "%s:%ld: too few columns\n", path, lineno);
+    exit(2);
+  }
+  AddBench(b, v[program], v[name], strtod(v[metric], 0));
+  FreeCsv(v);
+}
+
+static void Load(struct Benches *b, const char *path) {
+  FILE *f;
+  long lineno;
+  char **header;
+  size_t size;
+  char *line;
+  if (!(f = fopen(path, "r"))) {
+    perror(path);
+    exit(2);
+  }
+  line = 0;
+  size = 0;
+  header = 0;
+  for (lineno = 1; getline(&line, &size, f) != -1; ++lineno) {
+    if (*SkipSpace(line) == '{') {
+      LoadJsonLine(b, path, lineno, line);
+    } else if (startswith(line, "program,")) {
+      FreeCsv(header);
+      header = SplitCsv(line);
+    } else if (*SkipSpace(line)) {
+      LoadCsvLine(b, path, lineno, header, line);
+    }
+  }
+  if (ferror(f)) {
+    perror(path);
+    exit(2);
+  }
+  FreeCsv(header);
+  free(line);
+  fclose(f);
+}
+
+static int CompareBenches(const void *a, const void *b) {
+  return strcmp(((const struct Bench *)a)->key, ((const struct Bench *)b)->key);
+}
+
+int main(int argc, char *argv[]) {
+  size_t i;
+  double delta;
+  struct Bench *old;
+  struct Benches olds = {0}, news = {0};
+  int regressions = 0;
+  if (!(prog = argv[0]))
+    prog = "benchdiff";
+  GetOpts(argc, argv);
+  Load(&olds, argv[optind]);
+  Load(&news, argv[optind + 1]);
+  qsort(olds.p, olds.n, sizeof(*olds.p), CompareBenches);
+  qsort(news.p, news.n, sizeof(*news.p), CompareBenches);
+  for (i = 0; i < news.n; ++i) {
+    if (!(old = bsearch(news.p + i, olds.p, olds.n, sizeof(*olds.p),
+                        CompareBenches))) {
+      if (!g_quiet)
+        printf("%8s %12s %12.3f  %s\n", "new", "", news.p[i].ns,
+               news.p[i].key);
+      continue;
+    }
+    delta = (news.p[i].ns - old->ns) / MAX(old->ns, .001) * 100;
+    if (delta > g_threshold && news.p[i].ns - old->ns >= g_floor) {
+      ++regressions;
+      printf("%+7.1f%% %12.3f %12.3f  %s  REGRESSED\n", delta, old->ns,
+             news.p[i].ns, news.p[i].key);
+    } else if (!g_quiet) {
+      printf("%+7.1f%% %12.3f %12.3f  %s\n", delta, old->ns, news.p[i].ns,
+             news.p[i].key);
+    }
+  }
+  if (regressions) {
+    fflush(stdout);
+    fprintf(stderr, "%s: %d benchmark%s regressed by more than %g%%\n", prog,
+            regressions, regressions == 1 ? "" : "s", g_threshold);
+  }
+  return !!regressions;
+}
@@ -778,8 +778,6 @@ void ReportResources(void) {
 
 bool MovePreservingDestinationInode(const char *from, const char *to) {
   bool res;
-  ssize_t rc;
-  size_t remain;
   struct stat st;
   int fdin, fdout;
   if ((fdin = open(from, O_RDONLY)) == -1) {
@@ -792,26 +790,7 @@ bool MovePreservingDestinationInode(const char *from, const char *to) {
   }
   fadvise(fdin, 0, st.st_size, MADV_SEQUENTIAL);
   ftruncate(fdout, st.st_size);
-  for (res = true, remain = st.st_size; remain;) {
-    rc = copy_file_range(fdin, 0, fdout, 0, remain, 0);
-    if (rc != -1) {
-      remain -= rc;
-    } else if (errno == EXDEV || errno == ENOSYS) {
-      if (lseek(fdin, 0, SEEK_SET) == -1) {
-        res = false;
-        break;
-      }
-      if (lseek(fdout, 0, SEEK_SET) == -1) {
-        res = false;
-        break;
-      }
-      res = copyfd(fdin, fdout, -1) != -1;
-      break;
-    } else {
-      res = false;
-      break;
-    }
-  }
+  res = copyfd(fdin, fdout, -1) != -1;
   close(fdin);
   close(fdout);
   return res;
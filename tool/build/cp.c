@@ -31,6 +31,7 @@
 #include "libc/sysv/consts/at.h"
 #include "libc/sysv/consts/ex.h"
 #include "libc/sysv/consts/exit.h"
+#include "libc/sysv/consts/madv.h"
 #include "libc/sysv/consts/o.h"
 #include "libc/sysv/consts/ok.h"
 #include "libc/sysv/consts/s.h"
@@ -175,6 +176,7 @@ bool MovePreservingDestinationInode(const char *from, const char *to) {
     close(fdin);
     return false;
   }
+  fadvise(fdin, 0, st.st_size, MADV_SEQUENTIAL);
   res = copyfd(fdin, fdout, -1) != -1;
   close(fdin);
   close(fdout);
@@ -0,0 +1,122 @@
+/*-*- mode:c;indent-tabs-mode:nil;c-basic-offset:2;tab-width:8;coding:utf-8 -*-│
+│ vi: set et ft=c ts=2 sts=2 sw=2 fenc=utf-8                               :vi │
+╞══════════════════════════════════════════════════════════════════════════════╡
+│ Copyright 2024 Justine Alexandra Roberts Tunney                              │
+│                                                                              │
+│ Permission to use, copy, modify, and/or distribute this software for         │
+│ any purpose with or without fee is hereby granted, provided that the         │
+│ above copyright notice and this permission notice appear in all copies.      │
+│                                                                              │
+│ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL                │
+│ WARRANTIES WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED                │
+│ WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE             │
+│ AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL         │
+│ DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR        │
+│ PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER               │
+│ TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR             │
+│ PERFORMANCE OF THIS SOFTWARE.                                                │
+╚─────────────────────────────────────────────────────────────────────────────*/
+#include "tool/build/lib/zipindex.h"
+#include "libc/mem/mem.h"
+#include "libc/runtime/zipos.internal.h"
+#include "libc/serialize.h"
+#include "libc/str/str.h"
+#include "libc/sysv/consts/s.h"
+#include "libc/x/x.h"
+#include "libc/zip.internal.h"
+#include "third_party/zlib/zlib.h"
+
+#define NAMESIZE (sizeof(ZIPOS_INDEX_NAME) - 1)
+
+/**
+ * Returns true if central directory record is a zipos index.
+ *
+ * Tools that copy zip files should skip these, since they'd be stale.
+ */
+bool IsZipIndex(const unsigned char *cfile) {
+  return __zipos_is_index(cfile);
+}
+
+/**
+ * Returns size of local file holding index of `records` zip entries.
+ */
+size_t GetZipIndexLfileSize(size_t records) {
+  return kZipLfileHdrMinSize + NAMESIZE + __zipos_index_size(records + 1);
+}
+
+/**
+ * Returns size of central directory record for index.
+ */
+size_t GetZipIndexCfileSize(void) {
+  return kZipCfileHdrMinSize + NAMESIZE;
+}
+
+/**
+ * Creates index of zip central directory, so zipos can start instantly.
+ *
+ * @param lfile receives GetZipIndexLfileSize(records) bytes
+ * @param cdir has `records` entries taking up `cdirsize` bytes, and is
+ *     followed by GetZipIndexCfileSize() bytes that receive the index's
+ *     own central directory record
+ * @param lo is file offset of first local file
+ * @param lfileoff is file offset at which `lfile` will be written
+ * @param cdiroff is file offset at which `cdir` will be written
+ */
+void CreateZipIndex(unsigned char *lfile, unsigned char *cdir, size_t cdirsize,
+                    size_t records, size_t lo, size_t lfileoff,
+                    size_t cdiroff) {
+  uint32_t crc;
+  unsigned char *p, *cfile, *idx;
+  size_t size = __zipos_index_size(records + 1);
+  size_t lfilesize = GetZipIndexLfileSize(records);
+
+  // write central directory record
+  // timestamps are zero so builds are reproducible
+  p = cfile = cdir + cdirsize;
+  p = WRITE32LE(p, kZipCfileHdrMagic);
+  *p++ = kZipCosmopolitanVersion;
+  *p++ = kZipOsUnix;
+  *p++ = kZipEra1989;
+  *p++ = kZipOsDos;
+  p = WRITE16LE(p, 0); /* gflags */
+  p = WRITE16LE(p, kZipCompressionNone);
+  p = WRITE16LE(p, 0); /* mtime */
+  p = WRITE16LE(p, 0); /* mdate */
+  p = WRITE32LE(p, 0); /* crc32 */
+  p = WRITE32LE(p, size);
+  p = WRITE32LE(p, size);
+  p = WRITE16LE(p, NAMESIZE);
+  p = WRITE16LE(p, 0); /* extra size */
+  p = WRITE16LE(p, 0); /* comment size */
+  p = WRITE16LE(p, 0); /* disk */
+  p = WRITE16LE(p, kZipIattrBinary);
+  p = WRITE32LE(p, (uint32_t)(S_IFREG | 0444) << 16);
+  p = WRITE32LE(p, lfileoff);
+  memcpy(p, ZIPOS_INDEX_NAME, NAMESIZE);
+
+  // compute index, which also covers its own record
+  idx = xmalloc(size);
+  __zipos_index_build(idx, cdir, cdirsize + GetZipIndexCfileSize(),
+                      records + 1, cdiroff - lo,
+                      cdiroff - (lfileoff + lfilesize));
+  crc = crc32_z(0, idx, size);
+  WRITE32LE(cfile + kZipCfileOffsetCrc32, crc);
+
+  // write local file
+  p = lfile;
+  p = WRITE32LE(p, kZipLfileHdrMagic);
+  *p++ = kZipEra1989;
+  *p++ = kZipOsDos;
+  p = WRITE16LE(p, 0); /* gflags */
+  p = WRITE16LE(p, kZipCompressionNone);
+  p = WRITE16LE(p, 0); /* mtime */
+  p = WRITE16LE(p, 0); /* mdate */
+  p = WRITE32LE(p, crc);
+  p = WRITE32LE(p, size);
+  p = WRITE32LE(p, size);
+  p = WRITE16LE(p, NAMESIZE);
+  p = WRITE16LE(p, 0); /* extra size */
+  p = mempcpy(p, ZIPOS_INDEX_NAME, NAMESIZE);
+  memcpy(p, idx, size);
+  free(idx);
+}
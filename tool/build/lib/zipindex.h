@@ -0,0 +1,12 @@
+#ifndef COSMOPOLITAN_TOOL_BUILD_LIB_ZIPINDEX_H_
+#define COSMOPOLITAN_TOOL_BUILD_LIB_ZIPINDEX_H_
+COSMOPOLITAN_C_START_
+
+bool IsZipIndex(const unsigned char *);
+size_t GetZipIndexLfileSize(size_t);
+size_t GetZipIndexCfileSize(void);
+void CreateZipIndex(unsigned char *, unsigned char *, size_t, size_t, size_t,
+                    size_t, size_t);
+
+COSMOPOLITAN_C_END_
+#endif /* COSMOPOLITAN_TOOL_BUILD_LIB_ZIPINDEX_H_ */
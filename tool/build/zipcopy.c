@@ -24,6 +24,7 @@
 #include "libc/errno.h"
 #include "libc/fmt/magnumstrs.internal.h"
 #include "libc/limits.h"
+#include "libc/mem/mem.h"
 #include "libc/runtime/runtime.h"
 #include "libc/serialize.h"
 #include "libc/stdio/stdio.h"
@@ -34,6 +35,7 @@
 #include "libc/sysv/consts/prot.h"
 #include "libc/zip.internal.h"
 #include "third_party/getopt/getopt.internal.h"
+#include "tool/build/lib/zipindex.h"
 
 static int infd;
 static int outfd;
@@ -43,6 +45,7 @@ static const char *prog;
 static const char *inpath;
 static const char *outpath;
 static unsigned char *inmap;
+static bool noindex;
 
 static wontreturn void Die(const char *path, const char *reason) {
   tinyprint(2, path, ": ", reason, "\n", NULL);
@@ -83,6 +86,7 @@ DESCRIPTION\n\
 FLAGS\n\
 \n\
   -h            show this help\n\
+  -I            don't add .zipos index to central directory\n\
 \n\
 EXAMPLE\n\
 \n\
@@ -97,8 +101,11 @@ EXAMPLE\n\
 
 static void GetOpts(int argc, char *argv[]) {
   int opt;
-  while ((opt = getopt(argc, argv, "h")) != -1) {
+  while ((opt = getopt(argc, argv, "hI")) != -1) {
     switch (opt) {
+      case 'I':
+        noindex = true;
+        break;
       case 'h':
         PrintUsage(1, 0);
       default:
@@ -116,8 +123,8 @@ static void CopyZip(void) {
   char *secstrs;
   int rela, recs;
   Elf64_Ehdr *ehdr;
-  unsigned long ldest, cdest, ltotal, ctotal, length;
-  unsigned char *ineof, *stop, *eocd, *cdir, *lfile, *cfile;
+  unsigned long ldest, cdest, ltotal, ctotal, itotal, length;
+  unsigned char *ineof, *stop, *eocd, *cdir, *lfile, *cfile, *cout, *iout;
 
   // find zip eocd header
   //
@@ -172,10 +179,17 @@ static void CopyZip(void) {
     if (READ32LE(lfile) != kZipLfileHdrMagic) {
       Die(inpath, "zip local file corrupted");
     }
+    if (IsZipIndex(cfile)) {
+      --recs;  // it'll be regenerated
+      continue;
+    }
     ctotal += ZIP_CFILE_HDRSIZE(cfile);
     ltotal += ZIP_LFILE_SIZE(lfile);
   }
-  if (outsize + ltotal + ctotal + ZIP_CDIR_HDRSIZE(eocd) > INT_MAX) {
+  itotal = noindex ? 0 : GetZipIndexLfileSize(recs);
+  if (outsize + ltotal + itotal + ctotal + GetZipIndexCfileSize() +
+          ZIP_CDIR_HDRSIZE(eocd) >
+      INT_MAX) {
     Die(outpath, "the time has come to upgrade to zip64");
   }
 
@@ -187,8 +201,13 @@ static void CopyZip(void) {
     SysDie(outpath, "lseek");
   }
   ldest = outsize;
-  cdest = outsize + ltotal;
+  cdest = 0;
+  if (!(cout = malloc(ctotal + GetZipIndexCfileSize()))) {
+    SysDie(outpath, "malloc");
+  }
   for (cfile = cdir; cfile < stop; cfile += ZIP_CFILE_HDRSIZE(cfile)) {
+    if (IsZipIndex(cfile))
+      continue;
     lfile = inmap + ZIP_CFILE_OFFSET(cfile);
     WRITE32LE(cfile + kZipCfileOffsetOffset, ldest);
     // write local file
@@ -197,14 +216,35 @@ static void CopyZip(void) {
       SysDie(outpath, "lfile pwrite");
     }
     ldest += length;
-    // write directory entry
+    // gather directory entry
     length = ZIP_CFILE_HDRSIZE(cfile);
-    if (pwrite(outfd, cfile, length, cdest) != length) {
-      SysDie(outpath, "lfile pwrite");
-    }
+    memcpy(cout + cdest, cfile, length);
     cdest += length;
   }
-  WRITE32LE(eocd + kZipCdirOffsetOffset, outsize + ltotal);
+  if (!noindex) {
+    // add index of directory, so zipos doesn't need to sort at startup
+    if (!(iout = malloc(itotal))) {
+      SysDie(outpath, "malloc");
+    }
+    CreateZipIndex(iout, cout, ctotal, recs, outsize, ldest,
+                   outsize + ltotal + itotal);
+    if (pwrite(outfd, iout, itotal, ldest) != itotal) {
+      SysDie(outpath, "index pwrite");
+    }
+    free(iout);
+    ldest += itotal;
+    ctotal += GetZipIndexCfileSize();
+    ++recs;
+  }
+  if (pwrite(outfd, cout, ctotal, ldest) != ctotal) {
+    SysDie(outpath, "cdir pwrite");
+  }
+  free(cout);
+  cdest = ldest + ctotal;
+  WRITE16LE(eocd + kZipCdirRecordsOnDiskOffset, recs);
+  WRITE16LE(eocd + kZipCdirRecordsOffset, recs);
+  WRITE32LE(eocd + kZipCdirSizeOffset, ctotal);
+  WRITE32LE(eocd + kZipCdirOffsetOffset, outsize + ltotal + itotal);
   length = ZIP_CDIR_HDRSIZE(eocd);
   if (pwrite(outfd, eocd, length, cdest) != length) {
     SysDie(outpath, "eocd pwrite");
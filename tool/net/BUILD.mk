@@ -66,7 +66,9 @@ TOOL_NET_DIRECTDEPS =							\
 	THIRD_PARTY_REGEX						\
 	THIRD_PARTY_SQLITE3						\
 	THIRD_PARTY_TZ							\
+	THIRD_PARTY_XXHASH						\
 	THIRD_PARTY_ZLIB						\
+	THIRD_PARTY_ZSTD						\
 	TOOL_ARGS							\
 	TOOL_BUILD_LIB							\
 	TOOL_DECODE_LIB							\
@@ -1687,6 +1687,44 @@ function ProgramPort(uint16) end
 ---@param int integer
 function ProgramMaxPayloadSize(int) end
 
+--- Same as the `-n` flag. Forks this many long-lived workers on startup, each of
+--- which accepts connections from the shared listening sockets using epoll and
+--- multiplexes idle keep-alive connections. Workers that exit are replaced on
+--- the next heartbeat. The default is `0`, which means a new process is forked
+--- for each connection. Only supported on Linux.
+--- This function can only be called from `.init.lua`.
+---@param int integer
+function ProgramEventWorkers(int) end
+
+--- Forks `n` long-lived workers on startup which take turns accepting
+--- connections from the shared listening sockets, so the cost of `fork()` is
+--- paid once per worker rather than once per connection. Each worker serves one
+--- connection at a time. Sandboxing (`-S`) and `OnWorkerStart` happen once per
+--- worker. A worker exits after it's handled `maxrequests` messages, in which
+--- case the last response says `Connection: close`, or once its peak resident
+--- set size has grown by `maxrss` bytes since it was forked. It's then replaced
+--- on the next heartbeat. Zero means no limit, which is the default.
+--- This function can only be called from `.init.lua`.
+---@param n integer
+---@param maxrequests? integer
+---@param maxrss? integer
+function ProgramWorkerPool(n, maxrequests, maxrss) end
+
+--- Same as the `-q` flag. Sets the `listen()` backlog, i.e. how many pending
+--- connections the kernel will queue. The default is `10`, or `1024` if event
+--- workers are enabled. Values larger than `65535` are clamped.
+--- This function can only be called from `.init.lua`.
+---@param int integer
+function ProgramBacklog(int) end
+
+--- Sets `SO_REUSEPORT` on the listening sockets, so that several redbean
+--- processes can bind the same port, e.g. for restarts where the new server
+--- starts before the old one stops. The kernel then balances connections
+--- between processes. Default is false.
+--- This function can only be called from `.init.lua`.
+---@param enabled boolean
+function ProgramReusePort(enabled) end
+
 --- This function is the same as the -K flag if called from .init.lua, e.g.
 --- `ProgramPrivateKey(LoadAsset("/.sign.key"))` for zip loading or
 --- `ProgramPrivateKey(Slurp("/etc/letsencrypt/privkey.pem"))` for local file
@@ -61,7 +61,9 @@
 #include "libc/runtime/memtrack.internal.h"
 #include "libc/runtime/runtime.h"
 #include "libc/runtime/stack.h"
+#include "libc/runtime/zipos.internal.h"
 #include "libc/serialize.h"
+#include "libc/sock/epoll.h"
 #include "libc/sock/goodsocket.internal.h"
 #include "libc/sock/sock.h"
 #include "libc/sock/struct/pollfd.h"
@@ -78,6 +80,7 @@
 #include "libc/sysv/consts/clock.h"
 #include "libc/sysv/consts/clone.h"
 #include "libc/sysv/consts/dt.h"
+#include "libc/sysv/consts/epoll.h"
 #include "libc/sysv/consts/ex.h"
 #include "libc/sysv/consts/exit.h"
 #include "libc/sysv/consts/f.h"
@@ -86,6 +89,7 @@
 #include "libc/sysv/consts/ipproto.h"
 #include "libc/sysv/consts/madv.h"
 #include "libc/sysv/consts/map.h"
+#include "libc/sysv/consts/msg.h"
 #include "libc/sysv/consts/o.h"
 #include "libc/sysv/consts/poll.h"
 #include "libc/sysv/consts/pr.h"
@@ -94,7 +98,9 @@
 #include "libc/sysv/consts/s.h"
 #include "libc/sysv/consts/sa.h"
 #include "libc/sysv/consts/sig.h"
+#include "libc/sysv/consts/so.h"
 #include "libc/sysv/consts/sock.h"
+#include "libc/sysv/consts/sol.h"
 #include "libc/sysv/consts/termios.h"
 #include "libc/sysv/consts/timer.h"
 #include "libc/sysv/consts/w.h"
@@ -127,7 +133,9 @@
 #include "third_party/mbedtls/x509.h"
 #include "third_party/mbedtls/x509_crt.h"
 #include "third_party/musl/netdb.h"
+#include "third_party/xxhash/xxhash.h"
 #include "third_party/zlib/zlib.h"
+#include "third_party/zstd/zstd.h"
 #include "tool/args/args.h"
 #include "tool/build/lib/case.h"
 #include "tool/net/lfinger.h"
@@ -170,6 +178,8 @@ __static_yoink("blink_xnu_aarch64");    // is apple silicon
 
 #define VERSION          0x020200
 #define HASH_LOAD_FACTOR /* 1. / */ 4
+#define HASH_PAR_MIN     16384 /* assets per indexing thread */
+#define HASH_PAR_MAX     8     /* indexing threads */
 #define READ(F, P, N)    readv(F, &(struct iovec){P, N}, 1)
 #define WRITE(F, P, N)   writev(F, &(struct iovec){P, N}, 1)
 #define AppendCrlf(P)    mempcpy(P, "\r\n", 2)
@@ -209,11 +219,11 @@ __static_yoink("blink_xnu_aarch64");    // is apple silicon
     }                       \
   } while (0)
 
-// letters not used: INOQYnoqwxy
+// letters not used: INOQYoxy
 // digits not used:  0123456789
 // puncts not used:  !"#$&'()+,-./;<=>@[\]^_`{|}~
 #define GETOPTS \
-  "*%BEJSVXZabdfghijkmsuvzA:C:D:F:G:H:K:L:M:P:R:T:U:W:c:e:l:p:r:t:w:"
+  "*%BEJSVXZabdfghijkmsuvzA:C:D:F:G:H:K:L:M:P:R:T:U:W:c:e:l:n:p:q:r:t:w:"
 
 static const uint8_t kGzipHeader[] = {
     0x1F,        // MAGNUM
@@ -288,6 +298,28 @@ static struct Servers {
   } *p;
 } servers;
 
+static struct Workers {
+  size_t n;
+  int *p;
+} workers;
+
+static struct Parked {
+  size_t n;
+  struct ParkedClient {
+    bool used;
+    bool polled;
+    bool greeted;
+    int messageshandled;
+    size_t partialn;
+    char *partial;
+    uint32_t addrsize;
+    struct sockaddr_in addr;
+    struct sockaddr_in *server;
+    struct timespec since;
+    struct timespec started;
+  } *p;
+} parkedclients;
+
 static struct Freelist {
   size_t n, c;
   void **p;
@@ -333,14 +365,15 @@ static struct Redirects {
 } redirects;
 
 static struct Assets {
+  bool stale;
   uint32_t n;
   struct Asset {
     bool istext;
+    bool loaded;
     uint32_t hash;
     uint64_t cf;
     uint64_t lf;
     int64_t lastmodified;
-    char *lastmodifiedstr;
     struct File {
       struct String path;
       struct stat st;
@@ -421,6 +454,11 @@ struct ClearedPerMessage {
 
 static bool suiteb;
 static bool killed;
+static bool parked;
+static bool isgreeted;
+static bool useepoll;
+static bool respawn;
+static bool reuseport;
 static bool zombied;
 static bool usingssl;
 static bool funtrace;
@@ -449,6 +487,9 @@ static bool connectionclose;
 static bool hasonloglatency;
 static bool hasonworkerstop;
 static bool isexitingworker;
+static bool ispreforked;
+static bool isrecycling;
+static bool iseventworker;
 static bool hasonworkerstart;
 static bool leakcrashreports;
 static bool hasonhttprequest;
@@ -462,17 +503,24 @@ static bool hasonclientconnection;
 static bool evadedragnetsurveillance;
 
 static int zfd;
+static int epfd;
 static int gmtoff;
 static int client;
+static int backlog;
 static int mainpid;
 static int sandboxed;
 static int changeuid;
 static int changegid;
 static int maxworkers;
+static int preforkworkers;
 static int shutdownsig;
 static int sslpskindex;
 static int oldloglevel;
 static int messageshandled;
+static long workerrequests;
+static long workermaxrequests;
+static long workermaxrss;
+static long workerbaserss;
 static int sslticketlifetime;
 static uint32_t clientaddrsize;
 
@@ -561,7 +609,9 @@ static void OnTerm(int sig) {
   if (!terminated) {
     shutdownsig = sig;
     terminated = true;
-  } else {
+  } else if (!ispreforked || sig != shutdownsig) {
+    // prefork workers can get the same signal twice, once from the tty
+    // and once more when the master forwards it, which isn't an escalation
     killed = true;
   }
 }
@@ -1043,6 +1093,25 @@ static void ProgramTimeout(long ms) {
   }
 }
 
+static void ProgramBacklog(long x) {
+  if (x < 1) {
+    FATALF("(cfg) error: listen backlog needs to be positive");
+  }
+  backlog = MIN(x, 65535);
+}
+
+static void ProgramEventWorkers(long x) {
+  preforkworkers = MAX(0, MIN(x, 4096));
+  useepoll = true;
+}
+
+static void ProgramWorkerPool(long n, long maxrequests, long maxrss) {
+  preforkworkers = MAX(0, MIN(n, 4096));
+  workermaxrequests = MAX(0, maxrequests);
+  workermaxrss = MAX(0, maxrss);
+  useepoll = false;
+}
+
 static void ProgramCache(long x, const char *s) {
   cacheseconds = x;
   if (s)
@@ -1378,8 +1447,24 @@ static void ReportWorkerResources(int pid, struct rusage *ru) {
   }
 }
 
+// removes pid from prefork worker list, returning true if it was there
+static bool ForgetWorker(int pid) {
+  size_t i;
+  for (i = 0; i < workers.n; ++i) {
+    if (workers.p[i] == pid) {
+      workers.p[i] = workers.p[--workers.n];
+      respawn = true;
+      return true;
+    }
+  }
+  return false;
+}
+
 static void HandleWorkerExit(int pid, int ws, struct rusage *ru) {
-  LockInc(&shared->c.connectionshandled);
+  if (!ForgetWorker(pid)) {
+    // event workers count their own connections
+    LockInc(&shared->c.connectionshandled);
+  }
   rusage_add(&shared->children, ru);
   ReportWorkerExit(pid, ws);
   ReportWorkerResources(pid, ru);
@@ -1396,6 +1481,15 @@ static void KillGroup(void) {
   KillGroupImpl(SIGTERM);
 }
 
+// forwards signal to prefork workers, which might not be in our group
+// or might not have been sent it, e.g. `kill -INT` on the master only
+static void KillWorkers(int sig) {
+  size_t i;
+  for (i = 0; i < workers.n; ++i) {
+    LOGIFNEG1(kill(workers.p[i], sig));
+  }
+}
+
 static void WaitAll(void) {
   int ws, pid;
   struct rusage ru;
@@ -1593,6 +1687,11 @@ static int TlsRecv(void *ctx, unsigned char *buf, size_t len, uint32_t tmo) {
   return TlsRecvImpl(ctx, buf, len, tmo);
 }
 
+// reads without blocking so event worker can park slow clients
+static ssize_t ReadNonblocking(int fd, void *buf, size_t size) {
+  return recv(fd, buf, size, MSG_DONTWAIT);
+}
+
 static ssize_t SslRead(int fd, void *buf, size_t size) {
   int rc;
   rc = mbedtls_ssl_read(&ssl, buf, size);
@@ -1717,7 +1816,7 @@ static void CertsDestroy(void) {
 }
 
 static void WipeServingKeys(void) {
-  if (uniprocess)
+  if (uniprocess || ispreforked)
     return;
   mbedtls_ssl_ticket_free(&ssltick);
   mbedtls_ssl_key_cert_free(conf.key_cert), conf.key_cert = 0;
@@ -2139,7 +2238,12 @@ static int64_t GetGmtOffset(int64_t t) {
 
 forceinline bool IsCompressed(struct Asset *a) {
   return !a->file &&
-         ZIP_LFILE_COMPRESSIONMETHOD(zmap + a->lf) == kZipCompressionDeflate;
+         ZIP_LFILE_COMPRESSIONMETHOD(zmap + a->lf) != kZipCompressionNone;
+}
+
+forceinline bool IsZstd(struct Asset *a) {
+  return !a->file &&
+         ZIP_LFILE_COMPRESSIONMETHOD(zmap + a->lf) == kZipCompressionZstd;
 }
 
 forceinline int GetMode(struct Asset *a) {
@@ -2147,23 +2251,18 @@ forceinline int GetMode(struct Asset *a) {
 }
 
 forceinline bool IsCompressionMethodSupported(int method) {
-  return method == kZipCompressionNone || method == kZipCompressionDeflate;
+  return method == kZipCompressionNone ||     //
+         method == kZipCompressionDeflate ||  //
+         method == kZipCompressionZstd;
 }
 
 static inline unsigned Hash(const void *p, unsigned long n) {
-  unsigned h, i;
-  for (h = i = 0; i < n; i++) {
-    h += ((unsigned char *)p)[i];
-    h *= 0x9e3779b1;
-  }
-  return MAX(1, h);
+  uint64_t h;
+  h = XXH3_64bits(p, n);
+  return MAX(1, (uint32_t)(h ^ h >> 32));
 }
 
 static void FreeAssets(void) {
-  size_t i;
-  for (i = 0; i < assets.n; ++i) {
-    Free(&assets.p[i].lastmodifiedstr);
-  }
   Free(&assets.p);
   assets.n = 0;
 }
@@ -2181,45 +2280,115 @@ static unsigned long roundup2pow(unsigned long x) {
   return x > 1 ? 2ul << bsrl(x - 1) : x ? 1 : 0;
 }
 
-static void IndexAssets(void) {
+struct AssetHasher {
+  pthread_t th;
+  uint32_t *hashes;
+  const uint64_t *cfs;
+  uint32_t i, n;
+};
+
+static void *HashAssets(void *arg) {
+  uint32_t i;
   uint64_t cf;
+  struct AssetHasher *h = arg;
+  for (i = h->i; i < h->i + h->n; ++i) {
+    cf = h->cfs[i];
+    h->hashes[i] = Hash(ZIP_CFILE_NAME(zmap + cf), ZIP_CFILE_NAMESIZE(zmap + cf));
+  }
+  return 0;
+}
+
+// hashes asset names using several threads if the zip is really big
+static void HashAssetsParallel(uint32_t *hashes, const uint64_t *cfs,
+                               uint32_t n) {
+  uint32_t i, j, k, chunk;
+  struct AssetHasher h[HASH_PAR_MAX];
+  k = MIN(HASH_PAR_MAX, MAX(1, MIN(__get_cpu_count(), n / HASH_PAR_MIN)));
+  chunk = (n + k - 1) / k;
+  for (i = j = 0; j < k; ++j, i += chunk) {
+    h[j].hashes = hashes;
+    h[j].cfs = cfs;
+    h[j].i = MIN(i, n);
+    h[j].n = MIN(chunk, n - h[j].i);
+  }
+  for (j = 1; j < k; ++j) {
+    if (pthread_create(&h[j].th, 0, HashAssets, h + j)) {
+      break;
+    }
+  }
+  HashAssets(h);
+  for (i = 1; i < j; ++i) {
+    pthread_join(h[i].th, 0);
+  }
+  for (; j < k; ++j) {
+    HashAssets(h + j);
+  }
+}
+
+// the asset table only tracks names; the remaining fields are
+// decoded from the central directory the first time it's served
+static void IndexAssets(void) {
+  uint64_t cf, *cfs;
   struct Asset *p;
-  struct timespec lm;
-  uint32_t i, n, m, step, hash;
+  uint32_t i, j, n, m, step, hash, *hashes;
   DEBUGF("(zip) indexing assets (inode %#lx)", zst.st_ino);
   FreeAssets();
+  assets.stale = false;
   CHECK_GE(HASH_LOAD_FACTOR, 2);
   CHECK(READ32LE(zcdir) == kZipCdir64HdrMagic ||
         READ32LE(zcdir) == kZipCdirHdrMagic);
   n = GetZipCdirRecords(zcdir);
   m = roundup2pow(MAX(1, n) * HASH_LOAD_FACTOR);
-  p = xcalloc(m, sizeof(struct Asset));
-  for (cf = GetZipCdirOffset(zcdir); n--; cf += ZIP_CFILE_HDRSIZE(zmap + cf)) {
+  cfs = xmalloc(MAX(1, n) * sizeof(*cfs));
+  for (j = 0, cf = GetZipCdirOffset(zcdir); n--;
+       cf += ZIP_CFILE_HDRSIZE(zmap + cf)) {
     CHECK_EQ(kZipCfileHdrMagic, ZIP_CFILE_MAGIC(zmap + cf));
+    if (__zipos_is_index(zmap + cf))
+      continue;
     if (!IsCompressionMethodSupported(ZIP_CFILE_COMPRESSIONMETHOD(zmap + cf))) {
       WARNF("(zip) don't understand zip compression method %d used by %`'.*s",
             ZIP_CFILE_COMPRESSIONMETHOD(zmap + cf),
             ZIP_CFILE_NAMESIZE(zmap + cf), ZIP_CFILE_NAME(zmap + cf));
       continue;
     }
-    hash = Hash(ZIP_CFILE_NAME(zmap + cf), ZIP_CFILE_NAMESIZE(zmap + cf));
+    cfs[j++] = cf;
+  }
+  n = j;
+  hashes = xmalloc(MAX(1, n) * sizeof(*hashes));
+  HashAssetsParallel(hashes, cfs, n);
+  p = xcalloc(m, sizeof(struct Asset));
+  for (j = 0; j < n; ++j) {
+    hash = hashes[j];
     step = 0;
     do {
       i = (hash + ((step * (step + 1)) >> 1)) & (m - 1);
       ++step;
     } while (p[i].hash);
-    GetZipCfileTimestamps(zmap + cf, &lm, 0, 0, gmtoff);
     p[i].hash = hash;
-    p[i].cf = cf;
-    p[i].lf = GetZipCfileOffset(zmap + cf);
-    p[i].istext = !!(ZIP_CFILE_INTERNALATTRIBUTES(zmap + cf) & kZipIattrText);
-    p[i].lastmodified = lm.tv_sec;
-    p[i].lastmodifiedstr = FormatUnixHttpDateTime(xmalloc(30), lm.tv_sec);
+    p[i].cf = cfs[j];
   }
+  free(hashes);
+  free(cfs);
   assets.p = p;
   assets.n = m;
 }
 
+// builds asset table if the zip changed since it was last indexed
+static void IndexAssetsIfStale(void) {
+  if (assets.stale) {
+    IndexAssets();
+  }
+}
+
+static void DecodeAsset(struct Asset *a) {
+  struct timespec lm;
+  GetZipCfileTimestamps(zmap + a->cf, &lm, 0, 0, gmtoff);
+  a->lf = GetZipCfileOffset(zmap + a->cf);
+  a->istext = !!(ZIP_CFILE_INTERNALATTRIBUTES(zmap + a->cf) & kZipIattrText);
+  a->lastmodified = lm.tv_sec;
+  a->loaded = true;
+}
+
 static bool OpenZip(bool force) {
   int fd;
   size_t n;
@@ -2246,7 +2415,7 @@ static bool OpenZip(bool force) {
           DCHECK(IsZipEocd32(zmap, zsize, zcdir - zmap) == kZipOk ||
                  IsZipEocd64(zmap, zsize, zcdir - zmap) == kZipOk);
           memcpy(&zst, &st, sizeof(st));
-          IndexAssets();
+          assets.stale = true;
           return true;
         } else {
           WARNF("(zip) couldn't locate central directory");
@@ -2270,6 +2439,7 @@ static struct Asset *GetAssetZip(const char *path, size_t pathlen) {
   uint32_t i, step, hash;
   if (pathlen > 1 && path[0] == '/')
     ++path, --pathlen;
+  IndexAssetsIfStale();
   hash = Hash(path, pathlen);
   for (step = 0;; ++step) {
     i = (hash + ((step * (step + 1)) >> 1)) & (assets.n - 1);
@@ -2278,6 +2448,9 @@ static struct Asset *GetAssetZip(const char *path, size_t pathlen) {
     if (hash == assets.p[i].hash &&
         pathlen == ZIP_CFILE_NAMESIZE(zmap + assets.p[i].cf) &&
         memcmp(path, ZIP_CFILE_NAME(zmap + assets.p[i].cf), pathlen) == 0) {
+      if (!assets.p[i].loaded) {
+        DecodeAsset(&assets.p[i]);
+      }
       return &assets.p[i];
     }
   }
@@ -2294,9 +2467,8 @@ static struct Asset *GetAssetFile(const char *path, size_t pathlen) {
       a->file->path.s = FreeLater(MergePaths(stagedirs.p[i].s, stagedirs.p[i].n,
                                              path, pathlen, &a->file->path.n));
       if (stat(a->file->path.s, &a->file->st) != -1) {
-        a->lastmodifiedstr = FormatUnixHttpDateTime(
-            FreeLater(xmalloc(30)),
-            (a->lastmodified = a->file->st.st_mtim.tv_sec));
+        a->lastmodified = a->file->st.st_mtim.tv_sec;
+        a->loaded = true;
         return a;
       } else {
         LockInc(&shared->c.statfails);
@@ -2389,6 +2561,22 @@ static bool Inflate(void *dp, size_t dn, const void *sp, size_t sn) {
   return !__inflate(dp, dn, sp, sn);
 }
 
+static bool Unzstd(void *dp, size_t dn, const void *sp, size_t sn) {
+  size_t rc;
+  LockInc(&shared->c.unzstds);
+  rc = ZSTD_decompress(dp, dn, sp, sn);
+  return !ZSTD_isError(rc) && rc == dn;
+}
+
+static bool Decompress(struct Asset *a, void *dp, size_t dn, const void *sp,
+                       size_t sn) {
+  if (IsZstd(a)) {
+    return Unzstd(dp, dn, sp, sn);
+  } else {
+    return Inflate(dp, dn, sp, sn);
+  }
+}
+
 static bool Verify(void *data, size_t size, uint32_t crc) {
   uint32_t got;
   LockInc(&shared->c.verifies);
@@ -2430,8 +2618,8 @@ static void *LoadAsset(struct Asset *a, size_t *out_size) {
     if (size == SIZE_MAX || !(data = malloc(size + 1)))
       return NULL;
     if (IsCompressed(a)) {
-      if (!Inflate(data, size, ZIP_LFILE_CONTENT(zmap + a->lf),
-                   GetZipCfileCompressedSize(zmap + a->cf))) {
+      if (!Decompress(a, data, size, ZIP_LFILE_CONTENT(zmap + a->lf),
+                      GetZipCfileCompressedSize(zmap + a->cf))) {
         free(data);
         return NULL;
       }
@@ -2591,7 +2779,7 @@ static char *ServeErrorImplDefault(unsigned code, const char *reason,
     if (IsCompressed(a)) {
       n = GetZipLfileUncompressedSize(zmap + a->lf);
       if ((s = FreeLater(malloc(n))) &&
-          Inflate(s, n, cpm.content, cpm.contentlength)) {
+          Decompress(a, s, n, cpm.content, cpm.contentlength)) {
         cpm.content = s;
         cpm.contentlength = n;
       } else {
@@ -2833,7 +3021,6 @@ static ssize_t InflateGenerator(struct iovec v[3]) {
 static char *ServeAssetDecompressed(struct Asset *a) {
   char *p;
   size_t size;
-  LockInc(&shared->c.inflates);
   LockInc(&shared->c.decompressedresponses);
   size = GetZipCfileUncompressedSize(zmap + a->cf);
   DEBUGF("(srvr) ServeAssetDecompressed(%ld)→%ld", cpm.contentlength, size);
@@ -2841,7 +3028,8 @@ static char *ServeAssetDecompressed(struct Asset *a) {
     cpm.content = 0;
     cpm.contentlength = size;
     return SetStatus(200, "OK");
-  } else if (!IsTiny()) {
+  } else if (!IsTiny() && !IsZstd(a)) {
+    LockInc(&shared->c.inflates);
     dg.t = 0;
     dg.i = 0;
     dg.c = 0;
@@ -2852,7 +3040,7 @@ static char *ServeAssetDecompressed(struct Asset *a) {
     dg.b = FreeLater(malloc(dg.z));
     return SetStatus(200, "OK");
   } else if ((p = FreeLater(malloc(size))) &&
-             Inflate(p, size, cpm.content, cpm.contentlength) &&
+             Decompress(a, p, size, cpm.content, cpm.contentlength) &&
              Verify(p, size, ZIP_CFILE_CRC32(zmap + a->cf))) {
     cpm.content = p;
     cpm.contentlength = size;
@@ -3048,6 +3236,8 @@ td { padding-right: 3em; }\r\n\
   for (zcf = zmap + GetZipCdirOffset(zcdir); n--;
        zcf += ZIP_CFILE_HDRSIZE(zcf)) {
     CHECK_EQ(kZipCfileHdrMagic, ZIP_CFILE_MAGIC(zcf));
+    if (__zipos_is_index(zcf))
+      continue;
     path = GetAssetPath(zcf, &pathlen);
     if (!IsHiddenPath(path, pathlen)) {
       w[0] = min(80, max(w[0], strwidth(path, 0) + 2));
@@ -3060,6 +3250,8 @@ td { padding-right: 3em; }\r\n\
   for (zcf = zmap + GetZipCdirOffset(zcdir); n--;
        zcf += ZIP_CFILE_HDRSIZE(zcf)) {
     CHECK_EQ(kZipCfileHdrMagic, ZIP_CFILE_MAGIC(zcf));
+    if (__zipos_is_index(zcf))
+      continue;
     path = GetAssetPath(zcf, &pathlen);
     if (!IsHiddenPath(path, pathlen)) {
       rp[0] = VisualizeControlCodes(path, pathlen, &rn[0]);
@@ -4548,6 +4740,23 @@ static int LuaProgramMaxPayloadSize(lua_State *L) {
   return LuaProgramInt(L, ProgramMaxPayloadSize);
 }
 
+static int LuaProgramBacklog(lua_State *L) {
+  OnlyCallFromInitLua(L, "ProgramBacklog");
+  return LuaProgramInt(L, ProgramBacklog);
+}
+
+static int LuaProgramEventWorkers(lua_State *L) {
+  OnlyCallFromInitLua(L, "ProgramEventWorkers");
+  return LuaProgramInt(L, ProgramEventWorkers);
+}
+
+static int LuaProgramWorkerPool(lua_State *L) {
+  OnlyCallFromInitLua(L, "ProgramWorkerPool");
+  ProgramWorkerPool(luaL_checkinteger(L, 1), luaL_optinteger(L, 2, 0),
+                    luaL_optinteger(L, 3, 0));
+  return 0;
+}
+
 static int LuaGetClientFd(lua_State *L) {
   OnlyCallDuringConnection(L, "GetClientFd");
   lua_pushinteger(L, client);
@@ -4742,6 +4951,11 @@ static int LuaProgramSslClientVerify(lua_State *L) {
   return LuaProgramBool(L, &sslclientverify);
 }
 
+static int LuaProgramReusePort(lua_State *L) {
+  OnlyCallFromInitLua(L, "ProgramReusePort");
+  return LuaProgramBool(L, &reuseport);
+}
+
 static int LuaProgramSslRequired(lua_State *L) {
   OnlyCallFromInitLua(L, "ProgramSslRequired");
   return LuaProgramBool(L, &requiressl);
@@ -4797,6 +5011,8 @@ static int LuaGetZipPaths(lua_State *L) {
   for (zcf = zmap + GetZipCdirOffset(zcdir); n--;
        zcf += ZIP_CFILE_HDRSIZE(zcf)) {
     CHECK_EQ(kZipCfileHdrMagic, ZIP_CFILE_MAGIC(zcf));
+    if (__zipos_is_index(zcf))
+      continue;
     path = GetAssetPath(zcf, &pathlen);
     if (prefixlen == 0 || startswith(path, prefix)) {
       lua_pushlstring(L, path, pathlen);
@@ -5174,8 +5390,10 @@ static const char *const kDontAutoComplete[] = {
     "LaunchBrowser",             //
     "LuaProgramSslRequired",     // TODO
     "ProgramAddr",               // TODO
+    "ProgramBacklog",            //
     "ProgramBrand",              //
     "ProgramCertificate",        // TODO
+    "ProgramEventWorkers",       //
     "ProgramGid",                //
     "ProgramLogPath",            // TODO
     "ProgramMaxPayloadSize",     // TODO
@@ -5188,6 +5406,7 @@ static const char *const kDontAutoComplete[] = {
     "ProgramTimeout",            // TODO
     "ProgramUid",                //
     "ProgramUniprocess",         //
+    "ProgramWorkerPool",         //
     "Respond",                   //
     "Route",                     //
     "RouteHost",                 //
@@ -5316,10 +5535,12 @@ static const luaL_Reg kLuaFuncs[] = {
     {"ParseUrl", LuaParseUrl},                                  //
     {"Popcnt", LuaPopcnt},                                      //
     {"ProgramAddr", LuaProgramAddr},                            //
+    {"ProgramBacklog", LuaProgramBacklog},                      //
     {"ProgramBrand", LuaProgramBrand},                          //
     {"ProgramCache", LuaProgramCache},                          //
     {"ProgramContentType", LuaProgramContentType},              //
     {"ProgramDirectory", LuaProgramDirectory},                  //
+    {"ProgramEventWorkers", LuaProgramEventWorkers},            //
     {"ProgramGid", LuaProgramGid},                              //
     {"ProgramHeader", LuaProgramHeader},                        //
     {"ProgramHeartbeatInterval", LuaProgramHeartbeatInterval},  //
@@ -5331,10 +5552,12 @@ static const luaL_Reg kLuaFuncs[] = {
     {"ProgramPidPath", LuaProgramPidPath},                      //
     {"ProgramPort", LuaProgramPort},                            //
     {"ProgramRedirect", LuaProgramRedirect},                    //
+    {"ProgramReusePort", LuaProgramReusePort},                  //
     {"ProgramTimeout", LuaProgramTimeout},                      //
     {"ProgramTrustedIp", LuaProgramTrustedIp},                  // undocumented
     {"ProgramUid", LuaProgramUid},                              //
     {"ProgramUniprocess", LuaProgramUniprocess},                //
+    {"ProgramWorkerPool", LuaProgramWorkerPool},                //
     {"Rand64", LuaRand64},                                      //
     {"Rdrand", LuaRdrand},                                      //
     {"Rdseed", LuaRdseed},                                      //
@@ -5596,6 +5819,8 @@ static void MemDestroy(void) {
   Free(&freelist.p), freelist.n = freelist.c = 0;
   Free(&hdrbuf.p), hdrbuf.n = hdrbuf.c = 0;
   Free(&servers.p), servers.n = 0;
+  Free(&workers.p), workers.n = 0;
+  Free(&parkedclients.p), parkedclients.n = 0;
   Free(&ports.p), ports.n = 0;
   Free(&ips.p), ips.n = 0;
   Free(&cpm.outbuf);
@@ -5665,6 +5890,8 @@ static const char *DescribeClose(void) {
     return "meltdown";
   if (terminated)
     return "terminated";
+  if (isrecycling)
+    return "recycled";
   if (connectionclose)
     return "connection closed";
   return "destroyed";
@@ -5847,9 +6074,13 @@ static void HandleFrag(size_t got) {
 }
 
 static void HandleReload(void) {
+  size_t i;
   LockInc(&shared->c.reloads);
   LuaOnServerReload(Reindex());
   invalidated = false;
+  for (i = 0; i < workers.n; ++i) {
+    kill(workers.p[i], SIGUSR1);
+  }
 }
 
 static void HandleHeartbeat(void) {
@@ -5941,8 +6172,11 @@ static void SendContinueIfNeeded(void) {
 static char *ReadMore(void) {
   size_t got;
   ssize_t rc;
+  reader_f rd;
   LockInc(&shared->c.frags);
-  if ((rc = reader(client, inbuf.p + amtread, inbuf.n - amtread)) != -1) {
+  if ((rd = reader) == ReadNonblocking)
+    rd = read;  // payloads are read to completion, even in event workers
+  if ((rc = rd(client, inbuf.p + amtread, inbuf.n - amtread)) != -1) {
     if (!(got = rc))
       return HandlePayloadDisconnect();
     amtread += got;
@@ -6259,6 +6493,7 @@ static bool IsNotModified(struct Asset *a) {
 static char *ServeAsset(struct Asset *a, const char *path, size_t pathlen) {
   char *p;
   const char *ct;
+  char lastmodified[30];
   ct = GetContentType(a, path, pathlen);
   if (IsNotModified(a)) {
     LockInc(&shared->c.notmodifieds);
@@ -6271,7 +6506,7 @@ static char *ServeAsset(struct Asset *a, const char *path, size_t pathlen) {
       return p;
     }
     if (IsCompressed(a)) {
-      if (ClientAcceptsGzip()) {
+      if (ClientAcceptsGzip() && !IsZstd(a)) {
         p = ServeAssetPrecompressed(a);
       } else {
         p = ServeAssetDecompressed(a);
@@ -6302,7 +6537,8 @@ static char *ServeAsset(struct Asset *a, const char *path, size_t pathlen) {
   }
   p = AppendContentType(p, ct);
   p = stpcpy(p, "Vary: Accept-Encoding\r\n");
-  p = AppendHeader(p, "Last-Modified", a->lastmodifiedstr);
+  p = AppendHeader(p, "Last-Modified",
+                   FormatUnixHttpDateTime(lastmodified, a->lastmodified));
   if (cpm.msg.version >= 11) {
     if (!cpm.gotcachecontrol) {
       p = AppendCache(p, cacheseconds, cachedirective);
@@ -6388,6 +6624,7 @@ static bool TransmitResponse(char *p) {
   Send(iov, iovlen);
   LockInc(&shared->c.messageshandled);
   ++messageshandled;
+  ++workerrequests;
   return true;
 }
 
@@ -6448,6 +6685,38 @@ static bool StreamResponse(char *p) {
   return true;
 }
 
+// returns peak resident set size of this process in bytes
+static long GetPeakRss(void) {
+  struct rusage ru;
+  if (getrusage(RUSAGE_SELF, &ru) == -1)
+    return 0;
+  return ru.ru_maxrss * 1024;
+}
+
+// returns true if prefork worker should exit and be replaced
+//
+// the rss limit applies to growth since the worker was forked, because
+// the peak rss reported by getrusage() includes what the master had in
+// memory at the time of fork(), which the worker has no control over.
+static bool ShouldRecycleWorker(void) {
+  long rss;
+  if (isrecycling)
+    return true;
+  if (!ispreforked)
+    return false;
+  if (workermaxrequests && workerrequests >= workermaxrequests) {
+    DEBUGF("(srvr) recycling worker after %,ld requests", workerrequests);
+    isrecycling = true;
+  } else if (workermaxrss &&
+             (rss = GetPeakRss() - workerbaserss) >= workermaxrss) {
+    DEBUGF("(srvr) recycling worker after growing %,ld bytes", rss);
+    isrecycling = true;
+  }
+  if (isrecycling)
+    LockInc(&shared->c.recycles);
+  return isrecycling;
+}
+
 static bool HandleMessageActual(void) {
   int rc;
   long reqtime, contime;
@@ -6475,6 +6744,10 @@ static bool HandleMessageActual(void) {
     LockInc(&shared->c.synchronizationfailures);
     DEBUGF("(clnt) could not synchronize message stream");
   }
+  if (ispreforked && workermaxrequests &&
+      workerrequests + 1 >= workermaxrequests) {
+    connectionclose = true;  // worker gets recycled after this message
+  }
   if (cpm.msg.version >= 10) {
     p = AppendCrlf(stpcpy(stpcpy(p, "Date: "), shared->currentdate));
     if (!cpm.branded)
@@ -6538,12 +6811,15 @@ static bool IsSsl(unsigned char c) {
   return true;
 }
 
-static void HandleMessages(void) {
+// handles http messages on client connection until it's closed, or in
+// an event worker, until it'd block, in which case parked is set. the
+// greeted flag says if the first bytes of this connection were seen.
+static void HandleMessages(bool greeted) {
   bool once;
   ssize_t rc;
   size_t got;
   (void)once;
-  for (once = false;;) {
+  for (once = greeted;;) {
     InitRequest();
     startread = timespec_real();
     for (;;) {
@@ -6591,6 +6867,12 @@ static void HandleMessages(void) {
       } else if (errno == EINTR) {
         LockInc(&shared->c.readinterrupts);
         errno = 0;
+      } else if (errno == EAGAIN && reader == ReadNonblocking) {
+        // wait for epoll to say there's more, keeping what's been read
+        errno = 0;
+        isgreeted = once;
+        parked = true;
+        return;
       } else if (errno == EAGAIN) {
         LockInc(&shared->c.readtimeouts);
         if (amtread)
@@ -6632,7 +6914,8 @@ static void HandleMessages(void) {
       if (killed) {
         LogClose(DescribeClose());
         return;
-      } else if (connectionclose || terminated || meltdown) {
+      } else if (connectionclose || terminated || meltdown ||
+                 ShouldRecycleWorker()) {
         NotifyClose();
         LogClose(DescribeClose());
         return;
@@ -6646,7 +6929,7 @@ static void HandleMessages(void) {
       if (killed) {
         LogClose(DescribeClose());
         return;
-      } else if (connectionclose) {
+      } else if (connectionclose || ShouldRecycleWorker()) {
         NotifyClose();
         LogClose(DescribeClose());
         return;
@@ -6656,6 +6939,11 @@ static void HandleMessages(void) {
     if (invalidated) {
       HandleReload();
     }
+    if (iseventworker && !amtread && !usingssl) {
+      isgreeted = true;
+      parked = true;
+      return;
+    }
   }
 }
 
@@ -6703,6 +6991,138 @@ static int EnableSandbox(void) {
   }
 }
 
+// restores connection state that's left over after HandleMessages()
+static void ResetClient(void) {
+  oldin.p = 0;
+  oldin.n = 0;
+  if (inbuf.c) {
+    inbuf.p -= inbuf.c;
+    inbuf.n += inbuf.c;
+    inbuf.c = 0;
+  }
+#ifndef UNSECURE
+  if (usingssl) {
+    usingssl = false;
+    reader = iseventworker ? ReadNonblocking : read;
+    writer = WritevAll;
+    mbedtls_ssl_session_reset(&ssl);
+  }
+#endif
+}
+
+static struct ParkedClient *GetParkedClient(int fd) {
+  size_t n;
+  if (fd >= parkedclients.n) {
+    n = MAX(fd + 1, parkedclients.n * 2);
+    parkedclients.p = xrealloc(parkedclients.p, n * sizeof(*parkedclients.p));
+    bzero(parkedclients.p + parkedclients.n,
+          (n - parkedclients.n) * sizeof(*parkedclients.p));
+    parkedclients.n = n;
+  }
+  return parkedclients.p + fd;
+}
+
+// remembers idle keep-alive connection until epoll says it's readable
+static void ParkClient(void) {
+  struct epoll_event ev;
+  struct ParkedClient *c;
+  c = GetParkedClient(client);
+  if (!c->used) {
+    c->used = true;
+    c->started = startconnection;
+  }
+  c->addr = clientaddr;
+  c->addrsize = clientaddrsize;
+  c->server = serveraddr;
+  c->since = timespec_real();
+  c->messageshandled = messageshandled;
+  c->greeted = isgreeted;
+  if (amtread) {
+    c->partial = xrealloc(c->partial, amtread);
+    memcpy(c->partial, inbuf.p, amtread);
+  }
+  c->partialn = amtread;
+  ev.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+  ev.data.u64 = servers.n + client;
+  if (epoll_ctl(epfd, c->polled ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, client,
+                &ev) != -1) {
+    c->polled = true;
+  } else {
+    WARNF("(srvr) %s epoll_ctl error: %m", DescribeClient());
+    c->used = false;
+    c->polled = false;
+    c->partialn = 0;
+    Free(&c->partial);
+    close(client);
+  }
+}
+
+static void UnparkClient(int fd) {
+  struct ParkedClient *c;
+  c = GetParkedClient(fd);
+  client = fd;
+  clientaddr = c->addr;
+  clientaddrsize = c->addrsize;
+  serveraddr = c->server;
+  startconnection = c->started;
+  messageshandled = c->messageshandled;
+  if (c->partialn) {
+    memcpy(inbuf.p, c->partial, c->partialn);
+    amtread = c->partialn;
+    c->partialn = 0;
+  }
+}
+
+static void CloseClient(void) {
+  struct ParkedClient *c;
+  DEBUGF("(stat) %s closing after %,ldµs", DescribeClient(),
+         timespec_tomicros(timespec_sub(timespec_real(), startconnection)));
+  if (client < parkedclients.n) {
+    c = parkedclients.p + client;
+    c->used = false;
+    c->polled = false;
+  }
+  LockInc(&shared->c.connectionshandled);
+  close(client);
+}
+
+// handles messages on connection inside prefork worker process
+static void ServeClient(bool greeted) {
+  parked = false;
+  connectionclose = false;
+  HandleMessages(greeted);
+  if (parked) {
+    ParkClient();
+  } else {
+    CloseClient();
+  }
+  amtread = 0;
+  ResetClient();
+  CollectGarbage();
+}
+
+static void ResumeClient(int fd) {
+  UnparkClient(fd);
+  ishandlingconnection = true;
+  ServeClient(parkedclients.p[fd].greeted);
+  ishandlingconnection = false;
+}
+
+// closes parked connections, or only ones idle since before deadline
+static void CloseParkedClients(const char *reason, struct timespec deadline) {
+  int fd;
+  for (fd = 0; fd < parkedclients.n; ++fd) {
+    if (!parkedclients.p[fd].used)
+      continue;
+    if (timespec_cmp(parkedclients.p[fd].since, deadline) >= 0)
+      continue;
+    UnparkClient(fd);
+    LogClose(reason);
+    CloseClient();
+    amtread = 0;
+  }
+}
+
 static int HandleConnection(size_t i) {
   uint32_t ip;
   int pid, tok, rc = 0;
@@ -6746,7 +7166,8 @@ static int HandleConnection(size_t i) {
       DEBUGF("(token) can't acquire accept() token for client");
     }
     startconnection = timespec_real();
-    if (UNLIKELY(maxworkers) && shared->workers >= maxworkers) {
+    if (UNLIKELY(maxworkers) && !ispreforked &&
+        shared->workers >= maxworkers) {
       EnterMeltdownMode();
       SendServiceUnavailable();
       close(client);
@@ -6761,7 +7182,11 @@ static int HandleConnection(size_t i) {
     if (uniprocess) {
       pid = -1;
       connectionclose = true;
+    } else if (ispreforked) {
+      ServeClient(false);
+      return 0;
     } else {
+      IndexAssetsIfStale();
       switch ((pid = fork())) {
         case 0:
           meltdown = false;
@@ -6794,7 +7219,7 @@ static int HandleConnection(size_t i) {
     if (!pid && !IsWindows()) {
       CloseServerFds();
     }
-    HandleMessages();
+    HandleMessages(false);
     DEBUGF("(stat) %s closing after %,ldµs", DescribeClient(),
            timespec_tomicros(timespec_sub(timespec_real(), startconnection)));
     if (!pid) {
@@ -6804,21 +7229,7 @@ static int HandleConnection(size_t i) {
       rc = ExitWorker();
     } else {
       close(client);
-      oldin.p = 0;
-      oldin.n = 0;
-      if (inbuf.c) {
-        inbuf.p -= inbuf.c;
-        inbuf.n += inbuf.c;
-        inbuf.c = 0;
-      }
-#ifndef UNSECURE
-      if (usingssl) {
-        usingssl = false;
-        reader = read;
-        writer = WritevAll;
-        mbedtls_ssl_session_reset(&ssl);
-      }
-#endif
+      ResetClient();
     }
     CollectGarbage();
   } else {
@@ -6938,11 +7349,13 @@ static int HandleReadline(void) {
 
 static int HandlePoll(int ms) {
   int rc, nfds;
-  size_t pollid, serverid;
-  if ((nfds = poll(polls, 1 + servers.n, ms)) != -1) {
+  size_t npolls, pollid, serverid;
+  // listening sockets belong to event workers when they're enabled
+  npolls = preforkworkers ? 1 : 1 + servers.n;
+  if ((nfds = poll(polls, npolls, ms)) != -1) {
     if (nfds) {
       // handle pollid/o events
-      for (pollid = 0; pollid < 1 + servers.n; ++pollid) {
+      for (pollid = 0; pollid < npolls; ++pollid) {
         if (!polls[pollid].revents)
           continue;
         if (polls[pollid].fd < 0)
@@ -6991,6 +7404,14 @@ static int HandlePoll(int ms) {
   return 0;
 }
 
+static int GetBacklog(void) {
+  if (backlog)
+    return backlog;
+  if (preforkworkers)
+    return 1024;
+  return 10;
+}
+
 static void Listen(void) {
   char ipbuf[16];
   size_t i, j, n;
@@ -7027,13 +7448,25 @@ static void Listen(void) {
         n--;  // skip this server instance
         continue;
       }
-
+      if (preforkworkers) {
+        // workers wait on these in poll, so only one of them should be
+        // able to win the race to accept(); the rest get EAGAIN.
+        fcntl(servers.p[n].fd, F_SETFL, O_NONBLOCK);
+      }
+      if (reuseport) {
+        // lets other redbean processes share the port, for zero downtime
+        // restarts where the new server starts before the old one stops
+        if (setsockopt(servers.p[n].fd, SOL_SOCKET, SO_REUSEPORT, &(int){1},
+                       sizeof(int)) == -1) {
+          WARNF("(srvr) can't set SO_REUSEPORT: %m");
+        }
+      }
       if (bind(servers.p[n].fd, (struct sockaddr *)&servers.p[n].addr,
                sizeof(servers.p[n].addr)) == -1) {
         DIEF("(srvr) bind error: %m: %hhu.%hhu.%hhu.%hhu:%hu", ips.p[i] >> 24,
              ips.p[i] >> 16, ips.p[i] >> 8, ips.p[i], ports.p[j]);
       }
-      if (listen(servers.p[n].fd, 10) == -1) {
+      if (listen(servers.p[n].fd, GetBacklog()) == -1) {
         DIEF("(srvr) listen error: %m");
       }
       addrsize = sizeof(servers.p[n].addr);
@@ -7068,6 +7501,166 @@ static void Listen(void) {
   }
 }
 
+// how long event worker lets keep-alive connection sit idle
+static struct timespec GetIdleTimeout(void) {
+  if (timeout.tv_sec < 0) {
+    return timespec_fromseconds(-timeout.tv_sec);
+  } else {
+    return timeval_totimespec(timeout);
+  }
+}
+
+static void HandleWorkerHeartbeat(void) {
+  size_t i;
+  struct timespec t;
+  if (timespec_cmp(timespec_sub((t = timespec_real()), lastheartbeat),
+                   heartbeatinterval) >= 0) {
+    lastheartbeat = t;
+    UpdateCurrentDate(t);
+    Reindex();
+    CloseParkedClients("idle timeout", timespec_sub(t, GetIdleTimeout()));
+    CollectGarbage();
+    for (i = 1; i <= servers.n; ++i) {
+      if (polls[i].fd < 0) {
+        polls[i].fd = -polls[i].fd;
+      }
+    }
+  }
+}
+
+static int StopWorker(void) {
+  CloseParkedClients(DescribeClose(), timespec_max);
+  if (hasonworkerstop) {
+    CallSimpleHook("OnWorkerStop");
+  }
+  return ExitWorker();
+}
+
+// runs inside prefork worker that serves one connection at a time
+static int PoolWorker(void) {
+  size_t i;
+  int n, rc = 0;
+  while (!terminated && !killed && rc != -1 && !ShouldRecycleWorker()) {
+    if (invalidated) {
+      HandleReload();
+    }
+    meltdown = false;
+    if ((n = poll(polls + 1, servers.n,
+                  timespec_tomillis(heartbeatinterval))) == -1) {
+      if (errno != EINTR && errno != EAGAIN) {
+        DIEF("(srvr) poll error: %m");
+      }
+      LockInc(&shared->c.pollinterrupts);
+      n = 0;
+    }
+    for (i = 0; n && i < servers.n && rc != -1 && !isrecycling; ++i) {
+      if (!polls[1 + i].revents || polls[1 + i].fd < 0)
+        continue;
+      serveraddr = &servers.p[i].addr;
+      ishandlingconnection = true;
+      rc = HandleConnection(i);
+      ishandlingconnection = false;
+    }
+    HandleWorkerHeartbeat();
+  }
+  return StopWorker();
+}
+
+// runs inside prefork worker that multiplexes keep-alive connections
+static int EventWorker(void) {
+  size_t i;
+  int j, n, rc = 0;
+  struct epoll_event ev, evs[64];
+  if ((epfd = epoll_create1(EPOLL_CLOEXEC)) == -1) {
+    DIEF("(srvr) epoll_create1 error: %m");
+  }
+  for (i = 0; i < servers.n; ++i) {
+    ev.events = EPOLLIN | EPOLLEXCLUSIVE;
+    ev.data.u64 = i;
+    if (epoll_ctl(epfd, EPOLL_CTL_ADD, servers.p[i].fd, &ev) == -1) {
+      DIEF("(srvr) epoll_ctl %s error: %m", DescribeServer());
+    }
+  }
+  while (!terminated && !killed && rc != -1 && !ShouldRecycleWorker()) {
+    if (invalidated) {
+      HandleReload();
+    }
+    if (meltdown) {
+      CloseParkedClients("meltdown", timespec_max);
+      meltdown = false;
+    }
+    if ((n = epoll_wait(epfd, evs, ARRAYLEN(evs),
+                        timespec_tomillis(heartbeatinterval))) == -1) {
+      if (errno != EINTR) {
+        DIEF("(srvr) epoll_wait error: %m");
+      }
+      LockInc(&shared->c.pollinterrupts);
+      n = 0;
+    }
+    for (j = 0; j < n && rc != -1 && !isrecycling; ++j) {
+      if (evs[j].data.u64 < servers.n) {
+        i = evs[j].data.u64;
+        serveraddr = &servers.p[i].addr;
+        ishandlingconnection = true;
+        rc = HandleConnection(i);
+        ishandlingconnection = false;
+      } else {
+        ResumeClient(evs[j].data.u64 - servers.n);
+      }
+    }
+    HandleWorkerHeartbeat();
+  }
+  close(epfd);
+  return StopWorker();
+}
+
+// forks long-lived workers until there's as many as were requested
+static int SpawnWorkers(void) {
+  int pid;
+  IndexAssetsIfStale();
+  while (!terminated && workers.n < preforkworkers) {
+    switch ((pid = fork())) {
+      case 0:
+        meltdown = false;
+        __isworker = true;
+        ispreforked = true;
+        iseventworker = useepoll;
+        if (iseventworker)
+          reader = ReadNonblocking;
+        connectionclose = false;
+        workers.n = 0;
+        workerrequests = 0;
+        workerbaserss = GetPeakRss();
+        if (!IsTiny() && systrace) {
+          kStartTsc = rdtsc();
+        }
+        TRACE_BEGIN;
+        if (sandboxed) {
+          CHECK_NE(-1, EnableSandbox());
+        }
+        if (hasonworkerstart) {
+          CallSimpleHook("OnWorkerStart");
+        }
+        return iseventworker ? EventWorker() : PoolWorker();
+      case -1:
+        // try again on next heartbeat
+        LockInc(&shared->c.forkerrors);
+        WARNF("(srvr) can't fork prefork worker: %m");
+        return 0;
+      default:
+        LockInc(&shared->workers);
+        ReseedRng(&rng, "parent");
+        if (hasonprocesscreate) {
+          LuaOnProcessCreate(pid);
+        }
+        workers.p = xrealloc(workers.p, (workers.n + 1) * sizeof(*workers.p));
+        workers.p[workers.n++] = pid;
+        break;
+    }
+  }
+  return 0;
+}
+
 static void HandleShutdown(void) {
   CloseServerFds();
   INFOF("(srvr) received %s", strsignal(shutdownsig));
@@ -7077,12 +7670,14 @@ static void HandleShutdown(void) {
     INFOF("(srvr) killing process group");
     KillGroup();
   }
+  KillWorkers(shutdownsig);
   WaitAll();
   INFOF("(srvr) shutdown complete");
 }
 
 // this function coroutines with linenoise
 int EventLoop(int ms) {
+  int rc;
   struct timespec t;
   DEBUGF("(repl) event loop");
   while (!terminated) {
@@ -7091,6 +7686,13 @@ int EventLoop(int ms) {
       lua_repl_lock();
       ReapZombies();
       lua_repl_unlock();
+    } else if (respawn) {
+      respawn = false;
+      lua_repl_lock();
+      rc = SpawnWorkers();
+      lua_repl_unlock();
+      if (rc == -1)
+        break;
     } else if (invalidated) {
       lua_repl_lock();
       HandleReload();
@@ -7104,6 +7706,7 @@ int EventLoop(int ms) {
                             heartbeatinterval) >= 0) {
       lastheartbeat = t;
       HandleHeartbeat();
+      respawn = preforkworkers > 0;
     } else if (HandlePoll(ms) == -1) {
       break;
     }
@@ -7256,6 +7859,8 @@ static void GetOpts(int argc, char *argv[]) {
       CASE('U', ProgramUid(atoi(optarg)));
       CASE('G', ProgramGid(atoi(optarg)));
       CASE('p', ProgramPort(ParseInt(optarg)));
+      CASE('n', ProgramEventWorkers(ParseInt(optarg)));
+      CASE('q', ProgramBacklog(ParseInt(optarg)));
       CASE('R', ProgramRedirectArg(0, optarg));
       case 'c':;  // accept "num" or "num,directive"
         char *p;
@@ -7367,6 +7972,14 @@ void RedBean(int argc, char *argv[]) {
 #endif
   LuaInit();
   oldloglevel = __log_level;
+  if (preforkworkers && (uniprocess || IsWindows())) {
+    WARNF("(srvr) prefork workers aren't supported in this mode");
+    preforkworkers = 0;
+  }
+  if (useepoll && !IsLinux()) {
+    WARNF("(srvr) event workers need linux; using worker pool instead");
+    useepoll = false;
+  }
   if (uniprocess) {
     shared->workers = 1;
   }
@@ -7398,6 +8011,7 @@ void RedBean(int argc, char *argv[]) {
   inbuf_actual.p = xmalloc(inbuf_actual.n);
   inbuf = inbuf_actual;
   isinitialized = true;
+  respawn = preforkworkers > 0;
   CallSimpleHookIfDefined("OnServerStart");
 #ifdef STATIC
   EventLoop(timespec_tomillis(heartbeatinterval));